@@ -43,7 +43,7 @@ def copy_shader(source, dest):
     print("source " + source)
     shutil.copy(source, dest)
 
-shader_names = ["default.vert", "default.frag"]
+shader_names = ["default.vert", "default.frag", "cluster_cull.comp"]
 
 def main():
     parser = argparse.ArgumentParser()
@@ -57,7 +57,11 @@ def main():
     for shader in shader_files:
         if shader in shader_names:
             path = Path(shader)
-            shader_out = path.suffix[1:len(path.suffix)] + ".spv"
+            # The default stages are named by their stage, all others by their name
+            if path.stem == "default":
+                shader_out = path.suffix[1:len(path.suffix)] + ".spv"
+            else:
+                shader_out = path.stem + ".spv"
             compile_shader(args.shader + shader, shader_out, args.verbose)
             if sys.platform == "linux":
                 copy_shader(shader_out, "../bin/shaders")
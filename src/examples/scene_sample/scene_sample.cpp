@@ -1,4 +1,278 @@
-int main(int argc, char *argv[]) {
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "common/examplebase.h"
+#include "core/threadpool.h"
+#include "scene/bvh.h"
+#include "scene/ecs.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace {
+
+using segfault::core::ThreadPool;
+using segfault::examples::ExampleBase;
+using segfault::examples::ExampleConfig;
+using segfault::scene::Aabb;
+using segfault::scene::Bvh;
+using segfault::scene::World;
+
+struct Position {
+    float x, y, z;
+};
+
+struct Velocity {
+    float x, y, z;
+};
+
+struct Spin {
+    float angle;
+    float speed;
+};
+
+struct Health {
+    float value;
+    float regeneration;
+};
+
+constexpr float WorldExtent = 100.0f;
+
+//-------------------------------------------------------------------------------------------------
+/// @brief Fills the world with moving entities and registers the systems moving them.
+/// @param[ in ] world The world.
+/// @param[ in ] count The number of entities.
+//-------------------------------------------------------------------------------------------------
+void setupScene(World &world, size_t count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-WorldExtent, WorldExtent);
+    std::uniform_real_distribution<float> speed(-5.0f, 5.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const Position p{ position(rng), position(rng), position(rng) };
+        const Velocity v{ speed(rng), speed(rng), speed(rng) };
+        switch (i % 3) {
+            case 0:
+                world.create(p, v);
+                break;
+            case 1:
+                world.create(p, v, Spin{ 0.0f, speed(rng) });
+                break;
+            default:
+                world.create(p, v, Health{ 50.0f, 1.0f });
+                break;
+        }
+    }
+
+    world.addSystem<Position, const Velocity>("integrate", [](float dt, Position &p, const Velocity &v) {
+        p.x += v.x * dt;
+        p.y += v.y * dt;
+        p.z += v.z * dt;
+    });
+    world.addSystem<const Position, Velocity>("bounce", [](float, const Position &p, Velocity &v) {
+        v.x = (p.x < -WorldExtent || p.x > WorldExtent) ? -v.x : v.x;
+        v.y = (p.y < -WorldExtent || p.y > WorldExtent) ? -v.y : v.y;
+        v.z = (p.z < -WorldExtent || p.z > WorldExtent) ? -v.z : v.z;
+    });
+    world.addSystem<Spin>("spin", [](float dt, Spin &s) {
+        s.angle += s.speed * dt;
+    });
+    world.addSystem<Health>("regenerate", [](float dt, Health &h) {
+        h.value = std::min(100.0f, h.value + h.regeneration * dt);
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+/// @brief Measures the frame time of the systems with and without worker threads.
+/// @param[ in ] count The number of entities.
+/// @param[ in ] frames The number of frames to measure.
+/// @return The exit code.
+//-------------------------------------------------------------------------------------------------
+int runBenchmark(size_t count, size_t frames) {
+    using Clock = std::chrono::steady_clock;
+
+    World world;
+    const auto setupStart = Clock::now();
+    setupScene(world, count);
+    const double setupMs = std::chrono::duration<double, std::milli>(Clock::now() - setupStart).count();
+    printf("entities: %zu, archetypes: %zu, chunks: %zu, phases: %zu, setup: %.2f ms\n", world.getNumEntities(),
+            world.getNumArchetypes(), world.getNumChunks(), world.getNumSystemPhases(), setupMs);
+
+    ThreadPool pool;
+    const float dt = 1.0f / 60.0f;
+    for (ThreadPool *workers : { static_cast<ThreadPool*>(nullptr), &pool }) {
+        world.runSystems(dt, workers);
+        const auto start = Clock::now();
+        for (size_t i = 0; i < frames; ++i) {
+            world.runSystems(dt, workers);
+        }
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+        printf("%-10s %8.3f ms/frame, %8.1f M entity updates/s\n", workers == nullptr ? "serial:" : "parallel:", ms,
+                count / ms / 1000.0);
+    }
+
+    // Structural changes: move a tenth of the entities between archetypes and back
+    std::vector<segfault::scene::Entity> entities;
+    world.query<Position>().forEachChunk([&entities](const segfault::scene::ChunkView &view) {
+        entities.insert(entities.end(), view.getEntities(), view.getEntities() + view.size());
+    });
+    const auto churnStart = Clock::now();
+    for (size_t i = 0; i < entities.size(); i += 10) {
+        world.add(entities[i], Spin{ 0.0f, 1.0f });
+    }
+    for (size_t i = 0; i < entities.size(); i += 10) {
+        world.remove<Spin>(entities[i]);
+    }
+    const double churnMs = std::chrono::duration<double, std::milli>(Clock::now() - churnStart).count();
+    printf("add/remove of %zu components: %.2f ms\n", (entities.size() + 9) / 10 * 2, churnMs);
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/// @brief Measures the build time and query throughput of the bounding volume hierarchy.
+/// @param[ in ] count The number of objects.
+/// @param[ in ] queries The number of queries per query type.
+/// @return The exit code.
+//-------------------------------------------------------------------------------------------------
+int runBvhBenchmark(size_t count, size_t queries) {
+    using Clock = std::chrono::steady_clock;
+    using segfault::scene::BvhRayHit;
+    using segfault::scene::Frustum;
+    using segfault::scene::Ray;
+
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> position(-WorldExtent, WorldExtent);
+    std::uniform_real_distribution<float> size(0.1f, 2.0f);
+    std::vector<Aabb> bounds(count);
+    for (Aabb &box : bounds) {
+        const glm::vec3 center(position(rng), position(rng) * 0.1f, position(rng));
+        const glm::vec3 extents(size(rng), size(rng), size(rng));
+        box = Aabb(center - extents, center + extents);
+    }
+
+    ThreadPool pool;
+    Bvh bvh;
+    for (ThreadPool *workers : { static_cast<ThreadPool*>(nullptr), &pool }) {
+        const auto start = Clock::now();
+        bvh.build(bounds.data(), nullptr, count, workers);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        printf("%-16s %8.2f ms, height %d, SAH cost %.1f\n", workers == nullptr ? "serial build:" : "parallel build:", ms,
+                bvh.getHeight(), bvh.computeSahCost());
+    }
+
+    auto refitStart = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        bounds[i].min.y += 0.05f;
+        bounds[i].max.y += 0.05f;
+        bvh.setBounds(static_cast<segfault::scene::BvhProxy>(i), bounds[i]);
+    }
+    bvh.refit();
+    printf("%-16s %8.2f ms\n", "refit:", std::chrono::duration<double, std::milli>(Clock::now() - refitStart).count());
+
+    std::vector<uint32_t> visible;
+    size_t numVisible = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        const glm::vec3 eye(position(rng), 20.0f, position(rng));
+        const glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f) *
+                glm::lookAt(eye, glm::vec3(position(rng), 0.0f, position(rng)), glm::vec3(0.0f, 1.0f, 0.0f));
+        visible.clear();
+        bvh.queryFrustum(Frustum::fromMatrix(viewProj), visible);
+        numVisible += visible.size();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("%-16s %8.0f queries/s, %zu objects visible on average\n", "frustum:", queries / seconds, numVisible / queries);
+
+    size_t numHits = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        const Ray ray(glm::vec3(position(rng), 20.0f, position(rng)), glm::normalize(glm::vec3(position(rng), -20.0f, position(rng))));
+        BvhRayHit hit;
+        numHits += bvh.raycast(ray, 500.0f, nullptr, hit) ? 1 : 0;
+    }
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("%-16s %8.0f rays/s, %zu hits\n", "raycast:", queries / seconds, numHits);
+
+    size_t numVisibleTargets = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        const glm::vec3 from(position(rng), 1.0f, position(rng));
+        const glm::vec3 to = from + glm::vec3(size(rng), 0.0f, size(rng)) * 5.0f;
+        numVisibleTargets += bvh.lineOfSight(from, to, nullptr) ? 1 : 0;
+    }
+    seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("%-16s %8.0f checks/s, %zu clear\n", "line of sight:", queries / seconds, numVisibleTargets);
+
     return 0;
 }
 
+//-------------------------------------------------------------------------------------------------
+/// @class SceneSample
+/// @brief Opens a window and updates an entity component system every frame.
+//-------------------------------------------------------------------------------------------------
+class SceneSample final : public ExampleBase {
+public:
+    SceneSample() :
+            ExampleBase(ExampleConfig{"scene_sample", "Scene sample", 50, 50, 800, 600, false}) {
+        // empty
+    }
+
+protected:
+    bool onSetup() override {
+        setupScene(mWorld, 10000);
+        return true;
+    }
+
+    void onUpdate(float dt) override {
+        mWorld.runSystems(dt, &mPool);
+    }
+
+private:
+    World mWorld;
+    ThreadPool mPool;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    // scene_sample --bench [entities] [frames] runs the headless ECS stress benchmark,
+    // scene_sample --bench-bvh [objects] [queries] the bounding volume hierarchy benchmark
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+        const size_t frames = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100;
+        return runBenchmark(count, frames > 0 ? frames : 1);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-bvh") == 0) {
+        const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+        const size_t queries = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+        return runBvhBenchmark(count > 0 ? count : 1, queries > 0 ? queries : 1);
+    }
+
+    SceneSample example;
+    return example.run(argc, argv);
+}
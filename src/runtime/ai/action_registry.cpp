@@ -0,0 +1,99 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/action_registry.h"
+#include "core/hash.h"
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	ActionId ActionRegistry::registerAction(const char* name, ActionHandler handler) {
+		const ActionId id = intern(name);
+		if (id != InvalidActionId) {
+			mEntries[id].action = handler;
+		}
+
+		return id;
+	}
+
+	ActionId ActionRegistry::registerCondition(const char* name, ConditionHandler handler) {
+		const ActionId id = intern(name);
+		if (id != InvalidActionId) {
+			mEntries[id].condition = handler;
+		}
+
+		return id;
+	}
+
+	ActionId ActionRegistry::findId(uint64_t nameHash) const {
+		auto it = mLookup.find(nameHash);
+		if (it == mLookup.end()) {
+			return InvalidActionId;
+		}
+
+		return it->second;
+	}
+
+	ActionId ActionRegistry::findId(const char* name) const {
+		if (name == nullptr) {
+			return InvalidActionId;
+		}
+
+		return findId(hashString(name));
+	}
+
+	ActionHandler ActionRegistry::getAction(ActionId id) const {
+		if (id >= mEntries.size()) {
+			return nullptr;
+		}
+
+		return mEntries[id].action;
+	}
+
+	ConditionHandler ActionRegistry::getCondition(ActionId id) const {
+		if (id >= mEntries.size()) {
+			return nullptr;
+		}
+
+		return mEntries[id].condition;
+	}
+
+	ActionId ActionRegistry::intern(const char* name) {
+		if (name == nullptr || *name == '\0') {
+			return InvalidActionId;
+		}
+
+		const uint64_t nameHash = hashString(name);
+		auto it = mLookup.find(nameHash);
+		if (it != mLookup.end()) {
+			return it->second;
+		}
+
+		const ActionId id = static_cast<ActionId>(mEntries.size());
+		mEntries.emplace_back();
+		mLookup[nameHash] = id;
+
+		return id;
+	}
+
+} // namespace segfault::ai
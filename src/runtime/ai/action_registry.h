@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "ai/behavior_tree_format.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::ai {
+
+	/// @brief The handler of an action node, gets the context of the agent owning the tree.
+	using ActionHandler = NodeStatus(*)(void* context);
+
+	/// @brief The handler of a condition node, gets the context of the agent owning the tree.
+	using ConditionHandler = bool(*)(void* context);
+
+	/// @brief The interned id of a registered name.
+	using ActionId = uint32_t;
+
+	/// @brief Marks an unknown name.
+	static constexpr ActionId InvalidActionId = 0xffffffff;
+
+	//---------------------------------------------------------------------------------------------
+	/// @class ActionRegistry
+	/// @brief Maps the action and condition names used in behavior trees to their handlers.
+	///
+	/// Names are interned into dense ids on registration. Trees resolve their leaf nodes once 
+	/// when they are loaded by the precomputed hash of the name, so ticking a node is a plain 
+	/// function pointer call. The handlers are copied into the nodes, the registry does not need 
+	/// to outlive the trees.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT ActionRegistry final {
+	public:
+		/// @brief The class constructor.
+		ActionRegistry() = default;
+
+		/// @brief The class destructor.
+		~ActionRegistry() = default;
+
+		/// @brief Registers the handler of an action, replaces an already registered one.
+		/// @param[ in ] name The name of the action as used in the tree description.
+		/// @param[ in ] handler The handler.
+		/// @return The interned id of the name.
+		ActionId registerAction(const char* name, ActionHandler handler);
+
+		/// @brief Registers the handler of a condition, replaces an already registered one.
+		/// @param[ in ] name The name of the condition as used in the tree description.
+		/// @param[ in ] handler The handler.
+		/// @return The interned id of the name.
+		ActionId registerCondition(const char* name, ConditionHandler handler);
+
+		/// @brief Returns the id of a name.
+		/// @param[ in ] nameHash The hash of the name, see core::hashString.
+		/// @return The id or InvalidActionId, if the name is not registered.
+		ActionId findId(uint64_t nameHash) const;
+
+		/// @brief Returns the id of a name.
+		/// @param[ in ] name The name.
+		/// @return The id or InvalidActionId, if the name is not registered.
+		ActionId findId(const char* name) const;
+
+		/// @brief Returns the action handler of an id.
+		/// @param[ in ] id The id.
+		/// @return The handler or nullptr, if no action is registered for it.
+		ActionHandler getAction(ActionId id) const;
+
+		/// @brief Returns the condition handler of an id.
+		/// @param[ in ] id The id.
+		/// @return The handler or nullptr, if no condition is registered for it.
+		ConditionHandler getCondition(ActionId id) const;
+
+		/// @brief Returns the number of interned names.
+		size_t getNumEntries() const { return mEntries.size(); }
+
+	private:
+		ActionId intern(const char* name);
+
+	private:
+		struct Entry {
+			ActionHandler action{ nullptr };
+			ConditionHandler condition{ nullptr };
+		};
+		std::vector<Entry> mEntries;
+		std::unordered_map<uint64_t, ActionId> mLookup;
+	};
+
+} // namespace segfault::ai
@@ -21,79 +21,235 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include "behavior_tree.h"
-#include "core/filearchive.h"
+#include "ai/compiled_asset.h"
+
+#include <cstddef>
+#include <new>
+#include <string>
 
 namespace segfault::ai {
 	using json = ::nlohmann::json;
 
 	using namespace segfault::core;
 
+	namespace {
+		constexpr size_t NodeAlignment = alignof(std::max_align_t);
+
+		size_t alignNodeSize(size_t size) {
+			return (size + NodeAlignment - 1) & ~(NodeAlignment - 1);
+		}
+
+		CompiledAssetCache<CompiledBehaviorTree>& getCache() {
+			static CompiledAssetCache<CompiledBehaviorTree> cache("behavior tree");
+			return cache;
+		}
+	}
+
 	class BehaviorTreeNodeFactory {
 	public:
 		BehaviorTreeNodeFactory() = default;
 		~BehaviorTreeNodeFactory() = default;
 
-		static BehaviorTreeNode* createNode(const json& nodeData) {
-			if (!nodeData.contains("type")) {
-				return nullptr;
+		static size_t getNodeSize(NodeType type) {
+			switch (type) {
+				case NodeType::SEQUENCE:
+					return alignNodeSize(sizeof(SequenceNode));
+				case NodeType::SELECTOR:
+					return alignNodeSize(sizeof(SelectorNode));
+				case NodeType::ACTION:
+					return alignNodeSize(sizeof(ActionNode));
+				case NodeType::CONDITION:
+					return alignNodeSize(sizeof(ConditionNode));
+				case NodeType::PARALLEL:
+					return alignNodeSize(sizeof(ParallelNode));
+				case NodeType::REPEAT:
+					return alignNodeSize(sizeof(RepeatNode));
+				case NodeType::TIMEOUT:
+					return alignNodeSize(sizeof(TimeoutNode));
+				case NodeType::COOLDOWN:
+					return alignNodeSize(sizeof(CooldownNode));
+				case NodeType::INVERTER:
+					return alignNodeSize(sizeof(InverterNode));
+				default:
+					return 0;
 			}
+		}
 
-			std::string nodeType = nodeData["type"].get<std::string>();
-
-			// Create the appropriate node based on the type
-			if (nodeType == "Sequence") {
-				return new SequenceNode(nodeData);
-			} else if (nodeType == "Selector") {
-				return new SelectorNode(nodeData);
-			} else if (nodeType == "Action") {
-				return new ActionNode(nodeData);
-			} else if (nodeType == "Condition") {
-				return new ConditionNode(nodeData);
-			} else {
-				// Unknown node type
-				return nullptr;
+		static BehaviorTreeNode* createNode(const BehaviorTreeNodeRecord& record, void* storage, const double* clock) {
+			DecoratorNode* decorator = nullptr;
+			switch (static_cast<NodeType>(record.type)) {
+				case NodeType::SEQUENCE:
+					return new (storage) SequenceNode();
+				case NodeType::SELECTOR:
+					return new (storage) SelectorNode();
+				case NodeType::ACTION:
+					return new (storage) ActionNode();
+				case NodeType::CONDITION:
+					return new (storage) ConditionNode();
+				case NodeType::PARALLEL:
+					return new (storage) ParallelNode(record.param);
+				case NodeType::REPEAT:
+					return new (storage) RepeatNode(record.param);
+				case NodeType::TIMEOUT:
+					decorator = new (storage) TimeoutNode(record.param);
+					break;
+				case NodeType::COOLDOWN:
+					decorator = new (storage) CooldownNode(record.param);
+					break;
+				case NodeType::INVERTER:
+					return new (storage) InverterNode();
+				default:
+					// Unknown node type
+					return nullptr;
 			}
+
+			decorator->setClock(clock);
+			return decorator;
 		}
 	};
 
-	BehaviorTree::BehaviorTree() {
-		// Constructor implementation (if needed)
+	std::shared_ptr<const CompiledBehaviorTree> BehaviorTreeCache::get(const char* configFile) {
+		return getCache().get(configFile);
+	}
+
+	void BehaviorTreeCache::clear() {
+		getCache().clear();
+	}
+
+	size_t BehaviorTreeCache::getNumEntries() {
+		return getCache().getNumEntries();
+	}
+
+	BehaviorTree::BehaviorTree() : mArena(256) {
+		// Small first block, instantiate reserves the exact size of the tree
 	}
 
 	BehaviorTree::~BehaviorTree() {
-		// Destructor implementation (if needed)
+		release();
 	}
 
 	bool BehaviorTree::init(const char* configFile) {
+		static const ActionRegistry emptyRegistry;
+		return init(configFile, emptyRegistry, nullptr);
+	}
+
+	bool BehaviorTree::init(const char* configFile, const ActionRegistry& registry, void* context) {
 		if (configFile == nullptr) {
 			return false;
 		}
-	
-		FileArchive archive(configFile, "r", true, false);
-		if (!archive.isValid()) {
+
+		release();
+		auto compiled = BehaviorTreeCache::get(configFile);
+		if (compiled == nullptr) {
 			return false;
 		}
 
-		// Read the entire file into a string
-		size_t size = archive.getSize();
-		std::string content(size, '\0');
-		archive.read(reinterpret_cast<uint8_t*>(&content[0]), size);
-		json Doc{ json::parse(content) };
-
-		mRootNode = BehaviorTreeNodeFactory::createNode(Doc);
-		if (mRootNode == nullptr) {	
+		if (!instantiate(*compiled)) {
+			release();
 			return false;
 		}
+		mCompiled = compiled;
+		bindLeafNodes(*compiled, registry, context);
+
+#ifdef SEGFAULT_BT_PROFILING
+		mProfile = BehaviorTreeProfiler::getProfile(configFile, compiled);
+		if (mProfile != nullptr) {
+			for (size_t i = 0; i < mNumNodes; ++i) {
+				mNodes[i]->setStats(mProfile->getNodeStats(i));
+			}
+		}
+#endif
 
 		return true;
 	}
 
-	void BehaviorTree::update() {
+	void BehaviorTree::update(float dt) {
 		if (mRootNode == nullptr) {
 			return;
 		}
-		
+
+		mTime += dt;
 		mRootNode->tick();
 	}
 
+	bool BehaviorTree::instantiate(const CompiledBehaviorTree& compiled) {
+		const size_t numNodes = compiled.getNumNodes();
+		if (numNodes == 0) {
+			return false;
+		}
+
+		// All nodes live in the arena of the tree, the node table doubles as the child arrays. 
+		// Reserving the exact size up front keeps the whole tree in a single block.
+		size_t storageSize = sizeof(BehaviorTreeNode*) * numNodes + alignof(std::max_align_t);
+		for (size_t i = 0; i < numNodes; ++i) {
+			storageSize += BehaviorTreeNodeFactory::getNodeSize(static_cast<NodeType>(compiled.getNode(i).type));
+		}
+		mArena.reserve(storageSize);
+
+		mNodes = mArena.allocateArray<BehaviorTreeNode*>(numNodes);
+		for (size_t i = 0; i < numNodes; ++i) {
+			const BehaviorTreeNodeRecord& record = compiled.getNode(i);
+			void* storage = mArena.allocate(BehaviorTreeNodeFactory::getNodeSize(static_cast<NodeType>(record.type)));
+			mNodes[i] = BehaviorTreeNodeFactory::createNode(record, storage, &mTime);
+			if (mNodes[i] == nullptr) {
+				return false;
+			}
+			++mNumNodes;
+		}
+
+		for (size_t i = 0; i < numNodes; ++i) {
+			const BehaviorTreeNodeRecord& record = compiled.getNode(i);
+			if (record.numChildren != 0) {
+				mNodes[i]->setChildren(&mNodes[record.firstChild], record.numChildren);
+			}
+		}
+		mRootNode = mNodes[0];
+
+		return true;
+	}
+
+	void BehaviorTree::bindLeafNodes(const CompiledBehaviorTree& compiled, const ActionRegistry& registry, void* context) {
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			const BehaviorTreeNodeRecord& record = compiled.getNode(i);
+			const NodeType type = static_cast<NodeType>(record.type);
+			if (type != NodeType::ACTION && type != NodeType::CONDITION) {
+				continue;
+			}
+
+			const ActionId id = registry.findId(record.nameHash);
+			if (type == NodeType::ACTION && registry.getAction(id) != nullptr) {
+				static_cast<ActionNode*>(mNodes[i])->bind(registry.getAction(id), context);
+			} else if (type == NodeType::CONDITION && registry.getCondition(id) != nullptr) {
+				static_cast<ConditionNode*>(mNodes[i])->bind(registry.getCondition(id), context);
+			} else if (registry.getNumEntries() != 0) {
+				const std::string msg = std::string("Unbound behavior tree node ") + compiled.getName(record) + ", it will always fail.";
+				logMessage(LogType::Warn, msg.c_str());
+			}
+		}
+	}
+
+	BehaviorTreeMemoryStats BehaviorTree::getMemoryStats() const {
+		BehaviorTreeMemoryStats stats;
+		stats.numNodes = mNumNodes;
+		stats.bytesUsed = mArena.getBytesUsed();
+		stats.bytesReserved = mArena.getBytesReserved();
+		stats.sharedBytes = mCompiled != nullptr ? mCompiled->getMemorySize() : 0;
+
+		return stats;
+	}
+
+	void BehaviorTree::release() {
+		// The nodes own no memory, destroying them is all that is left before rewinding the arena
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			mNodes[i]->~BehaviorTreeNode();
+		}
+		mNodes = nullptr;
+		mNumNodes = 0;
+		mArena.reset();
+		mRootNode = nullptr;
+		mTime = 0.0;
+		mCompiled.reset();
+		mProfile.reset();
+	}
+
 } // namespace segfault::ai
@@ -23,33 +23,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "core/segfault.h"
+#include "ai/behavior_tree_format.h"
+#include "ai/behavior_tree_profiler.h"
+#include "ai/action_registry.h"
+#include "core/monotonicarena.h"
 
-#include <functional>
-#include <nlohmann/json.hpp>
+#include <cassert>
+#include <memory>
+#include <vector>
 
 namespace segfault::ai {
 
-	using json = ::nlohmann::json;
-
-	enum class NodeStatus {
-		INVALID = -1,
-		IDLE = 0,
-		RUNNING = 1,
-		SUCCESS = 2,
-		FAILURE = 3,
-		SKIPPED = 4,
-		COUNT
-	};
-
-	enum class NodeType {
-		INVALID = -1,
-		SEQUENCE,
-		SELECTOR,
-		CONDITION,
-		ACTION,
-		Count
-	};
-
 	//---------------------------------------------------------------------------------------------
 	/// @class BehaviorTreeNode
 	/// @brief The BehaviorTreeNode class represents a single node in a behavior tree, which is a
@@ -63,120 +47,442 @@ namespace segfault::ai {
 		BehaviorTreeNode(const BehaviorTreeNode& rhs) = delete;
 		BehaviorTreeNode& operator = (const BehaviorTreeNode& rhs) = delete;
 
-		BehaviorTreeNode() = default;
+		explicit BehaviorTreeNode(NodeType type) : mNodeType(type) {
+			// empty
+		}
+
 		virtual ~BehaviorTreeNode() = default;
-		
-		/// @brief Pure virtual function to be implemented by derived classes
-		virtual NodeStatus tick() = 0;
 
-		virtual void addChild(BehaviorTreeNode* node) {}
+		/// @brief Ticks the node and records its statistics, if profiling is enabled.
+		/// @return The status of the node after the tick.
+		NodeStatus tick() {
+#ifdef SEGFAULT_BT_PROFILING
+			if (mStats != nullptr) {
+				const auto start = std::chrono::steady_clock::now();
+				mNodeStatus = onTick();
+				const auto end = std::chrono::steady_clock::now();
+				mStats->record(mNodeStatus, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+				return mNodeStatus;
+			}
+#endif
+			mNodeStatus = onTick();
+			return mNodeStatus;
+		}
+
+		/// @brief Assigns the children of the node. The children are owned by the tree.
+		/// @param[ in ] children The array of children.
+		/// @param[ in ] numChildren The number of children.
+		virtual void setChildren(BehaviorTreeNode* const* /*children*/, size_t /*numChildren*/) {}
+
+		/// @brief Aborts the node if it is running and resets its state for the next activation. 
+		/// Running children are halted as well.
+		void halt() {
+			if (mNodeStatus == NodeStatus::RUNNING) {
+				onHalt();
+			}
+			mNodeStatus = NodeStatus::INVALID;
+		}
 
 		NodeType getNodeType() const { return mNodeType; }
 		NodeStatus getNodeStatus() const { return mNodeStatus; }
 
+#ifdef SEGFAULT_BT_PROFILING
+		/// @brief Assigns the statistics the node records its ticks into.
+		void setStats(BehaviorTreeNodeStats* stats) { mStats = stats; }
+#endif
+
+	protected:
+		/// @brief Pure virtual function to be implemented by derived classes
+		virtual NodeStatus onTick() = 0;
+
+		/// @brief Called when a running node is halted, resets the state of the node.
+		virtual void onHalt() {}
+
 	private:
 		NodeType mNodeType{ NodeType::INVALID };
 		NodeStatus mNodeStatus{ NodeStatus::INVALID };
+#ifdef SEGFAULT_BT_PROFILING
+		BehaviorTreeNodeStats* mStats{ nullptr };
+#endif
 	};
 
-	class SequenceNode : public BehaviorTreeNode {
+	class CompositeNode : public BehaviorTreeNode {
 	public:
-		explicit SequenceNode(const json& nodeData) {
+		explicit CompositeNode(NodeType type) : BehaviorTreeNode(type) {
 			// empty
 		}
 
-		NodeStatus tick() override {
-			for (auto *child : mChildren) {
-				assert(child != nullptr);
-				auto status = child->tick();
+		void setChildren(BehaviorTreeNode* const* children, size_t numChildren) override {
+			mChildren = children;
+			mNumChildren = numChildren;
+		}
+
+	protected:
+		void onHalt() override {
+			haltChildren(0);
+		}
+
+		/// @brief Halts the children starting at the given index.
+		void haltChildren(size_t first) {
+			for (size_t i = first; i < mNumChildren; ++i) {
+				mChildren[i]->halt();
+			}
+		}
+
+	protected:
+		BehaviorTreeNode* const* mChildren{ nullptr };
+		size_t mNumChildren{ 0 };
+	};
+
+	class SequenceNode : public CompositeNode {
+	public:
+		SequenceNode() : CompositeNode(NodeType::SEQUENCE) {
+			// empty
+		}
+
+	protected:
+		NodeStatus onTick() override {
+			for (size_t i = 0; i < mNumChildren; ++i) {
+				assert(mChildren[i] != nullptr);
+				auto status = mChildren[i]->tick();
 				if (status != NodeStatus::SUCCESS) {
+					// Children behind this one may still run from an earlier tick
+					haltChildren(i + 1);
 					return status;
 				}
 			}
 			return NodeStatus::SUCCESS;
 		}
+	};
+
+	class ConditionNode : public BehaviorTreeNode {
+	public:
+		ConditionNode() : BehaviorTreeNode(NodeType::CONDITION) {
+			// empty
+		}
 
-		~SequenceNode() override {
-			for (auto child : mChildren) {
-				delete child;
+		ConditionNode(ConditionHandler handler, void* context) : BehaviorTreeNode(NodeType::CONDITION), 
+				mHandler(handler), mContext(context) {
+			// empty
+		}
+
+		/// @brief Binds the handler and the agent context.
+		void bind(ConditionHandler handler, void* context) {
+			mHandler = handler;
+			mContext = context;
+		}
+
+	protected:
+		NodeStatus onTick() override {
+			if (mHandler == nullptr) {
+				return NodeStatus::FAILURE;
 			}
-			mChildren.clear();
+			
+			return mHandler(mContext) ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+		}
+
+	private:
+		ConditionHandler mHandler{ nullptr };
+		void* mContext{ nullptr };
+	};
+
+	class ActionNode : public BehaviorTreeNode {
+	public:
+		ActionNode() : BehaviorTreeNode(NodeType::ACTION) {
+			// empty
+		}
+
+		ActionNode(ActionHandler handler, void* context) : BehaviorTreeNode(NodeType::ACTION), 
+				mHandler(handler), mContext(context) {
+			// empty
+		}
+
+		/// @brief Binds the handler and the agent context.
+		void bind(ActionHandler handler, void* context) {
+			mHandler = handler;
+			mContext = context;
 		}
 
-		void addChild(BehaviorTreeNode* node) override {
-			mChildren.push_back(node);
+	protected:
+		NodeStatus onTick() override {
+			if (mHandler == nullptr) {
+				return NodeStatus::FAILURE;
+			}
+
+			return mHandler(mContext);
 		}
 
 	private:
-		std::vector< BehaviorTreeNode*> mChildren;
+		ActionHandler mHandler{ nullptr };
+		void* mContext{ nullptr };
 	};
 
-	class ConditionNode : public SequenceNode {
+	class SelectorNode : public CompositeNode {
 	public:
-		explicit ConditionNode(const json& nodeData) : SequenceNode(nodeData) {
+		SelectorNode() : CompositeNode(NodeType::SELECTOR) {
 			// empty
 		}
 
-		NodeStatus tick() override {
-			if (mFunc()) {
-				return mFunc() ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+	protected:
+		NodeStatus onTick() override {
+			for (size_t i = 0; i < mNumChildren; ++i) {
+				assert(mChildren[i] != nullptr);
+
+				auto status = mChildren[i]->tick();
+				if (status != NodeStatus::FAILURE) {
+					haltChildren(i + 1);
+					return status;
+				}
 			}
-			
 			return NodeStatus::FAILURE;
 		}
+	};
+
+	class ParallelNode : public CompositeNode {
+	public:
+		explicit ParallelNode(uint32_t successThreshold) : CompositeNode(NodeType::PARALLEL), mSuccessThreshold(successThreshold) {
+			// empty
+		}
+
+	protected:
+		NodeStatus onTick() override {
+			assert(mNumChildren <= MaxParallelChildren);
+
+			// Finished children are not ticked again until the whole node has finished
+			for (size_t i = 0; i < mNumChildren; ++i) {
+				const uint64_t mask = 1ull << i;
+				if (((mSucceeded | mFailed) & mask) != 0) {
+					continue;
+				}
+
+				const auto status = mChildren[i]->tick();
+				if (status == NodeStatus::SUCCESS) {
+					mSucceeded |= mask;
+				} else if (status == NodeStatus::FAILURE) {
+					mFailed |= mask;
+				}
+			}
+
+			const size_t threshold = mSuccessThreshold < mNumChildren ? mSuccessThreshold : mNumChildren;
+			if (countBits(mSucceeded) >= threshold) {
+				onHalt();
+				return NodeStatus::SUCCESS;
+			}
+			if (countBits(mFailed) > mNumChildren - threshold) {
+				onHalt();
+				return NodeStatus::FAILURE;
+			}
+
+			return NodeStatus::RUNNING;
+		}
+
+		void onHalt() override {
+			// Children still running when the node finishes are aborted
+			haltChildren(0);
+			mSucceeded = mFailed = 0;
+		}
+
+	private:
+		static size_t countBits(uint64_t mask) {
+			size_t count = 0;
+			for (; mask != 0; mask &= mask - 1) {
+				++count;
+			}
+			return count;
+		}
 
 	private:
-		std::function<bool()> mFunc;
+		uint32_t mSuccessThreshold{ 0 };
+		uint64_t mSucceeded{ 0 };
+		uint64_t mFailed{ 0 };
 	};
 
-	class ActionNode : public BehaviorTreeNode {
+	class DecoratorNode : public CompositeNode {
+	public:
+		explicit DecoratorNode(NodeType type) : CompositeNode(type) {
+			// empty
+		}
+
+		/// @brief Assigns the clock of the tree in seconds, used by timed decorators.
+		void setClock(const double* clock) {
+			mClock = clock;
+		}
+
+	protected:
+		BehaviorTreeNode* getChild() const {
+			return mNumChildren != 0 ? mChildren[0] : nullptr;
+		}
+
+		double now() const {
+			return mClock != nullptr ? *mClock : 0.0;
+		}
+
+	private:
+		const double* mClock{ nullptr };
+	};
+
+	class InverterNode : public DecoratorNode {
 	public:
-		explicit ActionNode(const json& nodeData) {
+		InverterNode() : DecoratorNode(NodeType::INVERTER) {
 			// empty
 		}
 
+	protected:
+		NodeStatus onTick() override {
+			BehaviorTreeNode* child = getChild();
+			if (child == nullptr) {
+				return NodeStatus::FAILURE;
+			}
+
+			const auto status = child->tick();
+			if (status == NodeStatus::SUCCESS) {
+				return NodeStatus::FAILURE;
+			} else if (status == NodeStatus::FAILURE) {
+				return NodeStatus::SUCCESS;
+			}
+			return status;
+		}
+	};
 
-		explicit ActionNode(std::function<NodeStatus()> func) : mFunc(func) {
+	class RepeatNode : public DecoratorNode {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] count The number of successful runs, zero repeats forever.
+		explicit RepeatNode(uint32_t count) : DecoratorNode(NodeType::REPEAT), mCount(count) {
 			// empty
 		}
 
-		NodeStatus tick() override {
-			return mFunc();
+	protected:
+		NodeStatus onTick() override {
+			BehaviorTreeNode* child = getChild();
+			if (child == nullptr) {
+				return NodeStatus::FAILURE;
+			}
+
+			// Run the child at most once per tick to keep the cost of a tick bounded
+			const auto status = child->tick();
+			if (status == NodeStatus::FAILURE) {
+				mRuns = 0;
+				return NodeStatus::FAILURE;
+			}
+			if (status == NodeStatus::SUCCESS && mCount != 0 && ++mRuns >= mCount) {
+				mRuns = 0;
+				return NodeStatus::SUCCESS;
+			}
+
+			return NodeStatus::RUNNING;
+		}
+
+		void onHalt() override {
+			haltChildren(0);
+			mRuns = 0;
 		}
 
 	private:
-		std::function<NodeStatus()> mFunc;
+		uint32_t mCount{ 0 };
+		uint32_t mRuns{ 0 };
 	};
 
-	class SelectorNode : public BehaviorTreeNode {
+	class TimeoutNode : public DecoratorNode {
 	public:
-		explicit SelectorNode(const json& nodeData) {
+		/// @brief The class constructor.
+		/// @param[ in ] durationMs The time the child may keep running in milliseconds.
+		explicit TimeoutNode(uint32_t durationMs) : DecoratorNode(NodeType::TIMEOUT), mDuration(durationMs / 1000.0) {
 			// empty
 		}
 
-		~SelectorNode() override {
-			for (auto* child : mChildren) {
-				delete child;
+	protected:
+		NodeStatus onTick() override {
+			BehaviorTreeNode* child = getChild();
+			if (child == nullptr) {
+				return NodeStatus::FAILURE;
+			}
+
+			if (!mRunning) {
+				mStartTime = now();
+				mRunning = true;
+			}
+
+			const auto status = child->tick();
+			if (status != NodeStatus::RUNNING) {
+				mRunning = false;
+				return status;
+			}
+			if (now() - mStartTime >= mDuration) {
+				onHalt();
+				return NodeStatus::FAILURE;
 			}
-			mChildren.clear();
+
+			return NodeStatus::RUNNING;
 		}
 
-		void addChild(BehaviorTreeNode* node) override {
-			mChildren.push_back(node);
+		void onHalt() override {
+			haltChildren(0);
+			mRunning = false;
 		}
 
-		NodeStatus tick() override {
-			for (auto* child : mChildren) {
-				assert(child != nullptr);
+	private:
+		double mDuration{ 0.0 };
+		double mStartTime{ 0.0 };
+		bool mRunning{ false };
+	};
 
-				auto status = child->tick();
-				if (status != NodeStatus::FAILURE) return status;
+	class CooldownNode : public DecoratorNode {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] durationMs The time the child is blocked after it has finished in milliseconds.
+		explicit CooldownNode(uint32_t durationMs) : DecoratorNode(NodeType::COOLDOWN), mDuration(durationMs / 1000.0) {
+			// empty
+		}
+
+	protected:
+		NodeStatus onTick() override {
+			BehaviorTreeNode* child = getChild();
+			if (child == nullptr || now() < mReadyTime) {
+				return NodeStatus::FAILURE;
 			}
-			return NodeStatus::FAILURE;
+
+			const auto status = child->tick();
+			if (status == NodeStatus::SUCCESS || status == NodeStatus::FAILURE) {
+				mReadyTime = now() + mDuration;
+			}
+
+			return status;
 		}
 
 	private:
-		std::vector< BehaviorTreeNode*> mChildren;
+		double mDuration{ 0.0 };
+		double mReadyTime{ 0.0 };
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class BehaviorTreeCache
+	/// @brief Process-wide cache of compiled behavior trees.
+	///
+	/// The cache is keyed by the hash of the file name, so every tree file is read and compiled 
+	/// only once per process regardless of how many agents are using it. It accepts both, baked 
+	/// blobs and json descriptions.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT BehaviorTreeCache final {
+	public:
+		/// @brief Returns the compiled tree for a file, loads it on the first request.
+		/// @param[ in ] configFile The path to the tree file.
+		/// @return The compiled tree or nullptr if the file cannot be loaded.
+		static std::shared_ptr<const CompiledBehaviorTree> get(const char* configFile);
+
+		/// @brief Drops all cached trees. Trees still in use stay alive until released.
+		static void clear();
+
+		/// @brief Returns the number of cached trees.
+		static size_t getNumEntries();
+	};
+
+	/// @brief The memory footprint of a behavior tree instance.
+	struct BehaviorTreeMemoryStats {
+		size_t numNodes{ 0 };           ///< The number of nodes.
+		size_t bytesUsed{ 0 };          ///< The bytes used by the nodes and the node table.
+		size_t bytesReserved{ 0 };      ///< The bytes reserved by the arena of the tree.
+		size_t sharedBytes{ 0 };        ///< The bytes of the compiled tree, shared by all instances.
 	};
 
 	//---------------------------------------------------------------------------------------------
@@ -199,15 +505,41 @@ namespace segfault::ai {
 		~BehaviorTree();
 
 		/// @brief Initializes the behavior tree with the specified parameters.
-		/// @param[ in ] configFile The path to the configuration file that defines the behavior tree structure.
+		/// @param[ in ] configFile The path to the json description or the baked blob of the tree.
 		/// @return True if initialization was successful, false otherwise.
 		bool init(const char* configFile);
 
+		/// @brief Initializes the behavior tree and binds its actions and conditions.
+		/// @param[ in ] configFile The path to the json description or the baked blob of the tree.
+		/// @param[ in ] registry The registry to resolve the action and condition names.
+		/// @param[ in ] context The agent context passed to all handlers.
+		/// @return True if initialization was successful, false otherwise.
+		bool init(const char* configFile, const ActionRegistry& registry, void* context);
+
 		/// @brief Updates the behavior tree, processing the nodes and executing actions as needed.
-		void update();
+		/// @param[ in ] dt The elapsed time since the last update in seconds, drives the timeouts 
+		/// and cooldowns.
+		void update(float dt = 0.0f);
+
+		/// @brief Returns the accumulated time of all updates in seconds.
+		double getTime() const { return mTime; }
+
+		/// @brief Returns the memory footprint of the tree.
+		BehaviorTreeMemoryStats getMemoryStats() const;
+
+	private:
+		bool instantiate(const CompiledBehaviorTree& compiled);
+		void bindLeafNodes(const CompiledBehaviorTree& compiled, const ActionRegistry& registry, void* context);
+		void release();
 
 	private:
+		std::shared_ptr<const CompiledBehaviorTree> mCompiled;
+		std::shared_ptr<BehaviorTreeProfile> mProfile;
+		core::MonotonicArena mArena;
+		BehaviorTreeNode** mNodes{ nullptr };
+		size_t mNumNodes{ 0 };
 		BehaviorTreeNode* mRootNode{ nullptr };
+		double mTime{ 0.0 };
 	};
 
 } // namespace segfault::ai
@@ -0,0 +1,316 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/behavior_tree_format.h"
+#include "core/hash.h"
+#include "core/monotonicarena.h"
+
+#include <cstring>
+#include <limits>
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	namespace {
+		NodeType getNodeTypeByName(const std::string &name) {
+			if (name == "Sequence") {
+				return NodeType::SEQUENCE;
+			} else if (name == "Selector") {
+				return NodeType::SELECTOR;
+			} else if (name == "Condition") {
+				return NodeType::CONDITION;
+			} else if (name == "Action") {
+				return NodeType::ACTION;
+			} else if (name == "Parallel") {
+				return NodeType::PARALLEL;
+			} else if (name == "Repeat") {
+				return NodeType::REPEAT;
+			} else if (name == "Timeout") {
+				return NodeType::TIMEOUT;
+			} else if (name == "Cooldown") {
+				return NodeType::COOLDOWN;
+			} else if (name == "Inverter") {
+				return NodeType::INVERTER;
+			}
+
+			return NodeType::INVALID;
+		}
+
+		bool isDecoratorType(uint8_t type) {
+			const NodeType nodeType = static_cast<NodeType>(type);
+			return nodeType == NodeType::REPEAT || nodeType == NodeType::TIMEOUT || 
+				nodeType == NodeType::COOLDOWN || nodeType == NodeType::INVERTER;
+		}
+
+		bool isCompositeType(uint8_t type) {
+			const NodeType nodeType = static_cast<NodeType>(type);
+			return nodeType == NodeType::SEQUENCE || nodeType == NodeType::SELECTOR || 
+				nodeType == NodeType::PARALLEL || isDecoratorType(type);
+		}
+
+		uint32_t getSeconds(const json& nodeData, const char* key) {
+			auto it = nodeData.find(key);
+			if (it == nodeData.end() || !it->is_number() || it->get<double>() < 0.0) {
+				return 0;
+			}
+
+			return static_cast<uint32_t>(it->get<double>() * 1000.0 + 0.5);
+		}
+
+		uint32_t getCount(const json& nodeData, const char* key, uint32_t defaultValue) {
+			auto it = nodeData.find(key);
+			if (it == nodeData.end() || !it->is_number_unsigned()) {
+				return defaultValue;
+			}
+
+			return it->get<uint32_t>();
+		}
+
+		uint32_t getParam(NodeType type, const json& nodeData, size_t numChildren) {
+			switch (type) {
+				case NodeType::PARALLEL:
+					return getCount(nodeData, "successThreshold", static_cast<uint32_t>(numChildren));
+				case NodeType::REPEAT:
+					return getCount(nodeData, "count", 0);
+				case NodeType::TIMEOUT:
+				case NodeType::COOLDOWN:
+					return getSeconds(nodeData, "seconds");
+				default:
+					return 0;
+			}
+		}
+
+		bool validateChildren(uint8_t type, size_t numChildren) {
+			if (isDecoratorType(type) && numChildren != 1) {
+				logMessage(LogType::Error, "A behavior tree decorator needs exactly one child.");
+				return false;
+			}
+			if (static_cast<NodeType>(type) == NodeType::PARALLEL && numChildren > MaxParallelChildren) {
+				logMessage(LogType::Error, "Too many children of a behavior tree parallel node.");
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	const char* getNodeTypeName(NodeType type) {
+		switch (type) {
+			case NodeType::SEQUENCE:
+				return "Sequence";
+			case NodeType::SELECTOR:
+				return "Selector";
+			case NodeType::CONDITION:
+				return "Condition";
+			case NodeType::ACTION:
+				return "Action";
+			case NodeType::PARALLEL:
+				return "Parallel";
+			case NodeType::REPEAT:
+				return "Repeat";
+			case NodeType::TIMEOUT:
+				return "Timeout";
+			case NodeType::COOLDOWN:
+				return "Cooldown";
+			case NodeType::INVERTER:
+				return "Inverter";
+			default:
+				return "Invalid";
+		}
+	}
+
+	bool CompiledBehaviorTree::compile(const json &doc) {
+		clear();
+
+		// Flatten the tree breadth-first, the children of each node get consecutive indices. The 
+		// queue is a temporary, so it lives in an arena which is dropped in one go.
+		MonotonicArena scratch(16 * 1024);
+		std::vector<const json*, ArenaAllocator<const json*>> pending{ ArenaAllocator<const json*>(scratch) };
+		pending.reserve(64);
+		pending.push_back(&doc);
+		for (size_t current = 0; current < pending.size(); ++current) {
+			const json &nodeData = *pending[current];
+			if (!nodeData.is_object()) {
+				logMessage(LogType::Error, "Behavior tree node is not an object.");
+				clear();
+				return false;
+			}
+
+			auto typeIt = nodeData.find("type");
+			if (typeIt == nodeData.end() || !typeIt->is_string()) {
+				logMessage(LogType::Error, "Behavior tree node without type.");
+				clear();
+				return false;
+			}
+
+			const std::string &typeName = typeIt->get_ref<const std::string&>();
+			const NodeType type = getNodeTypeByName(typeName);
+			if (type == NodeType::INVALID) {
+				const std::string msg = "Unknown behavior tree node type " + typeName + ".";
+				logMessage(LogType::Error, msg.c_str());
+				clear();
+				return false;
+			}
+
+			BehaviorTreeNodeRecord record;
+			record.type = static_cast<uint8_t>(type);
+
+			auto nameIt = nodeData.find("name");
+			if (nameIt != nodeData.end() && nameIt->is_string()) {
+				const std::string &name = nameIt->get_ref<const std::string&>();
+				record.nameOffset = addString(name);
+				record.nameHash = hashString(name.c_str());
+			}
+
+			auto childrenIt = nodeData.find("children");
+			if (childrenIt != nodeData.end()) {
+				if (!childrenIt->is_array() || childrenIt->size() > std::numeric_limits<uint16_t>::max()) {
+					logMessage(LogType::Error, "Invalid children of behavior tree node.");
+					clear();
+					return false;
+				}
+
+				if (!isCompositeType(record.type) && !childrenIt->empty()) {
+					logMessage(LogType::Warn, "Children of a leaf node will be ignored.");
+				} else {
+					record.firstChild = static_cast<uint32_t>(pending.size());
+					record.numChildren = static_cast<uint16_t>(childrenIt->size());
+					for (const auto &child : *childrenIt) {
+						pending.push_back(&child);
+					}
+				}
+			}
+
+			if (!validateChildren(record.type, record.numChildren)) {
+				clear();
+				return false;
+			}
+			record.param = getParam(type, nodeData, record.numChildren);
+
+			mNodes.push_back(record);
+		}
+		mNodes.shrink_to_fit();
+		mStrings.shrink_to_fit();
+
+		return true;
+	}
+
+	bool CompiledBehaviorTree::load(const uint8_t *data, size_t size) {
+		clear();
+		if (!isBinary(data, size) || size < sizeof(BehaviorTreeFileHeader)) {
+			return false;
+		}
+
+		BehaviorTreeFileHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (header.version != BehaviorTreeVersion) {
+			logMessage(LogType::Error, "Unsupported behavior tree version, rebake the asset.");
+			return false;
+		}
+
+		const size_t recordsSize = static_cast<size_t>(header.numNodes) * sizeof(BehaviorTreeNodeRecord);
+		if (header.numNodes == 0 || sizeof(header) + recordsSize + header.stringTableSize > size) {
+			logMessage(LogType::Error, "Behavior tree blob is truncated.");
+			return false;
+		}
+
+		mNodes.resize(header.numNodes);
+		memcpy(mNodes.data(), data + sizeof(header), recordsSize);
+		mStrings.assign(data + sizeof(header) + recordsSize, data + sizeof(header) + recordsSize + header.stringTableSize);
+
+		// Never trust baked data: children must point forward and names must be terminated
+		if (!mStrings.empty() && mStrings.back() != '\0') {
+			logMessage(LogType::Error, "Behavior tree string table is corrupt.");
+			clear();
+			return false;
+		}
+
+		for (size_t i = 0; i < mNodes.size(); ++i) {
+			const BehaviorTreeNodeRecord &node = mNodes[i];
+			const bool validChildren = node.numChildren == 0 || 
+				(node.firstChild > i && static_cast<size_t>(node.firstChild) + node.numChildren <= mNodes.size());
+			const bool validName = node.nameOffset == InvalidStringOffset || node.nameOffset < mStrings.size();
+			if (node.type >= static_cast<uint8_t>(NodeType::Count) || !validChildren || !validName || 
+					!validateChildren(node.type, node.numChildren)) {
+				logMessage(LogType::Error, "Behavior tree node record is corrupt.");
+				clear();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool CompiledBehaviorTree::save(std::vector<uint8_t> &blob) const {
+		if (mNodes.empty()) {
+			return false;
+		}
+
+		BehaviorTreeFileHeader header;
+		header.numNodes = static_cast<uint32_t>(mNodes.size());
+		header.stringTableSize = static_cast<uint32_t>(mStrings.size());
+
+		const size_t recordsSize = mNodes.size() * sizeof(BehaviorTreeNodeRecord);
+		blob.resize(sizeof(header) + recordsSize + mStrings.size());
+		memcpy(blob.data(), &header, sizeof(header));
+		memcpy(blob.data() + sizeof(header), mNodes.data(), recordsSize);
+		if (!mStrings.empty()) {
+			memcpy(blob.data() + sizeof(header) + recordsSize, mStrings.data(), mStrings.size());
+		}
+
+		return true;
+	}
+
+	bool CompiledBehaviorTree::isBinary(const uint8_t *data, size_t size) {
+		if (data == nullptr || size < sizeof(uint32_t)) {
+			return false;
+		}
+
+		uint32_t magic{ 0 };
+		memcpy(&magic, data, sizeof(magic));
+
+		return magic == BehaviorTreeMagic;
+	}
+
+	const char *CompiledBehaviorTree::getName(const BehaviorTreeNodeRecord &node) const {
+		if (node.nameOffset == InvalidStringOffset) {
+			return "";
+		}
+
+		return &mStrings[node.nameOffset];
+	}
+
+	void CompiledBehaviorTree::clear() {
+		mNodes.clear();
+		mStrings.clear();
+	}
+
+	uint32_t CompiledBehaviorTree::addString(const std::string &str) {
+		const uint32_t offset = static_cast<uint32_t>(mStrings.size());
+		mStrings.insert(mStrings.end(), str.begin(), str.end());
+		mStrings.push_back('\0');
+
+		return offset;
+	}
+
+} // namespace segfault::ai
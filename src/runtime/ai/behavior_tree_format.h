@@ -0,0 +1,163 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace segfault::ai {
+
+	using json = ::nlohmann::json;
+
+	enum class NodeStatus {
+		INVALID = -1,
+		IDLE = 0,
+		RUNNING = 1,
+		SUCCESS = 2,
+		FAILURE = 3,
+		SKIPPED = 4,
+		COUNT
+	};
+
+	enum class NodeType {
+		INVALID = -1,
+		SEQUENCE,
+		SELECTOR,
+		CONDITION,
+		ACTION,
+		PARALLEL,
+		REPEAT,
+		TIMEOUT,
+		COOLDOWN,
+		INVERTER,
+		Count
+	};
+
+	/// @brief Returns the name of a node type as used in the json description.
+	/// @param[ in ] type The node type.
+	/// @return The name, "Invalid" for unknown types.
+	SEGFAULT_EXPORT const char* getNodeTypeName(NodeType type);
+
+	/// @brief The magic number of a baked behavior tree blob, "SFBT" in little endian.
+	static constexpr uint32_t BehaviorTreeMagic = 0x54424653;
+
+	/// @brief The version of the baked behavior tree format.
+	static constexpr uint16_t BehaviorTreeVersion = 2;
+
+	/// @brief The maximum number of children of a parallel node.
+	static constexpr uint32_t MaxParallelChildren = 64;
+
+	/// @brief Marks a missing string in the string table.
+	static constexpr uint32_t InvalidStringOffset = 0xffffffff;
+
+	/// @brief The header of a baked behavior tree blob.
+	struct BehaviorTreeFileHeader {
+		uint32_t magic{ BehaviorTreeMagic };		///< The magic number, must be BehaviorTreeMagic.
+		uint16_t version{ BehaviorTreeVersion };	///< The format version.
+		uint16_t reserved{ 0 };						///< Reserved, must be zero.
+		uint32_t numNodes{ 0 };						///< The number of node records following the header.
+		uint32_t stringTableSize{ 0 };				///< The size of the string table after the records.
+	};
+	static_assert(sizeof(BehaviorTreeFileHeader) == 16, "Unexpected header layout.");
+
+	/// @brief A single flattened node. The nodes are stored breadth-first, so the children of a 
+	/// node are always the contiguous range [firstChild, firstChild + numChildren).
+	struct BehaviorTreeNodeRecord {
+		uint8_t type{ 0 };							///< The NodeType of the node.
+		uint8_t reserved{ 0 };						///< Reserved, must be zero.
+		uint16_t numChildren{ 0 };					///< The number of children.
+		uint32_t firstChild{ 0 };					///< The index of the first child.
+		uint32_t nameOffset{ InvalidStringOffset };	///< The offset of the node name in the string table.
+		uint32_t param{ 0 };						///< The node parameter, the success threshold of a parallel,
+													///< the count of a repeat or the duration of a timeout or 
+													///< cooldown in milliseconds.
+		uint64_t nameHash{ 0 };						///< The hash of the node name, used to bind leaf nodes.
+	};
+	static_assert(sizeof(BehaviorTreeNodeRecord) == 24, "Unexpected node record layout.");
+
+	//---------------------------------------------------------------------------------------------
+	/// @class CompiledBehaviorTree
+	/// @brief The immutable, flattened form of a behavior tree.
+	///
+	/// A compiled tree is either loaded from a blob baked by the assetbaker or compiled once from 
+	/// the json description. It is shared between all agents using the same tree, the runtime 
+	/// nodes are instantiated from it without any further parsing.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT CompiledBehaviorTree final {
+	public:
+		/// @brief The class constructor.
+		CompiledBehaviorTree() = default;
+
+		/// @brief The class destructor.
+		~CompiledBehaviorTree() = default;
+
+		/// @brief Compiles the tree from its json description.
+		/// @param[ in ] doc The json document describing the root node.
+		/// @return True if the document describes a valid tree, false otherwise.
+		bool compile(const json &doc);
+
+		/// @brief Loads the tree from a baked blob.
+		/// @param[ in ] data The blob data.
+		/// @param[ in ] size The size of the blob in bytes.
+		/// @return True if the blob is a valid tree, false otherwise.
+		bool load(const uint8_t *data, size_t size);
+
+		/// @brief Serializes the tree into a blob.
+		/// @param[ out ] blob The blob to write to.
+		/// @return True if the tree was serialized, false if the tree is empty.
+		bool save(std::vector<uint8_t> &blob) const;
+
+		/// @brief Checks if the data starts with the baked behavior tree magic.
+		/// @param[ in ] data The data to check.
+		/// @param[ in ] size The size of the data in bytes.
+		/// @return True if the data is a baked blob.
+		static bool isBinary(const uint8_t *data, size_t size);
+
+		/// @brief Returns the number of nodes.
+		size_t getNumNodes() const { return mNodes.size(); }
+
+		/// @brief Returns the node record at the given index.
+		const BehaviorTreeNodeRecord &getNode(size_t index) const { return mNodes[index]; }
+
+		/// @brief Returns the name of a node.
+		/// @param[ in ] node The node record.
+		/// @return The name or an empty string, if the node has no name.
+		const char *getName(const BehaviorTreeNodeRecord &node) const;
+
+		/// @brief Returns the size of the node records and the string table in bytes.
+		size_t getMemorySize() const { return mNodes.capacity() * sizeof(BehaviorTreeNodeRecord) + mStrings.capacity(); }
+
+	private:
+		void clear();
+		uint32_t addString(const std::string &str);
+
+	private:
+		std::vector<BehaviorTreeNodeRecord> mNodes;
+		std::vector<char> mStrings;
+	};
+
+} // namespace segfault::ai
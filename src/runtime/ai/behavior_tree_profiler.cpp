@@ -0,0 +1,186 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/behavior_tree_profiler.h"
+#include "core/hash.h"
+
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::ai {
+
+	using json = ::nlohmann::json;
+
+	using namespace segfault::core;
+
+	namespace {
+		struct ProfilerState {
+			std::mutex lock;
+			std::unordered_map<uint64_t, std::shared_ptr<BehaviorTreeProfile>> profiles;
+		};
+
+		ProfilerState& getProfilerState() {
+			static ProfilerState state;
+			return state;
+		}
+
+		std::vector<int64_t> getParents(const CompiledBehaviorTree& tree) {
+			std::vector<int64_t> parents(tree.getNumNodes(), -1);
+			for (size_t i = 0; i < tree.getNumNodes(); ++i) {
+				const BehaviorTreeNodeRecord& node = tree.getNode(i);
+				for (size_t child = node.firstChild; child < node.firstChild + node.numChildren; ++child) {
+					parents[child] = static_cast<int64_t>(i);
+				}
+			}
+
+			return parents;
+		}
+
+		std::string getFrameName(const CompiledBehaviorTree& tree, size_t index) {
+			const BehaviorTreeNodeRecord& node = tree.getNode(index);
+			std::string frame = getNodeTypeName(static_cast<NodeType>(node.type));
+			const char* name = tree.getName(node);
+			if (*name != '\0') {
+				frame += ":";
+				frame += name;
+			}
+
+			return frame;
+		}
+	}
+
+	BehaviorTreeProfile::BehaviorTreeProfile(const char* name, std::shared_ptr<const CompiledBehaviorTree> tree) :
+			mName(name), mTree(tree), mStats(new BehaviorTreeNodeStats[tree->getNumNodes()]) {
+		// empty
+	}
+
+	void BehaviorTreeProfile::reset() {
+		for (size_t i = 0; i < mTree->getNumNodes(); ++i) {
+			mStats[i].reset();
+		}
+	}
+
+	bool BehaviorTreeProfiler::isEnabled() {
+#ifdef SEGFAULT_BT_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	std::shared_ptr<BehaviorTreeProfile> BehaviorTreeProfiler::getProfile(const char* name, const std::shared_ptr<const CompiledBehaviorTree>& tree) {
+		if (!isEnabled() || name == nullptr || tree == nullptr) {
+			return nullptr;
+		}
+
+		ProfilerState& state = getProfilerState();
+		std::lock_guard<std::mutex> guard(state.lock);
+		auto& profile = state.profiles[hashString(name)];
+		if (profile == nullptr || &profile->getTree() != tree.get()) {
+			profile = std::make_shared<BehaviorTreeProfile>(name, tree);
+		}
+
+		return profile;
+	}
+
+	void BehaviorTreeProfiler::reset() {
+		ProfilerState& state = getProfilerState();
+		std::lock_guard<std::mutex> guard(state.lock);
+		for (auto& entry : state.profiles) {
+			entry.second->reset();
+		}
+	}
+
+	std::string BehaviorTreeProfiler::dumpJson() {
+		static const char* statusNames[] = { "idle", "running", "success", "failure", "skipped" };
+		static_assert(sizeof(statusNames) / sizeof(statusNames[0]) == static_cast<size_t>(NodeStatus::COUNT), "Missing status name.");
+
+		ProfilerState& state = getProfilerState();
+		std::lock_guard<std::mutex> guard(state.lock);
+		json doc;
+		doc["trees"] = json::array();
+		for (const auto& entry : state.profiles) {
+			const BehaviorTreeProfile& profile = *entry.second;
+			const CompiledBehaviorTree& tree = profile.getTree();
+			const std::vector<int64_t> parents = getParents(tree);
+			json nodes = json::array();
+			for (size_t i = 0; i < tree.getNumNodes(); ++i) {
+				const BehaviorTreeNodeStats& stats = profile.getNodeStats(i);
+				const uint64_t numTicks = stats.numTicks.load(std::memory_order_relaxed);
+				const double totalTimeUs = static_cast<double>(stats.totalTimeNs.load(std::memory_order_relaxed)) / 1000.0;
+				json node;
+				node["index"] = i;
+				node["parent"] = parents[i];
+				node["type"] = getNodeTypeName(static_cast<NodeType>(tree.getNode(i).type));
+				node["name"] = tree.getName(tree.getNode(i));
+				node["ticks"] = numTicks;
+				node["totalTimeUs"] = totalTimeUs;
+				node["avgTimeUs"] = numTicks != 0 ? totalTimeUs / static_cast<double>(numTicks) : 0.0;
+				json histogram;
+				for (size_t status = 0; status < static_cast<size_t>(NodeStatus::COUNT); ++status) {
+					histogram[statusNames[status]] = stats.statusCounts[status].load(std::memory_order_relaxed);
+				}
+				node["status"] = histogram;
+				nodes.push_back(node);
+			}
+			doc["trees"].push_back({ { "name", profile.getName() }, { "nodes", nodes } });
+		}
+
+		return doc.dump(2);
+	}
+
+	std::string BehaviorTreeProfiler::dumpFlameReport() {
+		ProfilerState& state = getProfilerState();
+		std::lock_guard<std::mutex> guard(state.lock);
+		std::ostringstream report;
+		for (const auto& entry : state.profiles) {
+			const BehaviorTreeProfile& profile = *entry.second;
+			const CompiledBehaviorTree& tree = profile.getTree();
+			const std::vector<int64_t> parents = getParents(tree);
+
+			// Folded stacks expect the self time, so remove the time spent in the children
+			std::vector<int64_t> selfTimeNs(tree.getNumNodes());
+			for (size_t i = 0; i < tree.getNumNodes(); ++i) {
+				selfTimeNs[i] += static_cast<int64_t>(profile.getNodeStats(i).totalTimeNs.load(std::memory_order_relaxed));
+				if (parents[i] >= 0) {
+					selfTimeNs[parents[i]] -= static_cast<int64_t>(profile.getNodeStats(i).totalTimeNs.load(std::memory_order_relaxed));
+				}
+			}
+
+			// Parents are stored before their children, so their stacks are always complete
+			std::vector<std::string> stacks(tree.getNumNodes());
+			for (size_t i = 0; i < tree.getNumNodes(); ++i) {
+				const std::string& parentStack = parents[i] >= 0 ? stacks[parents[i]] : profile.getName();
+				stacks[i] = parentStack + ";" + getFrameName(tree, i);
+				const int64_t selfTimeUs = selfTimeNs[i] / 1000;
+				if (selfTimeUs > 0) {
+					report << stacks[i] << " " << selfTimeUs << "\n";
+				}
+			}
+		}
+
+		return report.str();
+	}
+
+} // namespace segfault::ai
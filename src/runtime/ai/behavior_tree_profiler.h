@@ -0,0 +1,129 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "ai/behavior_tree_format.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace segfault::ai {
+
+	/// @brief The tick statistics of a single node, aggregated over all agents using the tree.
+	struct BehaviorTreeNodeStats {
+		std::atomic<uint64_t> numTicks{ 0 };		///< The number of ticks.
+		std::atomic<uint64_t> totalTimeNs{ 0 };		///< The cumulative time including the children in ns.
+		std::atomic<uint64_t> statusCounts[static_cast<size_t>(NodeStatus::COUNT)]{}; ///< The histogram of the returned status.
+
+		/// @brief Records a single tick.
+		/// @param[ in ] status The returned status.
+		/// @param[ in ] timeNs The time spent in the tick in ns.
+		void record(NodeStatus status, int64_t timeNs) {
+			numTicks.fetch_add(1, std::memory_order_relaxed);
+			totalTimeNs.fetch_add(static_cast<uint64_t>(timeNs), std::memory_order_relaxed);
+			const int index = static_cast<int>(status);
+			if (index >= 0 && index < static_cast<int>(NodeStatus::COUNT)) {
+				statusCounts[index].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		/// @brief Resets all counters.
+		void reset() {
+			numTicks = 0;
+			totalTimeNs = 0;
+			for (auto& count : statusCounts) {
+				count = 0;
+			}
+		}
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class BehaviorTreeProfile
+	/// @brief The node statistics of one compiled tree, shared by all agents using it.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT BehaviorTreeProfile final {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] name The name of the profiled tree, usually its file name.
+		/// @param[ in ] tree The compiled tree.
+		BehaviorTreeProfile(const char* name, std::shared_ptr<const CompiledBehaviorTree> tree);
+
+		/// @brief The class destructor.
+		~BehaviorTreeProfile() = default;
+
+		/// @brief Returns the statistics of the node at the given index.
+		BehaviorTreeNodeStats* getNodeStats(size_t index) { return &mStats[index]; }
+
+		/// @brief Returns the statistics of the node at the given index.
+		const BehaviorTreeNodeStats& getNodeStats(size_t index) const { return mStats[index]; }
+
+		/// @brief Returns the name of the profiled tree.
+		const std::string& getName() const { return mName; }
+
+		/// @brief Returns the profiled tree.
+		const CompiledBehaviorTree& getTree() const { return *mTree; }
+
+		/// @brief Resets all node statistics.
+		void reset();
+
+	private:
+		std::string mName;
+		std::shared_ptr<const CompiledBehaviorTree> mTree;
+		std::unique_ptr<BehaviorTreeNodeStats[]> mStats;
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class BehaviorTreeProfiler
+	/// @brief Collects the per-node tick statistics of all behavior trees in the process.
+	///
+	/// The instrumentation is only compiled in with SEGFAULT_BT_PROFILING, otherwise no profiles 
+	/// are created and ticking a node has no overhead. The statistics can be dumped as json or as
+	/// folded stacks, which can be fed directly into flamegraph.pl or speedscope.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT BehaviorTreeProfiler final {
+	public:
+		/// @brief Returns true, if the profiling is compiled in.
+		static bool isEnabled();
+
+		/// @brief Returns the profile of a tree, creates it on the first request.
+		/// @param[ in ] name The name of the tree, usually its file name.
+		/// @param[ in ] tree The compiled tree.
+		/// @return The profile or nullptr, if profiling is not enabled.
+		static std::shared_ptr<BehaviorTreeProfile> getProfile(const char* name, const std::shared_ptr<const CompiledBehaviorTree>& tree);
+
+		/// @brief Resets the statistics of all profiles.
+		static void reset();
+
+		/// @brief Dumps the statistics of all profiles as json.
+		/// @return The json document as a string.
+		static std::string dumpJson();
+
+		/// @brief Dumps the self time of all nodes in microseconds as folded stacks.
+		/// @return One line per node in the form "tree;Type:name;Type:name time".
+		static std::string dumpFlameReport();
+	};
+
+} // namespace segfault::ai
@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/behavior_tree_scheduler.h"
+#include "ai/behavior_tree.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	namespace {
+		constexpr uint32_t AgentIndexBits = 20;
+		constexpr uint32_t AgentIndexMask = (1u << AgentIndexBits) - 1;
+		constexpr uint32_t AgentGenerationMask = 0xffffffffu >> AgentIndexBits;
+
+		// The last index is left out, its handle with the last generation is InvalidAgentHandle
+		constexpr uint32_t MaxAgents = AgentIndexMask;
+
+		// A priority of zero or below would keep the urgency at zero however long the agent waits
+		constexpr float MinPriority = 1.0e-3f;
+		constexpr float MaxPriority = 1.0e6f;
+		constexpr float MaxDistance = 1.0e6f;
+
+		inline AgentHandle makeHandle(uint32_t index, uint32_t generation) {
+			return (generation << AgentIndexBits) | index;
+		}
+
+		inline uint32_t getIndex(AgentHandle handle) {
+			return handle & AgentIndexMask;
+		}
+
+		inline uint32_t getGeneration(AgentHandle handle) {
+			return handle >> AgentIndexBits;
+		}
+
+		// Also maps NaN to the minimum
+		inline float clampValue(float value, float minValue, float maxValue) {
+			return value >= minValue ? std::min(value, maxValue) : minValue;
+		}
+	}
+
+	AgentHandle BehaviorTreeScheduler::addAgent(BehaviorTree* tree, float priority) {
+		if (tree == nullptr) {
+			logMessage(LogType::Error, "Cannot schedule an invalid behavior tree.");
+			return InvalidAgentHandle;
+		}
+
+		uint32_t index = 0;
+		if (!mFreeList.empty()) {
+			index = mFreeList.back();
+			mFreeList.pop_back();
+		} else if (mAgents.size() < MaxAgents) {
+			index = static_cast<uint32_t>(mAgents.size());
+			mAgents.emplace_back();
+		} else {
+			logMessage(LogType::Error, "Cannot schedule more behavior trees, the scheduler is full.");
+			return InvalidAgentHandle;
+		}
+
+		Agent &agent = mAgents[index];
+		const uint32_t generation = agent.generation;
+		agent = Agent();
+		agent.tree = tree;
+		agent.priority = clampValue(priority, MinPriority, MaxPriority);
+		agent.generation = generation;
+		++mStats.numAgents;
+
+		return makeHandle(index, generation);
+	}
+
+	void BehaviorTreeScheduler::removeAgent(AgentHandle handle) {
+		if (!isValid(handle)) {
+			return;
+		}
+
+		Agent &agent = getAgent(handle);
+		agent.tree = nullptr;
+		agent.generation = (agent.generation + 1) & AgentGenerationMask;
+		mFreeList.push_back(getIndex(handle));
+		--mStats.numAgents;
+	}
+
+	void BehaviorTreeScheduler::setPriority(AgentHandle handle, float priority) {
+		if (isValid(handle)) {
+			getAgent(handle).priority = clampValue(priority, MinPriority, MaxPriority);
+		}
+	}
+
+	void BehaviorTreeScheduler::setDistance(AgentHandle handle, float distance) {
+		if (isValid(handle)) {
+			getAgent(handle).distance = clampValue(distance, 0.0f, MaxDistance);
+		}
+	}
+
+	void BehaviorTreeScheduler::update(float dt) {
+		mOrder.clear();
+		for (size_t i = 0; i < mAgents.size(); ++i) {
+			Agent &agent = mAgents[i];
+			if (agent.tree == nullptr) {
+				continue;
+			}
+
+			agent.pendingTime += dt;
+			// The aging term does not shrink with the distance, so far agents are ticked eventually too
+			const float waitFrames = static_cast<float>(agent.waitFrames);
+			agent.urgency = agent.priority * (1.0f + waitFrames) / (1.0f + agent.distance) + waitFrames * MinPriority;
+			mOrder.push_back(static_cast<uint32_t>(i));
+		}
+
+		std::sort(mOrder.begin(), mOrder.end(), [this](uint32_t lhs, uint32_t rhs) {
+			return mAgents[lhs].urgency > mAgents[rhs].urgency;
+		});
+
+		using Clock = std::chrono::steady_clock;
+		const auto start = Clock::now();
+		const auto budget = std::chrono::duration<double, std::milli>(mBudgetMs);
+
+		size_t numTicked = 0;
+		for (; numTicked < mOrder.size(); ++numTicked) {
+			if (numTicked != 0 && mBudgetMs > 0.0 && Clock::now() - start >= budget) {
+				break;
+			}
+
+			Agent &agent = mAgents[mOrder[numTicked]];
+			agent.tree->update(agent.pendingTime);
+			agent.pendingTime = 0.0f;
+			agent.waitFrames = 0;
+		}
+
+		uint32_t maxWaitFrames = 0;
+		for (size_t i = numTicked; i < mOrder.size(); ++i) {
+			Agent &agent = mAgents[mOrder[i]];
+			++agent.waitFrames;
+			maxWaitFrames = std::max(maxWaitFrames, agent.waitFrames);
+		}
+
+		mStats.numTicked = numTicked;
+		mStats.numDeferred = mOrder.size() - numTicked;
+		mStats.maxWaitFrames = maxWaitFrames;
+		mStats.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	bool BehaviorTreeScheduler::isValid(AgentHandle handle) const {
+		const uint32_t index = getIndex(handle);
+		return index < mAgents.size() && mAgents[index].tree != nullptr && 
+				mAgents[index].generation == getGeneration(handle);
+	}
+
+	BehaviorTreeScheduler::Agent &BehaviorTreeScheduler::getAgent(AgentHandle handle) {
+		return mAgents[getIndex(handle)];
+	}
+
+} // namespace segfault::ai
@@ -0,0 +1,125 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <vector>
+
+namespace segfault::ai {
+
+	class BehaviorTree;
+
+	/// @brief The handle of an agent registered at the scheduler. It combines the slot of the 
+	/// agent with a generation, so handles of removed agents stay invalid when the slot is reused.
+	using AgentHandle = uint32_t;
+
+	/// @brief Marks an invalid agent handle.
+	static constexpr AgentHandle InvalidAgentHandle = 0xffffffff;
+
+	/// @brief The statistics of the last scheduler update.
+	struct BehaviorTreeSchedulerStats {
+		size_t numAgents{ 0 };          ///< The number of registered agents.
+		size_t numTicked{ 0 };          ///< The number of trees ticked in the last update.
+		size_t numDeferred{ 0 };        ///< The number of trees deferred to a later frame.
+		uint32_t maxWaitFrames{ 0 };    ///< The longest time an agent has waited in frames.
+		double elapsedMs{ 0.0 };        ///< The time spent ticking trees in milliseconds.
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class BehaviorTreeScheduler
+	/// @brief Ticks the behavior trees of many agents within a frame budget.
+	///
+	/// Each update sorts the agents by urgency, which grows with their priority and the number 
+	/// of frames they have waited and shrinks with their distance to the point of interest. Trees 
+	/// are ticked in that order until the budget is spent, the rest is deferred to the next frame. 
+	/// A deferred agent accumulates the elapsed time, so its timeouts and cooldowns stay correct.
+	/// At least one tree is ticked per update, so the scheduler always makes progress. Priorities 
+	/// are clamped to a small positive minimum and the waiting time also adds to the urgency 
+	/// regardless of the distance, so every agent is ticked eventually.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT BehaviorTreeScheduler final {
+	public:
+		/// @brief The class constructor.
+		BehaviorTreeScheduler() = default;
+
+		/// @brief The class destructor.
+		~BehaviorTreeScheduler() = default;
+
+		/// @brief Registers an agent, the tree must outlive its registration.
+		/// @param[ in ] tree The behavior tree of the agent.
+		/// @param[ in ] priority The priority of the agent, higher values are ticked earlier.
+		/// @return The handle of the agent or InvalidAgentHandle on error.
+		AgentHandle addAgent(BehaviorTree* tree, float priority = 1.0f);
+
+		/// @brief Removes an agent.
+		/// @param[ in ] handle The handle of the agent.
+		void removeAgent(AgentHandle handle);
+
+		/// @brief Sets the priority of an agent.
+		/// @param[ in ] handle The handle of the agent.
+		/// @param[ in ] priority The new priority.
+		void setPriority(AgentHandle handle, float priority);
+
+		/// @brief Sets the distance of an agent to the point of interest, usually the camera.
+		/// @param[ in ] handle The handle of the agent.
+		/// @param[ in ] distance The distance in world units.
+		void setDistance(AgentHandle handle, float distance);
+
+		/// @brief Sets the time budget per update.
+		/// @param[ in ] budgetMs The budget in milliseconds, zero ticks all agents.
+		void setFrameBudget(double budgetMs) { mBudgetMs = budgetMs; }
+
+		/// @brief Returns the time budget per update in milliseconds.
+		double getFrameBudget() const { return mBudgetMs; }
+
+		/// @brief Ticks the most urgent trees until the frame budget is spent.
+		/// @param[ in ] dt The elapsed time since the last update in seconds.
+		void update(float dt);
+
+		/// @brief Returns the statistics of the last update.
+		const BehaviorTreeSchedulerStats& getStats() const { return mStats; }
+
+	private:
+		struct Agent {
+			BehaviorTree* tree{ nullptr };
+			float priority{ 1.0f };
+			float distance{ 0.0f };
+			float pendingTime{ 0.0f };
+			float urgency{ 0.0f };
+			uint32_t waitFrames{ 0 };
+			uint32_t generation{ 0 };
+		};
+
+		bool isValid(AgentHandle handle) const;
+		Agent &getAgent(AgentHandle handle);
+
+	private:
+		std::vector<Agent> mAgents;
+		std::vector<uint32_t> mFreeList;
+		std::vector<uint32_t> mOrder;
+		double mBudgetMs{ 0.0 };
+		BehaviorTreeSchedulerStats mStats;
+	};
+
+} // namespace segfault::ai
@@ -0,0 +1,138 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "core/filearchive.h"
+#include "core/hash.h"
+
+#include <nlohmann/json.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::ai {
+
+	/// @brief Loads a compiled ai asset from a file holding either a baked blob or its json 
+	/// description. TCompiled must provide static isBinary(data, size), load(data, size) and 
+	/// compile(json).
+	/// @param[ in ] fileName The path to the file.
+	/// @param[ in ] kind The name of the asset kind used in error messages.
+	/// @return The compiled asset or nullptr on error.
+	template<class TCompiled>
+	std::shared_ptr<TCompiled> loadCompiledAsset(const char* fileName, const char* kind) {
+		core::FileArchive archive(fileName, "rb", true, false);
+		if (!archive.isValid()) {
+			return nullptr;
+		}
+
+		const size_t size = archive.getSize();
+		std::vector<uint8_t> content(size);
+		if (size == 0 || archive.read(content.data(), size) != size) {
+			return nullptr;
+		}
+
+		auto compiled = std::make_shared<TCompiled>();
+		if (TCompiled::isBinary(content.data(), size)) {
+			if (!compiled->load(content.data(), size)) {
+				return nullptr;
+			}
+			return compiled;
+		}
+
+		::nlohmann::json doc = ::nlohmann::json::parse(content.begin(), content.end(), nullptr, false);
+		if (doc.is_discarded()) {
+			const std::string msg = std::string("Cannot parse ") + kind + " " + fileName + ".";
+			core::logMessage(core::LogType::Error, msg.c_str());
+			return nullptr;
+		}
+
+		if (!compiled->compile(doc)) {
+			return nullptr;
+		}
+
+		return compiled;
+	}
+
+	//---------------------------------------------------------------------------------------------
+	/// @class CompiledAssetCache
+	/// @brief A thread-safe cache of compiled ai assets keyed by the hash of the file name.
+	//---------------------------------------------------------------------------------------------
+	template<class TCompiled>
+	class CompiledAssetCache final {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] kind The name of the asset kind used in error messages.
+		explicit CompiledAssetCache(const char* kind) : mKind(kind) {
+			// empty
+		}
+
+		/// @brief Returns the compiled asset of a file, loads it on the first request.
+		/// @param[ in ] fileName The path to the file.
+		/// @return The compiled asset or nullptr if the file cannot be loaded.
+		std::shared_ptr<const TCompiled> get(const char* fileName) {
+			if (fileName == nullptr) {
+				return nullptr;
+			}
+
+			const uint64_t key = core::hashString(fileName);
+			std::lock_guard<std::mutex> guard(mLock);
+			auto it = mEntries.find(key);
+			if (it != mEntries.end() && it->second.fileName == fileName) {
+				return it->second.asset;
+			}
+
+			std::shared_ptr<const TCompiled> compiled = loadCompiledAsset<TCompiled>(fileName, mKind);
+			if (compiled != nullptr) {
+				mEntries[key] = { fileName, compiled };
+			}
+
+			return compiled;
+		}
+
+		/// @brief Drops all cached assets. Assets still in use stay alive until released.
+		void clear() {
+			std::lock_guard<std::mutex> guard(mLock);
+			mEntries.clear();
+		}
+
+		/// @brief Returns the number of cached assets.
+		size_t getNumEntries() {
+			std::lock_guard<std::mutex> guard(mLock);
+			return mEntries.size();
+		}
+
+	private:
+		struct Entry {
+			std::string fileName;
+			std::shared_ptr<const TCompiled> asset;
+		};
+		const char* mKind;
+		std::mutex mLock;
+		std::unordered_map<uint64_t, Entry> mEntries;
+	};
+
+} // namespace segfault::ai
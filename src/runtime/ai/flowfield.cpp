@@ -0,0 +1,416 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/flowfield.h"
+#include "core/simd.h"
+#include "core/threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	namespace {
+		constexpr float Infinity = std::numeric_limits<float>::infinity();
+		constexpr float Sqrt2 = 1.41421356f;
+		constexpr float MinGradient = 1.0e-12f;
+		constexpr uint32_t InvalidCell = 0xffffffff;
+		constexpr int32_t NeighborX[8] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+		constexpr int32_t NeighborY[8] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+		constexpr size_t NumOrthogonal = 4;
+
+		bool isCheaper(const std::pair<float, uint32_t>& lhs, const std::pair<float, uint32_t>& rhs) {
+			return lhs.first > rhs.first;
+		}
+
+		// Diagonal moves must not cut the corner of a blocked cell
+		bool canMove(const uint8_t* costs, uint32_t from, size_t neighbor, int32_t stride) {
+			if (neighbor < NumOrthogonal) {
+				return true;
+			}
+
+			return costs[from + NeighborX[neighbor]] != FlowCostBlocked && 
+				costs[from + NeighborY[neighbor] * stride] != FlowCostBlocked;
+		}
+
+		float getStepCost(const uint8_t* costs, uint32_t to, size_t neighbor) {
+			return static_cast<float>(costs[to]) * (neighbor < NumOrthogonal ? 1.0f : Sqrt2);
+		}
+	}
+
+	FlowFieldGrid::FlowFieldGrid(uint32_t width, uint32_t height, float cellSize, const glm::vec3& origin) :
+			mWidth(width), mHeight(height), 
+			mStride(static_cast<uint32_t>(alignToSimdWidth(width + 4))), 
+			mCellSize(cellSize > 0.0f ? cellSize : 1.0f), 
+			mOrigin(origin) {
+		// The border and the padding columns stay blocked, the stride leaves room for a full 
+		// SIMD batch after the last column
+		mCosts.assign(static_cast<size_t>(mStride) * (mHeight + 2), FlowCostBlocked);
+		for (uint32_t y = 0; y < mHeight; ++y) {
+			std::fill_n(mCosts.begin() + getIndex(0, y), mWidth, FlowCostDefault);
+		}
+	}
+
+	void FlowFieldGrid::setCost(uint32_t x, uint32_t y, uint8_t cost) {
+		if (x >= mWidth || y >= mHeight) {
+			return;
+		}
+
+		const uint32_t index = getIndex(x, y);
+		cost = std::max(cost, FlowCostDefault);
+		if (mCosts[index] != cost) {
+			mCosts[index] = cost;
+			mChanges.push_back(index);
+		}
+	}
+
+	bool FlowFieldGrid::worldToCell(const glm::vec3& pos, uint32_t& x, uint32_t& y) const {
+		const float fx = (pos.x - mOrigin.x) / mCellSize;
+		const float fz = (pos.z - mOrigin.z) / mCellSize;
+		if (!(fx >= 0.0f && fz >= 0.0f && fx < static_cast<float>(mWidth) && fz < static_cast<float>(mHeight))) {
+			return false;
+		}
+
+		x = static_cast<uint32_t>(fx);
+		y = static_cast<uint32_t>(fz);
+
+		return true;
+	}
+
+	glm::vec3 FlowFieldGrid::cellToWorld(uint32_t x, uint32_t y) const {
+		return glm::vec3(mOrigin.x + (static_cast<float>(x) + 0.5f) * mCellSize, mOrigin.y, 
+			mOrigin.z + (static_cast<float>(y) + 0.5f) * mCellSize);
+	}
+
+	void FlowField::build(const FlowFieldGrid& grid, uint32_t goalX, uint32_t goalY) {
+		const size_t numCells = grid.getNumPaddedCells();
+		mIntegration.assign(numCells, Infinity);
+		mParents.assign(numCells, InvalidCell);
+		mDirX.assign(numCells, 0.0f);
+		mDirZ.assign(numCells, 0.0f);
+		mInvalidMask.assign(numCells, 0);
+		mOpen.clear();
+		mNumUpdatedCells = 0;
+		if (grid.getWidth() == 0 || grid.getHeight() == 0) {
+			return;
+		}
+
+		mGoal = grid.getIndex(std::min(goalX, grid.getWidth() - 1), std::min(goalY, grid.getHeight() - 1));
+		if (grid.getCosts()[mGoal] != FlowCostBlocked) {
+			mIntegration[mGoal] = 0.0f;
+			mOpen.emplace_back(0.0f, mGoal);
+		}
+
+		uint32_t minRow = 1, maxRow = grid.getHeight();
+		propagate(grid, minRow, maxRow);
+		computeDirections(grid, 1, grid.getHeight());
+	}
+
+	void FlowField::update(const FlowFieldGrid& grid, const std::vector<uint32_t>& changes) {
+		const uint32_t stride = grid.getStride();
+		if (mIntegration.size() != grid.getNumPaddedCells() || 
+				std::find(changes.begin(), changes.end(), mGoal) != changes.end()) {
+			build(grid, mGoal % stride - 1, mGoal / stride - 1);
+			return;
+		}
+		if (changes.empty()) {
+			return;
+		}
+
+		// Invalidate the changed cells, their neighbors, whose diagonal moves may cut a changed 
+		// corner, and every cell whose cheapest route ran through any of them
+		mNumUpdatedCells = 0;
+		mInvalid.clear();
+		for (uint32_t index : changes) {
+			for (size_t n = 0; n <= 8; ++n) {
+				const uint32_t cell = n == 8 ? index : index + NeighborX[n] + NeighborY[n] * static_cast<int32_t>(stride);
+				const uint32_t row = cell / stride;
+				const uint32_t column = cell % stride;
+				const bool isInterior = row >= 1 && row <= grid.getHeight() && column >= 1 && column <= grid.getWidth();
+				if (isInterior && mInvalidMask[cell] == 0) {
+					mInvalidMask[cell] = 1;
+					mInvalid.push_back(cell);
+				}
+			}
+		}
+		for (size_t i = 0; i < mInvalid.size(); ++i) {
+			const uint32_t index = mInvalid[i];
+			for (size_t n = 0; n < 8; ++n) {
+				const uint32_t neighbor = index + NeighborX[n] + NeighborY[n] * static_cast<int32_t>(stride);
+				if (mParents[neighbor] == index && mInvalidMask[neighbor] == 0) {
+					mInvalidMask[neighbor] = 1;
+					mInvalid.push_back(neighbor);
+				}
+			}
+		}
+		for (uint32_t index : mInvalid) {
+			mIntegration[index] = Infinity;
+			mParents[index] = InvalidCell;
+		}
+
+		// Seed the invalidated cells from their valid neighbors and let the wavefront repair 
+		// them, cheaper cells also propagate into the valid part of the field
+		const uint8_t* costs = grid.getCosts();
+		uint32_t minRow = grid.getHeight(), maxRow = 1;
+		mOpen.clear();
+		for (uint32_t index : mInvalid) {
+			minRow = std::min(minRow, index / stride);
+			maxRow = std::max(maxRow, index / stride);
+			if (costs[index] == FlowCostBlocked) {
+				continue;
+			}
+			if (index == mGoal) {
+				mIntegration[index] = 0.0f;
+				mOpen.emplace_back(0.0f, index);
+				continue;
+			}
+
+			for (size_t n = 0; n < 8; ++n) {
+				const uint32_t neighbor = index + NeighborX[n] + NeighborY[n] * static_cast<int32_t>(stride);
+				if (mIntegration[neighbor] == Infinity || !canMove(costs, index, n, stride)) {
+					continue;
+				}
+
+				const float cost = mIntegration[neighbor] + getStepCost(costs, index, n);
+				if (cost < mIntegration[index]) {
+					mIntegration[index] = cost;
+					mParents[index] = neighbor;
+				}
+			}
+			if (mIntegration[index] != Infinity) {
+				mOpen.emplace_back(mIntegration[index], index);
+			}
+		}
+		std::make_heap(mOpen.begin(), mOpen.end(), isCheaper);
+		propagate(grid, minRow, maxRow);
+
+		for (uint32_t index : mInvalid) {
+			mInvalidMask[index] = 0;
+		}
+		mNumUpdatedCells += mInvalid.size();
+
+		// The gradient of a cell depends on its neighbors, so one more row on each side
+		computeDirections(grid, std::max(minRow, 2u) - 1, std::min(maxRow + 1, grid.getHeight()));
+	}
+
+	glm::vec3 FlowField::sample(const FlowFieldGrid& grid, const glm::vec3& pos) const {
+		uint32_t x = 0, y = 0;
+		if (mDirX.empty() || !grid.worldToCell(pos, x, y)) {
+			return glm::vec3(0.0f);
+		}
+
+		const uint32_t index = grid.getIndex(x, y);
+		return glm::vec3(mDirX[index], 0.0f, mDirZ[index]);
+	}
+
+	void FlowField::sample(const FlowFieldGrid& grid, const glm::vec3* positions, glm::vec3* directions, size_t count) const {
+		for (size_t i = 0; i < count; ++i) {
+			directions[i] = sample(grid, positions[i]);
+		}
+	}
+
+	void FlowField::relax(const FlowFieldGrid& grid, uint32_t index, uint32_t& minRow, uint32_t& maxRow) {
+		const uint8_t* costs = grid.getCosts();
+		const int32_t stride = static_cast<int32_t>(grid.getStride());
+		for (size_t n = 0; n < 8; ++n) {
+			const uint32_t neighbor = index + NeighborX[n] + NeighborY[n] * stride;
+			if (costs[neighbor] == FlowCostBlocked || !canMove(costs, index, n, stride)) {
+				continue;
+			}
+
+			const float cost = mIntegration[index] + getStepCost(costs, neighbor, n);
+			if (cost < mIntegration[neighbor]) {
+				mIntegration[neighbor] = cost;
+				mParents[neighbor] = index;
+				mOpen.emplace_back(cost, neighbor);
+				std::push_heap(mOpen.begin(), mOpen.end(), isCheaper);
+
+				const uint32_t row = neighbor / static_cast<uint32_t>(stride);
+				minRow = std::min(minRow, row);
+				maxRow = std::max(maxRow, row);
+				++mNumUpdatedCells;
+			}
+		}
+	}
+
+	void FlowField::propagate(const FlowFieldGrid& grid, uint32_t& minRow, uint32_t& maxRow) {
+		while (!mOpen.empty()) {
+			std::pop_heap(mOpen.begin(), mOpen.end(), isCheaper);
+			const auto entry = mOpen.back();
+			mOpen.pop_back();
+			if (entry.first > mIntegration[entry.second]) {
+				continue;
+			}
+
+			relax(grid, entry.second, minRow, maxRow);
+		}
+	}
+
+	void FlowField::computeDirections(const FlowFieldGrid& grid, uint32_t firstRow, uint32_t lastRow) {
+		const uint32_t stride = grid.getStride();
+		const uint32_t width = grid.getWidth();
+		const uint8_t* costs = grid.getCosts();
+		const float* integration = mIntegration.data();
+		for (uint32_t row = firstRow; row <= lastRow; ++row) {
+			const uint32_t rowStart = row * stride;
+
+			// The downhill gradient by central differences, blocked neighbors count as flat
+#ifdef SEGFAULT_SIMD_SSE2
+			const __m128 inf = _mm_set1_ps(Infinity);
+			const __m128 minGradient = _mm_set1_ps(MinGradient);
+			for (uint32_t x = 1; x <= width; x += SimdWidth) {
+				const uint32_t i = rowStart + x;
+				const __m128 center = _mm_loadu_ps(integration + i);
+				__m128 left = _mm_loadu_ps(integration + i - 1);
+				__m128 right = _mm_loadu_ps(integration + i + 1);
+				__m128 up = _mm_loadu_ps(integration + i - stride);
+				__m128 down = _mm_loadu_ps(integration + i + stride);
+				__m128 mask = _mm_cmpeq_ps(left, inf);
+				left = _mm_or_ps(_mm_and_ps(mask, center), _mm_andnot_ps(mask, left));
+				mask = _mm_cmpeq_ps(right, inf);
+				right = _mm_or_ps(_mm_and_ps(mask, center), _mm_andnot_ps(mask, right));
+				mask = _mm_cmpeq_ps(up, inf);
+				up = _mm_or_ps(_mm_and_ps(mask, center), _mm_andnot_ps(mask, up));
+				mask = _mm_cmpeq_ps(down, inf);
+				down = _mm_or_ps(_mm_and_ps(mask, center), _mm_andnot_ps(mask, down));
+
+				const __m128 dx = _mm_sub_ps(left, right);
+				const __m128 dz = _mm_sub_ps(up, down);
+				const __m128 length2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+				const __m128 valid = _mm_and_ps(_mm_cmpneq_ps(center, inf), _mm_cmpgt_ps(length2, minGradient));
+				const __m128 scale = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(length2, minGradient)));
+				_mm_storeu_ps(mDirX.data() + i, _mm_and_ps(valid, _mm_mul_ps(dx, scale)));
+				_mm_storeu_ps(mDirZ.data() + i, _mm_and_ps(valid, _mm_mul_ps(dz, scale)));
+			}
+#else
+			for (uint32_t x = 1; x <= width; ++x) {
+				const uint32_t i = rowStart + x;
+				const float center = integration[i];
+				const float left = integration[i - 1] == Infinity ? center : integration[i - 1];
+				const float right = integration[i + 1] == Infinity ? center : integration[i + 1];
+				const float up = integration[i - stride] == Infinity ? center : integration[i - stride];
+				const float down = integration[i + stride] == Infinity ? center : integration[i + stride];
+				const float dx = left - right;
+				const float dz = up - down;
+				const float length2 = dx * dx + dz * dz;
+				const bool valid = center != Infinity && length2 > MinGradient;
+				const float scale = valid ? 1.0f / std::sqrt(length2) : 0.0f;
+				mDirX[i] = dx * scale;
+				mDirZ[i] = dz * scale;
+			}
+#endif
+
+			// Saddles and corridors of equal cost have no gradient, head for the cheapest neighbor
+			for (uint32_t x = 1; x <= width; ++x) {
+				const uint32_t i = rowStart + x;
+				if (mDirX[i] != 0.0f || mDirZ[i] != 0.0f || i == mGoal || integration[i] == Infinity) {
+					continue;
+				}
+
+				size_t best = 8;
+				float bestCost = integration[i];
+				for (size_t n = 0; n < 8; ++n) {
+					const uint32_t neighbor = i + NeighborX[n] + NeighborY[n] * static_cast<int32_t>(stride);
+					if (integration[neighbor] < bestCost && canMove(costs, i, n, stride)) {
+						bestCost = integration[neighbor];
+						best = n;
+					}
+				}
+				if (best != 8) {
+					const float scale = best < NumOrthogonal ? 1.0f : 1.0f / Sqrt2;
+					mDirX[i] = static_cast<float>(NeighborX[best]) * scale;
+					mDirZ[i] = static_cast<float>(NeighborY[best]) * scale;
+				}
+			}
+		}
+	}
+
+	FlowFieldCache::FlowFieldCache(FlowFieldGrid& grid, size_t maxFields, ThreadPool* pool) :
+			mGrid(grid), mMaxFields(std::max<size_t>(maxFields, 1)), mPool(pool) {
+		// empty
+	}
+
+	const FlowField* FlowFieldCache::get(uint32_t goalX, uint32_t goalY) {
+		if (mGrid.getWidth() == 0 || mGrid.getHeight() == 0) {
+			return nullptr;
+		}
+
+		const uint32_t key = mGrid.getIndex(std::min(goalX, mGrid.getWidth() - 1), std::min(goalY, mGrid.getHeight() - 1));
+		auto it = mFields.find(key);
+		if (it != mFields.end()) {
+			mLru.splice(mLru.begin(), mLru, it->second.lruPos);
+			++mStats.numHits;
+			return it->second.field.get();
+		}
+
+		if (mFields.size() >= mMaxFields) {
+			mFields.erase(mLru.back());
+			mLru.pop_back();
+		}
+
+		auto field = std::make_unique<FlowField>();
+		field->build(mGrid, goalX, goalY);
+		++mStats.numBuilds;
+		mLru.push_front(key);
+		FlowField* result = field.get();
+		mFields[key] = { std::move(field), mLru.begin() };
+
+		return result;
+	}
+
+	void FlowFieldCache::update() {
+		const std::vector<uint32_t>& changes = mGrid.getChanges();
+		if (changes.empty()) {
+			return;
+		}
+
+		std::vector<FlowField*> fields;
+		fields.reserve(mFields.size());
+		for (auto& entry : mFields) {
+			fields.push_back(entry.second.field.get());
+		}
+
+		if (mPool != nullptr && fields.size() > 1) {
+			mPool->parallelFor(fields.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					fields[i]->update(mGrid, changes);
+				}
+			});
+		} else {
+			for (FlowField* field : fields) {
+				field->update(mGrid, changes);
+			}
+		}
+		mStats.numUpdates += fields.size();
+		mGrid.clearChanges();
+	}
+
+	void FlowFieldCache::clear() {
+		mFields.clear();
+		mLru.clear();
+	}
+
+} // namespace segfault::ai
@@ -0,0 +1,252 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <glm/glm.hpp>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace segfault::core {
+	class ThreadPool;
+}
+
+namespace segfault::ai {
+
+	/// @brief The cost of a cell agents cannot enter.
+	static constexpr uint8_t FlowCostBlocked = 255;
+
+	/// @brief The cost of a regular cell.
+	static constexpr uint8_t FlowCostDefault = 1;
+
+	//---------------------------------------------------------------------------------------------
+	/// @class FlowFieldGrid
+	/// @brief The cost grid flow fields are generated on.
+	///
+	/// The grid lies in the xz-plane. Cells are stored row by row with a blocked border, so 
+	/// neighbor lookups never need bounds checks, and the row stride is padded to the SIMD width.
+	/// Cost changes are recorded until FlowFieldCache::update has applied them to the fields.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT FlowFieldGrid final {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] width The number of cells in x.
+		/// @param[ in ] height The number of cells in z.
+		/// @param[ in ] cellSize The edge length of a cell in world units.
+		/// @param[ in ] origin The world position of the corner of the first cell.
+		FlowFieldGrid(uint32_t width, uint32_t height, float cellSize = 1.0f, const glm::vec3& origin = glm::vec3(0.0f));
+
+		/// @brief The class destructor.
+		~FlowFieldGrid() = default;
+
+		/// @brief Sets the cost of a cell and records the change.
+		/// @param[ in ] x The cell column.
+		/// @param[ in ] y The cell row.
+		/// @param[ in ] cost The cost from FlowCostDefault to FlowCostBlocked.
+		void setCost(uint32_t x, uint32_t y, uint8_t cost);
+
+		/// @brief Returns the cost of a cell.
+		uint8_t getCost(uint32_t x, uint32_t y) const { return mCosts[getIndex(x, y)]; }
+
+		/// @brief Returns the cell containing a world position.
+		/// @param[ in ] pos The world position.
+		/// @param[ out ] x The cell column.
+		/// @param[ out ] y The cell row.
+		/// @return False if the position is outside of the grid.
+		bool worldToCell(const glm::vec3& pos, uint32_t& x, uint32_t& y) const;
+
+		/// @brief Returns the world position of the center of a cell.
+		glm::vec3 cellToWorld(uint32_t x, uint32_t y) const;
+
+		/// @brief Returns the padded index of a cell.
+		uint32_t getIndex(uint32_t x, uint32_t y) const { return (y + 1) * mStride + x + 1; }
+
+		/// @brief Returns the number of cells in x.
+		uint32_t getWidth() const { return mWidth; }
+
+		/// @brief Returns the number of cells in z.
+		uint32_t getHeight() const { return mHeight; }
+
+		/// @brief Returns the row stride of the padded cell arrays.
+		uint32_t getStride() const { return mStride; }
+
+		/// @brief Returns the number of entries of the padded cell arrays.
+		size_t getNumPaddedCells() const { return mCosts.size(); }
+
+		/// @brief Returns the padded cost array.
+		const uint8_t* getCosts() const { return mCosts.data(); }
+
+		/// @brief Returns the padded indices of the cells changed since the last clearChanges.
+		const std::vector<uint32_t>& getChanges() const { return mChanges; }
+
+		/// @brief Forgets the recorded changes.
+		void clearChanges() { mChanges.clear(); }
+
+	private:
+		uint32_t mWidth;
+		uint32_t mHeight;
+		uint32_t mStride;
+		float mCellSize;
+		glm::vec3 mOrigin;
+		std::vector<uint8_t> mCosts;
+		std::vector<uint32_t> mChanges;
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class FlowField
+	/// @brief The integration and direction field leading all agents on a grid to one goal.
+	///
+	/// The integration field holds the cost to reach the goal from every cell, computed by a 
+	/// Dijkstra wavefront from the goal. The direction field is the normalized downhill gradient 
+	/// of the integration field, computed for four cells at a time. Agents only sample their cell, 
+	/// so moving a crowd costs O(agents) after the O(cells) build. Cost changes are applied 
+	/// incrementally: only cells whose cheapest route ran through a changed cell are recomputed.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT FlowField final {
+	public:
+		/// @brief The class constructor.
+		FlowField() = default;
+
+		/// @brief The class destructor.
+		~FlowField() = default;
+
+		/// @brief Builds the field from scratch.
+		/// @param[ in ] grid The cost grid.
+		/// @param[ in ] goalX The goal column.
+		/// @param[ in ] goalY The goal row.
+		void build(const FlowFieldGrid& grid, uint32_t goalX, uint32_t goalY);
+
+		/// @brief Updates the field after cell costs have changed.
+		/// @param[ in ] grid The cost grid.
+		/// @param[ in ] changes The padded indices of the changed cells.
+		void update(const FlowFieldGrid& grid, const std::vector<uint32_t>& changes);
+
+		/// @brief Returns the direction to move in at a world position.
+		/// @param[ in ] grid The cost grid.
+		/// @param[ in ] pos The world position.
+		/// @return The normalized direction in the xz-plane, zero at the goal, outside of the 
+		/// grid or in cells without a route to the goal.
+		glm::vec3 sample(const FlowFieldGrid& grid, const glm::vec3& pos) const;
+
+		/// @brief Returns the directions for many positions.
+		/// @param[ in ] grid The cost grid.
+		/// @param[ in ] positions The world positions.
+		/// @param[ out ] directions The directions.
+		/// @param[ in ] count The number of positions.
+		void sample(const FlowFieldGrid& grid, const glm::vec3* positions, glm::vec3* directions, size_t count) const;
+
+		/// @brief Returns the cost to reach the goal from a cell, infinity if there is no route.
+		float getIntegration(const FlowFieldGrid& grid, uint32_t x, uint32_t y) const { 
+			return mIntegration[grid.getIndex(x, y)]; 
+		}
+
+		/// @brief Returns the padded index of the goal cell.
+		uint32_t getGoal() const { return mGoal; }
+
+		/// @brief Returns the number of cells recomputed by the last build or update.
+		size_t getNumUpdatedCells() const { return mNumUpdatedCells; }
+
+	private:
+		void relax(const FlowFieldGrid& grid, uint32_t index, uint32_t& minRow, uint32_t& maxRow);
+		void propagate(const FlowFieldGrid& grid, uint32_t& minRow, uint32_t& maxRow);
+		void computeDirections(const FlowFieldGrid& grid, uint32_t firstRow, uint32_t lastRow);
+
+	private:
+		uint32_t mGoal{ 0 };
+		std::vector<float> mIntegration;
+		std::vector<uint32_t> mParents;
+		std::vector<float> mDirX;
+		std::vector<float> mDirZ;
+		std::vector<std::pair<float, uint32_t>> mOpen;
+		std::vector<uint32_t> mInvalid;
+		std::vector<uint8_t> mInvalidMask;
+		size_t mNumUpdatedCells{ 0 };
+	};
+
+	/// @brief The counters of a flow field cache.
+	struct FlowFieldCacheStats {
+		size_t numHits{ 0 };            ///< The number of requests served by a cached field.
+		size_t numBuilds{ 0 };          ///< The number of fields built from scratch.
+		size_t numUpdates{ 0 };         ///< The number of incremental field updates.
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class FlowFieldCache
+	/// @brief Keeps the flow fields of the most recently used goals of a grid.
+	///
+	/// All agents heading to the same goal share one field. update applies the recorded cost 
+	/// changes of the grid to all cached fields, on the workers of a thread pool if one is given.
+	/// The cache is not thread-safe, use it from the game thread.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT FlowFieldCache final {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] grid The cost grid, must outlive the cache.
+		/// @param[ in ] maxFields The maximum number of cached fields.
+		/// @param[ in ] pool The optional pool to update the fields in parallel.
+		FlowFieldCache(FlowFieldGrid& grid, size_t maxFields = 16, core::ThreadPool* pool = nullptr);
+
+		/// @brief The class destructor.
+		~FlowFieldCache() = default;
+
+		/// @brief Returns the field of a goal, builds it on the first request.
+		/// @param[ in ] goalX The goal column.
+		/// @param[ in ] goalY The goal row.
+		/// @return The field, valid until the goal is evicted.
+		const FlowField* get(uint32_t goalX, uint32_t goalY);
+
+		/// @brief Applies the cost changes of the grid to all cached fields and clears them.
+		void update();
+
+		/// @brief Drops all fields.
+		void clear();
+
+		/// @brief Returns the number of cached fields.
+		size_t getNumFields() const { return mFields.size(); }
+
+		/// @brief Returns the counters.
+		const FlowFieldCacheStats& getStats() const { return mStats; }
+
+		FlowFieldCache(const FlowFieldCache&) = delete;
+		FlowFieldCache& operator = (const FlowFieldCache&) = delete;
+
+	private:
+		struct Entry {
+			std::unique_ptr<FlowField> field;
+			std::list<uint32_t>::iterator lruPos;
+		};
+
+		FlowFieldGrid& mGrid;
+		const size_t mMaxFields;
+		core::ThreadPool* mPool;
+		std::unordered_map<uint32_t, Entry> mFields;
+		std::list<uint32_t> mLru;
+		FlowFieldCacheStats mStats;
+	};
+
+} // namespace segfault::ai
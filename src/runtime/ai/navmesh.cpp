@@ -0,0 +1,406 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/navmesh.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	namespace {
+		constexpr uint32_t InvalidIndex = 0xffffffff;
+
+		struct PolyGraph {
+			const NavMesh& mesh;
+
+			size_t getNumNodes() const { return mesh.getNumPolygons(); }
+			std::pair<uint32_t, uint32_t> getLinks(uint32_t node) const { return mesh.getLinks(node); }
+			uint32_t getTarget(uint32_t link) const { return mesh.getLinkTarget(link); }
+			float getCost(uint32_t link) const { return mesh.getLinkCost(link); }
+			float getHeuristic(uint32_t node, uint32_t goal) const { return glm::length(mesh.getCenter(node) - mesh.getCenter(goal)); }
+		};
+
+		struct ClusterGraph {
+			const NavMesh& mesh;
+
+			size_t getNumNodes() const { return mesh.getNumClusters(); }
+			std::pair<uint32_t, uint32_t> getLinks(uint32_t node) const { return mesh.getClusterLinks(node); }
+			uint32_t getTarget(uint32_t link) const { return mesh.getClusterLinkTarget(link); }
+			float getCost(uint32_t link) const { return mesh.getClusterLinkCost(link); }
+			float getHeuristic(uint32_t node, uint32_t goal) const { 
+				return glm::length(mesh.getClusterCenter(node) - mesh.getClusterCenter(goal)); 
+			}
+		};
+
+		bool isCheaper(const std::pair<float, uint32_t>& lhs, const std::pair<float, uint32_t>& rhs) {
+			return lhs.first > rhs.first;
+		}
+
+		// The link costs are the distances of the node centers, so the straight line distance 
+		// is a consistent heuristic and expanded nodes never need to be reopened
+		template<class TGraph, class TFilter>
+		bool searchAStar(const TGraph& graph, uint32_t start, uint32_t goal, NavQuery::SearchState& state, 
+				const TFilter& isAllowed, size_t& numExpanded) {
+			state.begin(graph.getNumNodes());
+			const uint32_t generation = state.generation;
+			state.visited[start] = generation;
+			state.cost[start] = 0.0f;
+			state.parent[start] = InvalidIndex;
+			state.open.emplace_back(graph.getHeuristic(start, goal), start);
+
+			while (!state.open.empty()) {
+				std::pop_heap(state.open.begin(), state.open.end(), isCheaper);
+				const uint32_t node = state.open.back().second;
+				state.open.pop_back();
+				if (node == goal) {
+					return true;
+				}
+				if (state.closed[node] == generation) {
+					continue;
+				}
+				state.closed[node] = generation;
+				++numExpanded;
+
+				const auto links = graph.getLinks(node);
+				for (uint32_t link = links.first; link < links.second; ++link) {
+					const uint32_t target = graph.getTarget(link);
+					if (state.closed[target] == generation || !isAllowed(target)) {
+						continue;
+					}
+
+					const float cost = state.cost[node] + graph.getCost(link);
+					if (state.visited[target] != generation || cost < state.cost[target]) {
+						state.visited[target] = generation;
+						state.cost[target] = cost;
+						state.parent[target] = node;
+						state.open.emplace_back(cost + graph.getHeuristic(target, goal), target);
+						std::push_heap(state.open.begin(), state.open.end(), isCheaper);
+					}
+				}
+			}
+
+			return false;
+		}
+	}
+
+	bool NavMesh::build(const glm::vec3* vertices, size_t numVertices, const uint32_t* indices, 
+			const uint32_t* polySizes, size_t numPolys, uint32_t clusterSize) {
+		clear();
+		if (vertices == nullptr || indices == nullptr || polySizes == nullptr || numPolys == 0) {
+			return false;
+		}
+
+		mVertices.assign(vertices, vertices + numVertices);
+		mPolyVertexStart.reserve(numPolys + 1);
+		mPolyVertexStart.push_back(0);
+		mCenters.reserve(numPolys);
+		for (size_t poly = 0; poly < numPolys; ++poly) {
+			const uint32_t first = mPolyVertexStart.back();
+			if (polySizes[poly] < 3) {
+				logMessage(LogType::Error, "A navigation mesh polygon needs at least three vertices.");
+				clear();
+				return false;
+			}
+
+			glm::vec3 center(0.0f);
+			for (uint32_t i = 0; i < polySizes[poly]; ++i) {
+				const uint32_t index = indices[first + i];
+				if (index >= numVertices) {
+					logMessage(LogType::Error, "Invalid navigation mesh vertex index.");
+					clear();
+					return false;
+				}
+				mPolyVertices.push_back(index);
+				center += mVertices[index];
+			}
+			mCenters.push_back(center / static_cast<float>(polySizes[poly]));
+			mPolyVertexStart.push_back(first + polySizes[poly]);
+		}
+
+		// Polygons sharing an edge become neighbors, the edge is keyed by its sorted vertex indices
+		struct Link {
+			NavPolyRef from;
+			NavPolyRef to;
+			glm::vec3 portal;
+		};
+		std::vector<Link> links;
+		std::unordered_map<uint64_t, NavPolyRef> edges;
+		edges.reserve(mPolyVertices.size());
+		for (NavPolyRef poly = 0; poly < numPolys; ++poly) {
+			const uint32_t first = mPolyVertexStart[poly];
+			const uint32_t count = mPolyVertexStart[poly + 1] - first;
+			for (uint32_t i = 0; i < count; ++i) {
+				const uint32_t a = mPolyVertices[first + i];
+				const uint32_t b = mPolyVertices[first + (i + 1) % count];
+				const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+				auto it = edges.find(key);
+				if (it == edges.end()) {
+					edges.emplace(key, poly);
+				} else if (it->second != poly && it->second != InvalidNavPoly) {
+					const glm::vec3 portal = (mVertices[a] + mVertices[b]) * 0.5f;
+					links.push_back({ it->second, poly, portal });
+					links.push_back({ poly, it->second, portal });
+					it->second = InvalidNavPoly;
+				}
+			}
+		}
+
+		std::sort(links.begin(), links.end(), [](const Link& lhs, const Link& rhs) { return lhs.from < rhs.from; });
+		mLinkStart.assign(numPolys + 1, 0);
+		mLinkTargets.reserve(links.size());
+		mLinkCosts.reserve(links.size());
+		mLinkPortals.reserve(links.size());
+		for (const Link& link : links) {
+			++mLinkStart[link.from + 1];
+			mLinkTargets.push_back(link.to);
+			mLinkCosts.push_back(glm::length(mCenters[link.to] - mCenters[link.from]));
+			mLinkPortals.push_back(link.portal);
+		}
+		for (size_t poly = 0; poly < numPolys; ++poly) {
+			mLinkStart[poly + 1] += mLinkStart[poly];
+		}
+
+		buildClusters(std::max(clusterSize, 1u));
+
+		return true;
+	}
+
+	void NavMesh::clear() {
+		mVertices.clear();
+		mPolyVertexStart.clear();
+		mPolyVertices.clear();
+		mCenters.clear();
+		mPolyClusters.clear();
+		mLinkStart.clear();
+		mLinkTargets.clear();
+		mLinkCosts.clear();
+		mLinkPortals.clear();
+		mClusterCenters.clear();
+		mClusterLinkStart.clear();
+		mClusterLinkTargets.clear();
+		mClusterLinkCosts.clear();
+	}
+
+	NavPolyRef NavMesh::findPolygon(const glm::vec3& pos) const {
+		NavPolyRef best = InvalidNavPoly;
+		float bestHeight = std::numeric_limits<float>::max();
+		NavPolyRef nearest = InvalidNavPoly;
+		float nearestDistance = std::numeric_limits<float>::max();
+		for (NavPolyRef poly = 0; poly < mCenters.size(); ++poly) {
+			const glm::vec3 delta = mCenters[poly] - pos;
+			const float distance = glm::dot(delta, delta);
+			if (distance < nearestDistance) {
+				nearestDistance = distance;
+				nearest = poly;
+			}
+
+			const float height = delta.y < 0.0f ? -delta.y : delta.y;
+			if (height < bestHeight && containsXZ(poly, pos)) {
+				bestHeight = height;
+				best = poly;
+			}
+		}
+
+		return best != InvalidNavPoly ? best : nearest;
+	}
+
+	bool NavMesh::containsXZ(NavPolyRef poly, const glm::vec3& pos) const {
+		// Convex polygon: the point is inside if it is on the same side of all edges
+		const uint32_t first = mPolyVertexStart[poly];
+		const uint32_t count = mPolyVertexStart[poly + 1] - first;
+		bool hasPositive = false;
+		bool hasNegative = false;
+		for (uint32_t i = 0; i < count; ++i) {
+			const glm::vec3& a = mVertices[mPolyVertices[first + i]];
+			const glm::vec3& b = mVertices[mPolyVertices[first + (i + 1) % count]];
+			const float side = (b.x - a.x) * (pos.z - a.z) - (b.z - a.z) * (pos.x - a.x);
+			hasPositive |= side > 0.0f;
+			hasNegative |= side < 0.0f;
+		}
+
+		return !(hasPositive && hasNegative);
+	}
+
+	void NavMesh::buildClusters(uint32_t clusterSize) {
+		// Grow clusters breadth-first from unassigned seeds, so each cluster is connected
+		const size_t numPolys = mCenters.size();
+		mPolyClusters.assign(numPolys, InvalidIndex);
+		std::vector<NavPolyRef> queue;
+		queue.reserve(clusterSize);
+		for (NavPolyRef seed = 0; seed < numPolys; ++seed) {
+			if (mPolyClusters[seed] != InvalidIndex) {
+				continue;
+			}
+
+			const uint32_t cluster = static_cast<uint32_t>(mClusterCenters.size());
+			glm::vec3 center(0.0f);
+			queue.clear();
+			queue.push_back(seed);
+			mPolyClusters[seed] = cluster;
+			for (size_t current = 0; current < queue.size(); ++current) {
+				const NavPolyRef poly = queue[current];
+				center += mCenters[poly];
+				for (uint32_t link = mLinkStart[poly]; link < mLinkStart[poly + 1] && queue.size() < clusterSize; ++link) {
+					const NavPolyRef target = mLinkTargets[link];
+					if (mPolyClusters[target] == InvalidIndex) {
+						mPolyClusters[target] = cluster;
+						queue.push_back(target);
+					}
+				}
+			}
+			mClusterCenters.push_back(center / static_cast<float>(queue.size()));
+		}
+
+		std::vector<std::pair<uint32_t, uint32_t>> clusterLinks;
+		for (NavPolyRef poly = 0; poly < numPolys; ++poly) {
+			for (uint32_t link = mLinkStart[poly]; link < mLinkStart[poly + 1]; ++link) {
+				const uint32_t from = mPolyClusters[poly];
+				const uint32_t to = mPolyClusters[mLinkTargets[link]];
+				if (from != to) {
+					clusterLinks.emplace_back(from, to);
+				}
+			}
+		}
+		std::sort(clusterLinks.begin(), clusterLinks.end());
+		clusterLinks.erase(std::unique(clusterLinks.begin(), clusterLinks.end()), clusterLinks.end());
+
+		const size_t numClusters = mClusterCenters.size();
+		mClusterLinkStart.assign(numClusters + 1, 0);
+		mClusterLinkTargets.reserve(clusterLinks.size());
+		mClusterLinkCosts.reserve(clusterLinks.size());
+		for (const auto& link : clusterLinks) {
+			++mClusterLinkStart[link.first + 1];
+			mClusterLinkTargets.push_back(link.second);
+			mClusterLinkCosts.push_back(glm::length(mClusterCenters[link.second] - mClusterCenters[link.first]));
+		}
+		for (size_t cluster = 0; cluster < numClusters; ++cluster) {
+			mClusterLinkStart[cluster + 1] += mClusterLinkStart[cluster];
+		}
+	}
+
+	void NavQuery::SearchState::begin(size_t numNodes) {
+		if (visited.size() != numNodes) {
+			cost.assign(numNodes, 0.0f);
+			parent.assign(numNodes, InvalidIndex);
+			visited.assign(numNodes, 0);
+			closed.assign(numNodes, 0);
+			generation = 0;
+		}
+
+		// Bumping the generation invalidates all nodes without touching them
+		open.clear();
+		if (++generation == 0) {
+			std::fill(visited.begin(), visited.end(), 0);
+			std::fill(closed.begin(), closed.end(), 0);
+			generation = 1;
+		}
+	}
+
+	NavQuery::NavQuery(const NavMesh& mesh) : mMesh(mesh) {
+		// empty
+	}
+
+	bool NavQuery::findCorridor(NavPolyRef start, NavPolyRef end, std::vector<NavPolyRef>& corridor) {
+		corridor.clear();
+		mNumExpanded = 0;
+		const size_t numPolys = mMesh.getNumPolygons();
+		if (start >= numPolys || end >= numPolys) {
+			return false;
+		}
+
+		// Upper level: mark the clusters along the cluster route as the only allowed ones
+		bool restricted = false;
+		const uint32_t startCluster = mMesh.getCluster(start);
+		const uint32_t endCluster = mMesh.getCluster(end);
+		if (startCluster != endCluster) {
+			if (!searchAStar(ClusterGraph{ mMesh }, startCluster, endCluster, mClusterSearch, 
+					[](uint32_t) { return true; }, mNumExpanded)) {
+				return false;
+			}
+
+			if (mAllowedClusters.size() != mMesh.getNumClusters() || ++mAllowedGeneration == 0) {
+				mAllowedClusters.assign(mMesh.getNumClusters(), 0);
+				mAllowedGeneration = 1;
+			}
+			for (uint32_t cluster = endCluster; cluster != InvalidIndex; cluster = mClusterSearch.parent[cluster]) {
+				mAllowedClusters[cluster] = mAllowedGeneration;
+			}
+			restricted = true;
+		}
+
+		// Lower level: polygons of the allowed clusters, the whole mesh if the route is too narrow
+		const PolyGraph graph{ mMesh };
+		bool found = false;
+		if (restricted) {
+			found = searchAStar(graph, start, end, mPolySearch, [this](NavPolyRef poly) {
+				return mAllowedClusters[mMesh.getCluster(poly)] == mAllowedGeneration;
+			}, mNumExpanded);
+		}
+		if (!found) {
+			found = searchAStar(graph, start, end, mPolySearch, [](NavPolyRef) { return true; }, mNumExpanded);
+		}
+		if (!found) {
+			return false;
+		}
+
+		for (NavPolyRef poly = end; poly != InvalidIndex; poly = mPolySearch.parent[poly]) {
+			corridor.push_back(poly);
+		}
+		std::reverse(corridor.begin(), corridor.end());
+
+		return true;
+	}
+
+	bool NavQuery::findPath(const glm::vec3& start, const glm::vec3& end, std::vector<glm::vec3>& path) {
+		path.clear();
+		std::vector<NavPolyRef> corridor;
+		if (!findCorridor(mMesh.findPolygon(start), mMesh.findPolygon(end), corridor)) {
+			return false;
+		}
+
+		buildPath(start, end, corridor, path);
+
+		return true;
+	}
+
+	void NavQuery::buildPath(const glm::vec3& start, const glm::vec3& end, const std::vector<NavPolyRef>& corridor, 
+			std::vector<glm::vec3>& path) const {
+		path.clear();
+		path.reserve(corridor.size() + 1);
+		path.push_back(start);
+		for (size_t i = 1; i < corridor.size(); ++i) {
+			const auto links = mMesh.getLinks(corridor[i - 1]);
+			for (uint32_t link = links.first; link < links.second; ++link) {
+				if (mMesh.getLinkTarget(link) == corridor[i]) {
+					path.push_back(mMesh.getLinkPortal(link));
+					break;
+				}
+			}
+		}
+		path.push_back(end);
+	}
+
+} // namespace segfault::ai
@@ -0,0 +1,206 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <glm/glm.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace segfault::ai {
+
+	/// @brief The index of a navigation mesh polygon.
+	using NavPolyRef = uint32_t;
+
+	/// @brief Marks an invalid polygon.
+	static constexpr NavPolyRef InvalidNavPoly = 0xffffffff;
+
+	//---------------------------------------------------------------------------------------------
+	/// @class NavMesh
+	/// @brief The polygon graph agents walk on.
+	///
+	/// All data lives in flat arrays, the polygon vertices and the links between neighboring 
+	/// polygons are stored as compressed ranges indexed by polygon. Polygons are grouped into 
+	/// clusters of connected polygons, the cluster graph is the upper level of the hierarchical 
+	/// search in NavQuery. The mesh is immutable after building and can be shared by any number 
+	/// of threads. Positions are located in the xz-plane, y is up.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT NavMesh final {
+	public:
+		/// @brief The class constructor.
+		NavMesh() = default;
+
+		/// @brief The class destructor.
+		~NavMesh() = default;
+
+		/// @brief Builds the mesh from convex polygons, polygons sharing an edge are linked.
+		/// @param[ in ] vertices The vertex positions.
+		/// @param[ in ] numVertices The number of vertices.
+		/// @param[ in ] indices The vertex indices of all polygons, one after another.
+		/// @param[ in ] polySizes The number of vertices per polygon.
+		/// @param[ in ] numPolys The number of polygons.
+		/// @param[ in ] clusterSize The maximum number of polygons per cluster.
+		/// @return True if the mesh was built, false for invalid input.
+		bool build(const glm::vec3* vertices, size_t numVertices, const uint32_t* indices, 
+			const uint32_t* polySizes, size_t numPolys, uint32_t clusterSize = 32);
+
+		/// @brief Removes all polygons.
+		void clear();
+
+		/// @brief Returns the polygon containing a position.
+		/// @param[ in ] pos The position.
+		/// @return The polygon below or above the position closest in height, the polygon with 
+		/// the nearest center if no polygon contains the position or InvalidNavPoly for an empty mesh.
+		NavPolyRef findPolygon(const glm::vec3& pos) const;
+
+		/// @brief Returns the number of polygons.
+		size_t getNumPolygons() const { return mCenters.size(); }
+
+		/// @brief Returns the center of a polygon.
+		const glm::vec3& getCenter(NavPolyRef poly) const { return mCenters[poly]; }
+
+		/// @brief Returns the cluster of a polygon.
+		uint32_t getCluster(NavPolyRef poly) const { return mPolyClusters[poly]; }
+
+		/// @brief Returns the range of links of a polygon.
+		std::pair<uint32_t, uint32_t> getLinks(NavPolyRef poly) const { return { mLinkStart[poly], mLinkStart[poly + 1] }; }
+
+		/// @brief Returns the polygon a link leads to.
+		NavPolyRef getLinkTarget(uint32_t link) const { return mLinkTargets[link]; }
+
+		/// @brief Returns the cost of a link, the distance of the polygon centers.
+		float getLinkCost(uint32_t link) const { return mLinkCosts[link]; }
+
+		/// @brief Returns the midpoint of the edge shared by the polygons of a link.
+		const glm::vec3& getLinkPortal(uint32_t link) const { return mLinkPortals[link]; }
+
+		/// @brief Returns the number of clusters.
+		size_t getNumClusters() const { return mClusterCenters.size(); }
+
+		/// @brief Returns the center of a cluster.
+		const glm::vec3& getClusterCenter(uint32_t cluster) const { return mClusterCenters[cluster]; }
+
+		/// @brief Returns the range of links of a cluster.
+		std::pair<uint32_t, uint32_t> getClusterLinks(uint32_t cluster) const { 
+			return { mClusterLinkStart[cluster], mClusterLinkStart[cluster + 1] }; 
+		}
+
+		/// @brief Returns the cluster a cluster link leads to.
+		uint32_t getClusterLinkTarget(uint32_t link) const { return mClusterLinkTargets[link]; }
+
+		/// @brief Returns the cost of a cluster link, the distance of the cluster centers.
+		float getClusterLinkCost(uint32_t link) const { return mClusterLinkCosts[link]; }
+
+	private:
+		bool containsXZ(NavPolyRef poly, const glm::vec3& pos) const;
+		void buildClusters(uint32_t clusterSize);
+
+	private:
+		std::vector<glm::vec3> mVertices;
+		std::vector<uint32_t> mPolyVertexStart;
+		std::vector<uint32_t> mPolyVertices;
+		std::vector<glm::vec3> mCenters;
+		std::vector<uint32_t> mPolyClusters;
+		std::vector<uint32_t> mLinkStart;
+		std::vector<NavPolyRef> mLinkTargets;
+		std::vector<float> mLinkCosts;
+		std::vector<glm::vec3> mLinkPortals;
+		std::vector<glm::vec3> mClusterCenters;
+		std::vector<uint32_t> mClusterLinkStart;
+		std::vector<uint32_t> mClusterLinkTargets;
+		std::vector<float> mClusterLinkCosts;
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class NavQuery
+	/// @brief Searches paths on a navigation mesh with hierarchical A*.
+	///
+	/// The search first runs A* on the cluster graph and then on the polygons of the clusters 
+	/// along that route only, falling back to the whole mesh if the restricted search fails. A 
+	/// query owns the search state, so every thread needs its own query.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT NavQuery final {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] mesh The mesh to search, must outlive the query.
+		explicit NavQuery(const NavMesh& mesh);
+
+		/// @brief The class destructor.
+		~NavQuery() = default;
+
+		/// @brief Searches the polygons leading from one polygon to another.
+		/// @param[ in ] start The start polygon.
+		/// @param[ in ] end The end polygon.
+		/// @param[ out ] corridor The polygons from start to end.
+		/// @return True if a path was found.
+		bool findCorridor(NavPolyRef start, NavPolyRef end, std::vector<NavPolyRef>& corridor);
+
+		/// @brief Searches a path between two positions.
+		/// @param[ in ] start The start position.
+		/// @param[ in ] end The end position.
+		/// @param[ out ] path The way points from start to end.
+		/// @return True if a path was found.
+		bool findPath(const glm::vec3& start, const glm::vec3& end, std::vector<glm::vec3>& path);
+
+		/// @brief Converts a corridor into way points through the midpoints of the shared edges.
+		/// @param[ in ] start The start position.
+		/// @param[ in ] end The end position.
+		/// @param[ in ] corridor The polygons from start to end.
+		/// @param[ out ] path The way points.
+		void buildPath(const glm::vec3& start, const glm::vec3& end, const std::vector<NavPolyRef>& corridor, 
+			std::vector<glm::vec3>& path) const;
+
+		/// @brief Returns the mesh of the query.
+		const NavMesh& getMesh() const { return mMesh; }
+
+		/// @brief Returns the number of nodes expanded by the last search.
+		size_t getNumExpanded() const { return mNumExpanded; }
+
+		NavQuery(const NavQuery&) = delete;
+		NavQuery& operator = (const NavQuery&) = delete;
+
+	public:
+		/// @brief The state of one A* search level.
+		struct SearchState {
+			std::vector<float> cost;
+			std::vector<uint32_t> parent;
+			std::vector<uint32_t> visited;
+			std::vector<uint32_t> closed;
+			std::vector<std::pair<float, uint32_t>> open;
+			uint32_t generation{ 0 };
+
+			void begin(size_t numNodes);
+		};
+
+	private:
+		const NavMesh& mMesh;
+		SearchState mClusterSearch;
+		SearchState mPolySearch;
+		std::vector<uint32_t> mAllowedClusters;
+		uint32_t mAllowedGeneration{ 0 };
+		size_t mNumExpanded{ 0 };
+	};
+
+} // namespace segfault::ai
@@ -0,0 +1,223 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/pathfinding_service.h"
+#include "core/threadpool.h"
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	PathfindingService::PathfindingService(const NavMesh& mesh, ThreadPool& pool, size_t cacheSize) :
+			mMesh(mesh), mPool(pool), mCacheSize(cacheSize) {
+		// empty
+	}
+
+	PathfindingService::~PathfindingService() {
+		std::unique_lock<std::mutex> guard(mRequestLock);
+		mFinished.wait(guard, [this]() { return mNumInFlight == 0; });
+	}
+
+	PathRequestId PathfindingService::requestPath(const glm::vec3& start, const glm::vec3& end) {
+		PathRequestId id = InvalidPathRequest;
+		{
+			std::lock_guard<std::mutex> guard(mRequestLock);
+			id = mNextId++;
+			if (mNextId == InvalidPathRequest) {
+				mNextId = 1;
+			}
+			mRequests[id] = Request();
+			++mNumInFlight;
+		}
+		++mNumRequests;
+
+		mPool.enqueue([this, id, start, end]() {
+			processRequest(id, start, end);
+		});
+
+		return id;
+	}
+
+	PathStatus PathfindingService::getStatus(PathRequestId id) const {
+		std::lock_guard<std::mutex> guard(mRequestLock);
+		auto it = mRequests.find(id);
+		return it != mRequests.end() ? it->second.status : PathStatus::INVALID;
+	}
+
+	PathStatus PathfindingService::takePath(PathRequestId id, std::vector<glm::vec3>& path) {
+		std::lock_guard<std::mutex> guard(mRequestLock);
+		auto it = mRequests.find(id);
+		if (it == mRequests.end()) {
+			return PathStatus::INVALID;
+		}
+
+		const PathStatus status = it->second.status;
+		if (status != PathStatus::PENDING) {
+			path = std::move(it->second.path);
+			mRequests.erase(it);
+		}
+
+		return status;
+	}
+
+	void PathfindingService::release(PathRequestId id) {
+		std::lock_guard<std::mutex> guard(mRequestLock);
+		mRequests.erase(id);
+	}
+
+	NodeStatus PathfindingService::updateAgent(NavAgent& agent) {
+		if (agent.request == InvalidPathRequest) {
+			agent.request = requestPath(agent.position, agent.target);
+			return NodeStatus::RUNNING;
+		}
+
+		switch (takePath(agent.request, agent.path)) {
+			case PathStatus::PENDING:
+				return NodeStatus::RUNNING;
+			case PathStatus::READY:
+				agent.request = InvalidPathRequest;
+				return NodeStatus::SUCCESS;
+			default:
+				agent.request = InvalidPathRequest;
+				return NodeStatus::FAILURE;
+		}
+	}
+
+	void PathfindingService::clearCache() {
+		std::lock_guard<std::mutex> guard(mCacheLock);
+		mCache.clear();
+		mLru.clear();
+	}
+
+	PathfindingStats PathfindingService::getStats() const {
+		PathfindingStats stats;
+		stats.numRequests = mNumRequests.load();
+		stats.numCacheHits = mNumCacheHits.load();
+		stats.numSearches = mNumSearches.load();
+		stats.numFailed = mNumFailed.load();
+
+		return stats;
+	}
+
+	void PathfindingService::processRequest(PathRequestId id, glm::vec3 start, glm::vec3 end) {
+		// Skip the search if the request was released while it was queued
+		if (getStatus(id) == PathStatus::INVALID) {
+			std::lock_guard<std::mutex> guard(mRequestLock);
+			--mNumInFlight;
+			mFinished.notify_all();
+			return;
+		}
+
+		std::unique_ptr<NavQuery> query = acquireQuery();
+		const NavPolyRef startPoly = mMesh.findPolygon(start);
+		const NavPolyRef endPoly = mMesh.findPolygon(end);
+		const uint64_t key = (static_cast<uint64_t>(startPoly) << 32) | endPoly;
+
+		std::vector<NavPolyRef> corridor;
+		bool found = findCachedCorridor(key, corridor);
+		if (found) {
+			++mNumCacheHits;
+		} else {
+			++mNumSearches;
+			found = query->findCorridor(startPoly, endPoly, corridor);
+			if (found) {
+				addCachedCorridor(key, corridor);
+			}
+		}
+
+		std::vector<glm::vec3> path;
+		if (found) {
+			query->buildPath(start, end, corridor, path);
+		} else {
+			++mNumFailed;
+		}
+		releaseQuery(std::move(query));
+
+		std::lock_guard<std::mutex> guard(mRequestLock);
+		auto it = mRequests.find(id);
+		if (it != mRequests.end()) {
+			it->second.status = found ? PathStatus::READY : PathStatus::FAILED;
+			it->second.path = std::move(path);
+		}
+		--mNumInFlight;
+		mFinished.notify_all();
+	}
+
+	bool PathfindingService::findCachedCorridor(uint64_t key, std::vector<NavPolyRef>& corridor) {
+		std::lock_guard<std::mutex> guard(mCacheLock);
+		auto it = mCache.find(key);
+		if (it == mCache.end()) {
+			return false;
+		}
+
+		mLru.splice(mLru.begin(), mLru, it->second.lruPos);
+		corridor = it->second.corridor;
+
+		return true;
+	}
+
+	void PathfindingService::addCachedCorridor(uint64_t key, const std::vector<NavPolyRef>& corridor) {
+		if (mCacheSize == 0) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> guard(mCacheLock);
+		if (mCache.find(key) != mCache.end()) {
+			return;
+		}
+
+		if (mCache.size() >= mCacheSize) {
+			mCache.erase(mLru.back());
+			mLru.pop_back();
+		}
+		mLru.push_front(key);
+		mCache[key] = { corridor, mLru.begin() };
+	}
+
+	std::unique_ptr<NavQuery> PathfindingService::acquireQuery() {
+		{
+			std::lock_guard<std::mutex> guard(mQueryLock);
+			if (!mFreeQueries.empty()) {
+				std::unique_ptr<NavQuery> query = std::move(mFreeQueries.back());
+				mFreeQueries.pop_back();
+				return query;
+			}
+		}
+
+		return std::make_unique<NavQuery>(mMesh);
+	}
+
+	void PathfindingService::releaseQuery(std::unique_ptr<NavQuery> query) {
+		std::lock_guard<std::mutex> guard(mQueryLock);
+		mFreeQueries.push_back(std::move(query));
+	}
+
+	NodeStatus findPathAction(void* context) {
+		NavAgent* agent = static_cast<NavAgent*>(context);
+		if (agent == nullptr || agent->service == nullptr) {
+			return NodeStatus::FAILURE;
+		}
+
+		return agent->service->updateAgent(*agent);
+	}
+
+} // namespace segfault::ai
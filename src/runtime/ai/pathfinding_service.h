@@ -0,0 +1,177 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "ai/navmesh.h"
+#include "ai/behavior_tree_format.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::core {
+	class ThreadPool;
+}
+
+namespace segfault::ai {
+
+	/// @brief The id of a path request.
+	using PathRequestId = uint32_t;
+
+	/// @brief Marks an invalid path request.
+	static constexpr PathRequestId InvalidPathRequest = 0;
+
+	enum class PathStatus {
+		INVALID = -1,
+		PENDING,
+		READY,
+		FAILED,
+		Count
+	};
+
+	/// @brief The counters of a pathfinding service.
+	struct PathfindingStats {
+		size_t numRequests{ 0 };        ///< The number of requests.
+		size_t numCacheHits{ 0 };       ///< The number of requests served from the path cache.
+		size_t numSearches{ 0 };        ///< The number of searches run on the workers.
+		size_t numFailed{ 0 };          ///< The number of requests without a path.
+	};
+
+	class PathfindingService;
+
+	/// @brief The navigation state of an agent, the context of findPathAction.
+	struct NavAgent {
+		PathfindingService* service{ nullptr };         ///< The service to request paths from.
+		glm::vec3 position{ 0.0f };                     ///< The current position.
+		glm::vec3 target{ 0.0f };                       ///< The position to find a path to.
+		PathRequestId request{ InvalidPathRequest };    ///< The request in flight.
+		std::vector<glm::vec3> path;                    ///< The last path found.
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class PathfindingService
+	/// @brief Serves path requests asynchronously on the workers of a thread pool.
+	///
+	/// Requesting a path only records the request and enqueues it, so any number of agents can 
+	/// request paths in the same frame without stalling the game thread. Corridors are cached 
+	/// by their start and end polygon in a least recently used cache, agents walking between 
+	/// the same areas share the search. Each worker borrows its own NavQuery.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT PathfindingService final {
+	public:
+		/// @brief The class constructor.
+		/// @param[ in ] mesh The mesh to search, must outlive the service.
+		/// @param[ in ] pool The pool running the searches, must outlive the service.
+		/// @param[ in ] cacheSize The maximum number of cached corridors, zero disables the cache.
+		PathfindingService(const NavMesh& mesh, core::ThreadPool& pool, size_t cacheSize = 256);
+
+		/// @brief The class destructor, waits for the searches in flight.
+		~PathfindingService();
+
+		/// @brief Requests a path, never blocks on the search.
+		/// @param[ in ] start The start position.
+		/// @param[ in ] end The end position.
+		/// @return The id of the request.
+		PathRequestId requestPath(const glm::vec3& start, const glm::vec3& end);
+
+		/// @brief Returns the status of a request.
+		/// @param[ in ] id The id of the request.
+		/// @return The status, INVALID for unknown or released requests.
+		PathStatus getStatus(PathRequestId id) const;
+
+		/// @brief Takes the result of a finished request and releases it.
+		/// @param[ in ] id The id of the request.
+		/// @param[ out ] path The way points, empty if no path was found.
+		/// @return The status of the request, a pending request is not released.
+		PathStatus takePath(PathRequestId id, std::vector<glm::vec3>& path);
+
+		/// @brief Releases a request, the result of a pending request is dropped.
+		/// @param[ in ] id The id of the request.
+		void release(PathRequestId id);
+
+		/// @brief Advances the path search of an agent, for use in behavior tree actions.
+		/// @param[ in ] agent The agent.
+		/// @return RUNNING while the path is searched, SUCCESS when agent.path was updated or 
+		/// FAILURE if there is no path.
+		NodeStatus updateAgent(NavAgent& agent);
+
+		/// @brief Drops all cached corridors.
+		void clearCache();
+
+		/// @brief Returns the counters.
+		PathfindingStats getStats() const;
+
+		PathfindingService(const PathfindingService&) = delete;
+		PathfindingService& operator = (const PathfindingService&) = delete;
+
+	private:
+		void processRequest(PathRequestId id, glm::vec3 start, glm::vec3 end);
+		bool findCachedCorridor(uint64_t key, std::vector<NavPolyRef>& corridor);
+		void addCachedCorridor(uint64_t key, const std::vector<NavPolyRef>& corridor);
+		std::unique_ptr<NavQuery> acquireQuery();
+		void releaseQuery(std::unique_ptr<NavQuery> query);
+
+	private:
+		struct Request {
+			PathStatus status{ PathStatus::PENDING };
+			std::vector<glm::vec3> path;
+		};
+		struct CacheEntry {
+			std::vector<NavPolyRef> corridor;
+			std::list<uint64_t>::iterator lruPos;
+		};
+
+		const NavMesh& mMesh;
+		core::ThreadPool& mPool;
+		const size_t mCacheSize;
+
+		mutable std::mutex mRequestLock;
+		std::condition_variable mFinished;
+		std::unordered_map<PathRequestId, Request> mRequests;
+		PathRequestId mNextId{ 1 };
+		size_t mNumInFlight{ 0 };
+
+		std::mutex mCacheLock;
+		std::unordered_map<uint64_t, CacheEntry> mCache;
+		std::list<uint64_t> mLru;
+
+		std::mutex mQueryLock;
+		std::vector<std::unique_ptr<NavQuery>> mFreeQueries;
+
+		std::atomic<size_t> mNumRequests{ 0 };
+		std::atomic<size_t> mNumCacheHits{ 0 };
+		std::atomic<size_t> mNumSearches{ 0 };
+		std::atomic<size_t> mNumFailed{ 0 };
+	};
+
+	/// @brief A behavior tree action searching a path for the agent, the context must be a NavAgent.
+	/// @param[ in ] context The NavAgent.
+	/// @return The status of the search, see PathfindingService::updateAgent.
+	SEGFAULT_EXPORT NodeStatus findPathAction(void* context);
+
+} // namespace segfault::ai
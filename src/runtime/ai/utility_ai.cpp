@@ -0,0 +1,374 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/utility_ai.h"
+#include "ai/compiled_asset.h"
+#include "core/hash.h"
+#include "core/simd.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	namespace {
+		constexpr size_t TileSize = 64;
+		constexpr float Log2e = 1.44269504f;
+		constexpr float MinPowBase = 1.0e-30f;
+
+		// The approximations below are shared by the scalar and the SIMD path, so all agents 
+		// are scored identically no matter which lane they end up in.
+		constexpr float Exp2C1 = 0.693147181f;
+		constexpr float Exp2C2 = 0.240226507f;
+		constexpr float Exp2C3 = 0.0555041087f;
+		constexpr float Exp2C4 = 0.00961812911f;
+		constexpr float Exp2C5 = 0.00133335581f;
+		constexpr float Log2C1 = 2.88539008f;
+		constexpr float Log2C3 = 0.961796694f;
+		constexpr float Log2C5 = 0.577078016f;
+		constexpr float Log2C7 = 0.412198583f;
+
+		CompiledAssetCache<CompiledUtilityModel>& getCache() {
+			static CompiledAssetCache<CompiledUtilityModel> cache("utility model");
+			return cache;
+		}
+
+		float clamp01(float x) {
+			return std::min(std::max(x, 0.0f), 1.0f);
+		}
+
+		float exp2Approx(float x) {
+			x = std::min(std::max(x, -126.0f), 126.0f);
+			float xf = static_cast<float>(static_cast<int32_t>(x));
+			if (xf > x) {
+				xf -= 1.0f;
+			}
+
+			const float f = x - xf;
+			const float p = 1.0f + f * (Exp2C1 + f * (Exp2C2 + f * (Exp2C3 + f * (Exp2C4 + f * Exp2C5))));
+			const int32_t bits = (static_cast<int32_t>(xf) + 127) << 23;
+			float scale;
+			memcpy(&scale, &bits, sizeof(scale));
+
+			return p * scale;
+		}
+
+		float log2Approx(float x) {
+			int32_t bits;
+			memcpy(&bits, &x, sizeof(bits));
+			const float e = static_cast<float>((bits >> 23) - 127);
+			bits = (bits & 0x7fffff) | 0x3f800000;
+			float m;
+			memcpy(&m, &bits, sizeof(m));
+
+			const float t = (m - 1.0f) / (m + 1.0f);
+			const float t2 = t * t;
+			return e + t * (Log2C1 + t2 * (Log2C3 + t2 * (Log2C5 + t2 * Log2C7)));
+		}
+
+		float evaluateCurveScalar(const UtilityConsiderationRecord& consideration, float x) {
+			const float d = clamp01(x) - consideration.xShift;
+			float y = 0.0f;
+			switch (static_cast<CurveType>(consideration.curve)) {
+				case CurveType::LINEAR:
+					y = consideration.slope * d + consideration.yShift;
+					break;
+				case CurveType::POLYNOMIAL: {
+					const float p = d > 0.0f ? exp2Approx(consideration.exponent * log2Approx(std::max(d, MinPowBase))) : 0.0f;
+					y = consideration.slope * p + consideration.yShift;
+					break;
+				}
+				case CurveType::LOGISTIC:
+					y = consideration.exponent / (1.0f + exp2Approx(-consideration.slope * Log2e * d)) + consideration.yShift;
+					break;
+				default:
+					break;
+			}
+
+			return clamp01(y);
+		}
+
+#ifdef SEGFAULT_SIMD_SSE2
+		__m128 clamp01(__m128 x) {
+			return _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		}
+
+		__m128 exp2Approx(__m128 x) {
+			x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+			__m128 xf = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			xf = _mm_sub_ps(xf, _mm_and_ps(_mm_cmpgt_ps(xf, x), _mm_set1_ps(1.0f)));
+
+			const __m128 f = _mm_sub_ps(x, xf);
+			__m128 p = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(Exp2C5)), _mm_set1_ps(Exp2C4));
+			p = _mm_add_ps(_mm_mul_ps(f, p), _mm_set1_ps(Exp2C3));
+			p = _mm_add_ps(_mm_mul_ps(f, p), _mm_set1_ps(Exp2C2));
+			p = _mm_add_ps(_mm_mul_ps(f, p), _mm_set1_ps(Exp2C1));
+			p = _mm_add_ps(_mm_mul_ps(f, p), _mm_set1_ps(1.0f));
+			const __m128i bits = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(xf), _mm_set1_epi32(127)), 23);
+
+			return _mm_mul_ps(p, _mm_castsi128_ps(bits));
+		}
+
+		__m128 log2Approx(__m128 x) {
+			const __m128i bits = _mm_castps_si128(x);
+			const __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+			const __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x7fffff)), _mm_set1_epi32(0x3f800000)));
+
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+			const __m128 t2 = _mm_mul_ps(t, t);
+			__m128 p = _mm_add_ps(_mm_mul_ps(t2, _mm_set1_ps(Log2C7)), _mm_set1_ps(Log2C5));
+			p = _mm_add_ps(_mm_mul_ps(t2, p), _mm_set1_ps(Log2C3));
+			p = _mm_add_ps(_mm_mul_ps(t2, p), _mm_set1_ps(Log2C1));
+
+			return _mm_add_ps(e, _mm_mul_ps(t, p));
+		}
+
+		__m128 evaluateCurveSimd(const UtilityConsiderationRecord& consideration, __m128 x) {
+			const __m128 d = _mm_sub_ps(clamp01(x), _mm_set1_ps(consideration.xShift));
+			const __m128 slope = _mm_set1_ps(consideration.slope);
+			const __m128 yShift = _mm_set1_ps(consideration.yShift);
+			__m128 y = _mm_setzero_ps();
+			switch (static_cast<CurveType>(consideration.curve)) {
+				case CurveType::LINEAR:
+					y = _mm_add_ps(_mm_mul_ps(slope, d), yShift);
+					break;
+				case CurveType::POLYNOMIAL: {
+					const __m128 positive = _mm_cmpgt_ps(d, _mm_setzero_ps());
+					const __m128 base = _mm_max_ps(d, _mm_set1_ps(MinPowBase));
+					const __m128 p = _mm_and_ps(positive, exp2Approx(_mm_mul_ps(_mm_set1_ps(consideration.exponent), log2Approx(base))));
+					y = _mm_add_ps(_mm_mul_ps(slope, p), yShift);
+					break;
+				}
+				case CurveType::LOGISTIC: {
+					const __m128 e = exp2Approx(_mm_mul_ps(_mm_set1_ps(-consideration.slope * Log2e), d));
+					y = _mm_add_ps(_mm_div_ps(_mm_set1_ps(consideration.exponent), _mm_add_ps(_mm_set1_ps(1.0f), e)), yShift);
+					break;
+				}
+				default:
+					break;
+			}
+
+			return clamp01(y);
+		}
+#endif
+
+		// Multiplies the compensated consideration scores into the option scores, returns true 
+		// if any score is still above zero.
+		bool applyConsideration(const UtilityConsiderationRecord& consideration, float compensation, 
+				const float* inputs, float* scores, size_t count) {
+			size_t i = 0;
+			bool anyPositive = false;
+#ifdef SEGFAULT_SIMD_SSE2
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 mod = _mm_set1_ps(compensation);
+			__m128 positive = _mm_setzero_ps();
+			for (; i + SimdWidth <= count; i += SimdWidth) {
+				const __m128 v = evaluateCurveSimd(consideration, _mm_loadu_ps(inputs + i));
+				const __m128 makeUp = _mm_mul_ps(_mm_sub_ps(one, v), mod);
+				const __m128 score = _mm_mul_ps(_mm_loadu_ps(scores + i), _mm_add_ps(v, _mm_mul_ps(makeUp, v)));
+				_mm_storeu_ps(scores + i, score);
+				positive = _mm_or_ps(positive, _mm_cmpgt_ps(score, _mm_setzero_ps()));
+			}
+			anyPositive = _mm_movemask_ps(positive) != 0;
+#endif
+			for (; i < count; ++i) {
+				const float v = evaluateCurveScalar(consideration, inputs[i]);
+				const float makeUp = (1.0f - v) * compensation;
+				scores[i] *= v + makeUp * v;
+				anyPositive |= scores[i] > 0.0f;
+			}
+
+			return anyPositive;
+		}
+
+		void selectBest(const float* scores, uint32_t option, float* best, uint32_t* bestOption, size_t count) {
+			size_t i = 0;
+#ifdef SEGFAULT_SIMD_SSE2
+			const __m128i optionIndex = _mm_set1_epi32(static_cast<int32_t>(option));
+			for (; i + SimdWidth <= count; i += SimdWidth) {
+				const __m128 score = _mm_loadu_ps(scores + i);
+				const __m128 current = _mm_loadu_ps(best + i);
+				const __m128 better = _mm_cmpgt_ps(score, current);
+				const __m128i betterMask = _mm_castps_si128(better);
+				const __m128i currentOption = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bestOption + i));
+				_mm_storeu_ps(best + i, _mm_or_ps(_mm_and_ps(better, score), _mm_andnot_ps(better, current)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bestOption + i), 
+					_mm_or_si128(_mm_and_si128(betterMask, optionIndex), _mm_andnot_si128(betterMask, currentOption)));
+			}
+#endif
+			for (; i < count; ++i) {
+				if (scores[i] > best[i]) {
+					best[i] = scores[i];
+					bestOption[i] = option;
+				}
+			}
+		}
+	}
+
+	void UtilityInputBatch::resize(size_t numAgents, size_t numInputs) {
+		mNumAgents = numAgents;
+		mNumInputs = numInputs;
+		mValues.assign(numAgents * numInputs, 0.0f);
+	}
+
+	std::shared_ptr<const CompiledUtilityModel> UtilityModelCache::get(const char* configFile) {
+		return getCache().get(configFile);
+	}
+
+	void UtilityModelCache::clear() {
+		getCache().clear();
+	}
+
+	size_t UtilityModelCache::getNumEntries() {
+		return getCache().getNumEntries();
+	}
+
+	bool UtilityAI::init(const char* configFile) {
+		mActions.clear();
+		mModel = UtilityModelCache::get(configFile);
+		if (mModel == nullptr) {
+			const std::string msg = std::string("Cannot load utility model ") + (configFile != nullptr ? configFile : "") + ".";
+			logMessage(LogType::Error, msg.c_str());
+			return false;
+		}
+
+		mActions.resize(mModel->getNumOptions(), nullptr);
+
+		return true;
+	}
+
+	bool UtilityAI::init(const char* configFile, const ActionRegistry& registry) {
+		if (!init(configFile)) {
+			return false;
+		}
+
+		for (size_t i = 0; i < mModel->getNumOptions(); ++i) {
+			const UtilityOptionRecord& option = mModel->getOption(i);
+			mActions[i] = registry.getAction(registry.findId(option.nameHash));
+			if (mActions[i] == nullptr) {
+				const std::string msg = std::string("Unbound utility option ") + mModel->getString(option.nameOffset) + ".";
+				logMessage(LogType::Warn, msg.c_str());
+			}
+		}
+
+		return true;
+	}
+
+	uint32_t UtilityAI::findInput(const char* name) const {
+		if (mModel == nullptr || name == nullptr) {
+			return InvalidUtilityIndex;
+		}
+
+		const uint64_t nameHash = hashString(name);
+		for (size_t i = 0; i < mModel->getNumInputs(); ++i) {
+			if (mModel->getInput(i).nameHash == nameHash) {
+				return static_cast<uint32_t>(i);
+			}
+		}
+
+		return InvalidUtilityIndex;
+	}
+
+	size_t UtilityAI::getNumInputs() const {
+		return mModel != nullptr ? mModel->getNumInputs() : 0;
+	}
+
+	size_t UtilityAI::getNumOptions() const {
+		return mModel != nullptr ? mModel->getNumOptions() : 0;
+	}
+
+	const char* UtilityAI::getOptionName(uint32_t option) const {
+		if (mModel == nullptr || option >= mModel->getNumOptions()) {
+			return "";
+		}
+
+		return mModel->getString(mModel->getOption(option).nameOffset);
+	}
+
+	void UtilityAI::evaluate(const UtilityInputBatch& inputs, UtilityDecision* decisions) const {
+		evaluate(inputs, 0, inputs.getNumAgents(), decisions);
+	}
+
+	void UtilityAI::evaluate(const UtilityInputBatch& inputs, size_t firstAgent, size_t numAgents, UtilityDecision* decisions) const {
+		if (mModel == nullptr || decisions == nullptr) {
+			return;
+		}
+		if (inputs.getNumInputs() < mModel->getNumInputs() || firstAgent + numAgents > inputs.getNumAgents()) {
+			logMessage(LogType::Error, "Utility input batch does not match the model.");
+			return;
+		}
+
+		// Tiles keep the scores of all options of a group of agents in the L1 cache
+		float scores[TileSize];
+		float best[TileSize];
+		uint32_t bestOption[TileSize];
+		for (size_t tile = 0; tile < numAgents; tile += TileSize) {
+			const size_t count = std::min(TileSize, numAgents - tile);
+			const size_t begin = firstAgent + tile;
+			std::fill(best, best + count, 0.0f);
+			std::fill(bestOption, bestOption + count, InvalidUtilityIndex);
+
+			for (size_t o = 0; o < mModel->getNumOptions(); ++o) {
+				const UtilityOptionRecord& option = mModel->getOption(o);
+				const float compensation = option.numConsiderations > 1 ? 1.0f - 1.0f / option.numConsiderations : 0.0f;
+				std::fill(scores, scores + count, option.weight);
+
+				bool anyPositive = option.weight > 0.0f;
+				for (uint32_t c = 0; c < option.numConsiderations && anyPositive; ++c) {
+					const UtilityConsiderationRecord& consideration = mModel->getConsideration(option.firstConsideration + c);
+					anyPositive = applyConsideration(consideration, compensation, inputs.getInputs(consideration.input) + begin, scores, count);
+				}
+
+				if (anyPositive) {
+					selectBest(scores, static_cast<uint32_t>(o), best, bestOption, count);
+				}
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				decisions[tile + i].option = bestOption[i];
+				decisions[tile + i].score = best[i];
+			}
+		}
+	}
+
+	void UtilityAI::execute(const UtilityDecision* decisions, void* const* contexts, size_t count) const {
+		if (decisions == nullptr || contexts == nullptr) {
+			return;
+		}
+
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t option = decisions[i].option;
+			if (option < mActions.size() && mActions[option] != nullptr) {
+				mActions[option](contexts[i]);
+			}
+		}
+	}
+
+	float UtilityAI::evaluateCurve(const UtilityConsiderationRecord& consideration, float x) {
+		return evaluateCurveScalar(consideration, x);
+	}
+
+} // namespace segfault::ai
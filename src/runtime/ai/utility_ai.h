@@ -0,0 +1,194 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "ai/utility_ai_format.h"
+#include "ai/action_registry.h"
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace segfault::ai {
+
+	//---------------------------------------------------------------------------------------------
+	/// @class UtilityInputBatch
+	/// @brief The inputs of many agents in structure-of-arrays layout.
+	///
+	/// Every input is a contiguous row holding the value of all agents, so the scoring reads 
+	/// each consideration input as a linear stream. Values are expected to be normalized to [0, 1].
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT UtilityInputBatch final {
+	public:
+		/// @brief The class constructor.
+		UtilityInputBatch() = default;
+
+		/// @brief The class destructor.
+		~UtilityInputBatch() = default;
+
+		/// @brief Resizes the batch, all values are reset to zero.
+		/// @param[ in ] numAgents The number of agents.
+		/// @param[ in ] numInputs The number of inputs, see UtilityAI::getNumInputs.
+		void resize(size_t numAgents, size_t numInputs);
+
+		/// @brief Sets an input value of an agent.
+		/// @param[ in ] input The index of the input.
+		/// @param[ in ] agent The index of the agent.
+		/// @param[ in ] value The value.
+		void setInput(uint32_t input, size_t agent, float value) {
+			assert(input < mNumInputs && agent < mNumAgents);
+			mValues[input * mNumAgents + agent] = value;
+		}
+
+		/// @brief Returns the row of an input.
+		/// @param[ in ] input The index of the input.
+		/// @return The values of all agents.
+		float *getInputs(uint32_t input) {
+			assert(input < mNumInputs);
+			return mValues.data() + input * mNumAgents;
+		}
+
+		/// @brief Returns the row of an input.
+		/// @param[ in ] input The index of the input.
+		/// @return The values of all agents.
+		const float *getInputs(uint32_t input) const {
+			assert(input < mNumInputs);
+			return mValues.data() + input * mNumAgents;
+		}
+
+		/// @brief Returns the number of agents.
+		size_t getNumAgents() const { return mNumAgents; }
+
+		/// @brief Returns the number of inputs.
+		size_t getNumInputs() const { return mNumInputs; }
+
+	private:
+		std::vector<float> mValues;
+		size_t mNumAgents{ 0 };
+		size_t mNumInputs{ 0 };
+	};
+
+	/// @brief The best option of an agent.
+	struct UtilityDecision {
+		uint32_t option{ InvalidUtilityIndex };		///< The index of the option, invalid if no option scored above zero.
+		float score{ 0.0f };						///< The score of the option.
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class UtilityModelCache
+	/// @brief Process-wide cache of compiled utility models, keyed by the hash of the file name.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT UtilityModelCache final {
+	public:
+		/// @brief Returns the compiled model for a file, loads it on the first request.
+		/// @param[ in ] configFile The path to the json description or the baked blob.
+		/// @return The compiled model or nullptr if the file cannot be loaded.
+		static std::shared_ptr<const CompiledUtilityModel> get(const char* configFile);
+
+		/// @brief Drops all cached models. Models still in use stay alive until released.
+		static void clear();
+
+		/// @brief Returns the number of cached models.
+		static size_t getNumEntries();
+	};
+
+	//---------------------------------------------------------------------------------------------
+	/// @class UtilityAI
+	/// @brief Picks the best option for many agents by scoring considerations.
+	///
+	/// Each option multiplies its weight with the response curves of its considerations, 
+	/// compensated for the number of considerations so options with many of them are not 
+	/// punished. Agents are scored in tiles of 64 with SIMD over the agents, without any per 
+	/// agent branching, which makes it the cheaper choice over behavior trees for large crowds. 
+	/// Evaluating is const, disjoint agent ranges can be scored on different threads.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT UtilityAI final {
+	public:
+		// No copying
+		UtilityAI(const UtilityAI& rhs) = delete;
+		UtilityAI& operator = (const UtilityAI& rhs) = delete;
+
+		/// @brief The class constructor.
+		UtilityAI() = default;
+
+		/// @brief The class destructor.
+		~UtilityAI() = default;
+
+		/// @brief Initializes the model.
+		/// @param[ in ] configFile The path to the json description or the baked blob of the model.
+		/// @return True if initialization was successful, false otherwise.
+		bool init(const char* configFile);
+
+		/// @brief Initializes the model and binds its options to actions of the same name.
+		/// @param[ in ] configFile The path to the json description or the baked blob of the model.
+		/// @param[ in ] registry The registry to resolve the option names.
+		/// @return True if initialization was successful, false otherwise.
+		bool init(const char* configFile, const ActionRegistry& registry);
+
+		/// @brief Returns the index of an input.
+		/// @param[ in ] name The name of the input.
+		/// @return The index or InvalidUtilityIndex, if the model has no such input.
+		uint32_t findInput(const char* name) const;
+
+		/// @brief Returns the number of inputs.
+		size_t getNumInputs() const;
+
+		/// @brief Returns the number of options.
+		size_t getNumOptions() const;
+
+		/// @brief Returns the name of an option.
+		/// @param[ in ] option The index of the option.
+		/// @return The name or an empty string for an invalid index.
+		const char* getOptionName(uint32_t option) const;
+
+		/// @brief Scores all agents of a batch.
+		/// @param[ in ] inputs The inputs of the agents.
+		/// @param[ out ] decisions The best option per agent, must hold one entry per agent.
+		void evaluate(const UtilityInputBatch& inputs, UtilityDecision* decisions) const;
+
+		/// @brief Scores a range of agents of a batch.
+		/// @param[ in ] inputs The inputs of the agents.
+		/// @param[ in ] firstAgent The index of the first agent.
+		/// @param[ in ] numAgents The number of agents.
+		/// @param[ out ] decisions The best option per agent of the range.
+		void evaluate(const UtilityInputBatch& inputs, size_t firstAgent, size_t numAgents, UtilityDecision* decisions) const;
+
+		/// @brief Runs the bound actions of the decisions.
+		/// @param[ in ] decisions The decisions.
+		/// @param[ in ] contexts The agent contexts passed to the handlers.
+		/// @param[ in ] count The number of agents.
+		void execute(const UtilityDecision* decisions, void* const* contexts, size_t count) const;
+
+		/// @brief Evaluates a response curve, matches the batched evaluation.
+		/// @param[ in ] consideration The consideration.
+		/// @param[ in ] x The input value.
+		/// @return The score in [0, 1].
+		static float evaluateCurve(const UtilityConsiderationRecord& consideration, float x);
+
+	private:
+		std::shared_ptr<const CompiledUtilityModel> mModel;
+		std::vector<ActionHandler> mActions;
+	};
+
+} // namespace segfault::ai
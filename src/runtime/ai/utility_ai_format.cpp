@@ -0,0 +1,319 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "ai/utility_ai_format.h"
+#include "core/hash.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace segfault::ai {
+
+	using namespace segfault::core;
+
+	namespace {
+		CurveType getCurveTypeByName(const std::string &name) {
+			if (name == "Linear") {
+				return CurveType::LINEAR;
+			} else if (name == "Polynomial") {
+				return CurveType::POLYNOMIAL;
+			} else if (name == "Logistic") {
+				return CurveType::LOGISTIC;
+			}
+
+			return CurveType::INVALID;
+		}
+
+		float getFloat(const json &data, const char *key, float defaultValue) {
+			auto it = data.find(key);
+			if (it == data.end() || !it->is_number()) {
+				return defaultValue;
+			}
+
+			return it->get<float>();
+		}
+
+		bool isFinite(const UtilityConsiderationRecord &record) {
+			return std::isfinite(record.slope) && std::isfinite(record.exponent) && 
+				std::isfinite(record.xShift) && std::isfinite(record.yShift);
+		}
+	}
+
+	const char *getCurveTypeName(CurveType type) {
+		switch (type) {
+			case CurveType::LINEAR:
+				return "Linear";
+			case CurveType::POLYNOMIAL:
+				return "Polynomial";
+			case CurveType::LOGISTIC:
+				return "Logistic";
+			default:
+				return "Invalid";
+		}
+	}
+
+	bool CompiledUtilityModel::compile(const json &doc) {
+		clear();
+
+		auto inputsIt = doc.find("inputs");
+		auto optionsIt = doc.find("options");
+		if (!doc.is_object() || inputsIt == doc.end() || !inputsIt->is_array() || 
+				optionsIt == doc.end() || !optionsIt->is_array() || optionsIt->empty()) {
+			logMessage(LogType::Error, "A utility model needs an inputs and an options array.");
+			return false;
+		}
+
+		for (const auto &input : *inputsIt) {
+			if (!input.is_string()) {
+				logMessage(LogType::Error, "Utility model input is not a name.");
+				clear();
+				return false;
+			}
+
+			const std::string &name = input.get_ref<const std::string&>();
+			UtilityInputRecord record;
+			record.nameOffset = addString(name);
+			record.nameHash = hashString(name.c_str());
+			mInputs.push_back(record);
+		}
+
+		for (const auto &option : *optionsIt) {
+			auto nameIt = option.find("name");
+			if (!option.is_object() || nameIt == option.end() || !nameIt->is_string()) {
+				logMessage(LogType::Error, "Utility model option without name.");
+				clear();
+				return false;
+			}
+
+			const std::string &name = nameIt->get_ref<const std::string&>();
+			UtilityOptionRecord record;
+			record.firstConsideration = static_cast<uint32_t>(mConsiderations.size());
+			record.weight = getFloat(option, "weight", 1.0f);
+			record.nameOffset = addString(name);
+			record.nameHash = hashString(name.c_str());
+
+			auto considerationsIt = option.find("considerations");
+			if (considerationsIt != option.end()) {
+				if (!considerationsIt->is_array() || considerationsIt->size() > std::numeric_limits<uint16_t>::max()) {
+					logMessage(LogType::Error, "Invalid considerations of utility model option.");
+					clear();
+					return false;
+				}
+
+				for (const auto &consideration : *considerationsIt) {
+					auto inputIt = consideration.find("input");
+					auto curveIt = consideration.find("curve");
+					if (!consideration.is_object() || inputIt == consideration.end() || !inputIt->is_string() || 
+							curveIt == consideration.end() || !curveIt->is_string()) {
+						logMessage(LogType::Error, "Utility model consideration needs an input and a curve.");
+						clear();
+						return false;
+					}
+
+					UtilityConsiderationRecord considerationRecord;
+					const uint64_t inputHash = hashString(inputIt->get_ref<const std::string&>().c_str());
+					considerationRecord.input = InvalidUtilityIndex;
+					for (size_t i = 0; i < mInputs.size(); ++i) {
+						if (mInputs[i].nameHash == inputHash) {
+							considerationRecord.input = static_cast<uint32_t>(i);
+							break;
+						}
+					}
+
+					const CurveType curve = getCurveTypeByName(curveIt->get_ref<const std::string&>());
+					if (considerationRecord.input == InvalidUtilityIndex || curve == CurveType::INVALID) {
+						const std::string msg = "Unknown input or curve in utility model option " + name + ".";
+						logMessage(LogType::Error, msg.c_str());
+						clear();
+						return false;
+					}
+
+					considerationRecord.curve = static_cast<uint8_t>(curve);
+					considerationRecord.slope = getFloat(consideration, "slope", 1.0f);
+					considerationRecord.exponent = getFloat(consideration, "exponent", 1.0f);
+					considerationRecord.xShift = getFloat(consideration, "xShift", 0.0f);
+					considerationRecord.yShift = getFloat(consideration, "yShift", 0.0f);
+					mConsiderations.push_back(considerationRecord);
+				}
+				record.numConsiderations = static_cast<uint16_t>(considerationsIt->size());
+			}
+
+			mOptions.push_back(record);
+		}
+
+		if (!validate()) {
+			clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool CompiledUtilityModel::load(const uint8_t *data, size_t size) {
+		clear();
+		if (!isBinary(data, size) || size < sizeof(UtilityModelFileHeader)) {
+			return false;
+		}
+
+		UtilityModelFileHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (header.version != UtilityModelVersion) {
+			logMessage(LogType::Error, "Unsupported utility model version, rebake the asset.");
+			return false;
+		}
+
+		const size_t inputsSize = static_cast<size_t>(header.numInputs) * sizeof(UtilityInputRecord);
+		const size_t optionsSize = static_cast<size_t>(header.numOptions) * sizeof(UtilityOptionRecord);
+		const size_t considerationsSize = static_cast<size_t>(header.numConsiderations) * sizeof(UtilityConsiderationRecord);
+		if (header.numOptions == 0 || 
+				sizeof(header) + inputsSize + optionsSize + considerationsSize + header.stringTableSize > size) {
+			logMessage(LogType::Error, "Utility model blob is truncated.");
+			return false;
+		}
+
+		const uint8_t *current = data + sizeof(header);
+		mInputs.resize(header.numInputs);
+		memcpy(mInputs.data(), current, inputsSize);
+		current += inputsSize;
+		mOptions.resize(header.numOptions);
+		memcpy(mOptions.data(), current, optionsSize);
+		current += optionsSize;
+		mConsiderations.resize(header.numConsiderations);
+		memcpy(mConsiderations.data(), current, considerationsSize);
+		current += considerationsSize;
+		mStrings.assign(current, current + header.stringTableSize);
+
+		if (!validate()) {
+			logMessage(LogType::Error, "Utility model blob is corrupt.");
+			clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool CompiledUtilityModel::save(std::vector<uint8_t> &blob) const {
+		if (mOptions.empty()) {
+			return false;
+		}
+
+		UtilityModelFileHeader header;
+		header.numInputs = static_cast<uint32_t>(mInputs.size());
+		header.numOptions = static_cast<uint32_t>(mOptions.size());
+		header.numConsiderations = static_cast<uint32_t>(mConsiderations.size());
+		header.stringTableSize = static_cast<uint32_t>(mStrings.size());
+
+		const size_t inputsSize = mInputs.size() * sizeof(UtilityInputRecord);
+		const size_t optionsSize = mOptions.size() * sizeof(UtilityOptionRecord);
+		const size_t considerationsSize = mConsiderations.size() * sizeof(UtilityConsiderationRecord);
+		blob.resize(sizeof(header) + inputsSize + optionsSize + considerationsSize + mStrings.size());
+
+		uint8_t *current = blob.data();
+		memcpy(current, &header, sizeof(header));
+		current += sizeof(header);
+		if (inputsSize != 0) {
+			memcpy(current, mInputs.data(), inputsSize);
+			current += inputsSize;
+		}
+		memcpy(current, mOptions.data(), optionsSize);
+		current += optionsSize;
+		if (considerationsSize != 0) {
+			memcpy(current, mConsiderations.data(), considerationsSize);
+			current += considerationsSize;
+		}
+		if (!mStrings.empty()) {
+			memcpy(current, mStrings.data(), mStrings.size());
+		}
+
+		return true;
+	}
+
+	bool CompiledUtilityModel::isBinary(const uint8_t *data, size_t size) {
+		if (data == nullptr || size < sizeof(uint32_t)) {
+			return false;
+		}
+
+		uint32_t magic{ 0 };
+		memcpy(&magic, data, sizeof(magic));
+
+		return magic == UtilityModelMagic;
+	}
+
+	const char *CompiledUtilityModel::getString(uint32_t offset) const {
+		if (offset >= mStrings.size()) {
+			return "";
+		}
+
+		return &mStrings[offset];
+	}
+
+	size_t CompiledUtilityModel::getMemorySize() const {
+		return mInputs.capacity() * sizeof(UtilityInputRecord) + mOptions.capacity() * sizeof(UtilityOptionRecord) + 
+			mConsiderations.capacity() * sizeof(UtilityConsiderationRecord) + mStrings.capacity();
+	}
+
+	void CompiledUtilityModel::clear() {
+		mInputs.clear();
+		mOptions.clear();
+		mConsiderations.clear();
+		mStrings.clear();
+	}
+
+	uint32_t CompiledUtilityModel::addString(const std::string &str) {
+		const uint32_t offset = static_cast<uint32_t>(mStrings.size());
+		mStrings.insert(mStrings.end(), str.begin(), str.end());
+		mStrings.push_back('\0');
+
+		return offset;
+	}
+
+	bool CompiledUtilityModel::validate() const {
+		// Never trust baked data: names must be terminated and all indices in range
+		if (mOptions.empty() || (!mStrings.empty() && mStrings.back() != '\0')) {
+			return false;
+		}
+
+		for (const auto &input : mInputs) {
+			if (input.nameOffset >= mStrings.size()) {
+				return false;
+			}
+		}
+
+		for (const auto &option : mOptions) {
+			const size_t end = static_cast<size_t>(option.firstConsideration) + option.numConsiderations;
+			if (option.nameOffset >= mStrings.size() || end > mConsiderations.size() || !std::isfinite(option.weight)) {
+				return false;
+			}
+		}
+
+		for (const auto &consideration : mConsiderations) {
+			if (consideration.input >= mInputs.size() || consideration.curve >= static_cast<uint8_t>(CurveType::Count) || 
+					!isFinite(consideration)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+} // namespace segfault::ai
@@ -0,0 +1,183 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace segfault::ai {
+
+	using json = ::nlohmann::json;
+
+	enum class CurveType {
+		INVALID = -1,
+		LINEAR,
+		POLYNOMIAL,
+		LOGISTIC,
+		Count
+	};
+
+	/// @brief Returns the name of a curve type as used in the json description.
+	/// @param[ in ] type The curve type.
+	/// @return The name, "Invalid" for unknown types.
+	SEGFAULT_EXPORT const char* getCurveTypeName(CurveType type);
+
+	/// @brief The magic number of a baked utility model blob, "SFUA" in little endian.
+	static constexpr uint32_t UtilityModelMagic = 0x41554653;
+
+	/// @brief The version of the baked utility model format.
+	static constexpr uint16_t UtilityModelVersion = 1;
+
+	/// @brief Marks an unknown input or option.
+	static constexpr uint32_t InvalidUtilityIndex = 0xffffffff;
+
+	/// @brief The header of a baked utility model blob.
+	struct UtilityModelFileHeader {
+		uint32_t magic{ UtilityModelMagic };		///< The magic number, must be UtilityModelMagic.
+		uint16_t version{ UtilityModelVersion };	///< The format version.
+		uint16_t reserved{ 0 };						///< Reserved, must be zero.
+		uint32_t numInputs{ 0 };					///< The number of input records following the header.
+		uint32_t numOptions{ 0 };					///< The number of option records following the inputs.
+		uint32_t numConsiderations{ 0 };			///< The number of consideration records following the options.
+		uint32_t stringTableSize{ 0 };				///< The size of the string table after the records.
+	};
+	static_assert(sizeof(UtilityModelFileHeader) == 24, "Unexpected header layout.");
+
+	/// @brief A named input, the value of an input is expected to be normalized to [0, 1].
+	struct UtilityInputRecord {
+		uint32_t nameOffset{ 0 };					///< The offset of the input name in the string table.
+		uint32_t reserved{ 0 };						///< Reserved, must be zero.
+		uint64_t nameHash{ 0 };						///< The hash of the input name.
+	};
+	static_assert(sizeof(UtilityInputRecord) == 16, "Unexpected input record layout.");
+
+	/// @brief Maps an input to a score in [0, 1] by a response curve.
+	///
+	/// With x being the input, the curves are
+	///   linear:     slope * (x - xShift) + yShift
+	///   polynomial: slope * max(x - xShift, 0) ^ exponent + yShift
+	///   logistic:   exponent / (1 + e ^ (-slope * (x - xShift))) + yShift
+	/// and the result is clamped to [0, 1].
+	struct UtilityConsiderationRecord {
+		uint32_t input{ 0 };						///< The index of the input.
+		uint8_t curve{ 0 };							///< The CurveType.
+		uint8_t reserved[3]{ 0, 0, 0 };				///< Reserved, must be zero.
+		float slope{ 1.0f };						///< The slope of the curve.
+		float exponent{ 1.0f };						///< The exponent or the height of a logistic curve.
+		float xShift{ 0.0f };						///< The horizontal shift.
+		float yShift{ 0.0f };						///< The vertical shift.
+	};
+	static_assert(sizeof(UtilityConsiderationRecord) == 24, "Unexpected consideration record layout.");
+
+	/// @brief A scored option. The considerations of an option are the contiguous range 
+	/// [firstConsideration, firstConsideration + numConsiderations).
+	struct UtilityOptionRecord {
+		uint32_t firstConsideration{ 0 };			///< The index of the first consideration.
+		uint16_t numConsiderations{ 0 };			///< The number of considerations.
+		uint16_t reserved{ 0 };						///< Reserved, must be zero.
+		float weight{ 1.0f };						///< The weight multiplied into the score.
+		uint32_t nameOffset{ 0 };					///< The offset of the option name in the string table.
+		uint64_t nameHash{ 0 };						///< The hash of the option name, used to bind actions.
+	};
+	static_assert(sizeof(UtilityOptionRecord) == 24, "Unexpected option record layout.");
+
+	//---------------------------------------------------------------------------------------------
+	/// @class CompiledUtilityModel
+	/// @brief The immutable, flattened form of a utility model.
+	///
+	/// Like a compiled behavior tree the model is either loaded from a blob baked by the 
+	/// assetbaker or compiled once from its json description and shared by all users.
+	//---------------------------------------------------------------------------------------------
+	class SEGFAULT_EXPORT CompiledUtilityModel final {
+	public:
+		/// @brief The class constructor.
+		CompiledUtilityModel() = default;
+
+		/// @brief The class destructor.
+		~CompiledUtilityModel() = default;
+
+		/// @brief Compiles the model from its json description.
+		/// @param[ in ] doc The json document with the inputs and options.
+		/// @return True if the document describes a valid model, false otherwise.
+		bool compile(const json &doc);
+
+		/// @brief Loads the model from a baked blob.
+		/// @param[ in ] data The blob data.
+		/// @param[ in ] size The size of the blob in bytes.
+		/// @return True if the blob is a valid model, false otherwise.
+		bool load(const uint8_t *data, size_t size);
+
+		/// @brief Serializes the model into a blob.
+		/// @param[ out ] blob The blob to write to.
+		/// @return True if the model was serialized, false if the model is empty.
+		bool save(std::vector<uint8_t> &blob) const;
+
+		/// @brief Checks if the data starts with the baked utility model magic.
+		/// @param[ in ] data The data to check.
+		/// @param[ in ] size The size of the data in bytes.
+		/// @return True if the data is a baked blob.
+		static bool isBinary(const uint8_t *data, size_t size);
+
+		/// @brief Returns the number of inputs.
+		size_t getNumInputs() const { return mInputs.size(); }
+
+		/// @brief Returns the input record at the given index.
+		const UtilityInputRecord &getInput(size_t index) const { return mInputs[index]; }
+
+		/// @brief Returns the number of options.
+		size_t getNumOptions() const { return mOptions.size(); }
+
+		/// @brief Returns the option record at the given index.
+		const UtilityOptionRecord &getOption(size_t index) const { return mOptions[index]; }
+
+		/// @brief Returns the number of considerations of all options.
+		size_t getNumConsiderations() const { return mConsiderations.size(); }
+
+		/// @brief Returns the consideration record at the given index.
+		const UtilityConsiderationRecord &getConsideration(size_t index) const { return mConsiderations[index]; }
+
+		/// @brief Returns a string from the string table.
+		/// @param[ in ] offset The offset of the string.
+		/// @return The string or an empty string, if the offset is invalid.
+		const char *getString(uint32_t offset) const;
+
+		/// @brief Returns the size of the records and the string table in bytes.
+		size_t getMemorySize() const;
+
+	private:
+		void clear();
+		uint32_t addString(const std::string &str);
+		bool validate() const;
+
+	private:
+		std::vector<UtilityInputRecord> mInputs;
+		std::vector<UtilityOptionRecord> mOptions;
+		std::vector<UtilityConsiderationRecord> mConsiderations;
+		std::vector<char> mStrings;
+	};
+
+} // namespace segfault::ai
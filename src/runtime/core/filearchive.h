@@ -113,7 +113,9 @@ inline FileArchive::FileArchive(FILE *stream, bool canRead, bool canWrite) :
 }
 
 inline FileArchive::~FileArchive() {
-    fclose(mStream);
+    if (mStream != nullptr) {
+        fclose(mStream);
+    }
 }
 
 inline size_t FileArchive::getSize() const {
@@ -141,7 +143,7 @@ inline size_t FileArchive::read(uint8_t *buffer, size_t size) {
 }
 
 inline size_t FileArchive::write(const uint8_t *buffer, size_t size) {
-    return fwrite(buffer, size, 1, mStream);
+    return fwrite(buffer, 1, size, mStream);
 }
 
 inline FILE *FileArchive::getStream() const {
@@ -0,0 +1,149 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "core/filewatcher.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace segfault::core {
+
+    namespace {
+
+        bool getModificationTime(const char *file, int64_t &modified) {
+            struct stat s{};
+            if (::stat(file, &s) != 0) {
+                return false;
+            }
+            modified = static_cast<int64_t>(s.st_mtime);
+
+            return true;
+        }
+
+        // Splits a path into its directory and name, the key of a watched file
+        void splitPath(const std::string &file, std::string &directory, std::string &name) {
+            const size_t pos = file.find_last_of("/\\");
+            if (pos == std::string::npos) {
+                directory = ".";
+                name = file;
+            } else {
+                directory = pos == 0 ? "/" : file.substr(0, pos);
+                name = file.substr(pos + 1);
+            }
+        }
+
+        std::string makeKey(const std::string &directory, const std::string &name) {
+            return directory + "/" + name;
+        }
+
+    } // namespace
+
+    FileWatcher::FileWatcher() {
+#ifdef __linux__
+        mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mNotify < 0) {
+            logMessage(LogType::Warn, "Cannot create an inotify instance, file changes are polled.");
+        }
+#endif
+    }
+
+    FileWatcher::~FileWatcher() {
+#ifdef __linux__
+        if (mNotify >= 0) {
+            close(mNotify);
+        }
+#endif
+    }
+
+    bool FileWatcher::addFile(const char *file) {
+        WatchedFile watched;
+        if (file == nullptr || !getModificationTime(file, watched.modified)) {
+            return false;
+        }
+
+        watched.file = file;
+        std::string directory, name;
+        splitPath(watched.file, directory, name);
+#ifdef __linux__
+        // Editors often save by renaming a new file over the old one, so the directory is watched
+        if (mNotify >= 0) {
+            const int watch = inotify_add_watch(mNotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watch < 0) {
+                return false;
+            }
+            mDirectories[watch] = directory;
+        }
+#endif
+        mFiles[makeKey(directory, name)] = std::move(watched);
+
+        return true;
+    }
+
+    size_t FileWatcher::poll(std::vector<std::string> &changed) {
+        const size_t count = changed.size();
+#ifdef __linux__
+        if (mNotify >= 0) {
+            alignas(inotify_event) char buffer[4096];
+            for (;;) {
+                const ssize_t size = read(mNotify, buffer, sizeof(buffer));
+                if (size <= 0) {
+                    break;
+                }
+
+                for (ssize_t offset = 0; offset < size; ) {
+                    const inotify_event *event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                    const auto directory = mDirectories.find(event->wd);
+                    if (event->len == 0 || directory == mDirectories.end()) {
+                        continue;
+                    }
+
+                    const auto file = mFiles.find(makeKey(directory->second, event->name));
+                    if (file != mFiles.end() && std::find(changed.begin() + count, changed.end(), file->second.file) == changed.end()) {
+                        changed.push_back(file->second.file);
+                    }
+                }
+            }
+
+            return changed.size() - count;
+        }
+#endif
+        for (auto &it : mFiles) {
+            WatchedFile &watched = it.second;
+            int64_t modified = 0;
+            if (getModificationTime(watched.file.c_str(), modified) && modified != watched.modified) {
+                watched.modified = modified;
+                changed.push_back(watched.file);
+            }
+        }
+
+        return changed.size() - count;
+    }
+
+} // namespace segfault::core
@@ -0,0 +1,76 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::core {
+
+    //---------------------------------------------------------------------------------------------
+    /// @class FileWatcher
+    /// @brief Reports changes of a set of files without blocking.
+    ///
+    /// On Linux the directories of the files are watched with inotify, so editors which save by 
+    /// writing a new file and renaming it are covered. Other platforms compare the modification 
+    /// times on each poll, which is fine for the few files watched in development builds.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT FileWatcher final {
+    public:
+        /// @brief The class constructor.
+        FileWatcher();
+
+        /// @brief The class destructor, stops watching.
+        ~FileWatcher();
+
+        /// @brief Starts watching a file.
+        /// @param[ in ] file The file, it must exist.
+        /// @return True if the file is watched.
+        bool addFile(const char *file);
+
+        /// @brief Collects the watched files changed since the last poll, never blocks.
+        /// @param[ out ] changed Receives the changed files as passed to addFile, each once.
+        /// @return The number of changed files.
+        size_t poll(std::vector<std::string> &changed);
+
+        /// @brief Returns the number of watched files.
+        size_t getNumFiles() const { return mFiles.size(); }
+
+        FileWatcher(const FileWatcher &) = delete;
+        FileWatcher &operator = (const FileWatcher &) = delete;
+
+    private:
+        struct WatchedFile {
+            std::string file;       ///< The file as passed to addFile.
+            int64_t modified{ 0 };  ///< The last modification time, used when polling.
+        };
+
+        std::unordered_map<std::string, WatchedFile> mFiles;    ///< The files by directory and name.
+        std::unordered_map<int, std::string> mDirectories;      ///< The watched directories by inotify watch.
+        int mNotify{ -1 };                                      ///< The inotify instance, -1 when polling.
+    };
+
+} // namespace segfault::core
@@ -22,10 +22,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include "core/genericfilemanager.h"
 #include "core/filearchive.h"
+#include "core/threadpool.h"
 
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <string>
+
 namespace segfault::core {
 
     FileArchive *GenericFileManager::createFileReader(const char *name) {
@@ -62,7 +65,7 @@ namespace segfault::core {
         if (archive == nullptr) {
             return;
         }
-        fclose(archive->getStream());
+        // The archive closes its stream
         delete archive;
     }
 
@@ -102,4 +105,38 @@ namespace segfault::core {
         return true;
     }
 
+    bool GenericFileManager::readRange(const char *name, size_t offset, size_t size, std::vector<uint8_t> &data) {
+        data.clear();
+        if (name == nullptr) {
+            return false;
+        }
+
+        FileArchive archive(name, "rb", true, false);
+        if (!archive.isValid() || !archive.seek(offset, SEEK_SET)) {
+            return false;
+        }
+        data.resize(size);
+        if (archive.read(data.data(), size) != size) {
+            data.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void GenericFileManager::readAsync(const char *name, size_t offset, size_t size, ReadCallback callback) {
+        if (name == nullptr || mThreadPool == nullptr) {
+            std::vector<uint8_t> data;
+            const bool success = readRange(name, offset, size, data);
+            callback(success, data);
+            return;
+        }
+
+        mThreadPool->enqueue([this, file = std::string(name), offset, size, callback = std::move(callback)]() {
+            std::vector<uint8_t> data;
+            const bool success = readRange(file.c_str(), offset, size, data);
+            callback(success, data);
+        });
+    }
+
 } // namespace segfault::core
@@ -26,12 +26,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace segfault::core {
 
+    class ThreadPool;
+
     /// @class GenericFileManager
     /// @brief A generic file manager implementation.
+    ///
+    /// Asynchronous reads run on the given thread pool, a pool of its own keeps the blocking 
+    /// reads from delaying other work. Without a pool they complete before readAsync returns.
     class SEGFAULT_EXPORT GenericFileManager final : public IFileManager {
     public:
         /// @brief Constructs a new instance of GenericFileManager.
-        GenericFileManager() = default;
+        /// @param threadPool The pool running the asynchronous reads, may be nullptr.
+        explicit GenericFileManager(ThreadPool *threadPool = nullptr) : mThreadPool(threadPool) {}
 
         /// @brief Destroys the GenericFileManager instance.
         ~GenericFileManager() final = default;
@@ -54,12 +60,30 @@ namespace segfault::core {
         /// @param name The name of the file to check.
         /// @return True if the file exists, false otherwise.
         bool exist(const char* name) final;
-        /// @brief Gets statistics for the specified archive.
 
+        /// @brief Gets statistics for the specified archive.
         /// @param name The name of the archive.
         /// @param stat The structure to store the statistics in.
         /// @return True if statistics were successfully retrieved, false otherwise.
         bool getArchiveStat(const char *name, FileStat &stat) final;
+
+        /// @brief Reads a byte range of a file.
+        /// @param name The name of the file.
+        /// @param offset The offset of the range.
+        /// @param size The size of the range in bytes.
+        /// @param data Receives the range.
+        /// @return True if the whole range was read, false otherwise.
+        bool readRange(const char *name, size_t offset, size_t size, std::vector<uint8_t> &data) final;
+
+        /// @brief Reads a byte range of a file on the thread pool.
+        /// @param name The name of the file, it is copied.
+        /// @param offset The offset of the range.
+        /// @param size The size of the range in bytes.
+        /// @param callback Called exactly once with the result.
+        void readAsync(const char *name, size_t offset, size_t size, ReadCallback callback) final;
+
+    private:
+        ThreadPool *mThreadPool{ nullptr };
     };
 
 } // namespace segfault::core
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace segfault::core {
+
+    /// @brief The offset basis of the 64-bit FNV-1a hash.
+    static constexpr uint64_t FnvOffsetBasis = 0xcbf29ce484222325ull;
+
+    /// @brief The prime of the 64-bit FNV-1a hash.
+    static constexpr uint64_t FnvPrime = 0x100000001b3ull;
+
+    /// @brief Computes the 64-bit FNV-1a hash of a memory block.
+    /// @param[ in ] data The data to hash.
+    /// @param[ in ] size The size of the data in bytes.
+    /// @param[ in ] seed The seed, pass a previous hash to continue hashing.
+    /// @return The hash value.
+    inline uint64_t hashBytes(const void *data, size_t size, uint64_t seed = FnvOffsetBasis) {
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= FnvPrime;
+        }
+
+        return hash;
+    }
+
+    /// @brief Computes the 64-bit FNV-1a hash of a zero-terminated string.
+    /// @param[ in ] str The string to hash.
+    /// @param[ in ] seed The seed, pass a previous hash to continue hashing.
+    /// @return The hash value, the seed for a nullptr.
+    inline uint64_t hashString(const char *str, uint64_t seed = FnvOffsetBasis) {
+        uint64_t hash = seed;
+        if (str == nullptr) {
+            return hash;
+        }
+
+        while (*str != '\0') {
+            hash ^= static_cast<uint8_t>(*str++);
+            hash *= FnvPrime;
+        }
+
+        return hash;
+    }
+
+} // namespace segfault::core
@@ -25,6 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "core/segfault.h"
 
 #include <memory.h>
+#include <functional>
+#include <vector>
 
 namespace segfault::core {
 
@@ -43,6 +45,24 @@ namespace segfault::core {
         virtual bool exist(const char* name) = 0;
         virtual bool getArchiveStat(const char *name, FileStat &stat) = 0;
 
+        /// @brief Receives the result of an asynchronous read on the thread that did the read.
+        using ReadCallback = std::function<void(bool success, std::vector<uint8_t> &data)>;
+
+        /// @brief Reads a byte range of a file.
+        /// @param[ in ] name The name of the file.
+        /// @param[ in ] offset The offset of the range.
+        /// @param[ in ] size The size of the range in bytes.
+        /// @param[ out ] data Receives the range.
+        /// @return True if the whole range was read, false otherwise.
+        virtual bool readRange(const char *name, size_t offset, size_t size, std::vector<uint8_t> &data) = 0;
+
+        /// @brief Reads a byte range of a file in the background.
+        /// @param[ in ] name The name of the file, it is copied.
+        /// @param[ in ] offset The offset of the range.
+        /// @param[ in ] size The size of the range in bytes.
+        /// @param[ in ] callback Called exactly once with the result.
+        virtual void readAsync(const char *name, size_t offset, size_t size, ReadCallback callback) = 0;
+
     protected:
         IFileManager() = default;
     };
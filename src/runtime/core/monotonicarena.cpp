@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "core/monotonicarena.h"
+
+#include <cassert>
+#include <cstdlib>
+
+namespace segfault::core {
+
+    static constexpr size_t BlockHeaderSize = (sizeof(void*) * 2 + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    MonotonicArena::MonotonicArena(size_t blockSize) : mBlockSize(blockSize > BlockHeaderSize ? blockSize : 4096) {
+        // empty
+    }
+
+    MonotonicArena::~MonotonicArena() {
+        release();
+    }
+
+    void *MonotonicArena::allocate(size_t size, size_t alignment) {
+        assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+        uintptr_t current = reinterpret_cast<uintptr_t>(mCurrent);
+        uintptr_t aligned = (current + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        if (mCurrent == nullptr || aligned + size > reinterpret_cast<uintptr_t>(mEnd)) {
+            addBlock(size + alignment);
+            current = reinterpret_cast<uintptr_t>(mCurrent);
+            aligned = (current + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        }
+
+        mBytesUsed += (aligned - current) + size;
+        mCurrent = reinterpret_cast<uint8_t*>(aligned + size);
+
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void MonotonicArena::reserve(size_t size) {
+        if (mCurrent == nullptr || static_cast<size_t>(mEnd - mCurrent) < size) {
+            addBlock(size);
+        }
+    }
+
+    void MonotonicArena::reset() {
+        if (mHead == nullptr) {
+            return;
+        }
+
+        // The newest block is the largest one, keep it
+        Block *block = mHead->next;
+        while (block != nullptr) {
+            Block *next = block->next;
+            mBytesReserved -= block->size;
+            free(block);
+            block = next;
+        }
+        mHead->next = nullptr;
+        mNumBlocks = 1;
+        mCurrent = reinterpret_cast<uint8_t*>(mHead) + BlockHeaderSize;
+        mBytesUsed = 0;
+    }
+
+    void MonotonicArena::release() {
+        Block *block = mHead;
+        while (block != nullptr) {
+            Block *next = block->next;
+            free(block);
+            block = next;
+        }
+        mHead = nullptr;
+        mCurrent = mEnd = nullptr;
+        mBytesUsed = mBytesReserved = 0;
+        mNumBlocks = 0;
+    }
+
+    void MonotonicArena::addBlock(size_t minSize) {
+        size_t size = mBlockSize;
+        if (mHead != nullptr) {
+            size = mHead->size * 2;
+        }
+        if (size < minSize + BlockHeaderSize) {
+            size = minSize + BlockHeaderSize;
+        }
+
+        Block *block = static_cast<Block*>(malloc(size));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        block->next = mHead;
+        block->size = size;
+        mHead = block;
+        mCurrent = reinterpret_cast<uint8_t*>(block) + BlockHeaderSize;
+        mEnd = reinterpret_cast<uint8_t*>(block) + size;
+        mBytesReserved += size;
+        ++mNumBlocks;
+    }
+
+} // namespace segfault::core
@@ -0,0 +1,158 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace segfault::core {
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A monotonic bump allocator.
+    ///
+    /// Memory is taken from blocks in increasing addresses and is only given back all at once by 
+    /// reset or release, so allocating is a pointer bump and freeing is a no-op. Objects created in 
+    /// the arena are not destroyed by it, owners must call non-trivial destructors themselves.
+    /// Blocks grow geometrically when a request does not fit into the current one.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT MonotonicArena final {
+    public:
+        /// @brief The class constructor.
+        /// @param[ in ] blockSize The size of the first block in bytes, allocated on first use.
+        explicit MonotonicArena(size_t blockSize = 4096);
+
+        /// @brief The class destructor, releases all blocks.
+        ~MonotonicArena();
+
+        /// @brief Allocates uninitialized memory.
+        /// @param[ in ] size The size in bytes.
+        /// @param[ in ] alignment The alignment, must be a power of two.
+        /// @return The memory, never nullptr.
+        void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /// @brief Allocates an uninitialized array.
+        /// @param[ in ] count The number of elements.
+        /// @return The array.
+        template<class T>
+        T *allocateArray(size_t count) {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        /// @brief Constructs an object in the arena.
+        /// @param[ in ] args The constructor arguments.
+        /// @return The new object.
+        template<class T, class... Args>
+        T *create(Args&&... args) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        /// @brief Makes sure that the current block has room for the given number of bytes.
+        /// @param[ in ] size The size in bytes.
+        void reserve(size_t size);
+
+        /// @brief Rewinds the arena, keeps the current block for reuse and frees all others.
+        void reset();
+
+        /// @brief Frees all blocks.
+        void release();
+
+        /// @brief Returns the number of allocated bytes including the alignment padding.
+        size_t getBytesUsed() const { return mBytesUsed; }
+
+        /// @brief Returns the number of bytes taken from the system.
+        size_t getBytesReserved() const { return mBytesReserved; }
+
+        /// @brief Returns the number of blocks.
+        size_t getNumBlocks() const { return mNumBlocks; }
+
+        MonotonicArena(const MonotonicArena &) = delete;
+        MonotonicArena &operator = (const MonotonicArena &) = delete;
+
+    private:
+        void addBlock(size_t minSize);
+
+    private:
+        struct Block {
+            Block *next;
+            size_t size;
+        };
+        Block *mHead{ nullptr };
+        uint8_t *mCurrent{ nullptr };
+        uint8_t *mEnd{ nullptr };
+        size_t mBlockSize{ 0 };
+        size_t mBytesUsed{ 0 };
+        size_t mBytesReserved{ 0 };
+        size_t mNumBlocks{ 0 };
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A standard allocator drawing from a MonotonicArena, for temporary containers.
+    //-------------------------------------------------------------------------------------------------
+    template<class T>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+
+        explicit ArenaAllocator(MonotonicArena &arena) : mArena(&arena) {
+            // empty
+        }
+
+        template<class U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : mArena(other.getArena()) {
+            // empty
+        }
+
+        T *allocate(size_t count) {
+            return mArena->allocateArray<T>(count);
+        }
+
+        void deallocate(T *, size_t) {
+            // Monotonic, memory is freed with the arena
+        }
+
+        MonotonicArena *getArena() const {
+            return mArena;
+        }
+
+    private:
+        MonotonicArena *mArena;
+    };
+
+    template<class T, class U>
+    inline bool operator == (const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+        return lhs.getArena() == rhs.getArena();
+    }
+
+    template<class T, class U>
+    inline bool operator != (const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+        return !(lhs == rhs);
+    }
+
+} // namespace segfault::core
@@ -0,0 +1,119 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "core/rangeallocator.h"
+
+namespace segfault::core {
+
+    RangeAllocator::RangeAllocator(uint32_t capacity) {
+        reset(capacity);
+    }
+
+    void RangeAllocator::reset(uint32_t capacity) {
+        mCapacity = capacity;
+        mUsed = 0;
+        mFreeByOffset.clear();
+        mFreeBySize.clear();
+        mAllocations.clear();
+        if (capacity != 0) {
+            addFreeRange(0, capacity);
+        }
+    }
+
+    uint32_t RangeAllocator::allocate(uint32_t size) {
+        if (size == 0) {
+            return InvalidOffset;
+        }
+
+        auto best = mFreeBySize.lower_bound(size);
+        if (best == mFreeBySize.end()) {
+            return InvalidOffset;
+        }
+
+        const uint32_t rangeSize = best->first;
+        const uint32_t offset = best->second;
+        removeFreeRange(mFreeByOffset.find(offset));
+        if (rangeSize > size) {
+            addFreeRange(offset + size, rangeSize - size);
+        }
+        mAllocations[offset] = size;
+        mUsed += size;
+
+        return offset;
+    }
+
+    bool RangeAllocator::free(uint32_t offset) {
+        auto allocation = mAllocations.find(offset);
+        if (allocation == mAllocations.end()) {
+            return false;
+        }
+
+        uint32_t begin = offset;
+        uint32_t end = offset + allocation->second;
+        mUsed -= allocation->second;
+        mAllocations.erase(allocation);
+
+        // Merge with the free neighbours
+        auto next = mFreeByOffset.lower_bound(begin);
+        if (next != mFreeByOffset.end() && next->first == end) {
+            end += next->second;
+            next = std::next(next);
+            removeFreeRange(std::prev(next));
+        }
+        if (next != mFreeByOffset.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == begin) {
+                begin = prev->first;
+                removeFreeRange(prev);
+            }
+        }
+        addFreeRange(begin, end - begin);
+
+        return true;
+    }
+
+    uint32_t RangeAllocator::getSize(uint32_t offset) const {
+        auto allocation = mAllocations.find(offset);
+        return allocation != mAllocations.end() ? allocation->second : 0;
+    }
+
+    uint32_t RangeAllocator::getLargestFreeRange() const {
+        return mFreeBySize.empty() ? 0 : mFreeBySize.rbegin()->first;
+    }
+
+    void RangeAllocator::addFreeRange(uint32_t offset, uint32_t size) {
+        mFreeByOffset.emplace(offset, size);
+        mFreeBySize.emplace(size, offset);
+    }
+
+    void RangeAllocator::removeFreeRange(std::map<uint32_t, uint32_t>::iterator range) {
+        auto bySize = mFreeBySize.equal_range(range->second);
+        for (auto it = bySize.first; it != bySize.second; ++it) {
+            if (it->second == range->first) {
+                mFreeBySize.erase(it);
+                break;
+            }
+        }
+        mFreeByOffset.erase(range);
+    }
+
+} // namespace segfault::core
@@ -0,0 +1,98 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <iterator>
+#include <map>
+#include <unordered_map>
+
+namespace segfault::core {
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	Sub-allocates ranges of an externally owned resource, like a GPU buffer.
+    ///
+    /// The allocator only does the bookkeeping in abstract units, the caller decides what a unit 
+    /// is (bytes, vertices, indices). Free ranges are found by best fit and merged with their 
+    /// neighbours when a range is given back, so the fragmentation stays low for meshes streaming 
+    /// in and out.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT RangeAllocator final {
+    public:
+        /// @brief Marks a failed allocation.
+        static constexpr uint32_t InvalidOffset = 0xffffffffu;
+
+        /// @brief The class constructor.
+        /// @param[ in ] capacity The number of units to manage.
+        explicit RangeAllocator(uint32_t capacity = 0);
+
+        /// @brief The class destructor.
+        ~RangeAllocator() = default;
+
+        /// @brief Frees all ranges and sets a new capacity.
+        /// @param[ in ] capacity The number of units to manage.
+        void reset(uint32_t capacity);
+
+        /// @brief Allocates a range.
+        /// @param[ in ] size The number of units, must not be zero.
+        /// @return The offset of the range or InvalidOffset if no free range is large enough.
+        uint32_t allocate(uint32_t size);
+
+        /// @brief Gives a range back.
+        /// @param[ in ] offset The offset returned by allocate.
+        /// @return False if the offset does not start an allocated range.
+        bool free(uint32_t offset);
+
+        /// @brief Returns the size of an allocated range.
+        /// @param[ in ] offset The offset returned by allocate.
+        /// @return The number of units, 0 if the offset does not start an allocated range.
+        uint32_t getSize(uint32_t offset) const;
+
+        /// @brief Returns the number of managed units.
+        uint32_t getCapacity() const { return mCapacity; }
+
+        /// @brief Returns the number of allocated units.
+        uint32_t getUsed() const { return mUsed; }
+
+        /// @brief Returns the size of the largest free range.
+        uint32_t getLargestFreeRange() const;
+
+        /// @brief Returns the number of free ranges, 1 means no fragmentation.
+        size_t getNumFreeRanges() const { return mFreeByOffset.size(); }
+
+    private:
+        void addFreeRange(uint32_t offset, uint32_t size);
+        void removeFreeRange(std::map<uint32_t, uint32_t>::iterator range);
+
+    private:
+        uint32_t mCapacity{ 0 };
+        uint32_t mUsed{ 0 };
+        std::map<uint32_t, uint32_t> mFreeByOffset;
+        std::multimap<uint32_t, uint32_t> mFreeBySize;
+        std::unordered_map<uint32_t, uint32_t> mAllocations;
+    };
+
+} // namespace segfault::core
@@ -0,0 +1,73 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+// SSE2 is part of every x86-64 target, other targets use the scalar code paths
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SEGFAULT_SIMD_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace segfault::core {
+
+    /// @brief The number of float lanes processed per SIMD batch.
+    static constexpr size_t SimdWidth = 4;
+
+    /// @brief Rounds a count up to a multiple of the SIMD width.
+    /// @param[ in ] count The count.
+    /// @return The padded count.
+    inline size_t alignToSimdWidth(size_t count) {
+        return (count + SimdWidth - 1) & ~(SimdWidth - 1);
+    }
+
+    /// @brief Multiplies two column-major 4x4 matrices, result = a * b.
+    /// @param[ in ] a The left matrix.
+    /// @param[ in ] b The right matrix.
+    /// @param[ out ] result The product, may alias a or b.
+    inline void multiplyMatrix4(const float *a, const float *b, float *result) {
+#ifdef SEGFAULT_SIMD_SSE2
+        const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+        for (size_t col = 0; col < 4; ++col) {
+            const __m128 b0 = _mm_set1_ps(b[col * 4]), b1 = _mm_set1_ps(b[col * 4 + 1]);
+            const __m128 b2 = _mm_set1_ps(b[col * 4 + 2]), b3 = _mm_set1_ps(b[col * 4 + 3]);
+            const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, b0), _mm_mul_ps(a1, b1)),
+                    _mm_add_ps(_mm_mul_ps(a2, b2), _mm_mul_ps(a3, b3)));
+            _mm_storeu_ps(result + col * 4, sum);
+        }
+#else
+        float product[16];
+        for (size_t col = 0; col < 4; ++col) {
+            for (size_t row = 0; row < 4; ++row) {
+                product[col * 4 + row] = a[row] * b[col * 4] + a[4 + row] * b[col * 4 + 1] +
+                        a[8 + row] * b[col * 4 + 2] + a[12 + row] * b[col * 4 + 3];
+            }
+        }
+        for (size_t i = 0; i < 16; ++i) {
+            result[i] = product[i];
+        }
+#endif
+    }
+
+} // namespace segfault::core
@@ -0,0 +1,268 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "core/spatialhash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace segfault::core {
+
+    namespace {
+        constexpr uint32_t MinNumBuckets = 64;
+        constexpr int64_t CellBias = 1 << 20;
+        constexpr int64_t CellRange = (1 << 21) - 1;
+
+        // When a query covers more cells than this, scanning all entries is cheaper.
+        constexpr uint64_t MaxCellsPerQuery = 4096;
+
+        inline int64_t toCell(float v, float invCellSize) {
+            // Clamp before the conversion, huge, infinite or NaN coordinates do not fit an integer.
+            const float c = std::floor(v * invCellSize);
+            if (!(c > static_cast<float>(-CellBias))) {
+                return 0;
+            }
+            if (c >= static_cast<float>(CellRange - CellBias)) {
+                return CellRange;
+            }
+            return static_cast<int64_t>(c) + CellBias;
+        }
+
+        inline uint64_t cellExtent(int64_t first, int64_t last) {
+            return last < first ? 0 : static_cast<uint64_t>(last - first) + 1;
+        }
+
+        inline uint64_t packCell(int64_t x, int64_t y, int64_t z) {
+            return static_cast<uint64_t>(x) | (static_cast<uint64_t>(y) << 21) | (static_cast<uint64_t>(z) << 42);
+        }
+
+        inline uint32_t hashCell(uint64_t key, uint32_t mask) {
+            key *= 0x9E3779B97F4A7C15ull;
+            return static_cast<uint32_t>(key >> 32) & mask;
+        }
+
+        inline uint32_t nextPowerOfTwo(size_t value) {
+            uint32_t result = MinNumBuckets;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+    } // Anonymous namespace
+
+    SpatialHash::ReadGuard::ReadGuard(const SpatialHash &hash) : mBuffer(nullptr) {
+        // Register as a reader, then make sure the buffer was not retired in between. The writer 
+        // only overwrites a retired buffer once its reader count dropped to zero.
+        for (;;) {
+            Buffer *buffer = hash.mFront.load();
+            buffer->numReaders.fetch_add(1);
+            if (hash.mFront.load() == buffer) {
+                mBuffer = buffer;
+                return;
+            }
+            buffer->numReaders.fetch_sub(1);
+        }
+    }
+
+    SpatialHash::ReadGuard::~ReadGuard() {
+        mBuffer->numReaders.fetch_sub(1);
+    }
+
+    SpatialHash::SpatialHash(float cellSize) :
+            mCellSize(cellSize > 0.0f ? cellSize : 1.0f),
+            mInvCellSize(1.0f / mCellSize),
+            mBuffers(),
+            mFront(&mBuffers[0]) {
+        if (cellSize <= 0.0f) {
+            logMessage(LogType::Warn, "Invalid cell size for spatial hash, using 1.");
+        }
+    }
+
+    void SpatialHash::rebuild(const uint32_t *ids, const glm::vec3 *positions, size_t count) {
+        if (count > 0 && (ids == nullptr || positions == nullptr)) {
+            logMessage(LogType::Error, "Invalid entity arrays for spatial hash.");
+            return;
+        }
+        if (count >= std::numeric_limits<uint32_t>::max()) {
+            logMessage(LogType::Error, "Too many entities for spatial hash.");
+            return;
+        }
+
+        Buffer *back = (mFront.load() == &mBuffers[0]) ? &mBuffers[1] : &mBuffers[0];
+        while (back->numReaders.load() != 0) {
+            std::this_thread::yield();
+        }
+
+        const uint32_t numBuckets = nextPowerOfTwo(count);
+        back->bucketMask = numBuckets - 1;
+        back->bucketStart.assign(numBuckets + 1, 0);
+        back->scratchBuckets.resize(count);
+        back->cellKeys.resize(count);
+        back->ids.resize(count);
+        back->x.resize(count);
+        back->y.resize(count);
+        back->z.resize(count);
+
+        // Counting sort by bucket: histogram, prefix sum, scatter
+        std::vector<uint32_t> &start = back->bucketStart;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 &p = positions[i];
+            const uint64_t key = packCell(toCell(p.x, mInvCellSize), toCell(p.y, mInvCellSize), toCell(p.z, mInvCellSize));
+            const uint32_t bucket = hashCell(key, back->bucketMask);
+            back->scratchBuckets[i] = bucket;
+            ++start[bucket + 1];
+        }
+        for (uint32_t i = 0; i < numBuckets; ++i) {
+            start[i + 1] += start[i];
+        }
+
+        back->cursor.assign(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 &p = positions[i];
+            const uint32_t dst = back->cursor[back->scratchBuckets[i]]++;
+            back->cellKeys[dst] = packCell(toCell(p.x, mInvCellSize), toCell(p.y, mInvCellSize), toCell(p.z, mInvCellSize));
+            back->ids[dst] = ids[i];
+            back->x[dst] = p.x;
+            back->y[dst] = p.y;
+            back->z[dst] = p.z;
+        }
+
+        mFront.store(back);
+    }
+
+    template<class TVisitor>
+    bool SpatialHash::visitCells(const Buffer &buffer, const glm::vec3 &boxMin, const glm::vec3 &boxMax, TVisitor &visitor) const {
+        if (buffer.ids.empty()) {
+            return true;
+        }
+
+        const int64_t x0 = toCell(boxMin.x, mInvCellSize), x1 = toCell(boxMax.x, mInvCellSize);
+        const int64_t y0 = toCell(boxMin.y, mInvCellSize), y1 = toCell(boxMax.y, mInvCellSize);
+        const int64_t z0 = toCell(boxMin.z, mInvCellSize), z1 = toCell(boxMax.z, mInvCellSize);
+        // Each extent is checked before multiplying, a query spanning the whole cell range would 
+        // overflow the product.
+        const uint64_t limit = std::min<uint64_t>(MaxCellsPerQuery, buffer.ids.size());
+        const uint64_t numX = cellExtent(x0, x1), numY = cellExtent(y0, y1), numZ = cellExtent(z0, z1);
+        const bool scanAll = numX > limit || numY > limit || numZ > limit || 
+                numX * numY > limit || numX * numY * numZ > limit;
+        if (scanAll) {
+            for (size_t i = 0; i < buffer.ids.size(); ++i) {
+                if (!visitor(i)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        for (int64_t z = z0; z <= z1; ++z) {
+            for (int64_t y = y0; y <= y1; ++y) {
+                for (int64_t x = x0; x <= x1; ++x) {
+                    // Buckets are shared by several cells, the key check drops the others and 
+                    // avoids visiting an entry twice.
+                    const uint64_t key = packCell(x, y, z);
+                    const uint32_t bucket = hashCell(key, buffer.bucketMask);
+                    const uint32_t end = buffer.bucketStart[bucket + 1];
+                    for (uint32_t i = buffer.bucketStart[bucket]; i < end; ++i) {
+                        if (buffer.cellKeys[i] == key && !visitor(i)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    size_t SpatialHash::queryRadius(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const {
+        ReadGuard guard(*this);
+        const Buffer &buffer = guard.get();
+        const float radiusSq = radius * radius;
+        const size_t first = result.size();
+        auto visitor = [&](size_t i) {
+            const float dx = buffer.x[i] - center.x, dy = buffer.y[i] - center.y, dz = buffer.z[i] - center.z;
+            if (dx * dx + dy * dy + dz * dz <= radiusSq) {
+                result.push_back(buffer.ids[i]);
+            }
+            return true;
+        };
+        visitCells(buffer, center - glm::vec3(radius), center + glm::vec3(radius), visitor);
+
+        return result.size() - first;
+    }
+
+    size_t SpatialHash::queryBox(const glm::vec3 &boxMin, const glm::vec3 &boxMax, std::vector<uint32_t> &result) const {
+        ReadGuard guard(*this);
+        const Buffer &buffer = guard.get();
+        const size_t first = result.size();
+        auto visitor = [&](size_t i) {
+            if (buffer.x[i] >= boxMin.x && buffer.x[i] <= boxMax.x &&
+                    buffer.y[i] >= boxMin.y && buffer.y[i] <= boxMax.y &&
+                    buffer.z[i] >= boxMin.z && buffer.z[i] <= boxMax.z) {
+                result.push_back(buffer.ids[i]);
+            }
+            return true;
+        };
+        visitCells(buffer, boxMin, boxMax, visitor);
+
+        return result.size() - first;
+    }
+
+    bool SpatialHash::anyInRadius(const glm::vec3 &center, float radius, uint32_t ignoreId) const {
+        ReadGuard guard(*this);
+        const Buffer &buffer = guard.get();
+        const float radiusSq = radius * radius;
+        auto visitor = [&](size_t i) {
+            const float dx = buffer.x[i] - center.x, dy = buffer.y[i] - center.y, dz = buffer.z[i] - center.z;
+            return buffer.ids[i] == ignoreId || dx * dx + dy * dy + dz * dz > radiusSq;
+        };
+
+        return !visitCells(buffer, center - glm::vec3(radius), center + glm::vec3(radius), visitor);
+    }
+
+    bool SpatialHash::findNearest(const glm::vec3 &center, float radius, uint32_t ignoreId, uint32_t &id) const {
+        ReadGuard guard(*this);
+        const Buffer &buffer = guard.get();
+        float bestSq = radius * radius;
+        bool found = false;
+        auto visitor = [&](size_t i) {
+            const float dx = buffer.x[i] - center.x, dy = buffer.y[i] - center.y, dz = buffer.z[i] - center.z;
+            const float distSq = dx * dx + dy * dy + dz * dz;
+            if (buffer.ids[i] != ignoreId && distSq <= bestSq) {
+                bestSq = distSq;
+                id = buffer.ids[i];
+                found = true;
+            }
+            return true;
+        };
+        visitCells(buffer, center - glm::vec3(radius), center + glm::vec3(radius), visitor);
+
+        return found;
+    }
+
+    size_t SpatialHash::getNumEntities() const {
+        ReadGuard guard(*this);
+        return guard.get().ids.size();
+    }
+
+} // namespace segfault::core
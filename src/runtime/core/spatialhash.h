@@ -0,0 +1,132 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+namespace segfault::core {
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A spatial hash grid for proximity queries over many moving entities.
+    ///
+    /// The grid is rebuilt in bulk once per frame from the entity positions by a counting sort 
+    /// into hashed cells, so all entities of a cell are contiguous in structure-of-arrays form. 
+    /// It is double-buffered: rebuild fills the back buffer and publishes it atomically, queries 
+    /// read the published buffer without locks and may run on any number of threads while the 
+    /// next frame is built. Only one thread may call rebuild at a time.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT SpatialHash final {
+    public:
+        /// @brief The class constructor.
+        /// @param[ in ] cellSize The edge length of a cell, about the typical query radius.
+        explicit SpatialHash(float cellSize);
+
+        /// @brief The class destructor.
+        ~SpatialHash() = default;
+
+        /// @brief Replaces all entities and publishes the new state to the readers.
+        /// @param[ in ] ids The entity ids.
+        /// @param[ in ] positions The entity positions.
+        /// @param[ in ] count The number of entities.
+        void rebuild(const uint32_t *ids, const glm::vec3 *positions, size_t count);
+
+        /// @brief Collects the entities within a radius.
+        /// @param[ in ] center The center of the sphere.
+        /// @param[ in ] radius The radius.
+        /// @param[ out ] result The ids of the entities are appended to it.
+        /// @return The number of entities found.
+        size_t queryRadius(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const;
+
+        /// @brief Collects the entities within an axis-aligned box.
+        /// @param[ in ] boxMin The minimum corner of the box.
+        /// @param[ in ] boxMax The maximum corner of the box.
+        /// @param[ out ] result The ids of the entities are appended to it.
+        /// @return The number of entities found.
+        size_t queryBox(const glm::vec3 &boxMin, const glm::vec3 &boxMax, std::vector<uint32_t> &result) const;
+
+        /// @brief Checks if any entity is within a radius, stops at the first hit.
+        /// @param[ in ] center The center of the sphere.
+        /// @param[ in ] radius The radius.
+        /// @param[ in ] ignoreId An entity to ignore, usually the one asking.
+        /// @return True if an entity was found.
+        bool anyInRadius(const glm::vec3 &center, float radius, uint32_t ignoreId) const;
+
+        /// @brief Returns the entity closest to a position within a radius.
+        /// @param[ in ] center The position.
+        /// @param[ in ] radius The search radius.
+        /// @param[ in ] ignoreId An entity to ignore, usually the one asking.
+        /// @param[ out ] id The id of the closest entity.
+        /// @return True if an entity was found.
+        bool findNearest(const glm::vec3 &center, float radius, uint32_t ignoreId, uint32_t &id) const;
+
+        /// @brief Returns the number of entities in the published state.
+        size_t getNumEntities() const;
+
+        /// @brief Returns the edge length of a cell.
+        float getCellSize() const { return mCellSize; }
+
+        SpatialHash(const SpatialHash &) = delete;
+        SpatialHash &operator = (const SpatialHash &) = delete;
+
+    private:
+        struct Buffer {
+            std::vector<uint32_t> bucketStart;
+            std::vector<uint64_t> cellKeys;
+            std::vector<uint32_t> ids;
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+            std::vector<uint32_t> scratchBuckets;
+            std::vector<uint32_t> cursor;
+            uint32_t bucketMask{ 0 };
+            std::atomic<uint32_t> numReaders{ 0 };
+        };
+
+        class ReadGuard {
+        public:
+            explicit ReadGuard(const SpatialHash &hash);
+            ~ReadGuard();
+            const Buffer &get() const { return *mBuffer; }
+
+        private:
+            Buffer *mBuffer;
+        };
+
+        template<class TVisitor>
+        bool visitCells(const Buffer &buffer, const glm::vec3 &boxMin, const glm::vec3 &boxMax, TVisitor &visitor) const;
+
+    private:
+        float mCellSize;
+        float mInvCellSize;
+        Buffer mBuffers[2];
+        std::atomic<Buffer*> mFront;
+    };
+
+} // namespace segfault::core
@@ -0,0 +1,153 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "core/threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace segfault::core {
+
+    namespace {
+        struct ParallelForState {
+            ParallelForState(size_t count, size_t chunkSize, const ThreadPool::RangeFunc &func) :
+                    count(count), chunkSize(chunkSize), numChunks((count + chunkSize - 1) / chunkSize), func(func) {
+                // empty
+            }
+
+            // Pulls chunks until none are left, returns when the range is exhausted
+            void run() {
+                size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+                for (; chunk < numChunks; chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+                    const size_t begin = chunk * chunkSize;
+                    func(begin, std::min(begin + chunkSize, count));
+                    if (numDone.fetch_add(1, std::memory_order_acq_rel) + 1 == numChunks) {
+                        std::lock_guard<std::mutex> guard(lock);
+                        done.notify_all();
+                    }
+                }
+            }
+
+            const size_t count;
+            const size_t chunkSize;
+            const size_t numChunks;
+            const ThreadPool::RangeFunc &func;
+            std::atomic<size_t> nextChunk{ 0 };
+            std::atomic<size_t> numDone{ 0 };
+            std::mutex lock;
+            std::condition_variable done;
+        };
+    }
+
+    ThreadPool::ThreadPool(size_t numThreads) {
+        if (numThreads == 0) {
+            const size_t numCores = std::thread::hardware_concurrency();
+            numThreads = numCores > 1 ? numCores - 1 : 1;
+        }
+
+        mWorkers.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(mLock);
+            mStop = true;
+        }
+        mWakeup.notify_all();
+        for (auto &worker : mWorkers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::enqueue(Task task) {
+        {
+            std::lock_guard<std::mutex> guard(mLock);
+            mQueue.push_back(std::move(task));
+        }
+        mWakeup.notify_one();
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t grainSize, const RangeFunc &func) {
+        if (count == 0) {
+            return;
+        }
+
+        // Aim for a few chunks per thread to balance uneven work
+        const size_t numThreads = mWorkers.size() + 1;
+        const size_t chunkSize = std::max(std::max<size_t>(grainSize, 1), count / (numThreads * 4));
+        if (chunkSize >= count) {
+            func(0, count);
+            return;
+        }
+
+        auto state = std::make_shared<ParallelForState>(count, chunkSize, func);
+        const size_t numHelpers = std::min(mWorkers.size(), state->numChunks - 1);
+        for (size_t i = 0; i < numHelpers; ++i) {
+            enqueue([state]() { state->run(); });
+        }
+        state->run();
+
+        // Helpers which start after the range is exhausted return at once, so the body reference 
+        // is never touched after this function returns
+        std::unique_lock<std::mutex> guard(state->lock);
+        state->done.wait(guard, [&state]() { 
+            return state->numDone.load(std::memory_order_acquire) == state->numChunks; 
+        });
+    }
+
+    void ThreadPool::waitIdle() {
+        std::unique_lock<std::mutex> guard(mLock);
+        mIdle.wait(guard, [this]() { return mQueue.empty() && mNumActive == 0; });
+    }
+
+    void ThreadPool::workerLoop() {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> guard(mLock);
+                mWakeup.wait(guard, [this]() { return mStop || !mQueue.empty(); });
+                if (mQueue.empty()) {
+                    return;
+                }
+
+                task = std::move(mQueue.front());
+                mQueue.pop_front();
+                ++mNumActive;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> guard(mLock);
+                --mNumActive;
+                if (mQueue.empty() && mNumActive == 0) {
+                    mIdle.notify_all();
+                }
+            }
+        }
+    }
+
+} // namespace segfault::core
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace segfault::core {
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A fixed set of worker threads processing a shared task queue.
+    ///
+    /// Tasks are run in the order they were enqueued. parallelFor splits an index range into 
+    /// chunks which are pulled by the workers and the calling thread alike, so it never deadlocks 
+    /// when called from a worker.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT ThreadPool final {
+    public:
+        /// @brief A task.
+        using Task = std::function<void()>;
+
+        /// @brief The body of a parallel loop, processes the indices [begin, end).
+        using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+        /// @brief The class constructor, starts the workers.
+        /// @param[ in ] numThreads The number of workers, zero uses one less than the number of cores.
+        explicit ThreadPool(size_t numThreads = 0);
+
+        /// @brief The class destructor, finishes all queued tasks and joins the workers.
+        ~ThreadPool();
+
+        /// @brief Enqueues a task.
+        /// @param[ in ] task The task.
+        void enqueue(Task task);
+
+        /// @brief Runs a loop body over an index range in parallel and waits for it to complete.
+        /// @param[ in ] count The number of indices.
+        /// @param[ in ] grainSize The minimum number of indices per chunk.
+        /// @param[ in ] func The loop body.
+        void parallelFor(size_t count, size_t grainSize, const RangeFunc &func);
+
+        /// @brief Blocks until the queue is empty and all workers are idle.
+        void waitIdle();
+
+        /// @brief Returns the number of workers.
+        size_t getNumThreads() const { return mWorkers.size(); }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator = (const ThreadPool &) = delete;
+
+    private:
+        void workerLoop();
+
+    private:
+        std::vector<std::thread> mWorkers;
+        std::deque<Task> mQueue;
+        std::mutex mLock;
+        std::condition_variable mWakeup;
+        std::condition_variable mIdle;
+        size_t mNumActive{ 0 };
+        bool mStop{ false };
+    };
+
+} // namespace segfault::core
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "core/segfault.h"
+#include "renderer/pipelinelibrary.h"
 
 struct SDL_Window;
 
@@ -62,6 +63,16 @@ namespace segfault::renderer {
         /// @brief Resizes the rendering surface.
         void resize();
 
+        /// @brief Requests the pipeline of a shader permutation. It is built in the background, 
+        /// until it is ready the default pipeline is drawn with.
+        /// @param[ in ] desc The shader sources, defines and render state.
+        /// @return The handle, InvalidPipeline on failure.
+        PipelineHandle requestPipeline(const PipelineDesc &desc);
+
+        /// @brief Sets the pipeline the mesh is drawn with.
+        /// @param[ in ] handle The pipeline handle, InvalidPipeline selects the default pipeline.
+        void setMeshPipeline(PipelineHandle handle);
+
     private:
         RHIImpl* mImpl{ nullptr };
     };
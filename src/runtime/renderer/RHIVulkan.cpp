@@ -22,16 +22,28 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include "RHI.h"
 #include "rendercore.h"
+#include "clusterculling.h"
+#include "lodselection.h"
+#include "meshformat.h"
+#include "meshpool.h"
+#include "pipelinelibrary.h"
+#include "renderqueue.h"
+#include "shadermanager.h"
+#include "shaderreflection.h"
+#include "textureformat.h"
+#include "textureloader.h"
+#include "texturestreamer.h"
+#include "vulkanlayoutcache.h"
 #include "vulkanutils.h"
+#include "core/genericfilemanager.h"
 #include "core/segfaultexception.h"
+#include "core/threadpool.h"
 #include "volk.h"
 #include "SDL_vulkan.h"
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include "scene/transformhierarchy.h"
 
 #include <vector>
 #include <iostream>
@@ -42,11 +54,47 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <fstream>
 #include <array>
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
 
 namespace segfault::renderer {
 
     using namespace segfault::core;
 
+    static_assert(sizeof(Vertex) == sizeof(MeshVertex), "The baked mesh vertex must match the pipeline vertex.");
+
+    /// @brief The baked mesh loaded at startup, the quads below are used when it is missing.
+    /// The pipeline vertex input follows the vertex format of the mesh.
+    const char *const DefaultMeshFile = "meshes/default.smesh";
+
+    /// @brief The baked texture streamed at startup, the source image is decoded when it is missing 
+    /// or the GPU cannot sample its format.
+    const char *const DefaultTextureFile = "textures/SegFault.stex";
+    const char *const FallbackTextureFile = "textures/SegFault.jpg";
+
+    /// @brief The shader sources watched for hot reload, they only exist in a development checkout. 
+    /// Recompiled SPIR-V is cached by the hash of the source.
+    const char *const VertexShaderSource = "../assets/shaders/default.vert";
+    const char *const FragmentShaderSource = "../assets/shaders/default.frag";
+    const char *const ShaderCacheDir = "shaders/cache";
+
+    /// @brief The pipeline cache shared by all pipeline builds, it is saved at shutdown.
+    const char *const PipelineCacheFile = "shaders/cache/pipelines.bin";
+
+    /// @brief The default capacities of the mesh pool, the pool grows to fit the default mesh.
+    constexpr uint32_t MeshPoolVertices = 1u << 20;
+    constexpr uint32_t MeshPoolIndices16 = 1u << 21;
+    constexpr uint32_t MeshPoolIndices32 = 1u << 21;
+    constexpr uint32_t MeshPoolMeshlets = 1u << 16;
+
+    /// @brief The cluster culling pre-pass, it is skipped for meshes without meshlets or when the 
+    /// shader is missing.
+    const char *const ClusterCullShaderFile = "shaders/cluster_cull.spv";
+
+    /// @brief The workgroup size of cluster_cull.comp.
+    constexpr uint32_t ClusterCullGroupSize = 64;
+
     const std::vector<Vertex> vertices = {
         {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
         {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
@@ -107,8 +155,10 @@ namespace segfault::renderer {
         VkShaderModule vertShaderModule{};
         VkShaderModule fragShaderModule{};
         VkRenderPass renderPass{};
+        // The layouts are owned by the layout cache and derived from the reflected shaders
+        VulkanLayoutCache layoutCache{};
+        ShaderReflection pipelineReflection{};
         VkDescriptorSetLayout descriptorSetLayout{};
-        VkDescriptorPool descriptorPool{};
         std::vector<VkDescriptorSet> descriptorSets{};
 
         VkPipelineLayout pipelineLayout{};
@@ -119,7 +169,25 @@ namespace segfault::renderer {
         std::vector<VkSemaphore> imageAvailableSemaphores{};
         std::vector<VkSemaphore> renderFinishedSemaphores{};
         std::vector<VkFence> inFlightFences{};
-        VkPipeline graphicsPipeline{};
+        // The default pipeline is built at startup, the permutations are built on the pipeline 
+        // pool and drawn with the default one until they are ready
+        VkPipelineCache pipelineCache{};
+        std::unique_ptr<IPipelineBuilder> pipelineBuilder{};
+        PipelineLibrary pipelineLibrary{};
+        core::ThreadPool pipelinePool{ 2 };
+        PipelineHandle defaultPipeline{ InvalidPipeline };
+        PipelineHandle meshPipeline{ InvalidPipeline };
+        bool fillModeNonSolid{ false };
+        // Reloaded shaders are compiled and the pipelines using them are rebuilt on the shader pool, 
+        // they are swapped in at the next frame and the old ones destroyed when no frame uses them
+        ShaderManager shaderManager{};
+        ShaderHandle vertShader{ InvalidShader };
+        ShaderHandle fragShader{ InvalidShader };
+        core::ThreadPool shaderPool{ 1 };
+        std::mutex reloadLock{};
+        std::vector<std::pair<PipelineHandle, VkPipeline>> reloadedPipelines{};
+        std::vector<std::pair<VkPipeline, uint64_t>> retiredPipelines{};
+        uint64_t frameCount{ 0 };
         bool framebufferResized{false};
         VkBuffer vertexBuffer{};
 
@@ -133,9 +201,51 @@ namespace segfault::renderer {
         VkImageView textureImageView{};
         VkSampler textureSampler{};
         VkDeviceMemory textureImageMemory{};
+        VkFormat textureFormat{ VK_FORMAT_R8G8B8A8_SRGB };
+        uint32_t textureMipLevels{ 1 };
+        bool textureCompressionBC{ false };
+        // Streamed levels are copied in a command buffer submitted ahead of the frame. The replaced 
+        // images and the staging buffers are destroyed when no frame in flight uses them anymore, 
+        // the descriptor set of a frame is pointed to the new view before the frame is recorded.
+        struct RetiredTexture {
+            VkImage image{};
+            VkImageView imageView{};
+            VkDeviceMemory imageMemory{};
+            VkBuffer stagingBuffer{};
+            VkDeviceMemory stagingBufferMemory{};
+            uint64_t frame{ 0 };
+        };
+        std::vector<VkCommandBuffer> uploadCommandBuffers{};
+        bool uploadsRecorded{ false };
+        std::vector<RetiredTexture> retiredTextures{};
+        std::vector<VkImageView> boundTextureViews{};
+        core::GenericFileManager textureFileManager{ &textureIoPool };
+        std::unique_ptr<ITextureStreamUploader> textureUploader{};
+        TextureStreamer textureStreamer{};
+        TextureHandle textureHandle{ InvalidTexture };
+        // The pool is declared after the file manager and the streamer, so it finishes its reads 
+        // while both still exist
+        core::ThreadPool textureIoPool{ 1 };
         VkImage depthImage{};
         VkDeviceMemory depthImageMemory{};
         VkImageView depthImageView{};
+        scene::TransformHierarchy transforms{};
+        scene::TransformHandle modelTransform{ scene::InvalidTransform };
+        RenderQueue renderQueue{};
+        MeshData mesh{};
+        MeshPool meshPool{};
+        MeshHandle meshHandle{ InvalidMesh };
+        uint32_t meshLod{ 0 };
+        LodSettings lodSettings{};
+        bool multiDrawIndirect{ false };
+        VkBuffer meshletBuffer{};
+        VkDeviceMemory meshletBufferMemory{};
+        std::vector<VkBuffer> clusterCommandBuffers{};
+        std::vector<VkDeviceMemory> clusterCommandBuffersMemory{};
+        std::vector<VkDescriptorSet> cullDescriptorSets{};
+        VkPipelineLayout cullPipelineLayout{};
+        VkPipeline cullPipeline{};
+        ClusterCullParams cullParams{};
 
         RHIImpl() = default;
         ~RHIImpl() = default;
@@ -158,10 +268,18 @@ namespace segfault::renderer {
         void createSwapChain();
         void createImageViews();
         void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
         void createRenderPass();
         void createDescriptorSetLayout();
         void createGraphicsPipeline();
+        bool reflectGraphicsPipeline(const std::vector<char> &vertShaderCode, const std::vector<char> &fragShaderCode, ShaderReflection &reflection);
+        VkPipeline buildGraphicsPipeline(const std::vector<char> &vertShaderCode, const std::vector<char> &fragShaderCode, 
+            const ShaderReflection &reflection, const PipelineState &state);
+        void createPipelineCache();
+        void savePipelineCache();
+        PipelineHandle requestPipeline(const PipelineDesc &desc);
+        void reloadShaders();
+        void destroyPipelines();
         void createFramebuffers();
         void createCommandPool(QueueFamilyIndices& indices);
         void createDepthResources();
@@ -173,22 +291,290 @@ namespace segfault::renderer {
         void cleanupSwapChain();
         void recreateSwapChain();
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-        void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+        void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, uint32_t mipLevels = 1);
         void createTextureImage();
-        VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+        bool createStreamedTextureImage();
+        bool isTextureFormatSupported(TextureFormat textureFormat, VkFormat format);
+        void updateTextureDescriptor(uint32_t frame);
+        VkCommandBuffer beginUploadCommands();
+        void retireTexture(const RetiredTexture &texture);
+        void destroyRetiredTextures(bool all);
+        VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
         void createTextureImageView();
         void createTextureSampler();
-        void createVertexBuffer();
-        void createIndexBuffer();
+        void loadMesh();
+        void createMeshPoolBuffers();
         void createUniformBuffers();
-        void createDescriptorPool();
         void createDescriptorSets();
+        void createClusterCulling();
+        void recordClusterCulling(VkCommandBuffer commandBuffer);
+        void destroyClusterCulling();
 
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
         void transitionImageLayout(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-        void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+        void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
         void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+        void copyBufferToImage(VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy> &regions);
+    };
+
+    /// @brief Converts a pipeline to the opaque handle of the pipeline library and back. Copying 
+    /// works for pointer handles and for the 64 bit integer handles of 32 bit platforms alike.
+    static uint64_t toNativePipeline(VkPipeline pipeline) {
+        static_assert(sizeof(VkPipeline) <= sizeof(uint64_t), "A pipeline must fit the library handle.");
+        uint64_t native = 0;
+        memcpy(&native, &pipeline, sizeof(pipeline));
+        return native;
+    }
+
+    static VkPipeline fromNativePipeline(uint64_t native) {
+        VkPipeline pipeline{ VK_NULL_HANDLE };
+        memcpy(&pipeline, &native, sizeof(pipeline));
+        return pipeline;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    /// @brief Builds the shader permutations of the pipeline library on its workers.
+    ///
+    /// The permutations are compiled through the SPIR-V cache and must keep the pipeline layout 
+    /// of the default shaders, as they share its descriptor sets. The pipelines are created 
+    /// through the shared pipeline cache, which Vulkan synchronizes internally.
+    //---------------------------------------------------------------------------------------------
+    class VulkanPipelineBuilder final : public IPipelineBuilder {
+    public:
+        explicit VulkanPipelineBuilder(RHIImpl &impl) : mImpl(impl) {}
+
+        uint64_t build(const PipelineDesc &desc) override {
+            std::vector<char> vertShaderCode, fragShaderCode;
+            if (!compileShaderCached(desc.vertexShader.c_str(), ShaderCacheDir, DefaultShaderCompiler, desc.defines, vertShaderCode) ||
+                    !compileShaderCached(desc.fragmentShader.c_str(), ShaderCacheDir, DefaultShaderCompiler, desc.defines, fragShaderCode)) {
+                logMessage(LogType::Error, "Failed to compile a shader permutation.");
+                return 0;
+            }
+            if (desc.state.wireframe && !mImpl.fillModeNonSolid) {
+                logMessage(LogType::Warn, "The device cannot draw wireframes.");
+                return 0;
+            }
+
+            ShaderReflection reflection;
+            if (!mImpl.reflectGraphicsPipeline(vertShaderCode, fragShaderCode, reflection) ||
+                    hashPipelineLayout(reflection) != hashPipelineLayout(mImpl.pipelineReflection)) {
+                logMessage(LogType::Error, "A shader permutation changes the pipeline layout.");
+                return 0;
+            }
+
+            return toNativePipeline(mImpl.buildGraphicsPipeline(vertShaderCode, fragShaderCode, reflection, desc.state));
+        }
+
+        void destroy(uint64_t pipeline) override {
+            vkDestroyPipeline(mImpl.device, fromNativePipeline(pipeline), nullptr);
+        }
+
+    private:
+        RHIImpl &mImpl;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    /// @brief Records the draws of a render queue into a Vulkan command buffer.
+    ///
+    /// The pipeline handle is resolved by the pipeline library, a pending permutation binds its 
+    /// fallback. There is one material per frame in flight so far, its handle is ignored. The 
+    /// mesh handle is the index binding of the mesh pool.
+    //---------------------------------------------------------------------------------------------
+    class VulkanDrawBackend final : public IDrawBackend {
+    public:
+        VulkanDrawBackend(RHIImpl &impl, VkCommandBuffer commandBuffer) : mImpl(impl), mCommandBuffer(commandBuffer) {}
+
+        void bindPipeline(uint32_t pipeline) override {
+            vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, fromNativePipeline(mImpl.pipelineLibrary.get(pipeline)));
+        }
+
+        void bindMaterial(uint32_t) override {
+            vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mImpl.pipelineLayout, 0, 1,
+                    &mImpl.descriptorSets[mImpl.currentFrame], 0, nullptr);
+        }
+
+        void bindMesh(uint32_t mesh) override {
+            const MeshIndexBinding binding = static_cast<MeshIndexBinding>(mesh);
+            VkBuffer vertexBuffers[] = { mImpl.vertexBuffer };
+            VkDeviceSize offsets[] = { 0 };
+            vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffers, offsets);
+            vkCmdBindIndexBuffer(mCommandBuffer, mImpl.indexBuffer, mImpl.meshPool.getIndexRegionOffset(binding),
+                    binding == MeshIndexBinding::Index16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+        }
+
+        void draw(const DrawItem &item) override {
+            vkCmdDrawIndexed(mCommandBuffer, item.indexCount, item.instanceCount, item.firstIndex, item.vertexOffset, item.firstInstance);
+        }
+
+    private:
+        RHIImpl &mImpl;
+        VkCommandBuffer mCommandBuffer;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    /// @brief Uploads mesh data into the pool buffers by a staging buffer per upload.
+    //---------------------------------------------------------------------------------------------
+    class VulkanMeshPoolUploader final : public IMeshPoolUploader {
+    public:
+        explicit VulkanMeshPoolUploader(RHIImpl &impl) : mImpl(impl) {}
+
+        bool upload(MeshPoolBuffer buffer, size_t offset, const void *data, size_t size) override {
+            if (size == 0) {
+                return true;
+            }
+
+            VkBuffer stagingBuffer{};
+            VkDeviceMemory stagingBufferMemory{};
+            mImpl.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    stagingBuffer, stagingBufferMemory);
+
+            void *mapped{ nullptr };
+            vkMapMemory(mImpl.device, stagingBufferMemory, 0, size, 0, &mapped);
+            memcpy(mapped, data, size);
+            vkUnmapMemory(mImpl.device, stagingBufferMemory);
+
+            VkBuffer target = mImpl.vertexBuffer;
+            if (buffer == MeshPoolBuffer::Index) {
+                target = mImpl.indexBuffer;
+            } else if (buffer == MeshPoolBuffer::Meshlet) {
+                target = mImpl.meshletBuffer;
+            }
+            mImpl.copyBuffer(stagingBuffer, target, size, offset);
+
+            vkDestroyBuffer(mImpl.device, stagingBuffer, nullptr);
+            vkFreeMemory(mImpl.device, stagingBufferMemory, nullptr);
+
+            return true;
+        }
+
+    private:
+        RHIImpl &mImpl;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    /// @brief Rebuilds the streamed texture image when its resident levels change.
+    ///
+    /// There is no sparse residency, so a new image with the resident levels is created. The kept 
+    /// levels are copied over from the old image and the new ones from a staging buffer. The copies 
+    /// are recorded into the upload commands of the current frame, which are submitted ahead of 
+    /// its draws and fenced with it. Nothing waits for the GPU, the old image and the staging 
+    /// buffer are retired and destroyed once the frames using them have finished.
+    //---------------------------------------------------------------------------------------------
+    class VulkanTextureStreamUploader final : public ITextureStreamUploader {
+    public:
+        explicit VulkanTextureStreamUploader(RHIImpl &impl) : mImpl(impl) {}
+
+        bool makeResident(TextureHandle, const StreamedTexture &texture, uint32_t firstMip, const uint8_t *data, size_t dataOffset) override {
+            const uint32_t numMips = texture.header.numMips;
+            const uint32_t oldFirstMip = texture.residentMip;
+            const TextureFormat textureFormat = static_cast<TextureFormat>(texture.header.format);
+            const VkFormat format = VulkanUtils::getTextureFormat(textureFormat, (texture.header.flags & TextureFlagSrgb) != 0);
+            if (oldFirstMip == numMips && !mImpl.isTextureFormatSupported(textureFormat, format)) {
+                logMessage(LogType::Warn, "The GPU cannot sample the baked texture format.");
+                return false;
+            }
+            if (firstMip == oldFirstMip) {
+                return true;
+            }
+
+            // The new levels are stored in one range of the file, the finest one last
+            VkBuffer stagingBuffer{};
+            VkDeviceMemory stagingBufferMemory{};
+            const bool upload = data != nullptr && firstMip < oldFirstMip;
+            if (upload) {
+                const VkDeviceSize size = texture.mips[firstMip].dataOffset + texture.mips[firstMip].dataSize - dataOffset;
+                mImpl.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        stagingBuffer, stagingBufferMemory);
+                void *mapped{ nullptr };
+                vkMapMemory(mImpl.device, stagingBufferMemory, 0, size, 0, &mapped);
+                memcpy(mapped, data, static_cast<size_t>(size));
+                vkUnmapMemory(mImpl.device, stagingBufferMemory);
+            }
+
+            const uint32_t mipLevels = numMips - firstMip;
+            VkImage image{};
+            VkDeviceMemory imageMemory{};
+            mImpl.createImage(texture.mips[firstMip].width, texture.mips[firstMip].height, format, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                image, imageMemory, mipLevels);
+
+            VkCommandBuffer commandBuffer = mImpl.beginUploadCommands();
+            recordBarrier(commandBuffer, image, mipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+            if (mImpl.textureImage != VK_NULL_HANDLE && oldFirstMip < numMips) {
+                recordBarrier(commandBuffer, mImpl.textureImage, numMips - oldFirstMip, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+                std::vector<VkImageCopy> copies;
+                for (uint32_t i = std::max(firstMip, oldFirstMip); i < numMips; ++i) {
+                    VkImageCopy copy{};
+                    copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i - oldFirstMip, 0, 1 };
+                    copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i - firstMip, 0, 1 };
+                    copy.extent = { texture.mips[i].width, texture.mips[i].height, 1 };
+                    copies.push_back(copy);
+                }
+                vkCmdCopyImage(commandBuffer, mImpl.textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    static_cast<uint32_t>(copies.size()), copies.data());
+            }
+            if (upload) {
+                std::vector<VkBufferImageCopy> regions;
+                for (uint32_t i = firstMip; i < oldFirstMip; ++i) {
+                    VkBufferImageCopy region{};
+                    region.bufferOffset = texture.mips[i].dataOffset - dataOffset;
+                    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i - firstMip, 0, 1 };
+                    region.imageExtent = { texture.mips[i].width, texture.mips[i].height, 1 };
+                    regions.push_back(region);
+                }
+                vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    static_cast<uint32_t>(regions.size()), regions.data());
+            }
+            recordBarrier(commandBuffer, image, mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+            retireImage(stagingBuffer, stagingBufferMemory);
+            mImpl.textureImage = image;
+            mImpl.textureImageMemory = imageMemory;
+            mImpl.textureFormat = format;
+            mImpl.textureMipLevels = mipLevels;
+            mImpl.textureImageView = mImpl.createImageView(image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+
+            return true;
+        }
+
+        void release(TextureHandle) override {
+            retireImage(VK_NULL_HANDLE, VK_NULL_HANDLE);
+        }
+
+    private:
+        void retireImage(VkBuffer stagingBuffer, VkDeviceMemory stagingBufferMemory) {
+            RHIImpl::RetiredTexture retired;
+            retired.image = mImpl.textureImage;
+            retired.imageView = mImpl.textureImageView;
+            retired.imageMemory = mImpl.textureImageMemory;
+            retired.stagingBuffer = stagingBuffer;
+            retired.stagingBufferMemory = stagingBufferMemory;
+            mImpl.retireTexture(retired);
+            mImpl.textureImageView = VK_NULL_HANDLE;
+            mImpl.textureImage = VK_NULL_HANDLE;
+            mImpl.textureImageMemory = VK_NULL_HANDLE;
+        }
+
+        static void recordBarrier(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, VkImageLayout oldLayout, VkImageLayout newLayout,
+                VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = newLayout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = image;
+            barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        RHIImpl &mImpl;
     };
 
     static std::vector<char> readFile(const std::string& filename) {
@@ -414,10 +800,19 @@ namespace segfault::renderer {
         queueCreateInfo.pNext = nullptr;
         queueCreateInfo.pQueuePriorities = &queuePrioritys[0];
 
+        VkPhysicalDeviceFeatures supportedFeatures{};
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        multiDrawIndirect = supportedFeatures.multiDrawIndirect == VK_TRUE;
+        textureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+        fillModeNonSolid = supportedFeatures.fillModeNonSolid == VK_TRUE;
+
         VkPhysicalDeviceFeatures deviceFeatures{};
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.multiDrawIndirect = multiDrawIndirect ? VK_TRUE : VK_FALSE;
+        deviceFeatures.textureCompressionBC = textureCompressionBC ? VK_TRUE : VK_FALSE;
+        deviceFeatures.fillModeNonSolid = fillModeNonSolid ? VK_TRUE : VK_FALSE;
 
         createInfo.pNext = nullptr;
         createInfo.pQueueCreateInfos = &queueCreateInfo;
@@ -625,39 +1020,143 @@ namespace segfault::renderer {
         }
     }
 
+    bool RHIImpl::reflectGraphicsPipeline(const std::vector<char> &vertShaderCode, const std::vector<char> &fragShaderCode, ShaderReflection &reflection) {
+        ShaderReflection vertReflection, fragReflection;
+        reflection = ShaderReflection();
+        if (!reflectShader(vertShaderCode.data(), vertShaderCode.size(), vertReflection) || vertReflection.stages != ShaderStageVertex ||
+                !reflectShader(fragShaderCode.data(), fragShaderCode.size(), fragReflection) || fragReflection.stages != ShaderStageFragment) {
+            logMessage(LogType::Error, "Failed to reflect the shaders of the graphics pipeline.");
+            return false;
+        }
+        if (!mergeShaderReflection(vertReflection, reflection) || !mergeShaderReflection(fragReflection, reflection)) {
+            logMessage(LogType::Error, "The stages of the graphics pipeline declare a binding differently.");
+            return false;
+        }
+
+        // The renderer writes exactly the uniform buffer and the texture of set 0
+        const ShaderBinding *ubo = findShaderBinding(reflection, 0, 0);
+        const ShaderBinding *sampler = findShaderBinding(reflection, 0, 1);
+        if (reflection.bindings.size() != 2 || ubo == nullptr || ubo->type != ShaderDescriptorType::UniformBuffer ||
+                sampler == nullptr || sampler->type != ShaderDescriptorType::CombinedImageSampler) {
+            logMessage(LogType::Error, "The graphics pipeline binds resources the renderer does not provide.");
+            return false;
+        }
+
+        return true;
+    }
+
     void RHIImpl::createDescriptorSetLayout() {
-        VkDescriptorSetLayoutBinding uboLayoutBinding{};
-        uboLayoutBinding.binding = 0;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uboLayoutBinding.descriptorCount = 1;
-
-        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        uboLayoutBinding.pImmutableSamplers = nullptr; // Optional
-
-        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-        samplerLayoutBinding.binding = 1;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.pImmutableSamplers = nullptr;
-        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-        std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
-        VkDescriptorSetLayoutCreateInfo layoutInfo{};
-        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-        layoutInfo.pBindings = bindings.data();
-
-        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        shaderManager.init(&shaderPool, ShaderCacheDir);
+        vertShader = shaderManager.add(VertexShaderSource, "shaders/vert.spv");
+        fragShader = shaderManager.add(FragmentShaderSource, "shaders/frag.spv");
+        if (vertShader == InvalidShader || fragShader == InvalidShader) {
+            throw SegfaultException("failed to open file!");
+        }
+
+        layoutCache.init(device);
+        if (!reflectGraphicsPipeline(*shaderManager.getCode(vertShader), *shaderManager.getCode(fragShader), pipelineReflection)) {
+            throw SegfaultException("failed to reflect shaders!");
+        }
+        descriptorSetLayout = layoutCache.getSetLayout(pipelineReflection, 0);
+        if (descriptorSetLayout == VK_NULL_HANDLE) {
             throw SegfaultException("failed to create descriptor set layout!");
         }
     }
 
     void RHIImpl::createGraphicsPipeline() {
-        auto vertShaderCode = readFile("shaders/vert.spv");
-        auto fragShaderCode = readFile("shaders/frag.spv");
+        pipelineLayout = layoutCache.getPipelineLayout(pipelineReflection);
+        if (pipelineLayout == VK_NULL_HANDLE) {
+            throw SegfaultException("failed to create pipeline layout!");
+        }
+
+        createPipelineCache();
+        pipelineBuilder = std::make_unique<VulkanPipelineBuilder>(*this);
+        pipelineLibrary.init(pipelineBuilder.get(), &pipelinePool);
+
+        // The default pipeline is the fallback of all permutations, so it is built right away
+        PipelineDesc desc;
+        desc.vertexShader = VertexShaderSource;
+        desc.fragmentShader = FragmentShaderSource;
+        VkPipeline pipeline = buildGraphicsPipeline(*shaderManager.getCode(vertShader), *shaderManager.getCode(fragShader), 
+            pipelineReflection, desc.state);
+        if (pipeline == VK_NULL_HANDLE) {
+            throw SegfaultException("failed to create graphics pipeline!");
+        }
+        defaultPipeline = pipelineLibrary.add(desc, toNativePipeline(pipeline));
+        meshPipeline = defaultPipeline;
+    }
+
+    void RHIImpl::createPipelineCache() {
+        // Data saved by another device or driver version is dropped before it reaches the driver
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        std::vector<char> data;
+        std::ifstream file(PipelineCacheFile, std::ios::ate | std::ios::binary);
+        if (file.is_open()) {
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        constexpr size_t HeaderSize = 16 + VK_UUID_SIZE;
+        uint32_t header[4] = {};
+        if (data.size() >= HeaderSize) {
+            memcpy(header, data.data(), sizeof(header));
+        }
+        if (header[0] < HeaderSize || header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header[2] != properties.vendorID ||
+                header[3] != properties.deviceID || memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            data.clear();
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = data.size();
+        cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+        if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+            logMessage(LogType::Warn, "Failed to create the pipeline cache, pipelines are built without it.");
+            pipelineCache = VK_NULL_HANDLE;
+        }
+    }
+
+    void RHIImpl::savePipelineCache() {
+        size_t size = 0;
+        if (pipelineCache == VK_NULL_HANDLE || vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) {
+            return;
+        }
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS) {
+            return;
+        }
+
+        // The shaders may all come from the SPIR-V files, so nothing created the cache directory yet
+        createShaderCacheDir(ShaderCacheDir);
+        std::ofstream file(PipelineCacheFile, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            logMessage(LogType::Warn, "Cannot save the pipeline cache.");
+            return;
+        }
+        file.write(data.data(), static_cast<std::streamsize>(size));
+    }
+
+    PipelineHandle RHIImpl::requestPipeline(const PipelineDesc &desc) {
+        return pipelineLibrary.request(desc, defaultPipeline);
+    }
+
+    VkPipeline RHIImpl::buildGraphicsPipeline(const std::vector<char> &vertShaderCode, const std::vector<char> &fragShaderCode, 
+            const ShaderReflection &reflection, const PipelineState &state) {
+        // The mesh format provides the attributes, the vertex shader picks the ones it reads
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+        if (!VulkanUtils::getAttributeDescriptions(meshPool.getVertexFormat(), reflection, attributeDescriptions)) {
+            logMessage(LogType::Error, "The vertex shader reads an input the mesh format does not provide.");
+            return VK_NULL_HANDLE;
+        }
 
         VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
         VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+        if (vertShaderModule == VK_NULL_HANDLE || fragShaderModule == VK_NULL_HANDLE) {
+            vkDestroyShaderModule(device, fragShaderModule, nullptr);
+            vkDestroyShaderModule(device, vertShaderModule, nullptr);
+            return VK_NULL_HANDLE;
+        }
 
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -676,8 +1175,7 @@ namespace segfault::renderer {
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-        auto bindingDescription = Vertex::getBindingDescription();
-        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+        auto bindingDescription = VulkanUtils::getBindingDescription(meshPool.getVertexFormat());
 
         vertexInputInfo.vertexBindingDescriptionCount = 1;
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -698,9 +1196,9 @@ namespace segfault::renderer {
         rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
         rasterizer.depthClampEnable = VK_FALSE;
         rasterizer.rasterizerDiscardEnable = VK_FALSE;
-        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterizer.polygonMode = state.wireframe ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;
         rasterizer.lineWidth = 1.0f;
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+        rasterizer.cullMode = VulkanUtils::getCullMode(state.cullMode);
         rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
         rasterizer.depthBiasEnable = VK_FALSE;
 
@@ -709,14 +1207,12 @@ namespace segfault::renderer {
         multisampling.sampleShadingEnable = VK_FALSE;
         multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
-        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-        colorBlendAttachment.blendEnable = VK_FALSE;
+        VkPipelineColorBlendAttachmentState colorBlendAttachment = VulkanUtils::getColorBlendAttachment(state.blendMode);
 
         VkPipelineDepthStencilStateCreateInfo depthStencil{};
         depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depthStencil.depthTestEnable = VK_TRUE;
-        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthTestEnable = state.depthTest ? VK_TRUE : VK_FALSE;
+        depthStencil.depthWriteEnable = state.depthWrite ? VK_TRUE : VK_FALSE;
         depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
         depthStencil.depthBoundsTestEnable = VK_FALSE;
         depthStencil.minDepthBounds = 0.0f; // Optional
@@ -745,15 +1241,6 @@ namespace segfault::renderer {
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates = dynamicStates.data();
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-
-        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-            throw SegfaultException("failed to create pipeline layout!");
-        }
-
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipelineInfo.stageCount = 2;
@@ -771,12 +1258,92 @@ namespace segfault::renderer {
         pipelineInfo.subpass = 0;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-            throw SegfaultException("failed to create graphics pipeline!");
+        VkPipeline pipeline{ VK_NULL_HANDLE };
+        if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            core::logMessage(core::LogType::Error, "failed to create graphics pipeline!");
+            pipeline = VK_NULL_HANDLE;
         }
 
         vkDestroyShaderModule(device, fragShaderModule, nullptr);
         vkDestroyShaderModule(device, vertShaderModule, nullptr);
+
+        return pipeline;
+    }
+
+    void RHIImpl::reloadShaders() {
+        // A pipeline retired in frame n was last recorded in frame n - 1, whose fence has been waited for by now
+        auto retired = std::remove_if(retiredPipelines.begin(), retiredPipelines.end(), [this](const std::pair<VkPipeline, uint64_t> &pipeline) {
+            if (pipeline.second + MAX_FRAMES_IN_FLIGHT > frameCount) {
+                return false;
+            }
+            vkDestroyPipeline(device, pipeline.first, nullptr);
+            return true;
+        });
+        retiredPipelines.erase(retired, retiredPipelines.end());
+
+        {
+            std::lock_guard<std::mutex> lock(reloadLock);
+            for (const std::pair<PipelineHandle, VkPipeline> &reloadedPipeline : reloadedPipelines) {
+                const uint64_t previous = pipelineLibrary.replace(reloadedPipeline.first, toNativePipeline(reloadedPipeline.second));
+                if (previous == 0) {
+                    vkDestroyPipeline(device, reloadedPipeline.second, nullptr);
+                    continue;
+                }
+                retiredPipelines.emplace_back(fromNativePipeline(previous), frameCount);
+            }
+            reloadedPipelines.clear();
+        }
+
+        std::vector<ShaderHandle> reloaded;
+        if (shaderManager.update(reloaded) == 0) {
+            return;
+        }
+
+        // Every ready permutation of a changed source is rebuilt, pending ones read the new source 
+        // anyway. The descriptor sets and the pipeline layout stay, the builder rejects a shader 
+        // changing its interface and the current pipeline is kept until a restart.
+        for (PipelineHandle handle = 0; handle < pipelineLibrary.getNumPipelines(); ++handle) {
+            if (pipelineLibrary.getStatus(handle) != PipelineStatus::Ready) {
+                continue;
+            }
+            const PipelineDesc *desc = pipelineLibrary.getDesc(handle);
+            const bool changed = std::any_of(reloaded.begin(), reloaded.end(), [this, desc](ShaderHandle shader) {
+                const char *sourceFile = shaderManager.getSourceFile(shader);
+                return sourceFile != nullptr && (desc->vertexShader == sourceFile || desc->fragmentShader == sourceFile);
+            });
+            if (!changed) {
+                continue;
+            }
+
+            // The pool runs the builds in order, so the last build of a pipeline uses the latest code
+            shaderPool.enqueue([this, handle, desc = *desc]() {
+                const uint64_t pipeline = pipelineBuilder->build(desc);
+                if (pipeline == 0) {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(reloadLock);
+                reloadedPipelines.emplace_back(handle, fromNativePipeline(pipeline));
+            });
+        }
+    }
+
+    void RHIImpl::destroyPipelines() {
+        shaderPool.waitIdle();
+        for (const std::pair<VkPipeline, uint64_t> &pipeline : retiredPipelines) {
+            vkDestroyPipeline(device, pipeline.first, nullptr);
+        }
+        retiredPipelines.clear();
+        for (const std::pair<PipelineHandle, VkPipeline> &reloadedPipeline : reloadedPipelines) {
+            vkDestroyPipeline(device, reloadedPipeline.second, nullptr);
+        }
+        reloadedPipelines.clear();
+        pipelineLibrary.clear();
+        defaultPipeline = InvalidPipeline;
+        meshPipeline = InvalidPipeline;
+        savePipelineCache();
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
+        pipelineCache = VK_NULL_HANDLE;
     }
 
     void RHIImpl::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
@@ -805,10 +1372,11 @@ namespace segfault::renderer {
         vkBindBufferMemory(device, buffer, bufferMemory, 0);
     }
 
-    void RHIImpl::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    void RHIImpl::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset) {
         VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
         VkBufferCopy copyRegion{};
+        copyRegion.dstOffset = dstOffset;
         copyRegion.size = size;
         vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
@@ -904,9 +1472,14 @@ namespace segfault::renderer {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        // The clusters are culled before the pass, the draws read the surviving commands
+        const PooledMesh *pooled = meshPool.get(meshHandle);
+        const bool clusterCulling = cullPipeline != VK_NULL_HANDLE && pooled != nullptr && cullParams.numMeshlets != 0;
+        if (clusterCulling) {
+            recordClusterCulling(commandBuffer);
+        }
 
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -922,14 +1495,30 @@ namespace segfault::renderer {
         scissor.extent = swapChainExtent;
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        VkBuffer vertexBuffers[] = { vertexBuffer };
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+        VulkanDrawBackend backend(*this, commandBuffer);
+        if (clusterCulling) {
+            backend.bindPipeline(meshPipeline);
+            backend.bindMaterial(0);
+            backend.bindMesh(static_cast<uint32_t>(pooled->binding));
+            constexpr VkDeviceSize stride = sizeof(DrawIndexedIndirectCommand);
+            if (multiDrawIndirect) {
+                vkCmdDrawIndexedIndirect(commandBuffer, clusterCommandBuffers[currentFrame], 0, cullParams.numMeshlets, stride);
+            } else {
+                for (uint32_t i = 0; i < cullParams.numMeshlets; ++i) {
+                    vkCmdDrawIndexedIndirect(commandBuffer, clusterCommandBuffers[currentFrame], i * stride, 1, stride);
+                }
+            }
+        } else {
+            renderQueue.clear();
+            DrawItem item;
+            item.key = makeOpaqueSortKey(0, meshPipeline, 0, 0.0f);
+            item.pipeline = meshPipeline;
+            if (meshPool.fillDrawItem(meshHandle, item, meshLod)) {
+                renderQueue.submit(item);
+            }
+            renderQueue.sort();
+            renderQueue.execute(backend);
+        }
 
         vkCmdEndRenderPass(commandBuffer);
 
@@ -966,16 +1555,41 @@ namespace segfault::renderer {
 
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+        transforms.setLocalRotation(modelTransform, glm::angleAxis(time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+        transforms.update();
+
+        const glm::vec3 eye(2.0f, 2.0f, 2.0f);
+        const glm::mat4 world = transforms.getWorldMatrix(modelTransform);
         UniformBufferObject ubo{};
-        ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        // Quantized positions are stored relative to the mesh bounds, restoring them is folded into the model matrix
+        ubo.model = world;
+        if (const PooledMesh *pooled = meshPool.get(meshHandle)) {
+            ubo.model = glm::scale(glm::translate(ubo.model, pooled->positionOffset), pooled->positionScale);
+        }
+        ubo.view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
         ubo.proj = glm::perspective(glm::radians(45.0f), swapChainExtent.width / (float)swapChainExtent.height, 0.1f, 10.0f);
         ubo.proj[1][1] *= -1;
         memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+
+        // The bounds, the lod errors and the meshlets are baked before quantization, so they live in the space of the world matrix
+        if (const PooledMesh *pooled = meshPool.get(meshHandle)) {
+            const LodView lodView = makeLodView(eye, glm::radians(45.0f), static_cast<float>(swapChainExtent.height), 0.1f);
+            meshLod = selectLod(*pooled, world, lodView, lodSettings, meshLod);
+            const MeshLodRecord &lod = pooled->lods[meshLod];
+            cullParams = makeClusterCullParams(ubo.proj * ubo.view, world, eye, lod.firstMeshlet, lod.numMeshlets);
+
+            // The texture covers the mesh once, so it is as large on screen as the mesh bounds
+            if (const StreamedTexture *texture = textureStreamer.get(textureHandle)) {
+                const float screenSize = computeProjectedError(glm::length(pooled->bounds.max - pooled->bounds.min), pooled->bounds, world, lodView);
+                textureStreamer.requestMip(textureHandle, computeTextureMipForScreenSize(texture->header.width, texture->header.height, screenSize));
+            }
+        }
     }
 
     void RHIImpl::drawFrame() {
         vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        reloadShaders();
+        destroyRetiredTextures(false);
 
         uint32_t imageIndex{};
         VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame],
@@ -990,11 +1604,26 @@ namespace segfault::renderer {
         }
 
         updateUniformBuffer(currentFrame);
+        textureStreamer.update();
+        pipelineLibrary.update();
+        if (boundTextureViews[currentFrame] != textureImageView) {
+            updateTextureDescriptor(currentFrame);
+        }
 
         vkResetFences(device, 1, &inFlightFences[currentFrame]);
         vkResetCommandBuffer(commandBuffers[currentFrame], 0);
         recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
 
+        // The uploads go first, their barriers order the copies before the draws sampling the texture
+        std::array<VkCommandBuffer, 2> submitCommandBuffers{};
+        uint32_t numSubmitCommandBuffers = 0;
+        if (uploadsRecorded) {
+            vkEndCommandBuffer(uploadCommandBuffers[currentFrame]);
+            submitCommandBuffers[numSubmitCommandBuffers++] = uploadCommandBuffers[currentFrame];
+            uploadsRecorded = false;
+        }
+        submitCommandBuffers[numSubmitCommandBuffers++] = commandBuffers[currentFrame];
+
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -1004,8 +1633,8 @@ namespace segfault::renderer {
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
 
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+        submitInfo.commandBufferCount = numSubmitCommandBuffers;
+        submitInfo.pCommandBuffers = submitCommandBuffers.data();
 
         VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
         submitInfo.signalSemaphoreCount = 1;
@@ -1039,6 +1668,7 @@ namespace segfault::renderer {
         }
 
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        ++frameCount;
     }
 
     void RHIImpl::cleanupSwapChain() {
@@ -1081,14 +1711,14 @@ namespace segfault::renderer {
 
     void RHIImpl::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
             VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image,
-            VkDeviceMemory& imageMemory) {
+            VkDeviceMemory& imageMemory, uint32_t mipLevels) {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
         imageInfo.extent.width = width;
         imageInfo.extent.height = height;
         imageInfo.extent.depth = 1;
-        imageInfo.mipLevels = 1;
+        imageInfo.mipLevels = mipLevels;
         imageInfo.arrayLayers = 1;
         imageInfo.format = format;
         imageInfo.tiling = tiling;
@@ -1116,41 +1746,148 @@ namespace segfault::renderer {
         vkBindImageMemory(device, image, imageMemory, 0);
     }
 
+    bool RHIImpl::createStreamedTextureImage() {
+        if (!textureFileManager.exist(DefaultTextureFile)) {
+            return false;
+        }
+
+        // The tail is made resident here, update streams the finer levels as the mesh needs them
+        textureUploader = std::make_unique<VulkanTextureStreamUploader>(*this);
+        textureStreamer.init(&textureFileManager, textureUploader.get(), TextureStreamSettings());
+        textureHandle = textureStreamer.add(DefaultTextureFile);
+        if (textureHandle == InvalidTexture) {
+            logMessage(LogType::Warn, "Cannot stream the baked texture, fall back to the source image.");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool RHIImpl::isTextureFormatSupported(TextureFormat textureFormat, VkFormat format) {
+        if (format == VK_FORMAT_UNDEFINED || (getTextureBlockExtent(textureFormat) > 1 && !textureCompressionBC)) {
+            return false;
+        }
+
+        const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+            VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+        VkFormatProperties formatProperties{};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+
+        return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+    }
+
+    void RHIImpl::updateTextureDescriptor(uint32_t frame) {
+        // Only the set of a frame whose fence has been waited for may be written
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = textureImageView;
+        imageInfo.sampler = textureSampler;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = descriptorSets[frame];
+        descriptorWrite.dstBinding = 1;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+        boundTextureViews[frame] = textureImageView;
+    }
+
+    VkCommandBuffer RHIImpl::beginUploadCommands() {
+        // Allocated on first use, the tail of the streamed texture is uploaded before the frame 
+        // resources exist and goes out with the first frame
+        if (uploadCommandBuffers.empty()) {
+            uploadCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = commandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = static_cast<uint32_t>(uploadCommandBuffers.size());
+            if (vkAllocateCommandBuffers(device, &allocInfo, uploadCommandBuffers.data()) != VK_SUCCESS) {
+                core::logMessage(core::LogType::Error, "failed to allocate upload command buffers!");
+                throw SegfaultException("failed to allocate upload command buffers!");
+            }
+        }
+
+        VkCommandBuffer commandBuffer = uploadCommandBuffers[currentFrame];
+        if (!uploadsRecorded) {
+            vkResetCommandBuffer(commandBuffer, 0);
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(commandBuffer, &beginInfo);
+            uploadsRecorded = true;
+        }
+
+        return commandBuffer;
+    }
+
+    void RHIImpl::retireTexture(const RetiredTexture &texture) {
+        // The upload commands of this frame still read the old image
+        retiredTextures.push_back(texture);
+        retiredTextures.back().frame = frameCount;
+    }
+
+    void RHIImpl::destroyRetiredTextures(bool all) {
+        // Like the pipelines, a texture retired in frame n is free once the fence of frame n has been waited for
+        auto retired = std::remove_if(retiredTextures.begin(), retiredTextures.end(), [this, all](const RetiredTexture &texture) {
+            if (!all && texture.frame + MAX_FRAMES_IN_FLIGHT > frameCount) {
+                return false;
+            }
+            vkDestroyImageView(device, texture.imageView, nullptr);
+            vkDestroyImage(device, texture.image, nullptr);
+            vkFreeMemory(device, texture.imageMemory, nullptr);
+            vkDestroyBuffer(device, texture.stagingBuffer, nullptr);
+            vkFreeMemory(device, texture.stagingBufferMemory, nullptr);
+            return true;
+        });
+        retiredTextures.erase(retired, retiredTextures.end());
+    }
+
     void RHIImpl::createTextureImage() {
-        int texWidth, texHeight, texChannels;
-        stbi_uc *pixels = stbi_load("textures/SegFault.jpg", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
+        if (createStreamedTextureImage()) {
+            return;
+        }
 
-        if (pixels == nullptr) {
+        // The fallback is decoded on the texture read worker, the upload waits for it on this thread
+        TextureLoader loader(textureFileManager, textureIoPool);
+        loader.load(FallbackTextureFile, true);
+        loader.waitIdle();
+        std::vector<LoadedImage> images;
+        loader.takeImages(images);
+        if (images.empty() || !images[0].success) {
             throw SegfaultException("failed to load texture image!");
         }
 
+        const LoadedImage &image = images[0];
+        textureFormat = image.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        VkDeviceSize imageSize = image.pixels.size();
+
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingBufferMemory;
         createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
         void* data{nullptr};
         vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels, static_cast<size_t>(imageSize));
+        memcpy(data, image.pixels.data(), static_cast<size_t>(imageSize));
         vkUnmapMemory(device, stagingBufferMemory);
 
-        stbi_image_free(pixels);
-
-        createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+        createImage(image.width, image.height, textureFormat, VK_IMAGE_TILING_OPTIMAL,
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             textureImage, textureImageMemory);
 
-        transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-        transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        transitionImageLayout(textureImage, textureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        copyBufferToImage(stagingBuffer, textureImage, image.width, image.height);
+        transitionImageLayout(textureImage, textureFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
         vkDestroyBuffer(device, stagingBuffer, nullptr);
         vkFreeMemory(device, stagingBufferMemory, nullptr);
     }
 
-    VkImageView RHIImpl::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
+    VkImageView RHIImpl::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = image;
@@ -1158,7 +1895,7 @@ namespace segfault::renderer {
         viewInfo.format = format;
         viewInfo.subresourceRange.aspectMask = aspectFlags;
         viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
@@ -1171,7 +1908,11 @@ namespace segfault::renderer {
     }
 
     void RHIImpl::createTextureImageView() {
-        textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+        // The streamed texture creates a view whenever its resident levels change
+        if (textureImageView != VK_NULL_HANDLE) {
+            return;
+        }
+        textureImageView = createImageView(textureImage, textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, textureMipLevels);
     }
 
     void RHIImpl::createTextureSampler() {
@@ -1198,52 +1939,54 @@ namespace segfault::renderer {
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.mipLodBias = 0.0f;
         samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = 0.0f;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
         if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
             throw SegfaultException("failed to create texture sampler!");
         }
     }
 
-    void RHIImpl::createVertexBuffer() {
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void *data{nullptr};
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+    void RHIImpl::loadMesh() {
+        bool loaded = false;
+        std::ifstream file(DefaultMeshFile, std::ios::ate | std::ios::binary);
+        if (file.is_open()) {
+            std::vector<uint8_t> blob(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(blob.data()), blob.size());
+            loaded = mesh.load(blob.data(), blob.size());
+            if (!loaded) {
+                logMessage(LogType::Warn, "Cannot use the baked mesh, fall back to the built-in geometry.");
+            }
+        }
 
-        copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+        if (!loaded) {
+            scene::Aabb bounds;
+            for (const Vertex &vertex : vertices) {
+                bounds.merge(vertex.pos);
+            }
+            const std::vector<uint32_t> builtinIndices(indices.begin(), indices.end());
+            mesh.create(MeshVertexFormat::PosColorUv, vertices.data(), vertices.size(), builtinIndices.data(), builtinIndices.size(), bounds);
+        }
 
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        const bool index16 = mesh.getIndexSize() == 2;
+        meshPool.init(mesh.getVertexFormat(), std::max(MeshPoolVertices, mesh.getNumVertices()),
+            std::max(MeshPoolIndices16, index16 ? mesh.getNumIndices() : 0u), std::max(MeshPoolIndices32, index16 ? 0u : mesh.getNumIndices()),
+            std::max(MeshPoolMeshlets, mesh.getNumMeshlets()));
     }
 
-    void RHIImpl::createIndexBuffer() {
-        VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-        VkBuffer stagingBuffer{};
-        VkDeviceMemory stagingBufferMemory{};
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void *data{nullptr};
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, indices.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+    void RHIImpl::createMeshPoolBuffers() {
+        createBuffer(meshPool.getVertexBufferSize(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+        createBuffer(meshPool.getIndexBufferSize(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+        createBuffer(meshPool.getMeshletBufferSize(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, meshletBuffer, meshletBufferMemory);
 
-        copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+        VulkanMeshPoolUploader uploader(*this);
+        meshHandle = meshPool.add(mesh, uploader);
 
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        // The GPU has its own copy now
+        mesh = MeshData();
     }
 
     void RHIImpl::createUniformBuffers() {
@@ -1261,34 +2004,10 @@ namespace segfault::renderer {
         }
     }
 
-    void RHIImpl::createDescriptorPool() {
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-
-        VkDescriptorPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-
-        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-            throw SegfaultException("failed to create descriptor pool!");
-        }
-    }
-
     void RHIImpl::createDescriptorSets() {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = descriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts = layouts.data();
-
         descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-        if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+        boundTextureViews.assign(MAX_FRAMES_IN_FLIGHT, textureImageView);
+        if (!layoutCache.allocateDescriptorSets(pipelineReflection, 0, MAX_FRAMES_IN_FLIGHT, descriptorSets.data())) {
             throw SegfaultException("failed to allocate descriptor sets!");
         }
 
@@ -1325,6 +2044,136 @@ namespace segfault::renderer {
         }
     }
 
+    void RHIImpl::createClusterCulling() {
+        const PooledMesh *pooled = meshPool.get(meshHandle);
+        if (pooled == nullptr || pooled->numMeshlets == 0) {
+            return;
+        }
+        std::ifstream shaderFile(ClusterCullShaderFile, std::ios::binary);
+        if (!shaderFile.is_open()) {
+            logMessage(LogType::Warn, "Cluster culling shader not found, draw the meshes in whole.");
+            return;
+        }
+        shaderFile.close();
+
+        // The pass binds the meshlets and the commands and pushes its parameters
+        auto shaderCode = readFile(ClusterCullShaderFile);
+        ShaderReflection reflection;
+        const ShaderBinding *meshlets = nullptr, *commands = nullptr;
+        if (reflectShader(shaderCode.data(), shaderCode.size(), reflection) && reflection.stages == ShaderStageCompute) {
+            meshlets = findShaderBinding(reflection, 0, 0);
+            commands = findShaderBinding(reflection, 0, 1);
+        }
+        if (reflection.bindings.size() != 2 || meshlets == nullptr || meshlets->type != ShaderDescriptorType::StorageBuffer ||
+                commands == nullptr || commands->type != ShaderDescriptorType::StorageBuffer ||
+                reflection.pushConstantSize != sizeof(ClusterCullParams)) {
+            logMessage(LogType::Warn, "Cluster culling shader does not match the renderer, draw the meshes in whole.");
+            return;
+        }
+
+        // One command buffer per frame in flight, the compute pass writes it and the draws read it. 
+        // It holds the meshlets of the largest detail level.
+        uint32_t maxMeshlets = 0;
+        for (uint32_t i = 0; i < pooled->numLods; ++i) {
+            maxMeshlets = std::max(maxMeshlets, pooled->lods[i].numMeshlets);
+        }
+        const VkDeviceSize commandsSize = maxMeshlets * sizeof(DrawIndexedIndirectCommand);
+        clusterCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        clusterCommandBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(commandsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, clusterCommandBuffers[i], clusterCommandBuffersMemory[i]);
+        }
+
+        cullDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        if (!layoutCache.allocateDescriptorSets(reflection, 0, MAX_FRAMES_IN_FLIGHT, cullDescriptorSets.data())) {
+            logMessage(LogType::Warn, "Cannot allocate the cluster culling descriptor sets, draw the meshes in whole.");
+            destroyClusterCulling();
+            return;
+        }
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+            bufferInfos[0].buffer = meshletBuffer;
+            bufferInfos[0].range = VK_WHOLE_SIZE;
+            bufferInfos[1].buffer = clusterCommandBuffers[i];
+            bufferInfos[1].range = VK_WHOLE_SIZE;
+
+            std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+            for (uint32_t j = 0; j < descriptorWrites.size(); ++j) {
+                descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites[j].dstSet = cullDescriptorSets[i];
+                descriptorWrites[j].dstBinding = j;
+                descriptorWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                descriptorWrites[j].descriptorCount = 1;
+                descriptorWrites[j].pBufferInfo = &bufferInfos[j];
+            }
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
+
+        cullPipelineLayout = layoutCache.getPipelineLayout(reflection);
+        if (cullPipelineLayout == VK_NULL_HANDLE) {
+            logMessage(LogType::Warn, "Cannot create the cluster culling pipeline layout, draw the meshes in whole.");
+            destroyClusterCulling();
+            return;
+        }
+
+        // The culling is optional, a failure releases the pass and the meshes are drawn without it
+        VkShaderModule shaderModule = createShaderModule(shaderCode);
+        if (shaderModule == VK_NULL_HANDLE) {
+            logMessage(LogType::Warn, "Cannot create the cluster culling shader, draw the meshes in whole.");
+            destroyClusterCulling();
+            return;
+        }
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = cullPipelineLayout;
+        const VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &cullPipeline);
+        vkDestroyShaderModule(device, shaderModule, nullptr);
+        if (result != VK_SUCCESS) {
+            logMessage(LogType::Warn, "Cannot create the cluster culling pipeline, draw the meshes in whole.");
+            destroyClusterCulling();
+        }
+    }
+
+    void RHIImpl::recordClusterCulling(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1,
+                &cullDescriptorSets[currentFrame], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ClusterCullParams), &cullParams);
+        vkCmdDispatch(commandBuffer, (cullParams.numMeshlets + ClusterCullGroupSize - 1) / ClusterCullGroupSize, 1, 1);
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = clusterCommandBuffers[currentFrame];
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+                0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    void RHIImpl::destroyClusterCulling() {
+        // The descriptor sets return with the pool of the layout cache, the meshlets stay in the mesh pool
+        vkDestroyPipeline(device, cullPipeline, nullptr);
+        cullPipeline = VK_NULL_HANDLE;
+        cullPipelineLayout = VK_NULL_HANDLE;
+        cullDescriptorSets.clear();
+        for (size_t i = 0; i < clusterCommandBuffers.size(); i++) {
+            vkDestroyBuffer(device, clusterCommandBuffers[i], nullptr);
+            vkFreeMemory(device, clusterCommandBuffersMemory[i], nullptr);
+        }
+        clusterCommandBuffers.clear();
+        clusterCommandBuffersMemory.clear();
+    }
+
     VkCommandBuffer  RHIImpl::beginSingleTimeCommands() {
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1364,7 +2213,7 @@ namespace segfault::renderer {
         endSingleTimeCommands(commandBuffer);
     }
 
-    void RHIImpl::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
+    void RHIImpl::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
         VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
         VkImageMemoryBarrier barrier{};
@@ -1378,7 +2227,7 @@ namespace segfault::renderer {
         barrier.image = image;
         barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.levelCount = mipLevels;
         barrier.subresourceRange.baseArrayLayer = 0;
         barrier.subresourceRange.layerCount = 1;
 
@@ -1441,8 +2290,6 @@ namespace segfault::renderer {
     }
 
     void RHIImpl::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
         VkBufferImageCopy region{};
         region.bufferOffset = 0;
         region.bufferRowLength = 0;
@@ -1460,13 +2307,19 @@ namespace segfault::renderer {
             1
         };
 
+        copyBufferToImage(buffer, image, std::vector<VkBufferImageCopy>{ region });
+    }
+
+    void RHIImpl::copyBufferToImage(VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy> &regions) {
+        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
         vkCmdCopyBufferToImage(
             commandBuffer,
             buffer,
             image,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            1,
-            &region
+            static_cast<uint32_t>(regions.size()),
+            regions.data()
         );
 
         endSingleTimeCommands(commandBuffer);
@@ -1552,6 +2405,7 @@ namespace segfault::renderer {
         mImpl->createImageViews();
         mImpl->createRenderPass();
         mImpl->createDescriptorSetLayout();
+        mImpl->loadMesh();
         mImpl->createGraphicsPipeline();
         mImpl->createCommandPool(mImpl->queueFamilyIndices);
         mImpl->createDepthResources();
@@ -1559,17 +2413,20 @@ namespace segfault::renderer {
         mImpl->createTextureImage();
         mImpl->createTextureImageView();
         mImpl->createTextureSampler();
-        mImpl->createVertexBuffer();
-        mImpl->createIndexBuffer();
+        mImpl->createMeshPoolBuffers();
         mImpl->createUniformBuffers();
-        mImpl->createDescriptorPool();
         mImpl->createDescriptorSets();
+        mImpl->createClusterCulling();
         mImpl->createCommandBuffers();
         mImpl->createSyncObjects();
+        mImpl->modelTransform = mImpl->transforms.create();
         return true;
     }
 
     bool RHI::shutdown() {
+        // The retired textures may still be in use by the last frames
+        vkDeviceWaitIdle(mImpl->device);
+        mImpl->destroyRetiredTextures(true);
         mImpl->cleanupSwapChain();
         vkDestroyImage(mImpl->device, mImpl->textureImage, nullptr);
         vkDestroySampler(mImpl->device, mImpl->textureSampler, nullptr);
@@ -1580,14 +2437,16 @@ namespace segfault::renderer {
             vkDestroyBuffer(mImpl->device, mImpl->uniformBuffers[i], nullptr);
             vkFreeMemory(mImpl->device, mImpl->uniformBuffersMemory[i], nullptr);
         }
-        vkDestroyDescriptorPool(mImpl->device, mImpl->descriptorPool, nullptr);
-        vkDestroyDescriptorSetLayout(mImpl->device, mImpl->descriptorSetLayout, nullptr);
         vkDestroyBuffer(mImpl->device, mImpl->vertexBuffer, nullptr);
         vkFreeMemory(mImpl->device, mImpl->vertexBufferMemory, nullptr);
 
         vkDestroyBuffer(mImpl->device, mImpl->indexBuffer, nullptr);
         vkFreeMemory(mImpl->device, mImpl->indexBufferMemory, nullptr);
 
+        vkDestroyBuffer(mImpl->device, mImpl->meshletBuffer, nullptr);
+        vkFreeMemory(mImpl->device, mImpl->meshletBufferMemory, nullptr);
+        mImpl->destroyClusterCulling();
+
         for (size_t i = 0; i < RHIImpl::MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroySemaphore(mImpl->device, mImpl->renderFinishedSemaphores[i], nullptr);
             vkDestroySemaphore(mImpl->device, mImpl->imageAvailableSemaphores[i], nullptr);
@@ -1598,7 +2457,8 @@ namespace segfault::renderer {
 
         vkDestroyShaderModule(mImpl->device, mImpl->fragShaderModule, nullptr);
         vkDestroyShaderModule(mImpl->device, mImpl->vertShaderModule, nullptr);
-        vkDestroyPipelineLayout(mImpl->device, mImpl->pipelineLayout, nullptr);
+        mImpl->destroyPipelines();
+        mImpl->layoutCache.destroy();
         vkDestroyRenderPass(mImpl->device, mImpl->renderPass, nullptr);
 
         vkDestroySwapchainKHR(mImpl->device, mImpl->swapChain, nullptr);
@@ -1618,4 +2478,12 @@ namespace segfault::renderer {
         mImpl->framebufferResized = true;
     }
 
+    PipelineHandle RHI::requestPipeline(const PipelineDesc &desc) {
+        return mImpl->requestPipeline(desc);
+    }
+
+    void RHI::setMeshPipeline(PipelineHandle handle) {
+        mImpl->meshPipeline = handle < mImpl->pipelineLibrary.getNumPipelines() ? handle : mImpl->defaultPipeline;
+    }
+
 } // namespace segfault::renderer
@@ -0,0 +1,86 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/clusterculling.h"
+
+#include <cmath>
+
+namespace segfault::renderer {
+
+    ClusterCullParams makeClusterCullParams(const glm::mat4 &viewProj, const glm::mat4 &model, 
+            const glm::vec3 &cameraPosition, uint32_t firstMeshlet, uint32_t numMeshlets) {
+        // The planes of the combined matrix are the frustum in object space
+        const scene::Frustum frustum = scene::Frustum::fromMatrix(viewProj * model);
+        ClusterCullParams params;
+        for (int i = 0; i < 6; ++i) {
+            params.planes[i] = frustum.planes[i];
+        }
+        const glm::vec4 camera = glm::inverse(model) * glm::vec4(cameraPosition, 1.0f);
+        params.cameraPosition = glm::vec4(camera.x, camera.y, camera.z, 1.0f);
+        params.firstMeshlet = firstMeshlet;
+        params.numMeshlets = numMeshlets;
+
+        return params;
+    }
+
+    bool isClusterVisible(const MeshletRecord &meshlet, const ClusterCullParams &params) {
+        if ((params.flags & ClusterCullFrustum) != 0) {
+            for (const glm::vec4 &plane : params.planes) {
+                const float distance = plane.x * meshlet.center[0] + plane.y * meshlet.center[1] + plane.z * meshlet.center[2] + plane.w;
+                if (distance < -meshlet.radius) {
+                    return false;
+                }
+            }
+        }
+
+        if ((params.flags & ClusterCullCone) != 0 && meshlet.coneCutoff < 1.0f) {
+            const float dx = meshlet.coneApex[0] - params.cameraPosition.x;
+            const float dy = meshlet.coneApex[1] - params.cameraPosition.y;
+            const float dz = meshlet.coneApex[2] - params.cameraPosition.z;
+            const float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+            const float d = dx * meshlet.coneAxis[0] + dy * meshlet.coneAxis[1] + dz * meshlet.coneAxis[2];
+            if (d >= meshlet.coneCutoff * length) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    size_t cullClusters(const MeshletRecord *meshlets, const ClusterCullParams &params, DrawIndexedIndirectCommand *commands) {
+        size_t numVisible = 0;
+        for (uint32_t i = 0; i < params.numMeshlets; ++i) {
+            const MeshletRecord &meshlet = meshlets[params.firstMeshlet + i];
+            const bool visible = isClusterVisible(meshlet, params);
+            DrawIndexedIndirectCommand &command = commands[i];
+            command.indexCount = meshlet.numIndices;
+            command.instanceCount = visible ? 1 : 0;
+            command.firstIndex = meshlet.firstIndex;
+            command.vertexOffset = meshlet.vertexOffset;
+            command.firstInstance = 0;
+            numVisible += visible ? 1 : 0;
+        }
+
+        return numVisible;
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,84 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "renderer/meshformat.h"
+
+namespace segfault::renderer {
+
+    /// @brief The layout of VkDrawIndexedIndirectCommand, one is written per cluster.
+    struct DrawIndexedIndirectCommand {
+        uint32_t indexCount{ 0 };       ///< The number of indices.
+        uint32_t instanceCount{ 0 };    ///< The number of instances, zero for culled clusters.
+        uint32_t firstIndex{ 0 };       ///< The first index.
+        int32_t vertexOffset{ 0 };      ///< The value added to every index.
+        uint32_t firstInstance{ 0 };    ///< The first instance.
+    };
+    static_assert(sizeof(DrawIndexedIndirectCommand) == 20, "Unexpected indirect command layout.");
+
+    /// @brief Enables the frustum test of the cluster culling.
+    constexpr uint32_t ClusterCullFrustum = 1u << 0;
+
+    /// @brief Enables the backface cone test of the cluster culling.
+    constexpr uint32_t ClusterCullCone = 1u << 1;
+
+    /// @brief The parameters of the cluster culling in the object space of the mesh. The layout 
+    /// matches the push constants of cluster_cull.comp.
+    struct ClusterCullParams {
+        glm::vec4 planes[6];            ///< The frustum planes in object space.
+        glm::vec4 cameraPosition;       ///< The camera position in object space, w is unused.
+        uint32_t firstMeshlet{ 0 };     ///< The first meshlet to cull.
+        uint32_t numMeshlets{ 0 };      ///< The number of meshlets to cull.
+        uint32_t flags{ ClusterCullFrustum | ClusterCullCone };    ///< The enabled tests.
+        uint32_t reserved{ 0 };         ///< Reserved, must be zero.
+    };
+    static_assert(sizeof(ClusterCullParams) == 128, "The cull parameters must fit the guaranteed push constant size.");
+
+    /// @brief Builds the culling parameters of a mesh instance. The tests run in object space, 
+    /// so the model matrix should only scale uniformly for the cone test to stay exact.
+    /// @param[ in ] viewProj The view projection matrix.
+    /// @param[ in ] model The object to world matrix of the mesh.
+    /// @param[ in ] cameraPosition The camera position in world space.
+    /// @param[ in ] firstMeshlet The first meshlet of the mesh.
+    /// @param[ in ] numMeshlets The number of meshlets of the mesh.
+    /// @return The parameters.
+    SEGFAULT_EXPORT ClusterCullParams makeClusterCullParams(const glm::mat4 &viewProj, const glm::mat4 &model, 
+        const glm::vec3 &cameraPosition, uint32_t firstMeshlet, uint32_t numMeshlets);
+
+    /// @brief Tests a cluster against the frustum and its normal cone.
+    /// @param[ in ] meshlet The cluster.
+    /// @param[ in ] params The culling parameters.
+    /// @return True if the cluster may be visible.
+    SEGFAULT_EXPORT bool isClusterVisible(const MeshletRecord &meshlet, const ClusterCullParams &params);
+
+    /// @brief Culls the clusters on the CPU like cluster_cull.comp does on the GPU. One command is 
+    /// written per cluster, culled clusters get an instance count of zero.
+    /// @param[ in ] meshlets All meshlets, the range of the parameters is culled.
+    /// @param[ in ] params The culling parameters.
+    /// @param[ out ] commands The commands, one per culled meshlet.
+    /// @return The number of visible clusters.
+    SEGFAULT_EXPORT size_t cullClusters(const MeshletRecord *meshlets, const ClusterCullParams &params, 
+        DrawIndexedIndirectCommand *commands);
+
+} // namespace segfault::renderer
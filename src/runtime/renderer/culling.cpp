@@ -0,0 +1,290 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/culling.h"
+#include "core/simd.h"
+#include "core/threadpool.h"
+
+#include <cstring>
+#include <limits>
+
+#if defined(SEGFAULT_CULLING_AVX2) && defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace segfault::renderer {
+
+    using namespace ::segfault::core;
+
+    namespace {
+        // Never visible, whatever the plane distance is
+        constexpr float InvisibleExtent = -1.0e30f;
+
+        // Objects per parallel chunk, a multiple of the padding
+        constexpr size_t ChunkSize = 4096;
+
+        template<bool Boxes>
+        size_t cullKernelScalar(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out) {
+            const float *cx = input.centerX, *cy = input.centerY, *cz = input.centerZ;
+            const float *ex = input.extentX, *ey = input.extentY, *ez = input.extentZ;
+            size_t count = 0;
+            for (size_t i = begin; i < end; ++i) {
+                bool visible = true;
+                for (const float *plane : input.planes) {
+                    const float d = plane[0] * cx[i] + plane[1] * cy[i] + plane[2] * cz[i] + plane[3];
+                    const float r = Boxes ? std::fabs(plane[0]) * ex[i] + std::fabs(plane[1]) * ey[i] + std::fabs(plane[2]) * ez[i] : ex[i];
+                    visible &= d + r >= 0.0f;
+                }
+                out[count] = static_cast<uint32_t>(i);
+                count += visible ? 1 : 0;
+            }
+
+            return count;
+        }
+
+#ifdef SEGFAULT_SIMD_SSE2
+        template<bool Boxes>
+        size_t cullKernelSse2(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out) {
+            const float *cx = input.centerX, *cy = input.centerY, *cz = input.centerZ;
+            const float *ex = input.extentX, *ey = input.extentY, *ez = input.extentZ;
+
+            __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+            for (size_t p = 0; p < 6; ++p) {
+                nx[p] = _mm_set1_ps(input.planes[p][0]);
+                ny[p] = _mm_set1_ps(input.planes[p][1]);
+                nz[p] = _mm_set1_ps(input.planes[p][2]);
+                nw[p] = _mm_set1_ps(input.planes[p][3]);
+                ax[p] = _mm_set1_ps(std::fabs(input.planes[p][0]));
+                ay[p] = _mm_set1_ps(std::fabs(input.planes[p][1]));
+                az[p] = _mm_set1_ps(std::fabs(input.planes[p][2]));
+            }
+
+            const __m128 zero = _mm_setzero_ps();
+            size_t count = 0;
+            for (size_t i = begin; i < end; i += 4) {
+                const __m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+                const __m128 rx = _mm_loadu_ps(ex + i);
+                __m128 ry = zero, rz = zero;
+                if (Boxes) {
+                    ry = _mm_loadu_ps(ey + i);
+                    rz = _mm_loadu_ps(ez + i);
+                }
+
+                __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (size_t p = 0; p < 6; ++p) {
+                    const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], x), _mm_mul_ps(ny[p], y)), _mm_add_ps(_mm_mul_ps(nz[p], z), nw[p]));
+                    const __m128 r = Boxes ? _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], rx), _mm_mul_ps(ay[p], ry)), _mm_mul_ps(az[p], rz)) : rx;
+                    visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+                }
+
+                // Branchless append, every lane is written and the cursor only advances on a hit
+                const int mask = _mm_movemask_ps(visible);
+                const uint32_t index = static_cast<uint32_t>(i);
+                out[count] = index;
+                count += mask & 1;
+                out[count] = index + 1;
+                count += (mask >> 1) & 1;
+                out[count] = index + 2;
+                count += (mask >> 2) & 1;
+                out[count] = index + 3;
+                count += (mask >> 3) & 1;
+            }
+
+            return count;
+        }
+#endif
+
+        bool isAvx2Supported() {
+#if defined(SEGFAULT_CULLING_AVX2) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#elif defined(SEGFAULT_CULLING_AVX2) && (defined(__GNUC__) || defined(__clang__))
+            return __builtin_cpu_supports("avx2") != 0;
+#else
+            return false;
+#endif
+        }
+    } // Anonymous namespace
+
+    CullingBounds::CullingBounds(BoundsType type) :
+            mType(type), mCount(0), mCenterX(), mCenterY(), mCenterZ(), mExtentX(), mExtentY(), mExtentZ() {
+        if (type != BoundsType::Sphere && type != BoundsType::Box) {
+            logMessage(LogType::Error, "Invalid bounds type, using spheres.");
+            mType = BoundsType::Sphere;
+        }
+    }
+
+    void CullingBounds::resize(size_t count) {
+        const size_t padded = (count + Padding - 1) & ~(Padding - 1);
+        const size_t old = mCount;
+        mCount = count;
+        mCenterX.resize(padded, 0.0f);
+        mCenterY.resize(padded, 0.0f);
+        mCenterZ.resize(padded, 0.0f);
+        mExtentX.resize(padded, InvisibleExtent);
+        mExtentY.resize(padded, InvisibleExtent);
+        mExtentZ.resize(padded, InvisibleExtent);
+
+        // Volumes dropped from the end become padding again
+        for (size_t i = count; i < std::min(old, padded); ++i) {
+            mExtentX[i] = mExtentY[i] = mExtentZ[i] = InvisibleExtent;
+        }
+    }
+
+    void CullingBounds::setSphere(size_t index, const glm::vec3 &center, float radius) {
+        if (index >= mCount || mType != BoundsType::Sphere) {
+            logMessage(LogType::Error, "Invalid sphere for culling.");
+            return;
+        }
+
+        mCenterX[index] = center.x;
+        mCenterY[index] = center.y;
+        mCenterZ[index] = center.z;
+        mExtentX[index] = radius;
+    }
+
+    void CullingBounds::setBox(size_t index, const scene::Aabb &box) {
+        if (index >= mCount || mType != BoundsType::Box) {
+            logMessage(LogType::Error, "Invalid box for culling.");
+            return;
+        }
+
+        const glm::vec3 center = box.getCenter();
+        const glm::vec3 extents = box.getExtents();
+        mCenterX[index] = center.x;
+        mCenterY[index] = center.y;
+        mCenterZ[index] = center.z;
+        mExtentX[index] = extents.x;
+        mExtentY[index] = extents.y;
+        mExtentZ[index] = extents.z;
+    }
+
+    FrustumCuller::FrustumCuller() : mPath(CullingPath::Scalar), mChunkCounts() {
+        setPath(CullingPath::Avx2);
+    }
+
+    bool FrustumCuller::isPathSupported(CullingPath path) {
+        switch (path) {
+            case CullingPath::Scalar:
+                return true;
+            case CullingPath::Sse2:
+#ifdef SEGFAULT_SIMD_SSE2
+                return true;
+#else
+                return false;
+#endif
+            case CullingPath::Avx2:
+                return isAvx2Supported();
+            default:
+                return false;
+        }
+    }
+
+    void FrustumCuller::setPath(CullingPath path) {
+        if (path <= CullingPath::Invalid || path >= CullingPath::Count) {
+            logMessage(LogType::Error, "Invalid culling path.");
+            return;
+        }
+
+        while (path > CullingPath::Scalar && !isPathSupported(path)) {
+            path = static_cast<CullingPath>(static_cast<int>(path) - 1);
+        }
+        mPath = path;
+    }
+
+    size_t FrustumCuller::cullRange(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out) const {
+        const bool boxes = input.boxes;
+        switch (mPath) {
+#ifdef SEGFAULT_CULLING_AVX2
+            case CullingPath::Avx2:
+                return cullKernelAvx2(input, begin, end, out);
+#endif
+#ifdef SEGFAULT_SIMD_SSE2
+            case CullingPath::Sse2:
+                return boxes ? cullKernelSse2<true>(input, begin, end, out) : cullKernelSse2<false>(input, begin, end, out);
+#endif
+            default:
+                return boxes ? cullKernelScalar<true>(input, begin, end, out) : cullKernelScalar<false>(input, begin, end, out);
+        }
+    }
+
+    size_t FrustumCuller::cull(const scene::Frustum &frustum, const CullingBounds &bounds, std::vector<uint32_t> &visible,
+            ThreadPool *pool) {
+        const size_t padded = bounds.getPaddedSize();
+        visible.clear();
+        if (bounds.size() == 0) {
+            return 0;
+        }
+
+        CullingKernelInput input{};
+        for (size_t p = 0; p < 6; ++p) {
+            const glm::vec4 &plane = frustum.planes[p];
+            input.planes[p][0] = plane.x;
+            input.planes[p][1] = plane.y;
+            input.planes[p][2] = plane.z;
+            input.planes[p][3] = plane.w;
+        }
+        input.centerX = bounds.getCenterX();
+        input.centerY = bounds.getCenterY();
+        input.centerZ = bounds.getCenterZ();
+        input.extentX = bounds.getExtentX();
+        input.extentY = bounds.getExtentY();
+        input.extentZ = bounds.getExtentZ();
+        input.boxes = bounds.getType() == BoundsType::Box;
+
+        // Every chunk writes into its own slice of the output, the slices are compacted afterwards
+        visible.resize(padded);
+        const size_t numChunks = (padded + ChunkSize - 1) / ChunkSize;
+        mChunkCounts.resize(numChunks);
+        auto process = [&](size_t first, size_t last) {
+            for (size_t chunk = first; chunk < last; ++chunk) {
+                const size_t begin = chunk * ChunkSize;
+                const size_t end = std::min(begin + ChunkSize, padded);
+                mChunkCounts[chunk] = cullRange(input, begin, end, visible.data() + begin);
+            }
+        };
+        if (pool != nullptr && numChunks > 1) {
+            pool->parallelFor(numChunks, 1, process);
+        } else {
+            process(0, numChunks);
+        }
+
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+            const size_t begin = chunk * ChunkSize;
+            if (total != begin && mChunkCounts[chunk] > 0) {
+                std::memmove(visible.data() + total, visible.data() + begin, mChunkCounts[chunk] * sizeof(uint32_t));
+            }
+            total += mChunkCounts[chunk];
+        }
+        visible.resize(total);
+
+        return total;
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,164 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "renderer/culling_kernels.h"
+#include "scene/bounds.h"
+
+#include <vector>
+
+namespace segfault::core {
+    class ThreadPool;
+}
+
+namespace segfault::renderer {
+
+    /// @brief The kind of bounding volume stored in a CullingBounds set.
+    enum class BoundsType {
+        Invalid = -1,
+        Sphere,
+        Box,
+        Count
+    };
+
+    /// @brief The instruction set used by the culling kernel.
+    enum class CullingPath {
+        Invalid = -1,
+        Scalar,
+        Sse2,
+        Avx2,
+        Count
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	Bounding volumes in structure-of-arrays layout for the culling kernels.
+    ///
+    /// Spheres are stored as center and radius, boxes as center and extents. The arrays are 
+    /// padded to a multiple of eight with volumes which are never visible, so the kernels do not 
+    /// need a remainder loop.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT CullingBounds final {
+    public:
+        /// @brief The number of lanes the arrays are padded to.
+        static constexpr size_t Padding = 8;
+
+        /// @brief The class constructor.
+        /// @param[ in ] type The kind of bounding volume.
+        explicit CullingBounds(BoundsType type);
+
+        /// @brief The class destructor.
+        ~CullingBounds() = default;
+
+        /// @brief Resizes the set, new volumes are invisible until set.
+        /// @param[ in ] count The number of volumes.
+        void resize(size_t count);
+
+        /// @brief Sets a bounding sphere.
+        /// @param[ in ] index The index.
+        /// @param[ in ] center The center.
+        /// @param[ in ] radius The radius.
+        void setSphere(size_t index, const glm::vec3 &center, float radius);
+
+        /// @brief Sets a bounding box.
+        /// @param[ in ] index The index.
+        /// @param[ in ] box The box.
+        void setBox(size_t index, const scene::Aabb &box);
+
+        /// @brief Returns the kind of bounding volume.
+        BoundsType getType() const { return mType; }
+
+        /// @brief Returns the number of volumes.
+        size_t size() const { return mCount; }
+
+        /// @brief Returns the padded number of volumes.
+        size_t getPaddedSize() const { return mCenterX.size(); }
+
+        /// @brief Returns the center coordinates.
+        const float *getCenterX() const { return mCenterX.data(); }
+        const float *getCenterY() const { return mCenterY.data(); }
+        const float *getCenterZ() const { return mCenterZ.data(); }
+
+        /// @brief Returns the radii of spheres or the extents of boxes.
+        const float *getExtentX() const { return mExtentX.data(); }
+        const float *getExtentY() const { return mExtentY.data(); }
+        const float *getExtentZ() const { return mExtentZ.data(); }
+
+    private:
+        BoundsType mType;
+        size_t mCount;
+        std::vector<float> mCenterX;
+        std::vector<float> mCenterY;
+        std::vector<float> mCenterZ;
+        std::vector<float> mExtentX;
+        std::vector<float> mExtentY;
+        std::vector<float> mExtentZ;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	Tests bounding volumes against a view frustum and returns the visible indices.
+    ///
+    /// The kernel tests four (SSE2) or eight (AVX2) volumes at once against all six planes and 
+    /// appends the visible indices without branches. Large sets are split into chunks processed 
+    /// on the thread pool, the per-chunk results are compacted into one list in index order.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT FrustumCuller final {
+    public:
+        /// @brief The class constructor, selects the fastest supported path.
+        FrustumCuller();
+
+        /// @brief The class destructor.
+        ~FrustumCuller() = default;
+
+        /// @brief Selects a path, unsupported paths fall back to the next slower one.
+        /// @param[ in ] path The requested path.
+        void setPath(CullingPath path);
+
+        /// @brief Returns the selected path.
+        CullingPath getPath() const { return mPath; }
+
+        /// @brief Returns true if a path is compiled in and supported by the CPU.
+        static bool isPathSupported(CullingPath path);
+
+        /// @brief Culls a set of bounding volumes.
+        /// @param[ in ] frustum The frustum.
+        /// @param[ in ] bounds The bounding volumes.
+        /// @param[ out ] visible Receives the indices of the visible volumes in ascending order.
+        /// @param[ in ] pool The worker threads or nullptr to cull on the calling thread.
+        /// @return The number of visible volumes.
+        size_t cull(const scene::Frustum &frustum, const CullingBounds &bounds, std::vector<uint32_t> &visible,
+                core::ThreadPool *pool = nullptr);
+
+    private:
+        size_t cullRange(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out) const;
+
+    private:
+        CullingPath mPath;
+        std::vector<size_t> mChunkCounts;
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,84 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/culling_kernels.h"
+
+#include <immintrin.h>
+
+namespace segfault::renderer {
+
+    namespace {
+        template<bool Boxes>
+        size_t cullKernel(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out) {
+            const float *cx = input.centerX, *cy = input.centerY, *cz = input.centerZ;
+            const float *ex = input.extentX, *ey = input.extentY, *ez = input.extentZ;
+
+            const __m256 signMask = _mm256_set1_ps(-0.0f);
+            __m256 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+            for (size_t p = 0; p < 6; ++p) {
+                nx[p] = _mm256_set1_ps(input.planes[p][0]);
+                ny[p] = _mm256_set1_ps(input.planes[p][1]);
+                nz[p] = _mm256_set1_ps(input.planes[p][2]);
+                nw[p] = _mm256_set1_ps(input.planes[p][3]);
+                ax[p] = _mm256_andnot_ps(signMask, nx[p]);
+                ay[p] = _mm256_andnot_ps(signMask, ny[p]);
+                az[p] = _mm256_andnot_ps(signMask, nz[p]);
+            }
+
+            const __m256 zero = _mm256_setzero_ps();
+            size_t count = 0;
+            for (size_t i = begin; i < end; i += 8) {
+                const __m256 x = _mm256_loadu_ps(cx + i), y = _mm256_loadu_ps(cy + i), z = _mm256_loadu_ps(cz + i);
+                const __m256 rx = _mm256_loadu_ps(ex + i);
+                __m256 ry = zero, rz = zero;
+                if (Boxes) {
+                    ry = _mm256_loadu_ps(ey + i);
+                    rz = _mm256_loadu_ps(ez + i);
+                }
+
+                __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (size_t p = 0; p < 6; ++p) {
+                    const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[p], x), _mm256_mul_ps(ny[p], y)),
+                            _mm256_add_ps(_mm256_mul_ps(nz[p], z), nw[p]));
+                    const __m256 r = Boxes ? _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], rx), _mm256_mul_ps(ay[p], ry)),
+                            _mm256_mul_ps(az[p], rz)) : rx;
+                    visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_GE_OQ));
+                }
+
+                const int mask = _mm256_movemask_ps(visible);
+                const uint32_t index = static_cast<uint32_t>(i);
+                for (uint32_t lane = 0; lane < 8; ++lane) {
+                    out[count] = index + lane;
+                    count += (mask >> lane) & 1;
+                }
+            }
+
+            return count;
+        }
+    } // Anonymous namespace
+
+    size_t cullKernelAvx2(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out) {
+        return input.boxes ? cullKernel<true>(input, begin, end, out) :
+                cullKernel<false>(input, begin, end, out);
+    }
+
+} // namespace segfault::renderer
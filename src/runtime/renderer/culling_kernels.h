@@ -0,0 +1,53 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace segfault::renderer {
+
+    /// @brief The input of a culling kernel.
+    ///
+    /// Plain data only: culling_avx2.cpp is built with AVX2 code generation and must not include 
+    /// headers with inline functions, the linker could pick its copies for the whole program.
+    struct CullingKernelInput {
+        float planes[6][4];
+        const float *centerX;
+        const float *centerY;
+        const float *centerZ;
+        const float *extentX;
+        const float *extentY;
+        const float *extentZ;
+        bool boxes;
+    };
+
+    /// @brief The AVX2 kernel, appends the indices of the visible volumes in [begin, end).
+    /// @param[ in ] input The planes and volumes.
+    /// @param[ in ] begin The first volume, a multiple of eight.
+    /// @param[ in ] end The end of the range, a multiple of eight.
+    /// @param[ out ] out Receives the visible indices, must hold end - begin entries.
+    /// @return The number of visible volumes.
+    size_t cullKernelAvx2(const CullingKernelInput &input, size_t begin, size_t end, uint32_t *out);
+
+} // namespace segfault::renderer
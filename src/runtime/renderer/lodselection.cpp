@@ -0,0 +1,77 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/lodselection.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace segfault::renderer {
+
+    LodView makeLodView(const glm::vec3 &cameraPosition, float fovY, float viewportHeight, float nearPlane) {
+        LodView view;
+        view.cameraPosition = cameraPosition;
+        view.projectionScale = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+        view.nearPlane = nearPlane;
+
+        return view;
+    }
+
+    float computeProjectedError(float error, const scene::Aabb &bounds, const glm::mat4 &model, const LodView &view) {
+        // The largest axis scale keeps the error conservative for non-uniform scales
+        const float scale = std::sqrt(std::max({ glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+            glm::dot(glm::vec3(model[1]), glm::vec3(model[1])), glm::dot(glm::vec3(model[2]), glm::vec3(model[2])) }));
+        const glm::vec3 center = glm::vec3(model * glm::vec4(bounds.getCenter(), 1.0f));
+        const float radius = glm::length(bounds.getExtents()) * scale;
+        const float distance = std::max(glm::length(center - view.cameraPosition) - radius, view.nearPlane);
+
+        return error * scale * view.projectionScale / distance;
+    }
+
+    uint32_t selectLod(const PooledMesh &mesh, const glm::mat4 &model, const LodView &view, const LodSettings &settings, 
+            uint32_t currentLod) {
+        if (mesh.numLods <= 1) {
+            return 0;
+        }
+
+        // The errors grow with the level, so walking from the current level finds the answer
+        const float coarser = settings.pixelError * (1.0f - settings.hysteresis);
+        const float finer = settings.pixelError * (1.0f + settings.hysteresis);
+        uint32_t lod = std::min(currentLod, mesh.numLods - 1);
+        while (lod + 1 < mesh.numLods && computeProjectedError(mesh.lods[lod + 1].error, mesh.bounds, model, view) <= coarser) {
+            ++lod;
+        }
+        while (lod > 0 && computeProjectedError(mesh.lods[lod].error, mesh.bounds, model, view) > finer) {
+            --lod;
+        }
+
+        return lod;
+    }
+
+    void selectLods(const PooledMesh &mesh, const glm::mat4 *models, size_t count, const LodView &view, 
+            const LodSettings &settings, uint32_t *lods) {
+        for (size_t i = 0; i < count; ++i) {
+            lods[i] = selectLod(mesh, models[i], view, settings, lods[i]);
+        }
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "renderer/meshpool.h"
+
+namespace segfault::renderer {
+
+    /// @brief The camera parameters projecting object space errors into pixels.
+    struct LodView {
+        glm::vec3 cameraPosition{ 0.0f };   ///< The camera position in world space.
+        float projectionScale{ 1.0f };      ///< The size in pixels of one unit at distance one.
+        float nearPlane{ 0.1f };            ///< The near plane distance, limits the projection of close objects.
+    };
+
+    /// @brief The tuning of the level of detail selection.
+    struct LodSettings {
+        float pixelError{ 1.0f };           ///< The accepted projected simplification error in pixels.
+        float hysteresis{ 0.25f };          ///< The relative band around the threshold in which a level is kept.
+    };
+
+    /// @brief Builds the view of a perspective camera.
+    /// @param[ in ] cameraPosition The camera position in world space.
+    /// @param[ in ] fovY The vertical field of view in radians.
+    /// @param[ in ] viewportHeight The height of the viewport in pixels.
+    /// @param[ in ] nearPlane The near plane distance.
+    /// @return The view.
+    SEGFAULT_EXPORT LodView makeLodView(const glm::vec3 &cameraPosition, float fovY, float viewportHeight, float nearPlane);
+
+    /// @brief Projects an object space error of a mesh instance onto the screen. The distance 
+    /// is taken to the nearest point of the bounding sphere, so the result is an upper bound.
+    /// @param[ in ] error The object space error.
+    /// @param[ in ] bounds The object space bounds of the mesh.
+    /// @param[ in ] model The object to world matrix of the instance.
+    /// @param[ in ] view The view.
+    /// @return The error in pixels.
+    SEGFAULT_EXPORT float computeProjectedError(float error, const scene::Aabb &bounds, const glm::mat4 &model, const LodView &view);
+
+    /// @brief Selects the detail level of a mesh instance. The coarsest level whose projected 
+    /// error stays below the threshold is chosen, but the current level is kept while the error 
+    /// stays within the hysteresis band, so instances near a switching distance do not flicker 
+    /// between two levels from frame to frame.
+    /// @param[ in ] mesh The pooled mesh.
+    /// @param[ in ] model The object to world matrix of the instance.
+    /// @param[ in ] view The view.
+    /// @param[ in ] settings The tuning.
+    /// @param[ in ] currentLod The level selected in the previous frame.
+    /// @return The level to draw.
+    SEGFAULT_EXPORT uint32_t selectLod(const PooledMesh &mesh, const glm::mat4 &model, const LodView &view, 
+        const LodSettings &settings, uint32_t currentLod);
+
+    /// @brief Selects the detail levels of many instances of one mesh.
+    /// @param[ in ] mesh The pooled mesh.
+    /// @param[ in ] models The object to world matrices of the instances.
+    /// @param[ in ] count The number of instances.
+    /// @param[ in ] view The view.
+    /// @param[ in ] settings The tuning.
+    /// @param[ inout ] lods The levels of the previous frame, receives the new levels.
+    SEGFAULT_EXPORT void selectLods(const PooledMesh &mesh, const glm::mat4 *models, size_t count, const LodView &view, 
+        const LodSettings &settings, uint32_t *lods);
+
+} // namespace segfault::renderer
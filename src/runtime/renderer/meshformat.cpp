@@ -0,0 +1,391 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/meshformat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        uint64_t alignOffset(uint64_t offset) {
+            return (offset + MeshDataAlignment - 1) & ~static_cast<uint64_t>(MeshDataAlignment - 1);
+        }
+
+        template<class TIndex>
+        bool indicesInRange(const uint8_t *data, uint32_t numIndices, uint32_t numVertices) {
+            for (uint32_t i = 0; i < numIndices; ++i) {
+                TIndex index;
+                memcpy(&index, data + i * sizeof(TIndex), sizeof(TIndex));
+                if (index >= numVertices) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    } // namespace
+
+    uint32_t getMeshVertexStride(MeshVertexFormat format) {
+        switch (format) {
+            case MeshVertexFormat::PosColorUv:
+                return sizeof(MeshVertex);
+            case MeshVertexFormat::PackedHalf:
+            case MeshVertexFormat::PackedSnorm16:
+                return sizeof(PackedMeshVertex);
+            default:
+                break;
+        }
+        return 0;
+    }
+
+    size_t getMeshVertexAttributes(MeshVertexFormat format, MeshVertexAttribute *attributes) {
+        if (attributes == nullptr) {
+            return 0;
+        }
+
+        switch (format) {
+            case MeshVertexFormat::PosColorUv:
+                attributes[0] = { VertexSemantic::Position, VertexAttributeType::Float3, offsetof(MeshVertex, pos) };
+                attributes[1] = { VertexSemantic::Color, VertexAttributeType::Float3, offsetof(MeshVertex, color) };
+                attributes[2] = { VertexSemantic::TexCoord, VertexAttributeType::Float2, offsetof(MeshVertex, texCoord) };
+                return 3;
+            case MeshVertexFormat::PackedHalf:
+            case MeshVertexFormat::PackedSnorm16:
+                attributes[0] = { VertexSemantic::Position, 
+                    format == MeshVertexFormat::PackedHalf ? VertexAttributeType::Half4 : VertexAttributeType::Snorm16x4, 
+                    offsetof(PackedMeshVertex, pos) };
+                attributes[1] = { VertexSemantic::Color, VertexAttributeType::Unorm8x4, offsetof(PackedMeshVertex, color) };
+                attributes[2] = { VertexSemantic::TexCoord, VertexAttributeType::Half2, offsetof(PackedMeshVertex, texCoord) };
+                attributes[3] = { VertexSemantic::Normal, VertexAttributeType::Snorm16x2, offsetof(PackedMeshVertex, normal) };
+                return 4;
+            default:
+                break;
+        }
+        return 0;
+    }
+
+    uint16_t packHalf(float value) {
+        uint32_t bits{ 0 };
+        memcpy(&bits, &value, sizeof(bits));
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        const uint32_t absBits = bits & 0x7fffffffu;
+        if (absBits >= 0x7f800000u) {
+            // Infinity stays infinity, NaN stays a quiet NaN
+            return static_cast<uint16_t>(sign | 0x7c00u | (absBits > 0x7f800000u ? 0x200u : 0u));
+        }
+        if (absBits >= 0x477ff000u) {
+            // Rounds to 65520 or more, which is beyond the largest half
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+        if (absBits < 0x38800000u) {
+            // Below the smallest normal half, the subnormal is the value in units of 2^-24
+            float absValue{ 0.0f };
+            memcpy(&absValue, &absBits, sizeof(absValue));
+            return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(absValue * 16777216.0f)));
+        }
+
+        // Rebias the exponent from 127 to 15 and round the dropped 13 mantissa bits to nearest even
+        uint32_t half = (absBits - 0x38000000u) >> 13;
+        const uint32_t remainder = absBits & 0x1fffu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0)) {
+            ++half;
+        }
+
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    float unpackHalf(uint16_t value) {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1fu;
+        const uint32_t mantissa = value & 0x3ffu;
+        if (exponent == 0) {
+            const float result = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign != 0 ? -result : result;
+        }
+
+        const uint32_t bits = exponent == 0x1fu ? (sign | 0x7f800000u | (mantissa << 13)) : 
+            (sign | ((exponent + 112u) << 23) | (mantissa << 13));
+        float result{ 0.0f };
+        memcpy(&result, &bits, sizeof(result));
+
+        return result;
+    }
+
+    int16_t packSnorm16(float value) {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    float unpackSnorm16(int16_t value) {
+        return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+    }
+
+    void encodeOctahedral(const glm::vec3 &normal, int16_t encoded[2]) {
+        const float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+        if (length <= 0.0f) {
+            encoded[0] = 0;
+            encoded[1] = 0;
+            return;
+        }
+
+        // Project onto the octahedron and fold the lower half over the diagonals
+        float x = normal.x / length, y = normal.y / length;
+        if (normal.z < 0.0f) {
+            const float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+        encoded[0] = packSnorm16(x);
+        encoded[1] = packSnorm16(y);
+    }
+
+    glm::vec3 decodeOctahedral(const int16_t encoded[2]) {
+        const float x = unpackSnorm16(encoded[0]);
+        const float y = unpackSnorm16(encoded[1]);
+        glm::vec3 normal(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+        if (normal.z < 0.0f) {
+            normal.x = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            normal.y = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        }
+
+        return normal / std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    }
+
+    bool MeshData::create(MeshVertexFormat format, const void *vertices, size_t numVertices, 
+            const uint32_t *indices, size_t numIndices, const scene::Aabb &bounds,
+            const glm::vec3 &positionScale, const glm::vec3 &positionOffset,
+            const MeshletRecord *meshlets, size_t numMeshlets, const MeshLodRecord *lods, size_t numLods) {
+        clear();
+        const uint32_t stride = getMeshVertexStride(format);
+        if (stride == 0 || vertices == nullptr || indices == nullptr || numVertices == 0 || 
+                numIndices == 0 || numIndices % 3 != 0 || numVertices > 0xffffffffu || numIndices > 0xffffffffu ||
+                (meshlets == nullptr && numMeshlets != 0) || (lods == nullptr && numLods != 0) || numLods > MaxMeshLods) {
+            logMessage(LogType::Error, "Invalid mesh data.");
+            return false;
+        }
+
+        // The offsets are stored as 32 bit values, lay the blob out in 64 bit and reject meshes 
+        // that do not fit instead of wrapping around
+        const uint64_t indexSize = numVertices <= 0xffff ? 2 : 4;
+        const uint64_t vertexDataOffset = alignOffset(sizeof(MeshFileHeader));
+        const uint64_t indexDataOffset = alignOffset(vertexDataOffset + static_cast<uint64_t>(numVertices) * stride);
+        const uint64_t meshletDataOffset = alignOffset(indexDataOffset + static_cast<uint64_t>(numIndices) * indexSize);
+        const uint64_t lodDataOffset = alignOffset(meshletDataOffset + static_cast<uint64_t>(numMeshlets) * sizeof(MeshletRecord));
+        const uint64_t blobSize = lodDataOffset + static_cast<uint64_t>(numLods) * sizeof(MeshLodRecord);
+        if (numMeshlets > 0xffffffffu || blobSize > 0xffffffffu) {
+            logMessage(LogType::Error, "Mesh is too large.");
+            return false;
+        }
+
+        mHeader = MeshFileHeader{};
+        mHeader.vertexFormat = static_cast<uint8_t>(format);
+        mHeader.indexSize = static_cast<uint8_t>(indexSize);
+        mHeader.numVertices = static_cast<uint32_t>(numVertices);
+        mHeader.numIndices = static_cast<uint32_t>(numIndices);
+        mHeader.vertexDataOffset = static_cast<uint32_t>(vertexDataOffset);
+        mHeader.indexDataOffset = static_cast<uint32_t>(indexDataOffset);
+        mHeader.numMeshlets = static_cast<uint32_t>(numMeshlets);
+        mHeader.meshletDataOffset = static_cast<uint32_t>(meshletDataOffset);
+        mHeader.numLods = static_cast<uint32_t>(numLods);
+        mHeader.lodDataOffset = static_cast<uint32_t>(lodDataOffset);
+        for (int i = 0; i < 3; ++i) {
+            mHeader.boundsMin[i] = bounds.min[i];
+            mHeader.boundsMax[i] = bounds.max[i];
+            mHeader.positionScale[i] = positionScale[i];
+            mHeader.positionOffset[i] = positionOffset[i];
+        }
+
+        mBlob.assign(static_cast<size_t>(blobSize), 0);
+        memcpy(mBlob.data(), &mHeader, sizeof(mHeader));
+        memcpy(mBlob.data() + mHeader.vertexDataOffset, vertices, numVertices * stride);
+        uint8_t *indexData = mBlob.data() + mHeader.indexDataOffset;
+        for (size_t i = 0; i < numIndices; ++i) {
+            if (indices[i] >= numVertices) {
+                logMessage(LogType::Error, "Mesh index out of range.");
+                clear();
+                return false;
+            }
+            if (mHeader.indexSize == 2) {
+                const uint16_t index = static_cast<uint16_t>(indices[i]);
+                memcpy(indexData + i * sizeof(uint16_t), &index, sizeof(index));
+            } else {
+                memcpy(indexData + i * sizeof(uint32_t), &indices[i], sizeof(uint32_t));
+            }
+        }
+        if (numMeshlets != 0) {
+            memcpy(mBlob.data() + mHeader.meshletDataOffset, meshlets, numMeshlets * sizeof(MeshletRecord));
+        }
+        if (numLods != 0) {
+            memcpy(mBlob.data() + mHeader.lodDataOffset, lods, numLods * sizeof(MeshLodRecord));
+        }
+        if (!validate(mBlob.data(), mBlob.size())) {
+            logMessage(LogType::Error, "Invalid meshlets or detail levels.");
+            clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MeshData::load(const uint8_t *data, size_t size) {
+        clear();
+        if (!isBinary(data, size) || size < sizeof(MeshFileHeader)) {
+            return false;
+        }
+
+        memcpy(&mHeader, data, sizeof(mHeader));
+        if (mHeader.version != MeshFileVersion) {
+            logMessage(LogType::Error, "Unsupported mesh version, rebake the asset.");
+            clear();
+            return false;
+        }
+
+        if (!validate(data, size)) {
+            logMessage(LogType::Error, "Mesh blob is corrupt.");
+            clear();
+            return false;
+        }
+        mBlob.assign(data, data + size);
+
+        return true;
+    }
+
+    bool MeshData::save(std::vector<uint8_t> &blob) const {
+        if (mBlob.empty()) {
+            return false;
+        }
+
+        blob = mBlob;
+
+        return true;
+    }
+
+    bool MeshData::isBinary(const uint8_t *data, size_t size) {
+        if (data == nullptr || size < sizeof(uint32_t)) {
+            return false;
+        }
+
+        uint32_t magic{ 0 };
+        memcpy(&magic, data, sizeof(magic));
+
+        return magic == MeshFileMagic;
+    }
+
+    scene::Aabb MeshData::getBounds() const {
+        return scene::Aabb(glm::vec3(mHeader.boundsMin[0], mHeader.boundsMin[1], mHeader.boundsMin[2]),
+            glm::vec3(mHeader.boundsMax[0], mHeader.boundsMax[1], mHeader.boundsMax[2]));
+    }
+
+    MeshletRecord MeshData::getMeshlet(uint32_t index) const {
+        MeshletRecord meshlet;
+        memcpy(&meshlet, getMeshletData() + static_cast<size_t>(index) * sizeof(MeshletRecord), sizeof(meshlet));
+
+        return meshlet;
+    }
+
+    MeshLodRecord MeshData::getLod(uint32_t index) const {
+        MeshLodRecord lod;
+        memcpy(&lod, mBlob.data() + mHeader.lodDataOffset + static_cast<size_t>(index) * sizeof(MeshLodRecord), sizeof(lod));
+
+        return lod;
+    }
+
+    glm::vec3 MeshData::getPositionScale() const {
+        return glm::vec3(mHeader.positionScale[0], mHeader.positionScale[1], mHeader.positionScale[2]);
+    }
+
+    glm::vec3 MeshData::getPositionOffset() const {
+        return glm::vec3(mHeader.positionOffset[0], mHeader.positionOffset[1], mHeader.positionOffset[2]);
+    }
+
+    void MeshData::clear() {
+        mHeader = MeshFileHeader{};
+        mBlob.clear();
+    }
+
+    bool MeshData::validate(const uint8_t *data, size_t size) const {
+        const uint32_t stride = getMeshVertexStride(getVertexFormat());
+        if (stride == 0 || (mHeader.indexSize != 2 && mHeader.indexSize != 4)) {
+            return false;
+        }
+        if (mHeader.numVertices == 0 || mHeader.numIndices == 0 || mHeader.numIndices % 3 != 0) {
+            return false;
+        }
+        if (mHeader.vertexDataOffset < sizeof(MeshFileHeader) || mHeader.vertexDataOffset % MeshDataAlignment != 0 ||
+                mHeader.indexDataOffset % MeshDataAlignment != 0) {
+            return false;
+        }
+
+        const size_t vertexEnd = static_cast<size_t>(mHeader.vertexDataOffset) + static_cast<size_t>(mHeader.numVertices) * stride;
+        const size_t indexEnd = static_cast<size_t>(mHeader.indexDataOffset) + static_cast<size_t>(mHeader.numIndices) * mHeader.indexSize;
+        if (vertexEnd > mHeader.indexDataOffset || indexEnd > size) {
+            return false;
+        }
+
+        if (mHeader.numMeshlets != 0) {
+            const size_t meshletEnd = static_cast<size_t>(mHeader.meshletDataOffset) + static_cast<size_t>(mHeader.numMeshlets) * sizeof(MeshletRecord);
+            if (mHeader.meshletDataOffset < indexEnd || mHeader.meshletDataOffset % MeshDataAlignment != 0 || meshletEnd > size) {
+                return false;
+            }
+            for (uint32_t i = 0; i < mHeader.numMeshlets; ++i) {
+                MeshletRecord meshlet;
+                memcpy(&meshlet, data + mHeader.meshletDataOffset + i * sizeof(MeshletRecord), sizeof(meshlet));
+                if (meshlet.numIndices == 0 || meshlet.numIndices % 3 != 0 || meshlet.numIndices > MaxMeshletTriangles * 3 ||
+                        meshlet.firstIndex > mHeader.numIndices || meshlet.numIndices > mHeader.numIndices - meshlet.firstIndex ||
+                        meshlet.numVertices > MaxMeshletVertices || meshlet.vertexOffset != 0) {
+                    return false;
+                }
+            }
+        }
+
+        if (mHeader.numLods != 0) {
+            const size_t lodEnd = static_cast<size_t>(mHeader.lodDataOffset) + static_cast<size_t>(mHeader.numLods) * sizeof(MeshLodRecord);
+            if (mHeader.numLods > MaxMeshLods || mHeader.lodDataOffset < indexEnd || mHeader.lodDataOffset % MeshDataAlignment != 0 || lodEnd > size) {
+                return false;
+            }
+            float error = 0.0f;
+            for (uint32_t i = 0; i < mHeader.numLods; ++i) {
+                MeshLodRecord lod;
+                memcpy(&lod, data + mHeader.lodDataOffset + i * sizeof(MeshLodRecord), sizeof(lod));
+                if (lod.numIndices == 0 || lod.numIndices % 3 != 0 || lod.firstIndex > mHeader.numIndices ||
+                        lod.numIndices > mHeader.numIndices - lod.firstIndex || lod.firstMeshlet > mHeader.numMeshlets ||
+                        lod.numMeshlets > mHeader.numMeshlets - lod.firstMeshlet || !(lod.error >= error)) {
+                    return false;
+                }
+                error = lod.error;
+            }
+        }
+
+        // The index data goes to the GPU as it is, an index out of range would read outside of the vertex buffer
+        const uint8_t *indexData = data + mHeader.indexDataOffset;
+        return mHeader.indexSize == 2 ? indicesInRange<uint16_t>(indexData, mHeader.numIndices, mHeader.numVertices) :
+            indicesInRange<uint32_t>(indexData, mHeader.numIndices, mHeader.numVertices);
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,316 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "scene/bounds.h"
+
+#include <vector>
+
+namespace segfault::renderer {
+
+    /// @brief The magic number of a baked mesh, "SFMS" in little endian.
+    constexpr uint32_t MeshFileMagic = 0x534d4653;
+
+    /// @brief The version of the baked mesh format.
+    constexpr uint16_t MeshFileVersion = 4;
+
+    /// @brief The alignment of the vertex and index data inside a baked mesh.
+    constexpr uint32_t MeshDataAlignment = 16;
+
+    /// @brief The vertex layouts of a baked mesh.
+    enum class MeshVertexFormat : int32_t {
+        Invalid = -1,
+        PosColorUv,     ///< Three floats position, three floats color, two floats uv, see MeshVertex.
+        PackedHalf,     ///< Half float position, see PackedMeshVertex.
+        PackedSnorm16,  ///< Snorm16 position, see PackedMeshVertex.
+        Count
+    };
+
+    /// @brief The meaning of a vertex attribute, the value is the shader input location.
+    enum class VertexSemantic : int32_t {
+        Invalid = -1,
+        Position,
+        Color,
+        TexCoord,
+        Normal,
+        Count
+    };
+
+    /// @brief The data type of a vertex attribute as it is fetched by the GPU.
+    enum class VertexAttributeType : int32_t {
+        Invalid = -1,
+        Float2,
+        Float3,
+        Half2,
+        Half4,
+        Snorm16x2,
+        Snorm16x4,
+        Unorm8x4,
+        Count
+    };
+
+    /// @brief Describes one attribute of a vertex format.
+    struct MeshVertexAttribute {
+        VertexSemantic semantic{ VertexSemantic::Invalid };         ///< The meaning of the attribute.
+        VertexAttributeType type{ VertexAttributeType::Invalid };   ///< The data type of the attribute.
+        uint32_t offset{ 0 };                                       ///< The offset from the start of the vertex.
+    };
+
+    /// @brief The maximum number of attributes of a vertex format.
+    constexpr size_t MaxMeshVertexAttributes = static_cast<size_t>(VertexSemantic::Count);
+
+    /// @brief Returns the size of a vertex in bytes.
+    /// @param[ in ] format The vertex format.
+    /// @return The stride, 0 for invalid formats.
+    SEGFAULT_EXPORT uint32_t getMeshVertexStride(MeshVertexFormat format);
+
+    /// @brief Returns the attributes of a vertex format.
+    /// @param[ in ] format The vertex format.
+    /// @param[ out ] attributes Receives up to MaxMeshVertexAttributes attributes.
+    /// @return The number of attributes, 0 for invalid formats.
+    SEGFAULT_EXPORT size_t getMeshVertexAttributes(MeshVertexFormat format, MeshVertexAttribute *attributes);
+
+    /// @brief The vertex of the PosColorUv format, binary compatible with the renderer vertex.
+    struct MeshVertex {
+        float pos[3];                           ///< The position.
+        float color[3];                         ///< The color.
+        float texCoord[2];                      ///< The texture coordinate.
+    };
+    static_assert(sizeof(MeshVertex) == 32, "Unexpected mesh vertex layout.");
+
+    /// @brief The vertex of the packed formats. The position is normalized to [-1, 1] over the 
+    /// mesh bounds and restored by the dequantization transform of the mesh.
+    struct PackedMeshVertex {
+        uint16_t pos[4];                        ///< The half or snorm16 position bits, w is one.
+        int16_t normal[2];                      ///< The octahedral encoded normal.
+        uint8_t color[4];                       ///< The color.
+        uint16_t texCoord[2];                   ///< The half float texture coordinate.
+    };
+    static_assert(sizeof(PackedMeshVertex) == 20, "Unexpected packed mesh vertex layout.");
+
+    /// @brief Converts a float to a half float with round to nearest even.
+    SEGFAULT_EXPORT uint16_t packHalf(float value);
+
+    /// @brief Converts a half float to a float.
+    SEGFAULT_EXPORT float unpackHalf(uint16_t value);
+
+    /// @brief Converts a float in [-1, 1] to snorm16, the value is clamped.
+    SEGFAULT_EXPORT int16_t packSnorm16(float value);
+
+    /// @brief Converts a snorm16 to a float in [-1, 1].
+    SEGFAULT_EXPORT float unpackSnorm16(int16_t value);
+
+    /// @brief Encodes a unit vector by the octahedral mapping, a zero vector maps to +z.
+    /// @param[ in ] normal The normal.
+    /// @param[ out ] encoded The two snorm16 components.
+    SEGFAULT_EXPORT void encodeOctahedral(const glm::vec3 &normal, int16_t encoded[2]);
+
+    /// @brief Decodes an octahedral encoded unit vector.
+    /// @param[ in ] encoded The two snorm16 components.
+    /// @return The normalized vector.
+    SEGFAULT_EXPORT glm::vec3 decodeOctahedral(const int16_t encoded[2]);
+
+    /// @brief The limits of a meshlet, chosen to fit the mesh shader limits of common GPUs.
+    constexpr uint32_t MaxMeshletVertices = 64;
+    constexpr uint32_t MaxMeshletTriangles = 124;
+
+    /// @brief A cluster of up to MaxMeshletTriangles triangles using up to MaxMeshletVertices 
+    /// vertices, with its bounding sphere and normal cone in object space. The layout matches 
+    /// the std430 meshlet struct of the cluster culling shader.
+    ///
+    /// The cluster faces away from a camera at position c if 
+    /// dot(normalize(coneApex - c), coneAxis) >= coneCutoff.
+    struct MeshletRecord {
+        float center[3]{ 0.0f, 0.0f, 0.0f };   ///< The center of the bounding sphere.
+        float radius{ 0.0f };                   ///< The radius of the bounding sphere.
+        float coneApex[3]{ 0.0f, 0.0f, 0.0f }; ///< The apex of the normal cone.
+        float coneCutoff{ 1.0f };               ///< The cosine of the cone angle, 1 disables the cone test.
+        float coneAxis[3]{ 0.0f, 0.0f, 1.0f }; ///< The axis of the normal cone.
+        uint32_t reserved{ 0 };                 ///< Reserved, must be zero.
+        uint32_t firstIndex{ 0 };               ///< The first index of the cluster triangles.
+        uint32_t numIndices{ 0 };               ///< The number of indices.
+        int32_t vertexOffset{ 0 };              ///< The base vertex, zero in baked meshes and set by the mesh pool.
+        uint32_t numVertices{ 0 };              ///< The number of unique vertices.
+    };
+    static_assert(sizeof(MeshletRecord) == 64, "Unexpected meshlet layout.");
+
+    /// @brief The maximum number of detail levels of a mesh.
+    constexpr uint32_t MaxMeshLods = 8;
+
+    /// @brief A level of detail of a mesh. All levels share the vertex data, each one is an own 
+    /// triangle list in the index data with its own meshlets. Level 0 is the full detail mesh.
+    struct MeshLodRecord {
+        uint32_t firstIndex{ 0 };       ///< The first index of the level.
+        uint32_t numIndices{ 0 };       ///< The number of indices.
+        uint32_t firstMeshlet{ 0 };     ///< The first meshlet of the level.
+        uint32_t numMeshlets{ 0 };      ///< The number of meshlets, zero if the mesh has none.
+        float error{ 0.0f };            ///< The object space deviation from level 0, never decreasing.
+        uint32_t reserved[3]{ 0, 0, 0 };///< Reserved, must be zero.
+    };
+    static_assert(sizeof(MeshLodRecord) == 32, "Unexpected lod layout.");
+
+    /// @brief The header of a baked mesh. The vertex and index data follow at the given offsets 
+    /// and are laid out exactly as the GPU consumes them.
+    struct MeshFileHeader {
+        uint32_t magic{ MeshFileMagic };             ///< The magic number, must be MeshFileMagic.
+        uint16_t version{ MeshFileVersion };         ///< The format version.
+        uint8_t vertexFormat{ 0 };                   ///< The MeshVertexFormat.
+        uint8_t indexSize{ 0 };                      ///< The size of an index, 2 or 4 bytes.
+        uint32_t numVertices{ 0 };                   ///< The number of vertices.
+        uint32_t numIndices{ 0 };                    ///< The number of indices, a multiple of three.
+        uint32_t vertexDataOffset{ 0 };              ///< The offset of the vertex data from the start of the blob.
+        uint32_t indexDataOffset{ 0 };               ///< The offset of the index data from the start of the blob.
+        float boundsMin[3]{ 0.0f, 0.0f, 0.0f };      ///< The minimum of the object space bounds.
+        float boundsMax[3]{ 0.0f, 0.0f, 0.0f };      ///< The maximum of the object space bounds.
+        float positionScale[3]{ 1.0f, 1.0f, 1.0f };  ///< The scale restoring quantized positions.
+        float positionOffset[3]{ 0.0f, 0.0f, 0.0f }; ///< The offset applied after the scale.
+        uint32_t numMeshlets{ 0 };                   ///< The number of meshlets, may be zero.
+        uint32_t meshletDataOffset{ 0 };             ///< The offset of the meshlet records from the start of the blob.
+        uint32_t numLods{ 0 };                       ///< The number of detail levels, zero means the whole index data.
+        uint32_t lodDataOffset{ 0 };                 ///< The offset of the lod records from the start of the blob.
+    };
+    static_assert(sizeof(MeshFileHeader) == 88, "Unexpected mesh header layout.");
+
+    //---------------------------------------------------------------------------------------------
+    /// @class MeshData
+    /// @brief A baked mesh ready for upload.
+    ///
+    /// The blob is kept as it is, the vertex and index data point into it and are copied into 
+    /// the GPU buffers without any conversion. Meshes are built and optimized by the assetbaker.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT MeshData final {
+    public:
+        /// @brief The class constructor.
+        MeshData() = default;
+
+        /// @brief The class destructor.
+        ~MeshData() = default;
+
+        /// @brief Builds the mesh from vertex and index data. 16 bit indices are used when all 
+        /// vertices can be addressed by them.
+        /// @param[ in ] format The vertex format of the data.
+        /// @param[ in ] vertices The vertex data, numVertices times the format stride.
+        /// @param[ in ] numVertices The number of vertices.
+        /// @param[ in ] indices The triangle list.
+        /// @param[ in ] numIndices The number of indices, must be a multiple of three.
+        /// @param[ in ] bounds The object space bounds.
+        /// @param[ in ] positionScale The scale restoring the stored positions.
+        /// @param[ in ] positionOffset The offset applied after the scale.
+        /// @param[ in ] meshlets The meshlets covering the index data, may be nullptr.
+        /// @param[ in ] numMeshlets The number of meshlets.
+        /// @param[ in ] lods The detail levels, sorted from full to lowest detail, may be nullptr.
+        /// @param[ in ] numLods The number of detail levels.
+        /// @return True if the data describes a valid mesh, false otherwise.
+        bool create(MeshVertexFormat format, const void *vertices, size_t numVertices, 
+            const uint32_t *indices, size_t numIndices, const scene::Aabb &bounds,
+            const glm::vec3 &positionScale = glm::vec3(1.0f), const glm::vec3 &positionOffset = glm::vec3(0.0f),
+            const MeshletRecord *meshlets = nullptr, size_t numMeshlets = 0,
+            const MeshLodRecord *lods = nullptr, size_t numLods = 0);
+
+        /// @brief Loads the mesh from a baked blob.
+        /// @param[ in ] data The blob data.
+        /// @param[ in ] size The size of the blob in bytes.
+        /// @return True if the blob is a valid mesh, false otherwise.
+        bool load(const uint8_t *data, size_t size);
+
+        /// @brief Returns the baked blob.
+        /// @param[ out ] blob The blob to write to.
+        /// @return True if the mesh was serialized, false if the mesh is empty.
+        bool save(std::vector<uint8_t> &blob) const;
+
+        /// @brief Checks if the data starts with the baked mesh magic.
+        /// @param[ in ] data The data to check.
+        /// @param[ in ] size The size of the data in bytes.
+        /// @return True if the data is a baked mesh.
+        static bool isBinary(const uint8_t *data, size_t size);
+
+        /// @brief Returns true if no mesh is loaded.
+        bool isEmpty() const { return mBlob.empty(); }
+
+        /// @brief Returns the vertex format.
+        MeshVertexFormat getVertexFormat() const { return static_cast<MeshVertexFormat>(mHeader.vertexFormat); }
+
+        /// @brief Returns the size of a vertex in bytes.
+        uint32_t getVertexStride() const { return getMeshVertexStride(getVertexFormat()); }
+
+        /// @brief Returns the number of vertices.
+        uint32_t getNumVertices() const { return mHeader.numVertices; }
+
+        /// @brief Returns the number of indices.
+        uint32_t getNumIndices() const { return mHeader.numIndices; }
+
+        /// @brief Returns the size of an index in bytes, 2 or 4.
+        uint32_t getIndexSize() const { return mHeader.indexSize; }
+
+        /// @brief Returns the vertex data.
+        const uint8_t *getVertexData() const { return mBlob.data() + mHeader.vertexDataOffset; }
+
+        /// @brief Returns the size of the vertex data in bytes.
+        size_t getVertexDataSize() const { return static_cast<size_t>(mHeader.numVertices) * getVertexStride(); }
+
+        /// @brief Returns the index data.
+        const uint8_t *getIndexData() const { return mBlob.data() + mHeader.indexDataOffset; }
+
+        /// @brief Returns the size of the index data in bytes.
+        size_t getIndexDataSize() const { return static_cast<size_t>(mHeader.numIndices) * mHeader.indexSize; }
+
+        /// @brief Returns the number of meshlets.
+        uint32_t getNumMeshlets() const { return mHeader.numMeshlets; }
+
+        /// @brief Returns the meshlet records, laid out as the GPU reads them.
+        const uint8_t *getMeshletData() const { return mBlob.data() + mHeader.meshletDataOffset; }
+
+        /// @brief Returns the size of the meshlet records in bytes.
+        size_t getMeshletDataSize() const { return static_cast<size_t>(mHeader.numMeshlets) * sizeof(MeshletRecord); }
+
+        /// @brief Returns a meshlet.
+        /// @param[ in ] index The meshlet index, must be less than getNumMeshlets.
+        MeshletRecord getMeshlet(uint32_t index) const;
+
+        /// @brief Returns the number of detail levels, zero if the index data is one level.
+        uint32_t getNumLods() const { return mHeader.numLods; }
+
+        /// @brief Returns a detail level.
+        /// @param[ in ] index The level, must be less than getNumLods.
+        MeshLodRecord getLod(uint32_t index) const;
+
+        /// @brief Returns the object space bounds.
+        scene::Aabb getBounds() const;
+
+        /// @brief Returns the scale restoring the stored positions, fold it into the model matrix.
+        glm::vec3 getPositionScale() const;
+
+        /// @brief Returns the offset applied after the position scale.
+        glm::vec3 getPositionOffset() const;
+
+    private:
+        void clear();
+        bool validate(const uint8_t *data, size_t size) const;
+
+    private:
+        MeshFileHeader mHeader{};
+        std::vector<uint8_t> mBlob;
+    };
+
+} // namespace segfault::renderer
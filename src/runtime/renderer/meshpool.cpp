@@ -0,0 +1,189 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/meshpool.h"
+
+#include <algorithm>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    bool MeshPool::init(MeshVertexFormat format, uint32_t maxVertices, uint32_t maxIndices16, uint32_t maxIndices32, uint32_t maxMeshlets) {
+        mMeshes.clear();
+        mFreeHandles.clear();
+        mNumMeshes = 0;
+        if (getMeshVertexStride(format) == 0) {
+            logMessage(LogType::Error, "Invalid mesh pool vertex format.");
+            mFormat = MeshVertexFormat::Invalid;
+            return false;
+        }
+
+        mFormat = format;
+        mVertices.reset(maxVertices);
+        // Keep the 32 bit region aligned to its index size
+        mIndices16.reset((maxIndices16 + 1) & ~1u);
+        mIndices32.reset(maxIndices32);
+        mMeshlets.reset(maxMeshlets);
+
+        return true;
+    }
+
+    MeshHandle MeshPool::add(const MeshData &mesh, IMeshPoolUploader &uploader) {
+        if (mesh.isEmpty() || mesh.getVertexFormat() != mFormat) {
+            logMessage(LogType::Error, "The mesh does not match the vertex format of the pool.");
+            return InvalidMesh;
+        }
+
+        PooledMesh pooled;
+        pooled.binding = mesh.getIndexSize() == 2 ? MeshIndexBinding::Index16 : MeshIndexBinding::Index32;
+        RangeAllocator &indices = pooled.binding == MeshIndexBinding::Index16 ? mIndices16 : mIndices32;
+        pooled.firstVertex = mVertices.allocate(mesh.getNumVertices());
+        pooled.firstIndex = indices.allocate(mesh.getNumIndices());
+        pooled.numMeshlets = mesh.getNumMeshlets();
+        pooled.firstMeshlet = pooled.numMeshlets != 0 ? mMeshlets.allocate(pooled.numMeshlets) : 0;
+        if (pooled.firstVertex == RangeAllocator::InvalidOffset || pooled.firstIndex == RangeAllocator::InvalidOffset ||
+                pooled.firstMeshlet == RangeAllocator::InvalidOffset) {
+            logMessage(LogType::Error, "The mesh pool is full.");
+            mVertices.free(pooled.firstVertex);
+            indices.free(pooled.firstIndex);
+            if (pooled.numMeshlets != 0) {
+                mMeshlets.free(pooled.firstMeshlet);
+            }
+            return InvalidMesh;
+        }
+
+        // The meshlets address the shared buffers directly
+        std::vector<MeshletRecord> meshlets(pooled.numMeshlets);
+        for (uint32_t i = 0; i < pooled.numMeshlets; ++i) {
+            meshlets[i] = mesh.getMeshlet(i);
+            meshlets[i].firstIndex += pooled.firstIndex;
+            meshlets[i].vertexOffset = static_cast<int32_t>(pooled.firstVertex);
+        }
+
+        const size_t vertexOffset = static_cast<size_t>(pooled.firstVertex) * mesh.getVertexStride();
+        const size_t indexOffset = getIndexRegionOffset(pooled.binding) + static_cast<size_t>(pooled.firstIndex) * mesh.getIndexSize();
+        if (!uploader.upload(MeshPoolBuffer::Vertex, vertexOffset, mesh.getVertexData(), mesh.getVertexDataSize()) ||
+                !uploader.upload(MeshPoolBuffer::Index, indexOffset, mesh.getIndexData(), mesh.getIndexDataSize()) ||
+                !uploader.upload(MeshPoolBuffer::Meshlet, static_cast<size_t>(pooled.firstMeshlet) * sizeof(MeshletRecord), 
+                    meshlets.data(), meshlets.size() * sizeof(MeshletRecord))) {
+            logMessage(LogType::Error, "Mesh upload failed.");
+            mVertices.free(pooled.firstVertex);
+            indices.free(pooled.firstIndex);
+            if (pooled.numMeshlets != 0) {
+                mMeshlets.free(pooled.firstMeshlet);
+            }
+            return InvalidMesh;
+        }
+
+        pooled.numVertices = mesh.getNumVertices();
+        pooled.numIndices = mesh.getNumIndices();
+        // A mesh without detail levels is one level covering everything
+        pooled.numLods = std::max(mesh.getNumLods(), 1u);
+        for (uint32_t i = 0; i < pooled.numLods; ++i) {
+            MeshLodRecord lod;
+            if (mesh.getNumLods() != 0) {
+                lod = mesh.getLod(i);
+            } else {
+                lod.numIndices = pooled.numIndices;
+                lod.numMeshlets = pooled.numMeshlets;
+            }
+            lod.firstIndex += pooled.firstIndex;
+            lod.firstMeshlet += pooled.firstMeshlet;
+            pooled.lods[i] = lod;
+        }
+        pooled.bounds = mesh.getBounds();
+        pooled.positionScale = mesh.getPositionScale();
+        pooled.positionOffset = mesh.getPositionOffset();
+
+        MeshHandle handle;
+        if (!mFreeHandles.empty()) {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+            mMeshes[handle] = pooled;
+        } else {
+            handle = static_cast<MeshHandle>(mMeshes.size());
+            mMeshes.push_back(pooled);
+        }
+        ++mNumMeshes;
+
+        return handle;
+    }
+
+    bool MeshPool::remove(MeshHandle handle) {
+        if (get(handle) == nullptr) {
+            return false;
+        }
+
+        PooledMesh &pooled = mMeshes[handle];
+        mVertices.free(pooled.firstVertex);
+        (pooled.binding == MeshIndexBinding::Index16 ? mIndices16 : mIndices32).free(pooled.firstIndex);
+        if (pooled.numMeshlets != 0) {
+            mMeshlets.free(pooled.firstMeshlet);
+        }
+        pooled = PooledMesh{};
+        mFreeHandles.push_back(handle);
+        --mNumMeshes;
+
+        return true;
+    }
+
+    const PooledMesh *MeshPool::get(MeshHandle handle) const {
+        if (handle >= mMeshes.size() || mMeshes[handle].binding == MeshIndexBinding::Invalid) {
+            return nullptr;
+        }
+
+        return &mMeshes[handle];
+    }
+
+    bool MeshPool::fillDrawItem(MeshHandle handle, DrawItem &item, uint32_t lod) const {
+        const PooledMesh *pooled = get(handle);
+        if (pooled == nullptr) {
+            return false;
+        }
+
+        const MeshLodRecord &level = pooled->lods[std::min(lod, pooled->numLods - 1)];
+        item.mesh = static_cast<uint32_t>(pooled->binding);
+        item.indexCount = level.numIndices;
+        item.firstIndex = level.firstIndex;
+        item.vertexOffset = static_cast<int32_t>(pooled->firstVertex);
+
+        return true;
+    }
+
+    size_t MeshPool::getVertexBufferSize() const {
+        return static_cast<size_t>(mVertices.getCapacity()) * getMeshVertexStride(mFormat);
+    }
+
+    size_t MeshPool::getIndexBufferSize() const {
+        return getIndexRegionOffset(MeshIndexBinding::Index32) + static_cast<size_t>(mIndices32.getCapacity()) * sizeof(uint32_t);
+    }
+
+    size_t MeshPool::getIndexRegionOffset(MeshIndexBinding binding) const {
+        return binding == MeshIndexBinding::Index32 ? static_cast<size_t>(mIndices16.getCapacity()) * sizeof(uint16_t) : 0;
+    }
+
+    const RangeAllocator &MeshPool::getIndexAllocator(MeshIndexBinding binding) const {
+        return binding == MeshIndexBinding::Index16 ? mIndices16 : mIndices32;
+    }
+
+} // namespace segfault::renderer
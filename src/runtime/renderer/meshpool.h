@@ -0,0 +1,178 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "core/rangeallocator.h"
+#include "renderer/meshformat.h"
+#include "renderer/renderqueue.h"
+
+#include <vector>
+
+namespace segfault::renderer {
+
+    /// @brief The handle of a mesh in a mesh pool.
+    using MeshHandle = uint32_t;
+
+    /// @brief Marks an invalid mesh.
+    constexpr MeshHandle InvalidMesh = 0xffffffffu;
+
+    /// @brief The GPU buffers of a mesh pool.
+    enum class MeshPoolBuffer : int32_t {
+        Invalid = -1,
+        Vertex,         ///< The shared vertex buffer.
+        Index,          ///< The shared index buffer with the 16 and the 32 bit region.
+        Meshlet,        ///< The meshlet records of all meshes, read by the cluster culling.
+        Count
+    };
+
+    /// @brief The index bindings of a mesh pool, meshes with the same binding are drawn without 
+    /// rebinding the buffers.
+    enum class MeshIndexBinding : int32_t {
+        Invalid = -1,
+        Index16,        ///< The 16 bit region of the index buffer.
+        Index32,        ///< The 32 bit region of the index buffer.
+        Count
+    };
+
+    /// @brief Copies data into a range of a pool buffer, implemented per graphics API.
+    class IMeshPoolUploader {
+    public:
+        /// @brief The class destructor.
+        virtual ~IMeshPoolUploader() = default;
+
+        /// @brief Uploads data into a pool buffer.
+        /// @param[ in ] buffer The destination buffer.
+        /// @param[ in ] offset The destination offset in bytes.
+        /// @param[ in ] data The data.
+        /// @param[ in ] size The size of the data in bytes.
+        /// @return True if the upload was recorded.
+        virtual bool upload(MeshPoolBuffer buffer, size_t offset, const void *data, size_t size) = 0;
+    };
+
+    /// @brief A mesh living in a mesh pool.
+    struct PooledMesh {
+        uint32_t firstVertex{ 0 };                              ///< The base vertex added to every index.
+        uint32_t numVertices{ 0 };                              ///< The number of vertices.
+        uint32_t firstIndex{ 0 };                               ///< The first index in the region of the binding.
+        uint32_t numIndices{ 0 };                               ///< The number of indices.
+        uint32_t firstMeshlet{ 0 };                             ///< The first meshlet in the meshlet buffer.
+        uint32_t numMeshlets{ 0 };                              ///< The number of meshlets, may be zero.
+        uint32_t numLods{ 0 };                                  ///< The number of detail levels, at least one.
+        MeshLodRecord lods[MaxMeshLods]{};                      ///< The detail levels with absolute ranges.
+        MeshIndexBinding binding{ MeshIndexBinding::Invalid };  ///< The index binding, Invalid for free slots.
+        scene::Aabb bounds{};                                   ///< The object space bounds.
+        glm::vec3 positionScale{ 1.0f };                        ///< The scale restoring the stored positions.
+        glm::vec3 positionOffset{ 0.0f };                       ///< The offset applied after the scale.
+    };
+
+    //---------------------------------------------------------------------------------------------
+    /// @class MeshPool
+    /// @brief Packs many meshes of one vertex format into one vertex and one index buffer.
+    ///
+    /// Vertices and indices are sub-allocated per mesh. The indices of a mesh stay local to the 
+    /// mesh and are uploaded as baked, a mesh is drawn with its first vertex as base vertex. The 
+    /// index buffer has a region per index size, so each mesh keeps the index size it was baked 
+    /// with and all meshes of a region share one binding, as indirect multi draws need it. The 
+    /// meshlets of all meshes are gathered in a third buffer with their ranges made absolute.
+    /// The pool does the bookkeeping only, the buffers are owned by the graphics API backend.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT MeshPool final {
+    public:
+        /// @brief The class constructor, the pool is empty until init is called.
+        MeshPool() = default;
+
+        /// @brief The class destructor.
+        ~MeshPool() = default;
+
+        /// @brief Sets the layout of the pool and removes all meshes.
+        /// @param[ in ] format The vertex format of all meshes.
+        /// @param[ in ] maxVertices The capacity of the vertex buffer in vertices.
+        /// @param[ in ] maxIndices16 The capacity of the 16 bit index region.
+        /// @param[ in ] maxIndices32 The capacity of the 32 bit index region.
+        /// @param[ in ] maxMeshlets The capacity of the meshlet buffer.
+        /// @return False for an invalid format.
+        bool init(MeshVertexFormat format, uint32_t maxVertices, uint32_t maxIndices16, uint32_t maxIndices32, uint32_t maxMeshlets = 0);
+
+        /// @brief Adds a mesh and uploads its data.
+        /// @param[ in ] mesh The mesh, must have the vertex format of the pool.
+        /// @param[ in ] uploader The uploader writing into the pool buffers.
+        /// @return The handle or InvalidMesh if the mesh does not fit or the upload failed.
+        MeshHandle add(const MeshData &mesh, IMeshPoolUploader &uploader);
+
+        /// @brief Removes a mesh, the caller must make sure no pending frame draws it anymore.
+        /// @param[ in ] handle The mesh handle.
+        /// @return False for an invalid handle.
+        bool remove(MeshHandle handle);
+
+        /// @brief Returns a mesh.
+        /// @param[ in ] handle The mesh handle.
+        /// @return The mesh or nullptr for an invalid handle.
+        const PooledMesh *get(MeshHandle handle) const;
+
+        /// @brief Fills the mesh binding and the draw range of a draw item.
+        /// @param[ in ] handle The mesh handle.
+        /// @param[ out ] item The draw item, the mesh field receives the MeshIndexBinding.
+        /// @param[ in ] lod The detail level to draw, clamped to the lowest detail level.
+        /// @return False for an invalid handle.
+        bool fillDrawItem(MeshHandle handle, DrawItem &item, uint32_t lod = 0) const;
+
+        /// @brief Returns the vertex format of all meshes.
+        MeshVertexFormat getVertexFormat() const { return mFormat; }
+
+        /// @brief Returns the size of the vertex buffer in bytes.
+        size_t getVertexBufferSize() const;
+
+        /// @brief Returns the size of the index buffer in bytes.
+        size_t getIndexBufferSize() const;
+
+        /// @brief Returns the size of the meshlet buffer in bytes.
+        size_t getMeshletBufferSize() const { return static_cast<size_t>(mMeshlets.getCapacity()) * sizeof(MeshletRecord); }
+
+        /// @brief Returns the byte offset of an index region in the index buffer.
+        size_t getIndexRegionOffset(MeshIndexBinding binding) const;
+
+        /// @brief Returns the size of an index of a binding in bytes.
+        static uint32_t getIndexSize(MeshIndexBinding binding) { return binding == MeshIndexBinding::Index16 ? 2 : 4; }
+
+        /// @brief Returns the number of meshes.
+        size_t getNumMeshes() const { return mNumMeshes; }
+
+        /// @brief Returns the vertex allocator, for statistics.
+        const core::RangeAllocator &getVertexAllocator() const { return mVertices; }
+
+        /// @brief Returns the index allocator of a binding, for statistics.
+        const core::RangeAllocator &getIndexAllocator(MeshIndexBinding binding) const;
+
+    private:
+        MeshVertexFormat mFormat{ MeshVertexFormat::Invalid };
+        core::RangeAllocator mVertices;
+        core::RangeAllocator mIndices16;
+        core::RangeAllocator mIndices32;
+        core::RangeAllocator mMeshlets;
+        std::vector<PooledMesh> mMeshes;
+        std::vector<MeshHandle> mFreeHandles;
+        size_t mNumMeshes{ 0 };
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,256 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/pipelinelibrary.h"
+#include "core/hash.h"
+#include "core/threadpool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        // The terminator is hashed too, so "ab" + "c" differs from "a" + "bc"
+        uint64_t hashField(const std::string &str, uint64_t seed) {
+            return hashBytes(str.c_str(), str.size() + 1, seed);
+        }
+
+        uint64_t hashSorted(const PipelineDesc &desc) {
+            uint64_t hash = hashField(desc.fragmentShader, hashField(desc.vertexShader, FnvOffsetBasis));
+            for (const std::string &define : desc.defines) {
+                hash = hashField(define, hash);
+            }
+            const PipelineState &state = desc.state;
+            const uint32_t packed[5] = { static_cast<uint32_t>(state.cullMode), static_cast<uint32_t>(state.blendMode),
+                state.depthTest ? 1u : 0u, state.depthWrite ? 1u : 0u, state.wireframe ? 1u : 0u };
+
+            return hashBytes(packed, sizeof(packed), hash);
+        }
+
+        bool isSameState(const PipelineState &a, const PipelineState &b) {
+            return a.cullMode == b.cullMode && a.blendMode == b.blendMode && a.depthTest == b.depthTest &&
+                a.depthWrite == b.depthWrite && a.wireframe == b.wireframe;
+        }
+
+        void sortDefines(PipelineDesc &desc) {
+            std::sort(desc.defines.begin(), desc.defines.end());
+            desc.defines.erase(std::unique(desc.defines.begin(), desc.defines.end()), desc.defines.end());
+        }
+
+    } // namespace
+
+    uint64_t hashPipelineDesc(const PipelineDesc &desc) {
+        PipelineDesc sorted = desc;
+        sortDefines(sorted);
+
+        return hashSorted(sorted);
+    }
+
+    /// The builds finished on the workers, shared with the build tasks so they can report to a 
+    /// library which stopped waiting for them.
+    struct PipelineLibrary::CompletionQueue {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::vector<BuiltPipeline> pipelines;
+        uint32_t numRunning{ 0 };
+    };
+
+    PipelineLibrary::~PipelineLibrary() {
+        waitIdle();
+    }
+
+    void PipelineLibrary::init(IPipelineBuilder *builder, ThreadPool *pool) {
+        mBuilder = builder;
+        mPool = pool;
+        mCompleted = std::make_shared<CompletionQueue>();
+    }
+
+    PipelineHandle PipelineLibrary::find(const PipelineDesc &desc, uint64_t hash) const {
+        auto range = mLookup.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const PipelineDesc &other = mPipelines[it->second].desc;
+            if (other.vertexShader == desc.vertexShader && other.fragmentShader == desc.fragmentShader &&
+                    other.defines == desc.defines && isSameState(other.state, desc.state)) {
+                return it->second;
+            }
+        }
+
+        return InvalidPipeline;
+    }
+
+    PipelineHandle PipelineLibrary::create(PipelineDesc desc, uint64_t hash, PipelineHandle fallback) {
+        const PipelineHandle handle = static_cast<PipelineHandle>(mPipelines.size());
+        Pipeline pipeline;
+        pipeline.desc = std::move(desc);
+        pipeline.fallback = fallback;
+        mPipelines.push_back(std::move(pipeline));
+        mLookup.emplace(hash, handle);
+
+        return handle;
+    }
+
+    PipelineHandle PipelineLibrary::add(const PipelineDesc &desc, uint64_t pipeline) {
+        PipelineDesc sorted = desc;
+        sortDefines(sorted);
+        const uint64_t hash = hashSorted(sorted);
+        if (pipeline == 0 || find(sorted, hash) != InvalidPipeline) {
+            return InvalidPipeline;
+        }
+
+        const PipelineHandle handle = create(std::move(sorted), hash, InvalidPipeline);
+        mPipelines[handle].pipeline = pipeline;
+        mPipelines[handle].status = PipelineStatus::Ready;
+
+        return handle;
+    }
+
+    PipelineHandle PipelineLibrary::request(const PipelineDesc &desc, PipelineHandle fallback) {
+        PipelineDesc sorted = desc;
+        sortDefines(sorted);
+        const uint64_t hash = hashSorted(sorted);
+        const PipelineHandle known = find(sorted, hash);
+        if (known != InvalidPipeline) {
+            return known;
+        }
+        if (mBuilder == nullptr || mPool == nullptr) {
+            logMessage(LogType::Error, "The pipeline library is not initialized.");
+            return InvalidPipeline;
+        }
+
+        // Fallbacks point to older pipelines only, so the chain has no cycles
+        if (fallback != InvalidPipeline && fallback >= mPipelines.size()) {
+            logMessage(LogType::Warn, "Invalid fallback pipeline, it is ignored.");
+            fallback = InvalidPipeline;
+        }
+        const PipelineHandle handle = create(sorted, hash, fallback);
+
+        std::shared_ptr<CompletionQueue> completed = mCompleted;
+        {
+            std::lock_guard<std::mutex> lock(completed->mutex);
+            ++completed->numRunning;
+        }
+        ++mNumPending;
+        IPipelineBuilder *builder = mBuilder;
+        mPool->enqueue([builder, completed, handle, desc = std::move(sorted)]() {
+            BuiltPipeline built;
+            built.handle = handle;
+            built.pipeline = builder->build(desc);
+
+            std::lock_guard<std::mutex> lock(completed->mutex);
+            completed->pipelines.push_back(built);
+            --completed->numRunning;
+            completed->idle.notify_all();
+        });
+
+        return handle;
+    }
+
+    uint64_t PipelineLibrary::get(PipelineHandle handle) const {
+        while (handle < mPipelines.size()) {
+            const Pipeline &pipeline = mPipelines[handle];
+            if (pipeline.status == PipelineStatus::Ready) {
+                return pipeline.pipeline;
+            }
+            handle = pipeline.fallback;
+        }
+
+        return 0;
+    }
+
+    PipelineStatus PipelineLibrary::getStatus(PipelineHandle handle) const {
+        return handle < mPipelines.size() ? mPipelines[handle].status : PipelineStatus::Invalid;
+    }
+
+    const PipelineDesc *PipelineLibrary::getDesc(PipelineHandle handle) const {
+        return handle < mPipelines.size() ? &mPipelines[handle].desc : nullptr;
+    }
+
+    uint64_t PipelineLibrary::replace(PipelineHandle handle, uint64_t pipeline) {
+        if (handle >= mPipelines.size() || mPipelines[handle].status != PipelineStatus::Ready || pipeline == 0) {
+            return 0;
+        }
+
+        const uint64_t previous = mPipelines[handle].pipeline;
+        mPipelines[handle].pipeline = pipeline;
+
+        return previous;
+    }
+
+    size_t PipelineLibrary::update() {
+        if (mCompleted == nullptr) {
+            return 0;
+        }
+
+        std::vector<BuiltPipeline> built;
+        {
+            std::lock_guard<std::mutex> lock(mCompleted->mutex);
+            built.swap(mCompleted->pipelines);
+        }
+
+        size_t numReady = 0;
+        for (const BuiltPipeline &entry : built) {
+            --mNumPending;
+            Pipeline &pipeline = mPipelines[entry.handle];
+            if (entry.pipeline == 0) {
+                const std::string msg = "Failed to build the pipeline of " + pipeline.desc.vertexShader + " and " + 
+                    pipeline.desc.fragmentShader + ", its fallback is used.";
+                logMessage(LogType::Error, msg.c_str());
+                pipeline.status = PipelineStatus::Failed;
+                continue;
+            }
+            pipeline.pipeline = entry.pipeline;
+            pipeline.status = PipelineStatus::Ready;
+            ++numReady;
+        }
+
+        return numReady;
+    }
+
+    void PipelineLibrary::waitIdle() {
+        if (mCompleted == nullptr) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mCompleted->mutex);
+        mCompleted->idle.wait(lock, [this]() {
+            return mCompleted->numRunning == 0;
+        });
+    }
+
+    void PipelineLibrary::clear() {
+        waitIdle();
+        update();
+        for (Pipeline &pipeline : mPipelines) {
+            if (pipeline.status == PipelineStatus::Ready && mBuilder != nullptr) {
+                mBuilder->destroy(pipeline.pipeline);
+            }
+        }
+        mPipelines.clear();
+        mLookup.clear();
+    }
+
+} // namespace segfault::renderer
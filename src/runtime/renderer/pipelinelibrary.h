@@ -0,0 +1,211 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::core {
+    class ThreadPool;
+}
+
+namespace segfault::renderer {
+
+    /// @brief The handle of a pipeline in the pipeline library.
+    using PipelineHandle = uint32_t;
+
+    /// @brief Marks an invalid pipeline handle.
+    static constexpr PipelineHandle InvalidPipeline = 0xFFFFFFFFu;
+
+    /// @brief The faces culled by the rasterizer.
+    enum class PipelineCullMode : int32_t {
+        Invalid = -1,
+        None,       ///< Both faces are drawn.
+        Back,       ///< Back faces are culled.
+        Front,      ///< Front faces are culled.
+        Count
+    };
+
+    /// @brief How the fragments are combined with the render target.
+    enum class PipelineBlendMode : int32_t {
+        Invalid = -1,
+        Opaque,     ///< The fragment replaces the target.
+        Alpha,      ///< The fragment is blended by its alpha.
+        Additive,   ///< The fragment is added to the target.
+        Count
+    };
+
+    /// @brief The fixed function state of a pipeline.
+    struct PipelineState {
+        PipelineCullMode cullMode{ PipelineCullMode::Back };        ///< The culled faces.
+        PipelineBlendMode blendMode{ PipelineBlendMode::Opaque };   ///< The blending.
+        bool depthTest{ true };                                     ///< True to test against the depth buffer.
+        bool depthWrite{ true };                                    ///< True to write the depth buffer.
+        bool wireframe{ false };                                    ///< True to draw the edges only.
+    };
+
+    /// @brief A shader permutation with its render state.
+    struct PipelineDesc {
+        std::string vertexShader;           ///< The GLSL source of the vertex shader.
+        std::string fragmentShader;         ///< The GLSL source of the fragment shader.
+        std::vector<std::string> defines;   ///< The permutation defines, NAME or NAME=VALUE.
+        PipelineState state;                ///< The render state.
+    };
+
+    /// @brief Hashes a pipeline description, the order of the defines does not matter.
+    /// @param[ in ] desc The description.
+    /// @return The hash.
+    SEGFAULT_EXPORT uint64_t hashPipelineDesc(const PipelineDesc &desc);
+
+    /// @brief Builds the pipelines of a pipeline library, implemented per graphics API.
+    class IPipelineBuilder {
+    public:
+        /// @brief The class destructor.
+        virtual ~IPipelineBuilder() = default;
+
+        /// @brief Compiles the shaders of a permutation and creates its pipeline. Called on the 
+        /// workers, several builds may run at the same time.
+        /// @param[ in ] desc The description, the defines are sorted.
+        /// @return The pipeline of the graphics API or 0 on failure.
+        virtual uint64_t build(const PipelineDesc &desc) = 0;
+
+        /// @brief Destroys a pipeline, called on the thread owning the library.
+        /// @param[ in ] pipeline The pipeline.
+        virtual void destroy(uint64_t pipeline) = 0;
+    };
+
+    /// @brief The build state of a pipeline.
+    enum class PipelineStatus : int32_t {
+        Invalid = -1,
+        Pending,    ///< The pipeline is built on a worker, its fallback is used.
+        Ready,      ///< The pipeline can be bound.
+        Failed,     ///< The build failed, its fallback is used for good.
+        Count
+    };
+
+    //---------------------------------------------------------------------------------------------
+    /// @class PipelineLibrary
+    /// @brief Owns the pipelines of the shader permutations and builds them in the background.
+    ///
+    /// A requested pipeline is keyed by the hash of its description, so the same permutation 
+    /// is built once. The build runs on the thread pool and is taken over by update at a frame 
+    /// boundary. Until then, or for good if it failed, get hands out the nearest ready pipeline 
+    /// along the fallback chain, so a new permutation never stalls a frame.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT PipelineLibrary final {
+    public:
+        /// @brief The class constructor, the library is unusable until init is called.
+        PipelineLibrary() = default;
+
+        /// @brief The class destructor, waits for the builds in flight. Call clear before to 
+        /// destroy the pipelines.
+        ~PipelineLibrary();
+
+        /// @brief Sets the builder and the pool.
+        /// @param[ in ] builder The builder, must outlive the library.
+        /// @param[ in ] pool The pool running the builds, must outlive the library.
+        void init(IPipelineBuilder *builder, core::ThreadPool *pool);
+
+        /// @brief Adds a pipeline created by the caller, it is ready at once.
+        /// @param[ in ] desc The description.
+        /// @param[ in ] pipeline The pipeline, owned by the library from now on.
+        /// @return The handle or InvalidPipeline if the description is known or the pipeline is 0.
+        PipelineHandle add(const PipelineDesc &desc, uint64_t pipeline);
+
+        /// @brief Requests a pipeline, its build is started unless the description is known.
+        /// @param[ in ] desc The description.
+        /// @param[ in ] fallback The pipeline used until the build finished, must be requested before.
+        /// @return The handle, the one of the known pipeline for a known description.
+        PipelineHandle request(const PipelineDesc &desc, PipelineHandle fallback = InvalidPipeline);
+
+        /// @brief Returns the pipeline to bind for a handle.
+        /// @param[ in ] handle The pipeline handle.
+        /// @return The pipeline of the handle or of its nearest ready fallback, 0 if there is none.
+        uint64_t get(PipelineHandle handle) const;
+
+        /// @brief Returns the build state of a pipeline.
+        /// @param[ in ] handle The pipeline handle.
+        /// @return The state, Invalid for an invalid handle.
+        PipelineStatus getStatus(PipelineHandle handle) const;
+
+        /// @brief Returns the description of a pipeline.
+        /// @param[ in ] handle The pipeline handle.
+        /// @return The description with sorted defines, nullptr for an invalid handle.
+        const PipelineDesc *getDesc(PipelineHandle handle) const;
+
+        /// @brief Replaces a ready pipeline, for shaders reloaded at runtime.
+        /// @param[ in ] handle The pipeline handle.
+        /// @param[ in ] pipeline The new pipeline, owned by the library from now on.
+        /// @return The previous pipeline, the caller destroys it once no frame uses it, 0 if 
+        /// the handle was not ready.
+        uint64_t replace(PipelineHandle handle, uint64_t pipeline);
+
+        /// @brief Takes over the finished builds, call once per frame.
+        /// @return The number of pipelines which became ready.
+        size_t update();
+
+        /// @brief Blocks until all builds in flight finished, update takes them over.
+        void waitIdle();
+
+        /// @brief Waits for the builds in flight and destroys all pipelines.
+        void clear();
+
+        /// @brief Returns the number of pipelines, pending and failed ones included.
+        size_t getNumPipelines() const { return mPipelines.size(); }
+
+        /// @brief Returns the number of builds in flight.
+        uint32_t getNumPending() const { return mNumPending; }
+
+        PipelineLibrary(const PipelineLibrary &) = delete;
+        PipelineLibrary &operator = (const PipelineLibrary &) = delete;
+
+    private:
+        PipelineHandle find(const PipelineDesc &desc, uint64_t hash) const;
+        PipelineHandle create(PipelineDesc desc, uint64_t hash, PipelineHandle fallback);
+
+    private:
+        struct Pipeline {
+            PipelineDesc desc;                                  ///< The description, defines sorted.
+            uint64_t pipeline{ 0 };                             ///< The pipeline of the graphics API.
+            PipelineHandle fallback{ InvalidPipeline };         ///< The pipeline used until this one is ready.
+            PipelineStatus status{ PipelineStatus::Pending };   ///< The build state.
+        };
+        struct BuiltPipeline {
+            PipelineHandle handle{ InvalidPipeline };
+            uint64_t pipeline{ 0 };
+        };
+        struct CompletionQueue;
+
+        IPipelineBuilder *mBuilder{ nullptr };
+        core::ThreadPool *mPool{ nullptr };
+        std::vector<Pipeline> mPipelines;
+        std::unordered_multimap<uint64_t, PipelineHandle> mLookup;
+        std::shared_ptr<CompletionQueue> mCompleted;
+        uint32_t mNumPending{ 0 };
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/renderqueue.h"
+
+#include <algorithm>
+#include <array>
+
+namespace segfault::renderer {
+
+    namespace {
+        constexpr uint32_t NumDigits = 8;
+        constexpr uint32_t NumBuckets = 256;
+
+        inline uint64_t mask(uint32_t value, uint32_t bits) {
+            return static_cast<uint64_t>(value) & ((1ull << bits) - 1);
+        }
+
+        inline uint64_t quantizeDepth(float depth) {
+            const float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+            return static_cast<uint64_t>(clamped * static_cast<float>((1u << SortKeyDepthBits) - 1));
+        }
+    } // Anonymous namespace
+
+    uint64_t makeOpaqueSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth) {
+        return (mask(pass, SortKeyPassBits) << (64 - SortKeyPassBits)) |
+                (mask(pipeline, SortKeyPipelineBits) << (SortKeyMaterialBits + SortKeyDepthBits)) |
+                (mask(material, SortKeyMaterialBits) << SortKeyDepthBits) |
+                quantizeDepth(depth);
+    }
+
+    uint64_t makeTranslucentSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth) {
+        const uint64_t invertedDepth = ((1ull << SortKeyDepthBits) - 1) - quantizeDepth(depth);
+        return (mask(pass, SortKeyPassBits) << (64 - SortKeyPassBits)) |
+                (invertedDepth << (SortKeyPipelineBits + SortKeyMaterialBits)) |
+                (mask(pipeline, SortKeyPipelineBits) << SortKeyMaterialBits) |
+                mask(material, SortKeyMaterialBits);
+    }
+
+    void RenderQueue::clear() {
+        mItems.clear();
+        mOrder.clear();
+    }
+
+    void RenderQueue::reserve(size_t count) {
+        mItems.reserve(count);
+        mOrder.reserve(count);
+        mScratch.reserve(count);
+    }
+
+    void RenderQueue::submit(const DrawItem &item) {
+        mOrder.push_back(SortEntry{ item.key, static_cast<uint32_t>(mItems.size()) });
+        mItems.push_back(item);
+    }
+
+    void RenderQueue::sort() {
+        const size_t count = mOrder.size();
+        if (count < 2) {
+            return;
+        }
+
+        // One pass builds the histograms of all digits
+        std::array<uint32_t, NumDigits * NumBuckets> histograms{};
+        for (const SortEntry &entry : mOrder) {
+            for (uint32_t digit = 0; digit < NumDigits; ++digit) {
+                ++histograms[digit * NumBuckets + ((entry.key >> (digit * 8)) & 0xff)];
+            }
+        }
+
+        mScratch.resize(count);
+        for (uint32_t digit = 0; digit < NumDigits; ++digit) {
+            uint32_t *histogram = &histograms[digit * NumBuckets];
+            const uint32_t shift = digit * 8;
+            if (histogram[(mOrder[0].key >> shift) & 0xff] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < NumBuckets; ++bucket) {
+                const uint32_t bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+            for (const SortEntry &entry : mOrder) {
+                mScratch[histogram[(entry.key >> shift) & 0xff]++] = entry;
+            }
+            mOrder.swap(mScratch);
+        }
+    }
+
+    RenderQueueStats RenderQueue::execute(IDrawBackend &backend) const {
+        RenderQueueStats stats;
+        const DrawItem *previous = nullptr;
+        for (const SortEntry &entry : mOrder) {
+            const DrawItem &item = mItems[entry.index];
+            const bool pipelineChanged = previous == nullptr || previous->pipeline != item.pipeline;
+            if (pipelineChanged) {
+                backend.bindPipeline(item.pipeline);
+                ++stats.numPipelineBinds;
+            }
+            if (pipelineChanged || previous->material != item.material) {
+                backend.bindMaterial(item.material);
+                ++stats.numMaterialBinds;
+            }
+            if (previous == nullptr || previous->mesh != item.mesh) {
+                backend.bindMesh(item.mesh);
+                ++stats.numMeshBinds;
+            }
+            backend.draw(item);
+            ++stats.numDraws;
+            previous = &item;
+        }
+
+        return stats;
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,151 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <vector>
+
+namespace segfault::renderer {
+
+    /// @brief The bit widths of the sort key fields.
+    constexpr uint32_t SortKeyPassBits = 6;
+    constexpr uint32_t SortKeyPipelineBits = 14;
+    constexpr uint32_t SortKeyMaterialBits = 20;
+    constexpr uint32_t SortKeyDepthBits = 24;
+
+    /// @brief Builds the key of an opaque draw: pass, pipeline, material, then depth front to back.
+    /// @param[ in ] pass The render pass index.
+    /// @param[ in ] pipeline The pipeline id.
+    /// @param[ in ] material The material id.
+    /// @param[ in ] depth The normalized view depth in [0, 1].
+    /// @return The sort key.
+    SEGFAULT_EXPORT uint64_t makeOpaqueSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth);
+
+    /// @brief Builds the key of a blended draw: pass, depth back to front, then pipeline and material.
+    /// @param[ in ] pass The render pass index.
+    /// @param[ in ] pipeline The pipeline id.
+    /// @param[ in ] material The material id.
+    /// @param[ in ] depth The normalized view depth in [0, 1].
+    /// @return The sort key.
+    SEGFAULT_EXPORT uint64_t makeTranslucentSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth);
+
+    /// @brief Returns the render pass index of a sort key.
+    inline uint32_t getSortKeyPass(uint64_t key) {
+        return static_cast<uint32_t>(key >> (64 - SortKeyPassBits));
+    }
+
+    /// @brief A draw call with the state it needs.
+    struct DrawItem {
+        uint64_t key{ 0 };              ///< The sort key.
+        uint32_t pipeline{ 0 };         ///< The pipeline handle of the backend.
+        uint32_t material{ 0 };         ///< The descriptor set handle of the backend.
+        uint32_t mesh{ 0 };             ///< The vertex and index buffer handle of the backend.
+        uint32_t indexCount{ 0 };       ///< The number of indices.
+        uint32_t firstIndex{ 0 };       ///< The first index.
+        int32_t vertexOffset{ 0 };      ///< The value added to every index.
+        uint32_t instanceCount{ 1 };    ///< The number of instances.
+        uint32_t firstInstance{ 0 };    ///< The first instance.
+    };
+
+    /// @brief Records the state changes and draws of a sorted queue, implemented per graphics API.
+    class IDrawBackend {
+    public:
+        /// @brief The class destructor.
+        virtual ~IDrawBackend() = default;
+
+        /// @brief Binds a pipeline.
+        virtual void bindPipeline(uint32_t pipeline) = 0;
+
+        /// @brief Binds the descriptor set of a material.
+        virtual void bindMaterial(uint32_t material) = 0;
+
+        /// @brief Binds the vertex and index buffers of a mesh.
+        virtual void bindMesh(uint32_t mesh) = 0;
+
+        /// @brief Records a draw, all state is already bound.
+        virtual void draw(const DrawItem &item) = 0;
+    };
+
+    /// @brief The state changes issued by a queue.
+    struct RenderQueueStats {
+        size_t numDraws{ 0 };
+        size_t numPipelineBinds{ 0 };
+        size_t numMaterialBinds{ 0 };
+        size_t numMeshBinds{ 0 };
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	Collects the draws of a frame, sorts them by key and records them with minimal binds.
+    ///
+    /// The keys are sorted with a stable LSD radix sort over 8 bit digits, digits which are the 
+    /// same for all keys are skipped. While recording, a bind is only issued if the state 
+    /// differs from the previous draw. A pipeline change rebinds the material as the pipeline 
+    /// layout may differ.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT RenderQueue final {
+    public:
+        /// @brief The class constructor.
+        RenderQueue() = default;
+
+        /// @brief The class destructor.
+        ~RenderQueue() = default;
+
+        /// @brief Removes all draws, the memory is kept for the next frame.
+        void clear();
+
+        /// @brief Reserves memory for a number of draws.
+        void reserve(size_t count);
+
+        /// @brief Adds a draw.
+        /// @param[ in ] item The draw.
+        void submit(const DrawItem &item);
+
+        /// @brief Sorts the draws by key, draws with equal keys keep their submission order.
+        void sort();
+
+        /// @brief Records the draws in sorted order.
+        /// @param[ in ] backend The backend recording the commands.
+        /// @return The issued state changes.
+        RenderQueueStats execute(IDrawBackend &backend) const;
+
+        /// @brief Returns the number of draws.
+        size_t size() const { return mItems.size(); }
+
+        /// @brief Returns a draw in sorted order, valid after sort.
+        const DrawItem &getSorted(size_t index) const { return mItems[mOrder[index].index]; }
+
+    private:
+        struct SortEntry {
+            uint64_t key;
+            uint32_t index;
+        };
+
+        std::vector<DrawItem> mItems;
+        std::vector<SortEntry> mOrder;
+        std::vector<SortEntry> mScratch;
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,263 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/shadermanager.h"
+#include "core/hash.h"
+#include "core/threadpool.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#    include <direct.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        constexpr uint32_t SpirvMagic = 0x07230203;
+
+        bool readBinaryFile(const std::string &file, std::vector<char> &data) {
+            std::ifstream stream(file, std::ios::ate | std::ios::binary);
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            data.resize(static_cast<size_t>(stream.tellg()));
+            stream.seekg(0);
+            stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+            return static_cast<bool>(stream);
+        }
+
+        bool isSpirv(const std::vector<char> &code) {
+            uint32_t magic = 0;
+            if (code.size() < sizeof(magic) || code.size() % sizeof(uint32_t) != 0) {
+                return false;
+            }
+            memcpy(&magic, code.data(), sizeof(magic));
+
+            return magic == SpirvMagic;
+        }
+
+        bool isDefineChar(char c) {
+            return isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' || c == '=' || c == '.';
+        }
+
+    } // namespace
+
+    void createShaderCacheDir(const char *cacheDir) {
+        if (cacheDir == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        _mkdir(cacheDir);
+#else
+        mkdir(cacheDir, 0755);
+#endif
+    }
+
+    bool compileShaderCached(const char *sourceFile, const char *cacheDir, const char *compiler, std::vector<char> &code) {
+        return compileShaderCached(sourceFile, cacheDir, compiler, {}, code);
+    }
+
+    bool compileShaderCached(const char *sourceFile, const char *cacheDir, const char *compiler, 
+            const std::vector<std::string> &defines, std::vector<char> &code) {
+        std::vector<char> source;
+        if (sourceFile == nullptr || cacheDir == nullptr || compiler == nullptr || !readBinaryFile(sourceFile, source)) {
+            return false;
+        }
+
+        // The defines end up on the command line, so they are restricted to harmless characters
+        std::string defineArgs;
+        for (const std::string &define : defines) {
+            if (define.empty() || !std::all_of(define.begin(), define.end(), isDefineChar)) {
+                const std::string msg = "Invalid shader define " + define + ".";
+                logMessage(LogType::Error, msg.c_str());
+                return false;
+            }
+            defineArgs += " -D" + define;
+        }
+
+        // The extension selects the stage, so it is part of the key like the compiler and the defines
+        const char *extension = strrchr(sourceFile, '.');
+        uint64_t hash = hashString(compiler, hashString(extension));
+        for (const std::string &define : defines) {
+            hash = hashBytes(define.c_str(), define.size() + 1, hash);
+        }
+        hash = hashBytes(source.data(), source.size(), hash);
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(hash));
+        const std::string cacheFile = std::string(cacheDir) + "/" + name;
+        if (readBinaryFile(cacheFile, code) && isSpirv(code)) {
+            return true;
+        }
+
+        // The compiler writes next to the cache file, a failed compile leaves no broken entry. 
+        // Permutations sharing a stage may compile it at the same time, each into its own file.
+        static std::atomic<uint32_t> numCompiles{ 0 };
+        createShaderCacheDir(cacheDir);
+        const std::string tempFile = cacheFile + "." + std::to_string(numCompiles++) + ".tmp";
+        const std::string command = std::string(compiler) + defineArgs + " \"" + sourceFile + "\" -o \"" + tempFile + "\"";
+        if (std::system(command.c_str()) != 0) {
+            std::remove(tempFile.c_str());
+            return false;
+        }
+        std::remove(cacheFile.c_str());
+        if (std::rename(tempFile.c_str(), cacheFile.c_str()) != 0) {
+            std::remove(tempFile.c_str());
+            return false;
+        }
+
+        return readBinaryFile(cacheFile, code) && isSpirv(code);
+    }
+
+    /// The compiles finished on the workers, shared with the compile tasks so they stay valid 
+    /// when the manager is gone before them.
+    struct ShaderManager::CompletionQueue {
+        std::mutex mutex;
+        std::vector<CompiledShader> shaders;
+    };
+
+    void ShaderManager::init(ThreadPool *pool, const char *cacheDir, const char *compiler) {
+        mPool = pool;
+        mCacheDir = cacheDir != nullptr ? cacheDir : ".";
+        mCompiler = compiler != nullptr ? compiler : DefaultShaderCompiler;
+        mCompleted = std::make_shared<CompletionQueue>();
+    }
+
+    ShaderHandle ShaderManager::add(const char *sourceFile, const char *spirvFile) {
+        Shader shader;
+        if (spirvFile == nullptr || !readBinaryFile(spirvFile, shader.code) || !isSpirv(shader.code)) {
+            const std::string msg = std::string("Cannot read the shader ") + (spirvFile != nullptr ? spirvFile : "") + ".";
+            logMessage(LogType::Error, msg.c_str());
+            return InvalidShader;
+        }
+
+        if (sourceFile != nullptr) {
+            shader.sourceFile = sourceFile;
+            shader.watched = mWatcher.addFile(sourceFile);
+        }
+        mShaders.push_back(std::move(shader));
+
+        return static_cast<ShaderHandle>(mShaders.size() - 1);
+    }
+
+    const std::vector<char> *ShaderManager::getCode(ShaderHandle handle) const {
+        return handle < mShaders.size() ? &mShaders[handle].code : nullptr;
+    }
+
+    const char *ShaderManager::getSourceFile(ShaderHandle handle) const {
+        return handle < mShaders.size() ? mShaders[handle].sourceFile.c_str() : nullptr;
+    }
+
+    uint32_t ShaderManager::getVersion(ShaderHandle handle) const {
+        return handle < mShaders.size() ? mShaders[handle].version : 0;
+    }
+
+    bool ShaderManager::isWatched(ShaderHandle handle) const {
+        return handle < mShaders.size() && mShaders[handle].watched;
+    }
+
+    size_t ShaderManager::update(std::vector<ShaderHandle> &reloaded) {
+        if (mCompleted == nullptr) {
+            return 0;
+        }
+
+        std::vector<std::string> changed;
+        mWatcher.poll(changed);
+        for (const std::string &file : changed) {
+            for (ShaderHandle handle = 0; handle < mShaders.size(); ++handle) {
+                Shader &shader = mShaders[handle];
+                if (shader.sourceFile != file) {
+                    continue;
+                }
+                if (shader.compiling) {
+                    shader.dirty = true;
+                } else {
+                    compile(handle);
+                }
+            }
+        }
+
+        std::vector<CompiledShader> compiled;
+        {
+            std::lock_guard<std::mutex> lock(mCompleted->mutex);
+            compiled.swap(mCompleted->shaders);
+        }
+        const size_t count = reloaded.size();
+        for (CompiledShader &result : compiled) {
+            Shader &shader = mShaders[result.handle];
+            shader.compiling = false;
+            --mNumPendingCompiles;
+            if (!result.success) {
+                const std::string msg = "Cannot compile the shader " + shader.sourceFile + ", the previous code stays.";
+                logMessage(LogType::Warn, msg.c_str());
+            } else if (result.code != shader.code) {
+                shader.code = std::move(result.code);
+                ++shader.version;
+                reloaded.push_back(result.handle);
+                const std::string msg = "Reloaded the shader " + shader.sourceFile + ".";
+                logMessage(LogType::Info, msg.c_str());
+            }
+
+            // Saved again while compiling, the result above may be outdated already
+            if (shader.dirty) {
+                shader.dirty = false;
+                compile(result.handle);
+            }
+        }
+
+        return reloaded.size() - count;
+    }
+
+    void ShaderManager::compile(ShaderHandle handle) {
+        Shader &shader = mShaders[handle];
+        shader.compiling = true;
+        ++mNumPendingCompiles;
+
+        auto task = [completed = mCompleted, handle, sourceFile = shader.sourceFile, cacheDir = mCacheDir, compiler = mCompiler]() {
+            CompiledShader result;
+            result.handle = handle;
+            result.success = compileShaderCached(sourceFile.c_str(), cacheDir.c_str(), compiler.c_str(), result.code);
+            std::lock_guard<std::mutex> lock(completed->mutex);
+            completed->shaders.push_back(std::move(result));
+        };
+        if (mPool != nullptr) {
+            mPool->enqueue(task);
+        } else {
+            task();
+        }
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,159 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "core/filewatcher.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace segfault::core {
+    class ThreadPool;
+}
+
+namespace segfault::renderer {
+
+    /// @brief The handle of a shader in the shader manager.
+    using ShaderHandle = uint32_t;
+
+    /// @brief Marks an invalid shader handle.
+    static constexpr ShaderHandle InvalidShader = 0xFFFFFFFFu;
+
+    /// @brief The GLSL compiler invoked for changed shaders, it has to be on the path.
+    static constexpr const char *DefaultShaderCompiler = "glslc";
+
+    /// @brief Creates the shader cache directory unless it exists, its parent has to exist.
+    /// @param[ in ] cacheDir The cache directory.
+    SEGFAULT_EXPORT void createShaderCacheDir(const char *cacheDir);
+
+    /// @brief Compiles a GLSL shader to SPIR-V unless the cache holds the SPIR-V of the same 
+    /// source. The cache file is named by the hash of the source and the compiler, includes 
+    /// are not part of the hash.
+    /// @param[ in ] sourceFile The GLSL source, the stage is taken from the extension.
+    /// @param[ in ] cacheDir The cache directory, created if missing.
+    /// @param[ in ] compiler The compiler command.
+    /// @param[ out ] code Receives the SPIR-V.
+    /// @return True if valid SPIR-V was compiled or found in the cache.
+    SEGFAULT_EXPORT bool compileShaderCached(const char *sourceFile, const char *cacheDir, const char *compiler, std::vector<char> &code);
+
+    /// @brief Compiles a permutation of a GLSL shader to SPIR-V through the cache, the defines 
+    /// are part of the cache key.
+    /// @param[ in ] sourceFile The GLSL source, the stage is taken from the extension.
+    /// @param[ in ] cacheDir The cache directory, created if missing.
+    /// @param[ in ] compiler The compiler command.
+    /// @param[ in ] defines The defines, NAME or NAME=VALUE of letters, digits, '_' and '.'.
+    /// @param[ out ] code Receives the SPIR-V.
+    /// @return True if valid SPIR-V was compiled or found in the cache.
+    SEGFAULT_EXPORT bool compileShaderCached(const char *sourceFile, const char *cacheDir, const char *compiler, 
+        const std::vector<std::string> &defines, std::vector<char> &code);
+
+    //---------------------------------------------------------------------------------------------
+    /// @class ShaderManager
+    /// @brief Owns the SPIR-V of the shaders and reloads it when their sources change.
+    ///
+    /// Shaders start with the SPIR-V built offline. When the source of a shader exists, it is 
+    /// watched; a change is compiled on the thread pool through the SPIR-V cache. update hands 
+    /// out the reloaded shaders at a frame boundary, so the renderer can rebuild the affected 
+    /// pipelines while the old ones keep rendering. A failed compile keeps the previous code.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT ShaderManager final {
+    public:
+        /// @brief The class constructor, the manager is unusable until init is called.
+        ShaderManager() = default;
+
+        /// @brief The class destructor, compiles in flight are dropped.
+        ~ShaderManager() = default;
+
+        /// @brief Sets the pool and the cache.
+        /// @param[ in ] pool The pool running the compiles, must outlive the manager.
+        /// @param[ in ] cacheDir The SPIR-V cache directory.
+        /// @param[ in ] compiler The compiler command.
+        void init(core::ThreadPool *pool, const char *cacheDir, const char *compiler = DefaultShaderCompiler);
+
+        /// @brief Adds a shader with its offline SPIR-V and watches its source if it exists.
+        /// @param[ in ] sourceFile The GLSL source, may be missing in shipped builds.
+        /// @param[ in ] spirvFile The SPIR-V built offline.
+        /// @return The handle or InvalidShader if the SPIR-V cannot be read.
+        ShaderHandle add(const char *sourceFile, const char *spirvFile);
+
+        /// @brief Returns the current SPIR-V of a shader.
+        /// @param[ in ] handle The shader handle.
+        /// @return The code or nullptr for an invalid handle.
+        const std::vector<char> *getCode(ShaderHandle handle) const;
+
+        /// @brief Returns the GLSL source of a shader.
+        /// @param[ in ] handle The shader handle.
+        /// @return The source file or nullptr for an invalid handle.
+        const char *getSourceFile(ShaderHandle handle) const;
+
+        /// @brief Returns how often a shader was reloaded.
+        /// @param[ in ] handle The shader handle.
+        /// @return The number of reloads, zero for an invalid handle.
+        uint32_t getVersion(ShaderHandle handle) const;
+
+        /// @brief Returns true if the source of a shader is watched.
+        /// @param[ in ] handle The shader handle.
+        bool isWatched(ShaderHandle handle) const;
+
+        /// @brief Starts compiles for changed sources and takes the finished ones, call once per frame.
+        /// @param[ out ] reloaded Receives the shaders with new code, appended.
+        /// @return The number of reloaded shaders.
+        size_t update(std::vector<ShaderHandle> &reloaded);
+
+        /// @brief Returns the number of compiles in flight.
+        uint32_t getNumPendingCompiles() const { return mNumPendingCompiles; }
+
+        ShaderManager(const ShaderManager &) = delete;
+        ShaderManager &operator = (const ShaderManager &) = delete;
+
+    private:
+        void compile(ShaderHandle handle);
+
+    private:
+        struct Shader {
+            std::string sourceFile;     ///< The GLSL source.
+            std::vector<char> code;     ///< The current SPIR-V.
+            uint32_t version{ 0 };      ///< The number of reloads.
+            bool watched{ false };      ///< True if the source is watched.
+            bool compiling{ false };    ///< True while a compile is in flight.
+            bool dirty{ false };        ///< True if the source changed during the compile.
+        };
+        struct CompiledShader {
+            ShaderHandle handle{ InvalidShader };
+            bool success{ false };
+            std::vector<char> code;
+        };
+        struct CompletionQueue;
+
+        core::ThreadPool *mPool{ nullptr };
+        std::string mCacheDir;
+        std::string mCompiler{ DefaultShaderCompiler };
+        core::FileWatcher mWatcher;
+        std::vector<Shader> mShaders;
+        std::shared_ptr<CompletionQueue> mCompleted;
+        uint32_t mNumPendingCompiles{ 0 };
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,511 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/shaderreflection.h"
+#include "core/hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        constexpr uint32_t SpirvMagic = 0x07230203;
+        constexpr uint32_t SpirvHeaderWords = 5;
+        constexpr uint32_t MaxSpirvIds = 1u << 22;
+        constexpr uint32_t MaxTypeDepth = 16;
+        constexpr uint32_t MaxStructMembers = 16384;
+        constexpr uint32_t Unset = 0xFFFFFFFFu;
+
+        // The opcodes, decorations, storage classes and execution models used, see the SPIR-V specification
+        enum SpirvOp : uint32_t {
+            OpEntryPoint = 15,
+            OpTypeInt = 21,
+            OpTypeFloat = 22,
+            OpTypeVector = 23,
+            OpTypeMatrix = 24,
+            OpTypeImage = 25,
+            OpTypeSampler = 26,
+            OpTypeSampledImage = 27,
+            OpTypeArray = 28,
+            OpTypeRuntimeArray = 29,
+            OpTypeStruct = 30,
+            OpTypePointer = 32,
+            OpConstant = 43,
+            OpVariable = 59,
+            OpDecorate = 71,
+            OpMemberDecorate = 72
+        };
+
+        enum SpirvDecoration : uint32_t {
+            DecorationBlock = 2,
+            DecorationBufferBlock = 3,
+            DecorationArrayStride = 6,
+            DecorationMatrixStride = 7,
+            DecorationBuiltIn = 11,
+            DecorationLocation = 30,
+            DecorationBinding = 33,
+            DecorationDescriptorSet = 34,
+            DecorationOffset = 35
+        };
+
+        enum SpirvStorageClass : uint32_t {
+            StorageUniformConstant = 0,
+            StorageInput = 1,
+            StorageUniform = 2,
+            StoragePushConstant = 9,
+            StorageStorageBuffer = 12
+        };
+
+        enum SpirvExecutionModel : uint32_t {
+            ExecutionVertex = 0,
+            ExecutionFragment = 4,
+            ExecutionGLCompute = 5
+        };
+
+        constexpr uint32_t ImageDimBuffer = 5;
+
+        struct SpirvId {
+            uint32_t opcode{ 0 };
+            const uint32_t *words{ nullptr };   // The defining instruction
+            uint32_t numWords{ 0 };
+            uint32_t set{ Unset };
+            uint32_t binding{ Unset };
+            uint32_t location{ Unset };
+            uint32_t arrayStride{ 0 };
+            bool builtIn{ false };
+            bool block{ false };
+            bool bufferBlock{ false };
+            std::vector<uint32_t> memberOffsets;
+            std::vector<uint32_t> memberMatrixStrides;
+        };
+
+        struct SpirvModule {
+            std::vector<SpirvId> ids;
+            uint32_t stage{ 0 };
+        };
+
+        const SpirvId *getId(const SpirvModule &module, uint32_t id) {
+            return id < module.ids.size() && module.ids[id].opcode != 0 ? &module.ids[id] : nullptr;
+        }
+
+        bool getConstant(const SpirvModule &module, uint32_t id, uint32_t &value) {
+            const SpirvId *constant = getId(module, id);
+            if (constant == nullptr || constant->opcode != OpConstant || constant->numWords < 4) {
+                return false;
+            }
+            value = constant->words[3];
+
+            return true;
+        }
+
+        void setMemberDecoration(std::vector<uint32_t> &values, uint32_t member, uint32_t value) {
+            if (member >= values.size()) {
+                values.resize(member + 1, 0);
+            }
+            values[member] = value;
+        }
+
+        // The size of a push constant member, matrices and arrays follow their stride decorations
+        bool getTypeSize(const SpirvModule &module, uint32_t typeId, uint32_t matrixStride, uint32_t depth, uint32_t &size) {
+            const SpirvId *type = getId(module, typeId);
+            if (type == nullptr || depth > MaxTypeDepth) {
+                return false;
+            }
+
+            switch (type->opcode) {
+                case OpTypeInt:
+                case OpTypeFloat:
+                    size = type->words[2] / 8;
+                    return true;
+                case OpTypeVector: {
+                    uint32_t componentSize = 0;
+                    if (!getTypeSize(module, type->words[2], 0, depth + 1, componentSize)) {
+                        return false;
+                    }
+                    size = componentSize * type->words[3];
+                    return true;
+                }
+                case OpTypeMatrix: {
+                    uint32_t columnSize = matrixStride;
+                    if (columnSize == 0 && !getTypeSize(module, type->words[2], 0, depth + 1, columnSize)) {
+                        return false;
+                    }
+                    size = columnSize * type->words[3];
+                    return true;
+                }
+                case OpTypeArray: {
+                    uint32_t length = 0, elementSize = type->arrayStride;
+                    if (!getConstant(module, type->words[3], length) ||
+                            (elementSize == 0 && !getTypeSize(module, type->words[2], matrixStride, depth + 1, elementSize))) {
+                        return false;
+                    }
+                    size = elementSize * length;
+                    return true;
+                }
+                case OpTypeStruct: {
+                    size = 0;
+                    for (uint32_t i = 2; i < type->numWords; ++i) {
+                        const uint32_t member = i - 2;
+                        const uint32_t offset = member < type->memberOffsets.size() ? type->memberOffsets[member] : 0;
+                        const uint32_t stride = member < type->memberMatrixStrides.size() ? type->memberMatrixStrides[member] : 0;
+                        uint32_t memberSize = 0;
+                        if (!getTypeSize(module, type->words[i], stride, depth + 1, memberSize)) {
+                            return false;
+                        }
+                        size = std::max(size, offset + memberSize);
+                    }
+                    return true;
+                }
+                default:
+                    break;
+            }
+
+            return false;
+        }
+
+        bool reflectDescriptor(const SpirvModule &module, const SpirvId &variable, uint32_t storage, uint32_t typeId, ShaderReflection &reflection) {
+            ShaderBinding binding;
+            binding.set = variable.set != Unset ? variable.set : 0;
+            binding.binding = variable.binding;
+            binding.stages = module.stage;
+
+            const SpirvId *type = getId(module, typeId);
+            while (type != nullptr && type->opcode == OpTypeArray) {
+                uint32_t length = 0;
+                if (!getConstant(module, type->words[3], length)) {
+                    return false;
+                }
+                binding.count *= length;
+                type = getId(module, type->words[2]);
+            }
+            if (type == nullptr || binding.binding == Unset) {
+                return false;
+            }
+
+            if (storage == StorageUniform && type->opcode == OpTypeStruct) {
+                binding.type = type->bufferBlock ? ShaderDescriptorType::StorageBuffer : ShaderDescriptorType::UniformBuffer;
+            } else if (storage == StorageStorageBuffer && type->opcode == OpTypeStruct) {
+                binding.type = ShaderDescriptorType::StorageBuffer;
+            } else if (type->opcode == OpTypeSampledImage) {
+                binding.type = ShaderDescriptorType::CombinedImageSampler;
+            } else if (type->opcode == OpTypeSampler) {
+                binding.type = ShaderDescriptorType::Sampler;
+            } else if (type->opcode == OpTypeImage && type->numWords > 7 && type->words[3] != ImageDimBuffer) {
+                binding.type = type->words[7] == 2 ? ShaderDescriptorType::StorageImage : ShaderDescriptorType::SampledImage;
+            } else {
+                // Texel buffers, runtime arrays and acceleration structures are not used so far
+                return false;
+            }
+            reflection.bindings.push_back(binding);
+
+            return true;
+        }
+
+        bool reflectVertexInput(const SpirvModule &module, const SpirvId &variable, uint32_t typeId, ShaderReflection &reflection) {
+            ShaderVertexInput input;
+            input.location = variable.location;
+            input.numComponents = 1;
+            const SpirvId *type = getId(module, typeId);
+            if (type != nullptr && type->opcode == OpTypeVector) {
+                input.numComponents = type->words[3];
+                type = getId(module, type->words[2]);
+            }
+            if (type == nullptr || input.location == Unset || input.numComponents > 4 ||
+                    (type->opcode != OpTypeFloat && type->opcode != OpTypeInt) || type->words[2] != 32) {
+                return false;
+            }
+
+            if (type->opcode == OpTypeFloat) {
+                input.type = ShaderScalarType::Float;
+            } else if (type->opcode == OpTypeInt) {
+                input.type = type->words[3] != 0 ? ShaderScalarType::Int : ShaderScalarType::Uint;
+            } else {
+                return false;
+            }
+            reflection.vertexInputs.push_back(input);
+
+            return true;
+        }
+
+        // The number of operand words each opcode needs at least, checked before the words are read
+        uint32_t getMinWords(uint32_t opcode) {
+            switch (opcode) {
+                case OpEntryPoint:
+                case OpTypeInt:
+                case OpTypeVector:
+                case OpTypeMatrix:
+                case OpTypeArray:
+                case OpTypePointer:
+                case OpConstant:
+                case OpVariable:
+                case OpMemberDecorate:
+                    return 4;
+                case OpTypeFloat:
+                case OpDecorate:
+                case OpTypeSampledImage:
+                case OpTypeRuntimeArray:
+                    return 3;
+                case OpTypeImage:
+                    return 9;
+                case OpTypeSampler:
+                case OpTypeStruct:
+                    return 2;
+                default:
+                    break;
+            }
+
+            return 1;
+        }
+
+    } // namespace
+
+    bool reflectShader(const void *code, size_t size, ShaderReflection &reflection) {
+        reflection = ShaderReflection();
+        if (code == nullptr || size % sizeof(uint32_t) != 0 || size < SpirvHeaderWords * sizeof(uint32_t)) {
+            return false;
+        }
+
+        // The words are copied, the binary may not be 4 byte aligned
+        std::vector<uint32_t> words(size / sizeof(uint32_t));
+        memcpy(words.data(), code, size);
+        const uint32_t bound = words[3];
+        if (words[0] != SpirvMagic || bound > MaxSpirvIds) {
+            return false;
+        }
+
+        SpirvModule module;
+        module.ids.resize(bound);
+        std::vector<uint32_t> variables;
+        for (size_t pos = SpirvHeaderWords; pos < words.size(); ) {
+            const uint32_t *instruction = &words[pos];
+            const uint32_t opcode = instruction[0] & 0xFFFFu;
+            const uint32_t numWords = instruction[0] >> 16;
+            if (numWords == 0 || pos + numWords > words.size() || numWords < getMinWords(opcode)) {
+                return false;
+            }
+            pos += numWords;
+
+            uint32_t resultId = Unset;
+            switch (opcode) {
+                case OpEntryPoint:
+                    if (module.stage != 0) {
+                        break;
+                    }
+                    if (instruction[1] == ExecutionVertex) {
+                        module.stage = ShaderStageVertex;
+                    } else if (instruction[1] == ExecutionFragment) {
+                        module.stage = ShaderStageFragment;
+                    } else if (instruction[1] == ExecutionGLCompute) {
+                        module.stage = ShaderStageCompute;
+                    } else {
+                        return false;
+                    }
+                    break;
+                case OpTypeInt:
+                case OpTypeFloat:
+                case OpTypeVector:
+                case OpTypeMatrix:
+                case OpTypeImage:
+                case OpTypeSampler:
+                case OpTypeSampledImage:
+                case OpTypeArray:
+                case OpTypeRuntimeArray:
+                case OpTypeStruct:
+                case OpTypePointer:
+                    resultId = instruction[1];
+                    break;
+                case OpConstant:
+                    resultId = instruction[2];
+                    break;
+                case OpVariable:
+                    resultId = instruction[2];
+                    variables.push_back(resultId);
+                    break;
+                case OpDecorate: {
+                    if (instruction[1] >= bound) {
+                        return false;
+                    }
+                    SpirvId &target = module.ids[instruction[1]];
+                    const uint32_t value = numWords > 3 ? instruction[3] : 0;
+                    switch (instruction[2]) {
+                        case DecorationBlock: target.block = true; break;
+                        case DecorationBufferBlock: target.bufferBlock = true; break;
+                        case DecorationArrayStride: target.arrayStride = value; break;
+                        case DecorationBuiltIn: target.builtIn = true; break;
+                        case DecorationLocation: target.location = value; break;
+                        case DecorationBinding: target.binding = value; break;
+                        case DecorationDescriptorSet: target.set = value; break;
+                        default: break;
+                    }
+                    break;
+                }
+                case OpMemberDecorate: {
+                    if (instruction[1] >= bound || instruction[2] >= MaxStructMembers) {
+                        return false;
+                    }
+                    SpirvId &target = module.ids[instruction[1]];
+                    const uint32_t value = numWords > 4 ? instruction[4] : 0;
+                    if (instruction[3] == DecorationOffset) {
+                        setMemberDecoration(target.memberOffsets, instruction[2], value);
+                    } else if (instruction[3] == DecorationMatrixStride) {
+                        setMemberDecoration(target.memberMatrixStrides, instruction[2], value);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            if (resultId != Unset) {
+                if (resultId >= bound) {
+                    return false;
+                }
+                SpirvId &id = module.ids[resultId];
+                id.opcode = opcode;
+                id.words = instruction;
+                id.numWords = numWords;
+            }
+        }
+        if (module.stage == 0) {
+            return false;
+        }
+
+        reflection.stages = module.stage;
+        for (uint32_t variableId : variables) {
+            const SpirvId &variable = module.ids[variableId];
+            const SpirvId *pointer = getId(module, variable.words[1]);
+            if (pointer == nullptr || pointer->opcode != OpTypePointer) {
+                return false;
+            }
+            if (variable.builtIn) {
+                continue;
+            }
+
+            const uint32_t typeId = pointer->words[3];
+            switch (variable.words[3]) {
+                case StorageUniformConstant:
+                case StorageUniform:
+                case StorageStorageBuffer:
+                    if (!reflectDescriptor(module, variable, variable.words[3], typeId, reflection)) {
+                        return false;
+                    }
+                    break;
+                case StoragePushConstant:
+                    if (!getTypeSize(module, typeId, 0, 0, reflection.pushConstantSize)) {
+                        return false;
+                    }
+                    reflection.pushConstantStages = module.stage;
+                    break;
+                case StorageInput:
+                    if (module.stage == ShaderStageVertex && !reflectVertexInput(module, variable, typeId, reflection)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ShaderBinding &a, const ShaderBinding &b) {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+        std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const ShaderVertexInput &a, const ShaderVertexInput &b) {
+            return a.location < b.location;
+        });
+
+        return true;
+    }
+
+    bool mergeShaderReflection(const ShaderReflection &stage, ShaderReflection &pipeline) {
+        for (const ShaderBinding &binding : stage.bindings) {
+            auto it = std::find_if(pipeline.bindings.begin(), pipeline.bindings.end(), [&binding](const ShaderBinding &other) {
+                return other.set == binding.set && other.binding == binding.binding;
+            });
+            if (it == pipeline.bindings.end()) {
+                pipeline.bindings.push_back(binding);
+            } else if (it->type != binding.type || it->count != binding.count) {
+                return false;
+            } else {
+                it->stages |= binding.stages;
+            }
+        }
+        std::sort(pipeline.bindings.begin(), pipeline.bindings.end(), [](const ShaderBinding &a, const ShaderBinding &b) {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+
+        // One push constant range serves all stages
+        if (stage.pushConstantSize > 0) {
+            pipeline.pushConstantSize = std::max(pipeline.pushConstantSize, stage.pushConstantSize);
+            pipeline.pushConstantStages |= stage.pushConstantStages;
+        }
+        if ((stage.stages & ShaderStageVertex) != 0) {
+            pipeline.vertexInputs = stage.vertexInputs;
+        }
+        pipeline.stages |= stage.stages;
+
+        return true;
+    }
+
+    uint32_t getNumDescriptorSets(const ShaderReflection &reflection) {
+        return reflection.bindings.empty() ? 0 : reflection.bindings.back().set + 1;
+    }
+
+    uint64_t hashDescriptorSet(const ShaderReflection &reflection, uint32_t set) {
+        uint64_t hash = FnvOffsetBasis;
+        for (const ShaderBinding &binding : reflection.bindings) {
+            if (binding.set != set) {
+                continue;
+            }
+            const uint32_t key[4] = { binding.binding, binding.count, static_cast<uint32_t>(binding.type), binding.stages };
+            hash = hashBytes(key, sizeof(key), hash);
+        }
+
+        return hash;
+    }
+
+    uint64_t hashPipelineLayout(const ShaderReflection &reflection) {
+        const uint32_t numSets = getNumDescriptorSets(reflection);
+        const uint32_t pushConstants[3] = { numSets, reflection.pushConstantSize, reflection.pushConstantStages };
+        uint64_t hash = hashBytes(pushConstants, sizeof(pushConstants));
+        for (uint32_t set = 0; set < numSets; ++set) {
+            const uint64_t setHash = hashDescriptorSet(reflection, set);
+            hash = hashBytes(&setHash, sizeof(setHash), hash);
+        }
+
+        return hash;
+    }
+
+    const ShaderBinding *findShaderBinding(const ShaderReflection &reflection, uint32_t set, uint32_t binding) {
+        for (const ShaderBinding &candidate : reflection.bindings) {
+            if (candidate.set == set && candidate.binding == binding) {
+                return &candidate;
+            }
+        }
+
+        return nullptr;
+    }
+
+} // namespace segfault::renderer
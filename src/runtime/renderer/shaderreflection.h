@@ -0,0 +1,119 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <vector>
+
+namespace segfault::renderer {
+
+    /// @brief The shader stage bits of a reflection.
+    constexpr uint32_t ShaderStageVertex = 1;
+    constexpr uint32_t ShaderStageFragment = 2;
+    constexpr uint32_t ShaderStageCompute = 4;
+
+    /// @brief The kinds of resources a shader binds.
+    enum class ShaderDescriptorType : int32_t {
+        Invalid = -1,
+        UniformBuffer,          ///< A uniform block.
+        StorageBuffer,          ///< A buffer block, read or written.
+        CombinedImageSampler,   ///< A sampled image with its sampler.
+        SampledImage,           ///< A sampled image without a sampler.
+        Sampler,                ///< A sampler without an image.
+        StorageImage,           ///< An image loaded or stored without sampling.
+        Count
+    };
+
+    /// @brief The component types of a vertex input.
+    enum class ShaderScalarType : int32_t {
+        Invalid = -1,
+        Float,
+        Int,
+        Uint,
+        Count
+    };
+
+    /// @brief A resource binding of a shader.
+    struct ShaderBinding {
+        uint32_t set{ 0 };                                          ///< The descriptor set.
+        uint32_t binding{ 0 };                                      ///< The binding in the set.
+        uint32_t count{ 1 };                                        ///< The array size, 1 for single resources.
+        ShaderDescriptorType type{ ShaderDescriptorType::Invalid }; ///< The descriptor type.
+        uint32_t stages{ 0 };                                       ///< The stages using the binding.
+    };
+
+    /// @brief An input of a vertex shader, fed from the vertex buffer.
+    struct ShaderVertexInput {
+        uint32_t location{ 0 };                             ///< The input location.
+        ShaderScalarType type{ ShaderScalarType::Invalid }; ///< The component type.
+        uint32_t numComponents{ 0 };                        ///< The number of components, 1 to 4.
+    };
+
+    /// @brief The interface of a shader or of the stages of a pipeline.
+    struct ShaderReflection {
+        uint32_t stages{ 0 };                           ///< The reflected stages.
+        std::vector<ShaderBinding> bindings;            ///< The bindings sorted by set and binding.
+        uint32_t pushConstantSize{ 0 };                 ///< The size of the push constant block, 0 if none.
+        uint32_t pushConstantStages{ 0 };               ///< The stages using the push constants.
+        std::vector<ShaderVertexInput> vertexInputs;    ///< The vertex inputs sorted by location.
+    };
+
+    /// @brief Reads the interface of a SPIR-V module with one entry point. Built-in variables 
+    /// are skipped, so gl_VertexIndex and friends need no vertex input.
+    /// @param[ in ] code The SPIR-V module.
+    /// @param[ in ] size The size of the module in bytes.
+    /// @param[ out ] reflection Receives the interface.
+    /// @return False if the module is malformed or uses an unsupported stage or resource.
+    SEGFAULT_EXPORT bool reflectShader(const void *code, size_t size, ShaderReflection &reflection);
+
+    /// @brief Merges the interface of a stage into the interface of a pipeline.
+    /// @param[ in ] stage The interface of the stage.
+    /// @param[ inout ] pipeline The interface of the pipeline.
+    /// @return False if a binding is declared with different types or counts.
+    SEGFAULT_EXPORT bool mergeShaderReflection(const ShaderReflection &stage, ShaderReflection &pipeline);
+
+    /// @brief Returns the number of descriptor sets, the highest set used plus one.
+    /// @param[ in ] reflection The interface.
+    SEGFAULT_EXPORT uint32_t getNumDescriptorSets(const ShaderReflection &reflection);
+
+    /// @brief Hashes the bindings of one descriptor set, equal sets of different shaders share 
+    /// the hash and thus their layout.
+    /// @param[ in ] reflection The interface.
+    /// @param[ in ] set The descriptor set.
+    /// @return The hash, the same for all empty sets.
+    SEGFAULT_EXPORT uint64_t hashDescriptorSet(const ShaderReflection &reflection, uint32_t set);
+
+    /// @brief Hashes the whole pipeline layout, all descriptor sets and the push constants.
+    /// @param[ in ] reflection The interface.
+    /// @return The hash.
+    SEGFAULT_EXPORT uint64_t hashPipelineLayout(const ShaderReflection &reflection);
+
+    /// @brief Returns a binding.
+    /// @param[ in ] reflection The interface.
+    /// @param[ in ] set The descriptor set.
+    /// @param[ in ] binding The binding.
+    /// @return The binding or nullptr if the interface does not use it.
+    SEGFAULT_EXPORT const ShaderBinding *findShaderBinding(const ShaderReflection &reflection, uint32_t set, uint32_t binding);
+
+} // namespace segfault::renderer
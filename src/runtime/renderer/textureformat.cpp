@@ -0,0 +1,256 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/textureformat.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        size_t alignOffset(size_t offset) {
+            return (offset + TextureDataAlignment - 1) & ~static_cast<size_t>(TextureDataAlignment - 1);
+        }
+
+        // The data holds at least the header and the mip table, size is the size of the whole blob
+        bool validateHeader(const TextureFileHeader &header, const uint8_t *data, size_t size) {
+            const TextureFormat format = static_cast<TextureFormat>(header.format);
+            if (header.magic != TextureFileMagic || getTextureBlockSize(format) == 0 || header.width == 0 || header.height == 0) {
+                return false;
+            }
+            if (header.numMips == 0 || header.numMips > MaxTextureMips || header.numMips > computeTextureMipCount(header.width, header.height)) {
+                return false;
+            }
+
+            const size_t tableEnd = static_cast<size_t>(header.mipTableOffset) + static_cast<size_t>(header.numMips) * sizeof(TextureMipRecord);
+            const size_t dataEnd = static_cast<size_t>(header.dataOffset) + header.dataSize;
+            if (header.mipTableOffset < sizeof(TextureFileHeader) || tableEnd > header.dataOffset || 
+                    header.dataOffset % TextureDataAlignment != 0 || dataEnd > size) {
+                return false;
+            }
+
+            // Every level must have the expected size and lie inside the data range, the GPU copies 
+            // from these offsets without further checks. The streamer derives ranges from the 
+            // differences of the offsets, so the levels must also be stored back to back from the 
+            // smallest level to level 0, exactly as create lays them out.
+            size_t expectedOffset = header.dataOffset;
+            for (uint32_t i = header.numMips; i-- > 0;) {
+                TextureMipRecord mip;
+                memcpy(&mip, data + header.mipTableOffset + i * sizeof(TextureMipRecord), sizeof(mip));
+                if (mip.width != std::max(header.width >> i, 1u) || mip.height != std::max(header.height >> i, 1u) ||
+                        mip.dataSize != computeTextureMipSize(format, mip.width, mip.height) || 
+                        mip.dataOffset != expectedOffset || static_cast<size_t>(mip.dataOffset) + mip.dataSize > dataEnd) {
+                    return false;
+                }
+                expectedOffset = alignOffset(expectedOffset + mip.dataSize);
+            }
+
+            return expectedOffset == dataEnd;
+        }
+
+    } // namespace
+
+    uint32_t getTextureBlockExtent(TextureFormat format) {
+        switch (format) {
+            case TextureFormat::RGBA8:
+                return 1;
+            case TextureFormat::BC1:
+            case TextureFormat::BC3:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return 4;
+            default:
+                break;
+        }
+        return 0;
+    }
+
+    uint32_t getTextureBlockSize(TextureFormat format) {
+        switch (format) {
+            case TextureFormat::RGBA8:
+                return 4;
+            case TextureFormat::BC1:
+                return 8;
+            case TextureFormat::BC3:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return 16;
+            default:
+                break;
+        }
+        return 0;
+    }
+
+    size_t computeTextureMipSize(TextureFormat format, uint32_t width, uint32_t height) {
+        const uint32_t extent = getTextureBlockExtent(format);
+        if (extent == 0) {
+            return 0;
+        }
+
+        const size_t blocksX = (static_cast<size_t>(width) + extent - 1) / extent;
+        const size_t blocksY = (static_cast<size_t>(height) + extent - 1) / extent;
+
+        return blocksX * blocksY * getTextureBlockSize(format);
+    }
+
+    uint32_t computeTextureMipCount(uint32_t width, uint32_t height) {
+        uint32_t size = std::max(width, height);
+        uint32_t count = 1;
+        while (size > 1) {
+            size >>= 1;
+            ++count;
+        }
+
+        return count;
+    }
+
+    bool TextureData::create(TextureFormat format, uint8_t flags, uint32_t width, uint32_t height, 
+            uint32_t numMips, const uint8_t *const *mips) {
+        clear();
+        if (getTextureBlockSize(format) == 0 || width == 0 || height == 0 || mips == nullptr || numMips == 0 ||
+                numMips > MaxTextureMips || numMips > computeTextureMipCount(width, height)) {
+            logMessage(LogType::Error, "Invalid texture data.");
+            return false;
+        }
+
+        mHeader = TextureFileHeader{};
+        mHeader.format = static_cast<uint8_t>(format);
+        mHeader.flags = flags;
+        mHeader.width = width;
+        mHeader.height = height;
+        mHeader.numMips = numMips;
+        mHeader.mipTableOffset = sizeof(TextureFileHeader);
+        mHeader.dataOffset = static_cast<uint32_t>(alignOffset(mHeader.mipTableOffset + numMips * sizeof(TextureMipRecord)));
+
+        // Lay out the levels from the smallest to level 0
+        TextureMipRecord records[MaxTextureMips];
+        size_t offset = mHeader.dataOffset;
+        for (uint32_t i = numMips; i-- > 0;) {
+            if (mips[i] == nullptr) {
+                logMessage(LogType::Error, "Invalid texture data.");
+                clear();
+                return false;
+            }
+            records[i].width = std::max(width >> i, 1u);
+            records[i].height = std::max(height >> i, 1u);
+            records[i].dataOffset = static_cast<uint32_t>(offset);
+            records[i].dataSize = static_cast<uint32_t>(computeTextureMipSize(format, records[i].width, records[i].height));
+            offset = alignOffset(offset + records[i].dataSize);
+            if (offset > 0xffffffffu) {
+                logMessage(LogType::Error, "Texture is too large.");
+                clear();
+                return false;
+            }
+        }
+        mHeader.dataSize = static_cast<uint32_t>(offset - mHeader.dataOffset);
+
+        mBlob.assign(offset, 0);
+        memcpy(mBlob.data(), &mHeader, sizeof(mHeader));
+        memcpy(mBlob.data() + mHeader.mipTableOffset, records, numMips * sizeof(TextureMipRecord));
+        for (uint32_t i = 0; i < numMips; ++i) {
+            memcpy(mBlob.data() + records[i].dataOffset, mips[i], records[i].dataSize);
+        }
+
+        return true;
+    }
+
+    bool TextureData::load(const uint8_t *data, size_t size) {
+        clear();
+        if (!isBinary(data, size) || size < sizeof(TextureFileHeader)) {
+            return false;
+        }
+
+        memcpy(&mHeader, data, sizeof(mHeader));
+        if (mHeader.version != TextureFileVersion) {
+            logMessage(LogType::Error, "Unsupported texture version, rebake the asset.");
+            clear();
+            return false;
+        }
+
+        if (!validateHeader(mHeader, data, size)) {
+            logMessage(LogType::Error, "Texture blob is corrupt.");
+            clear();
+            return false;
+        }
+        mBlob.assign(data, data + size);
+
+        return true;
+    }
+
+    bool TextureData::save(std::vector<uint8_t> &blob) const {
+        if (mBlob.empty()) {
+            return false;
+        }
+
+        blob = mBlob;
+
+        return true;
+    }
+
+    bool TextureData::isBinary(const uint8_t *data, size_t size) {
+        if (data == nullptr || size < sizeof(uint32_t)) {
+            return false;
+        }
+
+        uint32_t magic{ 0 };
+        memcpy(&magic, data, sizeof(magic));
+
+        return magic == TextureFileMagic;
+    }
+
+    bool TextureData::readHeader(const uint8_t *data, size_t size, size_t fileSize, TextureFileHeader &header, TextureMipRecord *mips) {
+        if (!isBinary(data, size) || size < sizeof(TextureFileHeader) || mips == nullptr) {
+            return false;
+        }
+
+        memcpy(&header, data, sizeof(header));
+        if (header.version != TextureFileVersion) {
+            logMessage(LogType::Error, "Unsupported texture version, rebake the asset.");
+            return false;
+        }
+        if (static_cast<size_t>(header.mipTableOffset) + static_cast<size_t>(header.numMips) * sizeof(TextureMipRecord) > size ||
+                !validateHeader(header, data, fileSize)) {
+            logMessage(LogType::Error, "Texture header is corrupt.");
+            return false;
+        }
+        memcpy(mips, data + header.mipTableOffset, header.numMips * sizeof(TextureMipRecord));
+
+        return true;
+    }
+
+    TextureMipRecord TextureData::getMip(uint32_t level) const {
+        TextureMipRecord mip;
+        memcpy(&mip, mBlob.data() + mHeader.mipTableOffset + static_cast<size_t>(level) * sizeof(TextureMipRecord), sizeof(mip));
+
+        return mip;
+    }
+
+    void TextureData::clear() {
+        mHeader = TextureFileHeader{};
+        mBlob.clear();
+    }
+
+} // namespace segfault::renderer
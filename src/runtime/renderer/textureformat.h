@@ -0,0 +1,213 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <vector>
+
+namespace segfault::renderer {
+
+    /// @brief The magic number of a baked texture, "SFTX" in little endian.
+    constexpr uint32_t TextureFileMagic = 0x58544653;
+
+    /// @brief The version of the baked texture format.
+    constexpr uint16_t TextureFileVersion = 1;
+
+    /// @brief The alignment of the mip levels inside a baked texture.
+    constexpr uint32_t TextureDataAlignment = 16;
+
+    /// @brief The maximum number of mip levels, enough for 32768 x 32768 texels.
+    constexpr uint32_t MaxTextureMips = 16;
+
+    /// @brief The texel layouts of a baked texture.
+    enum class TextureFormat : int32_t {
+        Invalid = -1,
+        RGBA8,      ///< Uncompressed, four bytes per texel.
+        BC1,        ///< RGB with optional 1 bit alpha, 8 bytes per 4x4 block.
+        BC3,        ///< RGBA, BC1 color plus interpolated alpha, 16 bytes per 4x4 block.
+        BC5,        ///< Two independent channels, meant for tangent space normals, 16 bytes per 4x4 block.
+        BC7,        ///< High quality RGBA, 16 bytes per 4x4 block.
+        Count
+    };
+
+    /// @brief The texture holds sRGB encoded color, the sampler converts it to linear.
+    constexpr uint8_t TextureFlagSrgb = 1;
+
+    /// @brief The texture holds a tangent space normal map in its first two channels.
+    constexpr uint8_t TextureFlagNormalMap = 2;
+
+    /// @brief Returns the width and height of a compression block in texels.
+    /// @param[ in ] format The texture format.
+    /// @return 4 for block compressed formats, 1 for uncompressed ones, 0 for invalid formats.
+    SEGFAULT_EXPORT uint32_t getTextureBlockExtent(TextureFormat format);
+
+    /// @brief Returns the size of a compression block or texel in bytes.
+    /// @param[ in ] format The texture format.
+    /// @return The block size, 0 for invalid formats.
+    SEGFAULT_EXPORT uint32_t getTextureBlockSize(TextureFormat format);
+
+    /// @brief Returns the size of a mip level in bytes, partial blocks at the border count as full blocks.
+    /// @param[ in ] format The texture format.
+    /// @param[ in ] width The width of the level in texels.
+    /// @param[ in ] height The height of the level in texels.
+    /// @return The size, 0 for invalid formats.
+    SEGFAULT_EXPORT size_t computeTextureMipSize(TextureFormat format, uint32_t width, uint32_t height);
+
+    /// @brief Returns the number of levels of a full mip chain down to 1 x 1.
+    /// @param[ in ] width The width of level 0.
+    /// @param[ in ] height The height of level 0.
+    /// @return The number of levels.
+    SEGFAULT_EXPORT uint32_t computeTextureMipCount(uint32_t width, uint32_t height);
+
+    /// @brief Describes one mip level of a baked texture.
+    struct TextureMipRecord {
+        uint32_t width{ 0 };            ///< The width in texels.
+        uint32_t height{ 0 };           ///< The height in texels.
+        uint32_t dataOffset{ 0 };       ///< The offset of the level from the start of the blob.
+        uint32_t dataSize{ 0 };         ///< The size of the level in bytes.
+    };
+    static_assert(sizeof(TextureMipRecord) == 16, "Unexpected mip layout.");
+
+    /// @brief The header of a baked texture. The mip records follow the header, the level data 
+    /// follows the records. The smallest level is stored first, so the low resolution tail of 
+    /// the chain is one contiguous range right behind the records.
+    struct TextureFileHeader {
+        uint32_t magic{ TextureFileMagic };     ///< The magic number, must be TextureFileMagic.
+        uint16_t version{ TextureFileVersion }; ///< The format version.
+        uint8_t format{ 0 };                    ///< The TextureFormat.
+        uint8_t flags{ 0 };                     ///< The TextureFlag bits.
+        uint32_t width{ 0 };                    ///< The width of level 0.
+        uint32_t height{ 0 };                   ///< The height of level 0.
+        uint32_t numMips{ 0 };                  ///< The number of mip levels.
+        uint32_t mipTableOffset{ 0 };           ///< The offset of the mip records from the start of the blob.
+        uint32_t dataOffset{ 0 };               ///< The offset of the level data from the start of the blob.
+        uint32_t dataSize{ 0 };                 ///< The size of the level data in bytes.
+    };
+    static_assert(sizeof(TextureFileHeader) == 32, "Unexpected texture header layout.");
+
+    /// @brief The size of the header and the largest mip table, reading this many bytes is 
+    /// enough for TextureData::readHeader.
+    constexpr size_t MaxTextureHeaderSize = sizeof(TextureFileHeader) + MaxTextureMips * sizeof(TextureMipRecord);
+
+    //---------------------------------------------------------------------------------------------
+    /// @class TextureData
+    /// @brief A baked texture ready for upload.
+    ///
+    /// The level data is stored in the layout the GPU expects, the whole data range can be 
+    /// copied into one staging buffer and each level copied from its offset. Textures are 
+    /// filtered and compressed by the assetbaker.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT TextureData final {
+    public:
+        /// @brief The class constructor.
+        TextureData() = default;
+
+        /// @brief The class destructor.
+        ~TextureData() = default;
+
+        /// @brief Builds the texture from encoded mip levels.
+        /// @param[ in ] format The texture format of the levels.
+        /// @param[ in ] flags The TextureFlag bits.
+        /// @param[ in ] width The width of level 0.
+        /// @param[ in ] height The height of level 0.
+        /// @param[ in ] numMips The number of levels, each one half the size of the previous one.
+        /// @param[ in ] mips The encoded levels, computeTextureMipSize bytes each.
+        /// @return True if the data describes a valid texture, false otherwise.
+        bool create(TextureFormat format, uint8_t flags, uint32_t width, uint32_t height, 
+            uint32_t numMips, const uint8_t *const *mips);
+
+        /// @brief Loads the texture from a baked blob.
+        /// @param[ in ] data The blob data.
+        /// @param[ in ] size The size of the blob in bytes.
+        /// @return True if the blob is a valid texture, false otherwise.
+        bool load(const uint8_t *data, size_t size);
+
+        /// @brief Returns the baked blob.
+        /// @param[ out ] blob The blob to write to.
+        /// @return True if the texture was serialized, false if the texture is empty.
+        bool save(std::vector<uint8_t> &blob) const;
+
+        /// @brief Checks if the data starts with the baked texture magic.
+        /// @param[ in ] data The data to check.
+        /// @param[ in ] size The size of the data in bytes.
+        /// @return True if the data is a baked texture.
+        static bool isBinary(const uint8_t *data, size_t size);
+
+        /// @brief Reads and validates the header and the mip table of a baked texture without 
+        /// its level data, used to stream the levels separately.
+        /// @param[ in ] data The start of the blob, at least the header and the mip table.
+        /// @param[ in ] size The size of the data in bytes.
+        /// @param[ in ] fileSize The size of the whole blob in bytes.
+        /// @param[ out ] header Receives the header.
+        /// @param[ out ] mips Receives the mip records, MaxTextureMips entries.
+        /// @return True if the header describes a valid texture of fileSize bytes.
+        static bool readHeader(const uint8_t *data, size_t size, size_t fileSize, TextureFileHeader &header, TextureMipRecord *mips);
+
+        /// @brief Returns true if no texture is loaded.
+        bool isEmpty() const { return mBlob.empty(); }
+
+        /// @brief Returns the texture format.
+        TextureFormat getFormat() const { return static_cast<TextureFormat>(mHeader.format); }
+
+        /// @brief Returns the TextureFlag bits.
+        uint8_t getFlags() const { return mHeader.flags; }
+
+        /// @brief Returns true if the texture holds sRGB encoded color.
+        bool isSrgb() const { return (mHeader.flags & TextureFlagSrgb) != 0; }
+
+        /// @brief Returns the width of level 0.
+        uint32_t getWidth() const { return mHeader.width; }
+
+        /// @brief Returns the height of level 0.
+        uint32_t getHeight() const { return mHeader.height; }
+
+        /// @brief Returns the number of mip levels.
+        uint32_t getNumMips() const { return mHeader.numMips; }
+
+        /// @brief Returns a mip level.
+        /// @param[ in ] level The level, must be less than getNumMips.
+        TextureMipRecord getMip(uint32_t level) const;
+
+        /// @brief Returns the data of a mip level.
+        /// @param[ in ] level The level, must be less than getNumMips.
+        const uint8_t *getMipData(uint32_t level) const { return mBlob.data() + getMip(level).dataOffset; }
+
+        /// @brief Returns the offset of the level data from the start of the blob.
+        uint32_t getDataOffset() const { return mHeader.dataOffset; }
+
+        /// @brief Returns the data of all levels.
+        const uint8_t *getData() const { return mBlob.data() + mHeader.dataOffset; }
+
+        /// @brief Returns the size of the data of all levels in bytes.
+        size_t getDataSize() const { return mHeader.dataSize; }
+
+    private:
+        void clear();
+
+    private:
+        TextureFileHeader mHeader{};
+        std::vector<uint8_t> mBlob;
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,211 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/textureloader.h"
+#include "core/ifilemanager.h"
+#include "core/simd.h"
+#include "core/threadpool.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <cstring>
+#include <limits>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        void expandRgb(const uint8_t *src, size_t numPixels, uint8_t *dst) {
+            size_t i = 0;
+#ifdef SEGFAULT_SIMD_SSE2
+            // Four pixels per batch, the 16 byte load needs two more pixels behind the batch
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            for (; i + 6 <= numPixels; i += 4) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+                const __m128i p01 = _mm_unpacklo_epi32(x, _mm_srli_si128(x, 3));
+                const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_unpacklo_epi64(p01, p23), alpha));
+            }
+#endif
+            for (; i < numPixels; ++i) {
+                dst[i * 4] = src[i * 3];
+                dst[i * 4 + 1] = src[i * 3 + 1];
+                dst[i * 4 + 2] = src[i * 3 + 2];
+                dst[i * 4 + 3] = 255;
+            }
+        }
+
+        void expandGray(const uint8_t *src, size_t numPixels, uint8_t *dst) {
+            size_t i = 0;
+#ifdef SEGFAULT_SIMD_SSE2
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            for (; i + 16 <= numPixels; i += 16) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m128i lo = _mm_unpacklo_epi8(x, x), hi = _mm_unpackhi_epi8(x, x);
+                __m128i *out = reinterpret_cast<__m128i*>(dst + i * 4);
+                _mm_storeu_si128(out, _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+                _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+                _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+                _mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+            }
+#endif
+            for (; i < numPixels; ++i) {
+                dst[i * 4] = dst[i * 4 + 1] = dst[i * 4 + 2] = src[i];
+                dst[i * 4 + 3] = 255;
+            }
+        }
+
+        void expandGrayAlpha(const uint8_t *src, size_t numPixels, uint8_t *dst) {
+            size_t i = 0;
+#ifdef SEGFAULT_SIMD_SSE2
+            // The gray bytes are doubled into words and interleaved with the gray-alpha words
+            const __m128i grayMask = _mm_set1_epi16(0x00FF);
+            for (; i + 8 <= numPixels; i += 8) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                const __m128i gray = _mm_and_si128(x, grayMask);
+                const __m128i grayGray = _mm_or_si128(gray, _mm_slli_epi16(gray, 8));
+                __m128i *out = reinterpret_cast<__m128i*>(dst + i * 4);
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(grayGray, x));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(grayGray, x));
+            }
+#endif
+            for (; i < numPixels; ++i) {
+                dst[i * 4] = dst[i * 4 + 1] = dst[i * 4 + 2] = src[i * 2];
+                dst[i * 4 + 3] = src[i * 2 + 1];
+            }
+        }
+
+    } // namespace
+
+    bool convertToRgba8(const uint8_t *src, uint32_t numChannels, size_t numPixels, uint8_t *dst) {
+        if (src == nullptr || dst == nullptr) {
+            return false;
+        }
+
+        switch (numChannels) {
+            case 1:
+                expandGray(src, numPixels, dst);
+                return true;
+            case 2:
+                expandGrayAlpha(src, numPixels, dst);
+                return true;
+            case 3:
+                expandRgb(src, numPixels, dst);
+                return true;
+            case 4:
+                memcpy(dst, src, numPixels * 4);
+                return true;
+            default:
+                break;
+        }
+
+        return false;
+    }
+
+    TextureLoader::TextureLoader(IFileManager &fileManager, ThreadPool &pool) :
+            mFileManager(fileManager), mPool(pool) {
+        // empty
+    }
+
+    TextureLoader::~TextureLoader() {
+        waitIdle();
+    }
+
+    void TextureLoader::load(const char *file, bool srgb) {
+        if (file == nullptr) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            ++mNumPending;
+        }
+        mPool.enqueue([this, file = std::string(file), srgb]() {
+            LoadedImage image;
+            image.file = file;
+            image.srgb = srgb;
+            decode(image);
+
+            std::lock_guard<std::mutex> lock(mLock);
+            mImages.push_back(std::move(image));
+            --mNumPending;
+            mFinished.notify_all();
+        });
+    }
+
+    size_t TextureLoader::takeImages(std::vector<LoadedImage> &images) {
+        std::lock_guard<std::mutex> lock(mLock);
+        const size_t count = mImages.size();
+        for (LoadedImage &image : mImages) {
+            // Failures are reported here, the workers do not share the log
+            if (!image.success) {
+                const std::string msg = "Cannot load the image " + image.file + ".";
+                logMessage(LogType::Warn, msg.c_str());
+            }
+            images.push_back(std::move(image));
+        }
+        mImages.clear();
+
+        return count;
+    }
+
+    void TextureLoader::waitIdle() {
+        std::unique_lock<std::mutex> lock(mLock);
+        mFinished.wait(lock, [this]() { return mNumPending == 0; });
+    }
+
+    size_t TextureLoader::getNumPending() const {
+        std::lock_guard<std::mutex> lock(mLock);
+        return mNumPending;
+    }
+
+    void TextureLoader::decode(LoadedImage &image) {
+        FileStat stat;
+        std::vector<uint8_t> data;
+        if (!mFileManager.getArchiveStat(image.file.c_str(), stat) || stat.filesize > static_cast<size_t>(std::numeric_limits<int>::max()) ||
+                !mFileManager.readRange(image.file.c_str(), 0, stat.filesize, data)) {
+            return;
+        }
+
+        int width = 0, height = 0, numChannels = 0;
+        stbi_uc *pixels = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &numChannels, 0);
+        if (pixels == nullptr) {
+            return;
+        }
+
+        // stb expands the channels itself when asked to, the SIMD conversion is faster
+        const size_t numPixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+        image.pixels.resize(numPixels * 4);
+        image.success = convertToRgba8(pixels, static_cast<uint32_t>(numChannels), numPixels, image.pixels.data());
+        stbi_image_free(pixels);
+        if (!image.success) {
+            image.pixels.clear();
+            return;
+        }
+        image.width = static_cast<uint32_t>(width);
+        image.height = static_cast<uint32_t>(height);
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace segfault::core {
+    class IFileManager;
+    class ThreadPool;
+}
+
+namespace segfault::renderer {
+
+    /// @brief A decoded source image, ready for upload.
+    struct LoadedImage {
+        std::string file;                   ///< The file the image was loaded from.
+        uint32_t width{ 0 };                ///< The width in pixels.
+        uint32_t height{ 0 };               ///< The height in pixels.
+        bool srgb{ true };                  ///< True if the color channels are sRGB encoded, selects the upload format.
+        bool success{ false };              ///< False if the file could not be read or decoded.
+        std::vector<uint8_t> pixels;        ///< The pixels as RGBA8, empty on failure.
+    };
+
+    /// @brief Expands pixels with one to four 8 bit channels to RGBA8. One channel is gray, two 
+    /// are gray and alpha, three are RGB, missing alpha is opaque.
+    /// @param[ in ] src The source pixels, tightly packed.
+    /// @param[ in ] numChannels The number of channels of the source pixels.
+    /// @param[ in ] numPixels The number of pixels.
+    /// @param[ out ] dst Receives numPixels RGBA8 pixels, must not overlap src.
+    /// @return False for an unsupported number of channels.
+    SEGFAULT_EXPORT bool convertToRgba8(const uint8_t *src, uint32_t numChannels, size_t numPixels, uint8_t *dst);
+
+    //---------------------------------------------------------------------------------------------
+    /// @class TextureLoader
+    /// @brief Reads and decodes source images on the workers of a thread pool.
+    ///
+    /// Each image is read through the file manager, decoded and converted to RGBA8 by one task, 
+    /// so loading many images scales with the number of workers. The render thread takes the 
+    /// finished images and uploads them, the loader never touches the graphics API.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT TextureLoader final {
+    public:
+        /// @brief The class constructor.
+        /// @param[ in ] fileManager The file manager to read from, must be thread safe and outlive the loader.
+        /// @param[ in ] pool The pool running the decodes, must outlive the loader.
+        TextureLoader(core::IFileManager &fileManager, core::ThreadPool &pool);
+
+        /// @brief The class destructor, waits for the images in flight.
+        ~TextureLoader();
+
+        /// @brief Enqueues an image, never blocks on the decode.
+        /// @param[ in ] file The image file, any format stb_image decodes.
+        /// @param[ in ] srgb True if the color channels are sRGB encoded.
+        void load(const char *file, bool srgb = true);
+
+        /// @brief Moves the finished images out, in the order they finished.
+        /// @param[ out ] images Receives the finished images, appended.
+        /// @return The number of images taken.
+        size_t takeImages(std::vector<LoadedImage> &images);
+
+        /// @brief Blocks until all enqueued images are finished.
+        void waitIdle();
+
+        /// @brief Returns the number of images enqueued but not finished.
+        size_t getNumPending() const;
+
+        TextureLoader(const TextureLoader &) = delete;
+        TextureLoader &operator = (const TextureLoader &) = delete;
+
+    private:
+        void decode(LoadedImage &image);
+
+    private:
+        core::IFileManager &mFileManager;
+        core::ThreadPool &mPool;
+
+        mutable std::mutex mLock;
+        std::condition_variable mFinished;
+        std::vector<LoadedImage> mImages;
+        size_t mNumPending{ 0 };
+    };
+
+} // namespace segfault::renderer
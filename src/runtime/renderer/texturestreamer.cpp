@@ -0,0 +1,314 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "renderer/texturestreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    /// The reads finished by the file manager, shared with the read callbacks so they stay 
+    /// valid when the streamer is gone before its reads.
+    struct TextureStreamer::CompletionQueue {
+        std::mutex mutex;
+        std::vector<CompletedRead> reads;
+    };
+
+    uint32_t computeTextureMipForScreenSize(uint32_t width, uint32_t height, float screenSize) {
+        const uint32_t coarsestMip = computeTextureMipCount(width, height) - 1;
+        if (!(screenSize > 0.0f)) {
+            return coarsestMip;
+        }
+
+        const float size = static_cast<float>(std::max(width, height));
+        if (screenSize >= size) {
+            return 0;
+        }
+
+        return std::min(static_cast<uint32_t>(std::log2(size / screenSize)), coarsestMip);
+    }
+
+    void TextureStreamer::init(IFileManager *fileManager, ITextureStreamUploader *uploader, const TextureStreamSettings &settings) {
+        mFileManager = fileManager;
+        mUploader = uploader;
+        mSettings = settings;
+        mCompleted = std::make_shared<CompletionQueue>();
+    }
+
+    TextureHandle TextureStreamer::add(const char *file) {
+        if (mFileManager == nullptr || mUploader == nullptr || file == nullptr) {
+            return InvalidTexture;
+        }
+
+        FileStat stat;
+        if (!mFileManager->getArchiveStat(file, stat)) {
+            logMessage(LogType::Error, "Cannot find the texture to stream.");
+            return InvalidTexture;
+        }
+
+        StreamedTexture texture;
+        std::vector<uint8_t> data;
+        if (!mFileManager->readRange(file, 0, std::min(stat.filesize, MaxTextureHeaderSize), data) ||
+                !TextureData::readHeader(data.data(), data.size(), stat.filesize, texture.header, texture.mips)) {
+            logMessage(LogType::Error, "Cannot stream the texture, it is no baked texture.");
+            return InvalidTexture;
+        }
+
+        const uint32_t numMips = texture.header.numMips;
+        texture.file = file;
+        texture.tailMip = numMips - 1;
+        while (texture.tailMip > 0 && std::max(texture.mips[texture.tailMip - 1].width, texture.mips[texture.tailMip - 1].height) <= mSettings.tailSize) {
+            --texture.tailMip;
+        }
+        texture.residentMip = numMips;
+        texture.wantedMip = texture.tailMip;
+
+        // The smallest level comes first in the file, so the tail is one range
+        const size_t tailOffset = texture.mips[numMips - 1].dataOffset;
+        const size_t tailEnd = static_cast<size_t>(texture.mips[texture.tailMip].dataOffset) + texture.mips[texture.tailMip].dataSize;
+        if (!mFileManager->readRange(file, tailOffset, tailEnd - tailOffset, data)) {
+            logMessage(LogType::Error, "Cannot read the texture tail.");
+            return InvalidTexture;
+        }
+
+        TextureHandle handle = static_cast<TextureHandle>(mTextures.size());
+        if (!mFreeHandles.empty()) {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+            texture.generation = mTextures[handle].generation;
+            mTextures[handle] = std::move(texture);
+        } else {
+            mTextures.push_back(std::move(texture));
+        }
+
+        if (!setResident(handle, mTextures[handle].tailMip, data.data(), tailOffset)) {
+            const uint32_t generation = mTextures[handle].generation + 1;
+            mTextures[handle] = StreamedTexture();
+            mTextures[handle].generation = generation;
+            mFreeHandles.push_back(handle);
+            return InvalidTexture;
+        }
+
+        return handle;
+    }
+
+    bool TextureStreamer::remove(TextureHandle handle) {
+        if (!isValid(handle)) {
+            return false;
+        }
+
+        StreamedTexture &texture = mTextures[handle];
+        mUploader->release(handle);
+        mResidentSize -= computeResidentSize(texture, texture.residentMip);
+        if (texture.pendingMip != MaxTextureMips) {
+            // The read finishes anyway, the new generation marks it as stale
+            mPendingSize -= texture.mips[texture.pendingMip].dataSize;
+            --mNumPendingReads;
+        }
+
+        const uint32_t generation = texture.generation + 1;
+        texture = StreamedTexture();
+        texture.generation = generation;
+        mFreeHandles.push_back(handle);
+
+        return true;
+    }
+
+    const StreamedTexture *TextureStreamer::get(TextureHandle handle) const {
+        return isValid(handle) ? &mTextures[handle] : nullptr;
+    }
+
+    void TextureStreamer::requestMip(TextureHandle handle, uint32_t mip) {
+        if (!isValid(handle)) {
+            return;
+        }
+
+        StreamedTexture &texture = mTextures[handle];
+        mip = std::min(mip, texture.header.numMips - 1);
+        texture.wantedMip = texture.lastUsedFrame == mFrame ? std::min(texture.wantedMip, mip) : mip;
+        texture.lastUsedFrame = mFrame;
+    }
+
+    void TextureStreamer::update() {
+        if (mUploader == nullptr) {
+            return;
+        }
+
+        // Finished reads are made resident over several updates to spread the upload cost
+        {
+            std::lock_guard<std::mutex> lock(mCompleted->mutex);
+            for (CompletedRead &read : mCompleted->reads) {
+                mReady.push_back(std::move(read));
+            }
+            mCompleted->reads.clear();
+        }
+        size_t numApplied = 0;
+        uint32_t numUploads = 0;
+        for (; numApplied < mReady.size() && numUploads < mSettings.maxUploadsPerUpdate; ++numApplied) {
+            CompletedRead &read = mReady[numApplied];
+            if (!isValid(read.handle) || mTextures[read.handle].generation != read.generation) {
+                continue;
+            }
+
+            StreamedTexture &texture = mTextures[read.handle];
+            mPendingSize -= texture.mips[read.mip].dataSize;
+            --mNumPendingReads;
+            texture.pendingMip = MaxTextureMips;
+            if (!read.success || !setResident(read.handle, read.mip, read.data.data(), texture.mips[read.mip].dataOffset)) {
+                logMessage(LogType::Warn, "Cannot stream a texture level, the texture stays at its current level.");
+                texture.finestMip = read.mip + 1;
+                continue;
+            }
+            ++numUploads;
+        }
+        mReady.erase(mReady.begin(), mReady.begin() + numApplied);
+
+        // The most blurred textures first, the recently used ones among equally blurred
+        std::vector<TextureHandle> candidates;
+        for (TextureHandle handle = 0; handle < mTextures.size(); ++handle) {
+            const StreamedTexture &texture = mTextures[handle];
+            if (isValid(handle) && texture.pendingMip == MaxTextureMips && texture.residentMip > texture.finestMip && 
+                    getWantedMip(texture) < texture.residentMip) {
+                candidates.push_back(handle);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](TextureHandle a, TextureHandle b) {
+            const StreamedTexture &ta = mTextures[a], &tb = mTextures[b];
+            const uint32_t blurA = ta.residentMip - getWantedMip(ta), blurB = tb.residentMip - getWantedMip(tb);
+            return blurA != blurB ? blurA > blurB : ta.lastUsedFrame > tb.lastUsedFrame;
+        });
+
+        for (TextureHandle handle : candidates) {
+            if (mNumPendingReads >= mSettings.maxPendingReads) {
+                break;
+            }
+
+            // Levels are streamed one at a time from coarse to fine
+            StreamedTexture &texture = mTextures[handle];
+            const uint32_t mip = texture.residentMip - 1;
+            const size_t size = texture.mips[mip].dataSize;
+            const size_t needed = mResidentSize + mPendingSize + size;
+            if (needed > mSettings.budget && !evict(needed - mSettings.budget, handle)) {
+                continue;
+            }
+
+            texture.pendingMip = mip;
+            mPendingSize += size;
+            ++mNumPendingReads;
+            std::shared_ptr<CompletionQueue> completed = mCompleted;
+            const uint32_t generation = texture.generation;
+            mFileManager->readAsync(texture.file.c_str(), texture.mips[mip].dataOffset, size, 
+                [completed, handle, generation, mip](bool success, std::vector<uint8_t> &data) {
+                    CompletedRead read;
+                    read.handle = handle;
+                    read.generation = generation;
+                    read.mip = mip;
+                    read.success = success;
+                    read.data = std::move(data);
+                    std::lock_guard<std::mutex> lock(completed->mutex);
+                    completed->reads.push_back(std::move(read));
+                });
+        }
+
+        ++mFrame;
+    }
+
+    bool TextureStreamer::isValid(TextureHandle handle) const {
+        return handle < mTextures.size() && !mTextures[handle].file.empty();
+    }
+
+    size_t TextureStreamer::computeResidentSize(const StreamedTexture &texture, uint32_t firstMip) const {
+        size_t size = 0;
+        for (uint32_t i = firstMip; i < texture.header.numMips; ++i) {
+            size += texture.mips[i].dataSize;
+        }
+
+        return size;
+    }
+
+    uint32_t TextureStreamer::getWantedMip(const StreamedTexture &texture) const {
+        if (texture.lastUsedFrame + mSettings.unusedFrames < mFrame) {
+            return texture.tailMip;
+        }
+
+        return std::min(texture.wantedMip, texture.tailMip);
+    }
+
+    bool TextureStreamer::evict(size_t size, TextureHandle keep) {
+        // Levels finer than needed go first, then the least recently used textures lose levels 
+        // from fine to coarse. Textures used this frame keep what they need.
+        std::vector<TextureHandle> victims;
+        for (TextureHandle handle = 0; handle < mTextures.size(); ++handle) {
+            const StreamedTexture &texture = mTextures[handle];
+            if (handle != keep && isValid(handle) && texture.pendingMip == MaxTextureMips && texture.residentMip < texture.tailMip &&
+                    (texture.residentMip < getWantedMip(texture) || texture.lastUsedFrame != mFrame)) {
+                victims.push_back(handle);
+            }
+        }
+        std::sort(victims.begin(), victims.end(), [this](TextureHandle a, TextureHandle b) {
+            const StreamedTexture &ta = mTextures[a], &tb = mTextures[b];
+            const bool overA = ta.residentMip < getWantedMip(ta), overB = tb.residentMip < getWantedMip(tb);
+            return overA != overB ? overA : ta.lastUsedFrame < tb.lastUsedFrame;
+        });
+
+        // Plan first, so nothing is evicted when the budget cannot be met anyway
+        std::vector<uint32_t> targets(victims.size());
+        size_t freed = 0;
+        size_t numVictims = 0;
+        for (; numVictims < victims.size() && freed < size; ++numVictims) {
+            const StreamedTexture &texture = mTextures[victims[numVictims]];
+            const uint32_t limit = texture.lastUsedFrame == mFrame ? getWantedMip(texture) : texture.tailMip;
+            uint32_t target = texture.residentMip;
+            while (target < limit && freed < size) {
+                freed += texture.mips[target].dataSize;
+                ++target;
+            }
+            targets[numVictims] = target;
+        }
+        if (freed < size) {
+            return false;
+        }
+
+        for (size_t i = 0; i < numVictims; ++i) {
+            setResident(victims[i], targets[i], nullptr, 0);
+        }
+
+        return true;
+    }
+
+    bool TextureStreamer::setResident(TextureHandle handle, uint32_t firstMip, const uint8_t *data, size_t dataOffset) {
+        StreamedTexture &texture = mTextures[handle];
+        if (!mUploader->makeResident(handle, texture, firstMip, data, dataOffset)) {
+            return false;
+        }
+
+        mResidentSize = mResidentSize - computeResidentSize(texture, texture.residentMip) + computeResidentSize(texture, firstMip);
+        texture.residentMip = firstMip;
+
+        return true;
+    }
+
+} // namespace segfault::renderer
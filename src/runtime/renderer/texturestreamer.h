@@ -0,0 +1,189 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "core/ifilemanager.h"
+#include "renderer/textureformat.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace segfault::renderer {
+
+    /// @brief The handle of a texture in a texture streamer.
+    using TextureHandle = uint32_t;
+
+    /// @brief Marks an invalid texture.
+    constexpr TextureHandle InvalidTexture = 0xffffffffu;
+
+    /// @brief A texture managed by a texture streamer. The levels [residentMip, numMips) are on 
+    /// the GPU, the levels up to tailMip never leave it.
+    struct StreamedTexture {
+        std::string file;                               ///< The baked texture file, empty for free slots.
+        TextureFileHeader header{};                     ///< The header of the file.
+        TextureMipRecord mips[MaxTextureMips]{};        ///< The levels of the file.
+        uint32_t tailMip{ 0 };                          ///< The finest level loaded with the texture.
+        uint32_t residentMip{ 0 };                      ///< The finest level on the GPU.
+        uint32_t wantedMip{ 0 };                        ///< The finest level requested in the last used frame.
+        uint32_t pendingMip{ MaxTextureMips };          ///< The level being read, MaxTextureMips if none.
+        uint32_t finestMip{ 0 };                        ///< The finest level to stream, raised when a read fails.
+        uint64_t lastUsedFrame{ 0 };                    ///< The last frame requesting a level.
+        uint32_t generation{ 0 };                       ///< Counts the reuses of the slot, stale reads are dropped.
+    };
+
+    /// @brief Creates and resizes the GPU textures of a texture streamer, implemented per graphics API.
+    class ITextureStreamUploader {
+    public:
+        /// @brief The class destructor.
+        virtual ~ITextureStreamUploader() = default;
+
+        /// @brief Changes the resident levels of a texture to [firstMip, numMips). Levels which 
+        /// stay resident are kept on the GPU, the new ones are passed in as read from the file.
+        /// @param[ in ] handle The texture handle.
+        /// @param[ in ] texture The texture, residentMip is still the previous level, it equals 
+        /// numMips when the texture is created.
+        /// @param[ in ] firstMip The new finest level.
+        /// @param[ in ] data The levels [firstMip, residentMip) as stored in the file, nullptr when evicting.
+        /// @param[ in ] dataOffset The file offset of the first byte of data.
+        /// @return True if the texture was changed.
+        virtual bool makeResident(TextureHandle handle, const StreamedTexture &texture, uint32_t firstMip, 
+            const uint8_t *data, size_t dataOffset) = 0;
+
+        /// @brief Destroys the GPU texture.
+        /// @param[ in ] handle The texture handle.
+        virtual void release(TextureHandle handle) = 0;
+    };
+
+    /// @brief The limits of a texture streamer.
+    struct TextureStreamSettings {
+        size_t budget{ 256u << 20 };        ///< The GPU memory of all resident levels in bytes.
+        uint32_t tailSize{ 64 };            ///< Levels up to this size are loaded with the texture and never evicted.
+        uint32_t maxPendingReads{ 4 };      ///< The number of levels read at the same time.
+        uint32_t maxUploadsPerUpdate{ 2 };  ///< The number of read levels made resident per update.
+        uint32_t unusedFrames{ 60 };        ///< After this many frames without requests a texture only needs its tail.
+    };
+
+    /// @brief Returns the finest level needed to show a texture at a size on screen.
+    /// @param[ in ] width The width of level 0.
+    /// @param[ in ] height The height of level 0.
+    /// @param[ in ] screenSize The size of the texture on screen in pixels.
+    /// @return The level whose texels map about one to one to pixels, 0 if even level 0 is too coarse.
+    SEGFAULT_EXPORT uint32_t computeTextureMipForScreenSize(uint32_t width, uint32_t height, float screenSize);
+
+    //---------------------------------------------------------------------------------------------
+    /// @class TextureStreamer
+    /// @brief Keeps the mip levels of baked textures resident as far as they are needed and fit 
+    /// into a memory budget.
+    ///
+    /// A texture is added with its low resolution tail only. The renderer requests the finest 
+    /// level it needs each frame, update then reads the missing levels one by one from coarse 
+    /// to fine in the background and makes them resident. The most blurred textures are served 
+    /// first. When the budget is exhausted, levels finer than needed and then the levels of the 
+    /// least recently used textures are evicted. Textures requested in the current frame are 
+    /// never evicted. The streamer does the bookkeeping only, the GPU textures are owned by 
+    /// the graphics API backend.
+    //---------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT TextureStreamer final {
+    public:
+        /// @brief The class constructor, the streamer is unusable until init is called.
+        TextureStreamer() = default;
+
+        /// @brief The class destructor, reads still in flight are dropped.
+        ~TextureStreamer() = default;
+
+        /// @brief Sets the file manager, the backend and the limits.
+        /// @param[ in ] fileManager The file manager reading the levels, must outlive the streamer.
+        /// @param[ in ] uploader The backend, must outlive the streamer.
+        /// @param[ in ] settings The limits.
+        void init(core::IFileManager *fileManager, ITextureStreamUploader *uploader, const TextureStreamSettings &settings);
+
+        /// @brief Adds a baked texture and makes its tail resident, the tail is read synchronously.
+        /// @param[ in ] file The baked texture file.
+        /// @return The handle or InvalidTexture if the file is not a valid texture.
+        TextureHandle add(const char *file);
+
+        /// @brief Removes a texture and releases its GPU texture.
+        /// @param[ in ] handle The texture handle.
+        /// @return False for an invalid handle.
+        bool remove(TextureHandle handle);
+
+        /// @brief Returns a texture.
+        /// @param[ in ] handle The texture handle.
+        /// @return The texture or nullptr for an invalid handle.
+        const StreamedTexture *get(TextureHandle handle) const;
+
+        /// @brief Requests a level for the current frame, the finest level of all requests in a 
+        /// frame wins.
+        /// @param[ in ] handle The texture handle.
+        /// @param[ in ] mip The finest level needed.
+        void requestMip(TextureHandle handle, uint32_t mip);
+
+        /// @brief Makes read levels resident, evicts and issues new reads. Call once per frame 
+        /// when the backend may change textures.
+        void update();
+
+        /// @brief Returns the size of all resident levels in bytes.
+        size_t getResidentSize() const { return mResidentSize; }
+
+        /// @brief Returns the size of the levels being read in bytes.
+        size_t getPendingSize() const { return mPendingSize; }
+
+        /// @brief Returns the number of levels being read.
+        uint32_t getNumPendingReads() const { return mNumPendingReads; }
+
+        TextureStreamer(const TextureStreamer &) = delete;
+        TextureStreamer &operator = (const TextureStreamer &) = delete;
+
+    private:
+        struct CompletedRead {
+            TextureHandle handle{ InvalidTexture };
+            uint32_t generation{ 0 };
+            uint32_t mip{ 0 };
+            bool success{ false };
+            std::vector<uint8_t> data;
+        };
+        struct CompletionQueue;
+
+        bool isValid(TextureHandle handle) const;
+        size_t computeResidentSize(const StreamedTexture &texture, uint32_t firstMip) const;
+        uint32_t getWantedMip(const StreamedTexture &texture) const;
+        bool evict(size_t size, TextureHandle keep);
+        bool setResident(TextureHandle handle, uint32_t firstMip, const uint8_t *data, size_t dataOffset);
+
+    private:
+        core::IFileManager *mFileManager{ nullptr };
+        ITextureStreamUploader *mUploader{ nullptr };
+        TextureStreamSettings mSettings{};
+        std::vector<StreamedTexture> mTextures;
+        std::vector<TextureHandle> mFreeHandles;
+        std::shared_ptr<CompletionQueue> mCompleted;
+        std::vector<CompletedRead> mReady;
+        uint64_t mFrame{ 1 };
+        size_t mResidentSize{ 0 };
+        size_t mPendingSize{ 0 };
+        uint32_t mNumPendingReads{ 0 };
+    };
+
+} // namespace segfault::renderer
@@ -0,0 +1,238 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "vulkanlayoutcache.h"
+#include "vulkanutils.h"
+#include "core/segfault.h"
+
+#include <algorithm>
+
+namespace segfault::renderer {
+
+    using namespace segfault::core;
+
+    namespace {
+
+        constexpr uint32_t InitialPoolCapacity = 16;
+
+        bool isSameSet(const std::vector<ShaderBinding> &cached, const ShaderReflection &reflection, uint32_t set) {
+            size_t numBindings = 0;
+            for (const ShaderBinding &binding : reflection.bindings) {
+                if (binding.set != set) {
+                    continue;
+                }
+                if (numBindings == cached.size()) {
+                    return false;
+                }
+                const ShaderBinding &other = cached[numBindings++];
+                if (other.binding != binding.binding || other.count != binding.count || other.type != binding.type || other.stages != binding.stages) {
+                    return false;
+                }
+            }
+
+            return numBindings == cached.size();
+        }
+
+    } // namespace
+
+    void VulkanLayoutCache::init(VkDevice device) {
+        mDevice = device;
+    }
+
+    VulkanLayoutCache::SetLayout *VulkanLayoutCache::getSetLayoutEntry(const ShaderReflection &reflection, uint32_t set) {
+        const uint64_t hash = hashDescriptorSet(reflection, set);
+        auto it = mSetLayouts.find(hash);
+        if (it != mSetLayouts.end()) {
+            if (!isSameSet(it->second.bindings, reflection, set)) {
+                logMessage(LogType::Error, "Descriptor set layouts with the same hash differ.");
+                return nullptr;
+            }
+            return &it->second;
+        }
+
+        SetLayout setLayout;
+        std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+        for (const ShaderBinding &binding : reflection.bindings) {
+            if (binding.set != set) {
+                continue;
+            }
+            VkDescriptorSetLayoutBinding layoutBinding{};
+            layoutBinding.binding = binding.binding;
+            layoutBinding.descriptorType = VulkanUtils::getDescriptorType(binding.type);
+            layoutBinding.descriptorCount = binding.count;
+            layoutBinding.stageFlags = VulkanUtils::getShaderStageFlags(binding.stages);
+            layoutBindings.push_back(layoutBinding);
+            setLayout.bindings.push_back(binding);
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+        layoutInfo.pBindings = layoutBindings.data();
+        if (vkCreateDescriptorSetLayout(mDevice, &layoutInfo, nullptr, &setLayout.layout) != VK_SUCCESS) {
+            logMessage(LogType::Error, "Failed to create descriptor set layout.");
+            return nullptr;
+        }
+
+        return &mSetLayouts.emplace(hash, std::move(setLayout)).first->second;
+    }
+
+    VkDescriptorSetLayout VulkanLayoutCache::getSetLayout(const ShaderReflection &reflection, uint32_t set) {
+        SetLayout *setLayout = getSetLayoutEntry(reflection, set);
+
+        return setLayout != nullptr ? setLayout->layout : VK_NULL_HANDLE;
+    }
+
+    VkPipelineLayout VulkanLayoutCache::getPipelineLayout(const ShaderReflection &reflection) {
+        const uint32_t numSets = getNumDescriptorSets(reflection);
+        std::vector<uint64_t> sets(numSets);
+        for (uint32_t set = 0; set < numSets; ++set) {
+            sets[set] = hashDescriptorSet(reflection, set);
+        }
+
+        const uint64_t hash = hashPipelineLayout(reflection);
+        auto it = mPipelineLayouts.find(hash);
+        if (it != mPipelineLayouts.end()) {
+            const PipelineLayout &cached = it->second;
+            if (cached.sets != sets || cached.pushConstantSize != reflection.pushConstantSize || 
+                    cached.pushConstantStages != reflection.pushConstantStages) {
+                logMessage(LogType::Error, "Pipeline layouts with the same hash differ.");
+                return VK_NULL_HANDLE;
+            }
+            return cached.layout;
+        }
+
+        // Unused sets in between get the empty layout
+        std::vector<VkDescriptorSetLayout> setLayouts(numSets);
+        for (uint32_t set = 0; set < numSets; ++set) {
+            setLayouts[set] = getSetLayout(reflection, set);
+            if (setLayouts[set] == VK_NULL_HANDLE) {
+                return VK_NULL_HANDLE;
+            }
+        }
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VulkanUtils::getShaderStageFlags(reflection.pushConstantStages);
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = reflection.pushConstantSize;
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = numSets;
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = reflection.pushConstantSize > 0 ? 1 : 0;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        PipelineLayout pipelineLayout;
+        if (vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout.layout) != VK_SUCCESS) {
+            logMessage(LogType::Error, "Failed to create pipeline layout.");
+            return VK_NULL_HANDLE;
+        }
+        pipelineLayout.sets = std::move(sets);
+        pipelineLayout.pushConstantSize = reflection.pushConstantSize;
+        pipelineLayout.pushConstantStages = reflection.pushConstantStages;
+
+        return mPipelineLayouts.emplace(hash, std::move(pipelineLayout)).first->second.layout;
+    }
+
+    bool VulkanLayoutCache::addPool(SetLayout &setLayout) {
+        const uint32_t capacity = setLayout.poolCapacity == 0 ? InitialPoolCapacity : setLayout.poolCapacity * 2;
+
+        // Sizes of the same type are merged, a pool then holds capacity sets of the layout
+        std::vector<VkDescriptorPoolSize> poolSizes;
+        for (const ShaderBinding &binding : setLayout.bindings) {
+            const VkDescriptorType type = VulkanUtils::getDescriptorType(binding.type);
+            auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [type](const VkDescriptorPoolSize &poolSize) {
+                return poolSize.type == type;
+            });
+            if (it == poolSizes.end()) {
+                poolSizes.push_back({ type, 0 });
+                it = poolSizes.end() - 1;
+            }
+            it->descriptorCount += binding.count * capacity;
+        }
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = capacity;
+
+        VkDescriptorPool pool{ VK_NULL_HANDLE };
+        if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+            logMessage(LogType::Error, "Failed to create descriptor pool.");
+            return false;
+        }
+        setLayout.pools.push_back(pool);
+        setLayout.poolCapacity = capacity;
+
+        return true;
+    }
+
+    bool VulkanLayoutCache::allocateDescriptorSets(const ShaderReflection &reflection, uint32_t set, uint32_t count, VkDescriptorSet *sets) {
+        SetLayout *setLayout = getSetLayoutEntry(reflection, set);
+        if (setLayout == nullptr || setLayout->bindings.empty() || sets == nullptr) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &setLayout->layout;
+
+            VkResult result = VK_ERROR_OUT_OF_POOL_MEMORY;
+            if (!setLayout->pools.empty()) {
+                allocInfo.descriptorPool = setLayout->pools.back();
+                result = vkAllocateDescriptorSets(mDevice, &allocInfo, &sets[i]);
+            }
+            if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+                if (!addPool(*setLayout)) {
+                    return false;
+                }
+                allocInfo.descriptorPool = setLayout->pools.back();
+                result = vkAllocateDescriptorSets(mDevice, &allocInfo, &sets[i]);
+            }
+            if (result != VK_SUCCESS) {
+                logMessage(LogType::Error, "Failed to allocate descriptor set.");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void VulkanLayoutCache::destroy() {
+        for (auto &pipelineLayout : mPipelineLayouts) {
+            vkDestroyPipelineLayout(mDevice, pipelineLayout.second.layout, nullptr);
+        }
+        mPipelineLayouts.clear();
+        for (auto &setLayout : mSetLayouts) {
+            for (VkDescriptorPool pool : setLayout.second.pools) {
+                vkDestroyDescriptorPool(mDevice, pool, nullptr);
+            }
+            vkDestroyDescriptorSetLayout(mDevice, setLayout.second.layout, nullptr);
+        }
+        mSetLayouts.clear();
+    }
+
+} // namespace segfault::renderer
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "volk.h"
+#include "shaderreflection.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace segfault::renderer {
+
+    //---------------------------------------------------------------------------------------------
+    /// @class VulkanLayoutCache
+    /// @brief Creates descriptor set layouts, pipeline layouts and descriptor sets from shader 
+    /// reflection.
+    ///
+    /// Layouts are keyed by the hash of their reflected bindings, so shader permutations with the 
+    /// same interface share one layout. Descriptor sets are allocated from pools kept per set 
+    /// layout, a full pool is followed by one twice its size. All objects live until destroy.
+    //---------------------------------------------------------------------------------------------
+    class VulkanLayoutCache final {
+    public:
+        /// @brief The class constructor, the cache is unusable until init is called.
+        VulkanLayoutCache() = default;
+
+        /// @brief The class destructor, call destroy before.
+        ~VulkanLayoutCache() = default;
+
+        /// @brief Sets the device.
+        /// @param[ in ] device The device creating the layouts.
+        void init(VkDevice device);
+
+        /// @brief Returns the layout of a descriptor set, it is created on the first request.
+        /// @param[ in ] reflection The interface of the pipeline.
+        /// @param[ in ] set The descriptor set.
+        /// @return The layout or VK_NULL_HANDLE on failure.
+        VkDescriptorSetLayout getSetLayout(const ShaderReflection &reflection, uint32_t set);
+
+        /// @brief Returns the pipeline layout of an interface with one push constant range for 
+        /// all stages, it is created on the first request.
+        /// @param[ in ] reflection The interface of the pipeline.
+        /// @return The layout or VK_NULL_HANDLE on failure.
+        VkPipelineLayout getPipelineLayout(const ShaderReflection &reflection);
+
+        /// @brief Allocates descriptor sets, they are freed by destroy.
+        /// @param[ in ] reflection The interface of the pipeline.
+        /// @param[ in ] set The descriptor set.
+        /// @param[ in ] count The number of sets to allocate.
+        /// @param[ out ] sets Receives count sets.
+        /// @return False if the set has no bindings or the allocation failed.
+        bool allocateDescriptorSets(const ShaderReflection &reflection, uint32_t set, uint32_t count, VkDescriptorSet *sets);
+
+        /// @brief Destroys all pools and layouts.
+        void destroy();
+
+        /// @brief Returns the number of distinct descriptor set layouts.
+        size_t getNumSetLayouts() const { return mSetLayouts.size(); }
+
+        /// @brief Returns the number of distinct pipeline layouts.
+        size_t getNumPipelineLayouts() const { return mPipelineLayouts.size(); }
+
+        VulkanLayoutCache(const VulkanLayoutCache &) = delete;
+        VulkanLayoutCache &operator = (const VulkanLayoutCache &) = delete;
+
+    private:
+        struct SetLayout {
+            std::vector<ShaderBinding> bindings;        ///< The bindings, to tell hash collisions apart.
+            VkDescriptorSetLayout layout{ VK_NULL_HANDLE };
+            std::vector<VkDescriptorPool> pools;        ///< The pools, only the last one has room.
+            uint32_t poolCapacity{ 0 };                 ///< The number of sets of the last pool.
+        };
+        struct PipelineLayout {
+            std::vector<uint64_t> sets;                 ///< The hashes of the sets, to tell hash collisions apart.
+            uint32_t pushConstantSize{ 0 };
+            uint32_t pushConstantStages{ 0 };
+            VkPipelineLayout layout{ VK_NULL_HANDLE };
+        };
+
+        SetLayout *getSetLayoutEntry(const ShaderReflection &reflection, uint32_t set);
+        bool addPool(SetLayout &setLayout);
+
+    private:
+        VkDevice mDevice{ VK_NULL_HANDLE };
+        std::unordered_map<uint64_t, SetLayout> mSetLayouts;
+        std::unordered_map<uint64_t, PipelineLayout> mPipelineLayouts;
+    };
+
+} // namespace segfault::renderer
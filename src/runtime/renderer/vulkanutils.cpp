@@ -24,43 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "core/segfaultexception.h"
 #include "volk.h"
 
+#include <algorithm>
 #include <array>
 
 namespace segfault::renderer {
 
     using namespace segfault::core;
 
-        std::array<VkVertexInputAttributeDescription, 3> Vertex::getAttributeDescriptions() {
-            std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-
-            attributeDescriptions[0].binding = 0;
-            attributeDescriptions[0].location = 0;
-            attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-            attributeDescriptions[1].binding = 0;
-            attributeDescriptions[1].location = 1;
-            attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-            attributeDescriptions[2].binding = 0;
-            attributeDescriptions[2].location = 2;
-            attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-            attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-
-            return attributeDescriptions;
-        }
-
-        VkVertexInputBindingDescription Vertex::getBindingDescription() {
-            VkVertexInputBindingDescription bindingDescription{};
-
-            bindingDescription.binding = 0;
-            bindingDescription.stride = sizeof(Vertex);
-            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-            return bindingDescription;
-        }
-
     VkFormat VulkanUtils::findSupportedFormat(VkPhysicalDevice &physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
         for (VkFormat format : candidates) {
             VkFormatProperties props;
@@ -84,4 +54,146 @@ namespace segfault::renderer {
         );
     }
 
+    std::vector<VkVertexInputAttributeDescription> VulkanUtils::getAttributeDescriptions(MeshVertexFormat format) {
+        static constexpr VkFormat AttributeFormats[] = {
+            VK_FORMAT_R32G32_SFLOAT,        // Float2
+            VK_FORMAT_R32G32B32_SFLOAT,     // Float3
+            VK_FORMAT_R16G16_SFLOAT,        // Half2
+            VK_FORMAT_R16G16B16A16_SFLOAT,  // Half4
+            VK_FORMAT_R16G16_SNORM,         // Snorm16x2
+            VK_FORMAT_R16G16B16A16_SNORM,   // Snorm16x4
+            VK_FORMAT_R8G8B8A8_UNORM        // Unorm8x4
+        };
+        static_assert(sizeof(AttributeFormats) / sizeof(AttributeFormats[0]) == static_cast<size_t>(VertexAttributeType::Count), 
+            "Missing attribute format.");
+
+        std::array<MeshVertexAttribute, MaxMeshVertexAttributes> attributes{};
+        const size_t numAttributes = getMeshVertexAttributes(format, attributes.data());
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(numAttributes);
+        for (size_t i = 0; i < numAttributes; ++i) {
+            attributeDescriptions[i].binding = 0;
+            attributeDescriptions[i].location = static_cast<uint32_t>(attributes[i].semantic);
+            attributeDescriptions[i].format = AttributeFormats[static_cast<size_t>(attributes[i].type)];
+            attributeDescriptions[i].offset = attributes[i].offset;
+        }
+
+        return attributeDescriptions;
+    }
+
+    bool VulkanUtils::getAttributeDescriptions(MeshVertexFormat format, const ShaderReflection &reflection, 
+            std::vector<VkVertexInputAttributeDescription> &attributeDescriptions) {
+        const std::vector<VkVertexInputAttributeDescription> formatAttributes = getAttributeDescriptions(format);
+        attributeDescriptions.clear();
+        for (const ShaderVertexInput &input : reflection.vertexInputs) {
+            auto it = std::find_if(formatAttributes.begin(), formatAttributes.end(), [&input](const VkVertexInputAttributeDescription &attribute) {
+                return attribute.location == input.location;
+            });
+            // All mesh attributes are float or normalized, they cannot feed integer inputs
+            if (it == formatAttributes.end() || input.type != ShaderScalarType::Float) {
+                attributeDescriptions.clear();
+                return false;
+            }
+            attributeDescriptions.push_back(*it);
+        }
+
+        return true;
+    }
+
+    VkVertexInputBindingDescription VulkanUtils::getBindingDescription(MeshVertexFormat format) {
+        VkVertexInputBindingDescription bindingDescription{};
+
+        bindingDescription.binding = 0;
+        bindingDescription.stride = getMeshVertexStride(format);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescription;
+    }
+
+    VkFormat VulkanUtils::getTextureFormat(TextureFormat format, bool srgb) {
+        switch (format) {
+            case TextureFormat::RGBA8:
+                return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+            case TextureFormat::BC1:
+                return srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case TextureFormat::BC3:
+                return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+            case TextureFormat::BC5:
+                return srgb ? VK_FORMAT_UNDEFINED : VK_FORMAT_BC5_UNORM_BLOCK;
+            case TextureFormat::BC7:
+                return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+            default:
+                break;
+        }
+
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    VkDescriptorType VulkanUtils::getDescriptorType(ShaderDescriptorType type) {
+        switch (type) {
+            case ShaderDescriptorType::UniformBuffer:
+                return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            case ShaderDescriptorType::StorageBuffer:
+                return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            case ShaderDescriptorType::CombinedImageSampler:
+                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case ShaderDescriptorType::SampledImage:
+                return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            case ShaderDescriptorType::Sampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case ShaderDescriptorType::StorageImage:
+                return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            default:
+                break;
+        }
+
+        return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    }
+
+    VkShaderStageFlags VulkanUtils::getShaderStageFlags(uint32_t stages) {
+        VkShaderStageFlags flags{ 0 };
+        if ((stages & ShaderStageVertex) != 0) {
+            flags |= VK_SHADER_STAGE_VERTEX_BIT;
+        }
+        if ((stages & ShaderStageFragment) != 0) {
+            flags |= VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+        if ((stages & ShaderStageCompute) != 0) {
+            flags |= VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        return flags;
+    }
+
+    VkCullModeFlags VulkanUtils::getCullMode(PipelineCullMode mode) {
+        switch (mode) {
+            case PipelineCullMode::None:
+                return VK_CULL_MODE_NONE;
+            case PipelineCullMode::Front:
+                return VK_CULL_MODE_FRONT_BIT;
+            default:
+                break;
+        }
+
+        return VK_CULL_MODE_BACK_BIT;
+    }
+
+    VkPipelineColorBlendAttachmentState VulkanUtils::getColorBlendAttachment(PipelineBlendMode mode) {
+        VkPipelineColorBlendAttachmentState attachment{};
+        attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        attachment.blendEnable = VK_FALSE;
+        if (mode != PipelineBlendMode::Alpha && mode != PipelineBlendMode::Additive) {
+            return attachment;
+        }
+
+        attachment.blendEnable = VK_TRUE;
+        attachment.srcColorBlendFactor = mode == PipelineBlendMode::Alpha ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+        attachment.dstColorBlendFactor = mode == PipelineBlendMode::Alpha ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+        attachment.colorBlendOp = VK_BLEND_OP_ADD;
+        attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachment.dstAlphaBlendFactor = mode == PipelineBlendMode::Alpha ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+        attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+        return attachment;
+    }
+
 }
@@ -23,6 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "volk.h"
+#include "meshformat.h"
+#include "pipelinelibrary.h"
+#include "shaderreflection.h"
+#include "textureformat.h"
 
 #include <vector>
 
@@ -38,13 +42,6 @@ namespace segfault::renderer {
 		glm::vec3 color{};      ///< Color of the vertex (RGB).
 		glm::vec2 texCoord{};   ///< Texture coordinates for the vertex.
 
-		/// @brief Returns the attribute descriptions for the vertex.
-		/// @return An array of VkVertexInputAttributeDescription for the vertex attributes.
-        static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions();
-
-		/// @brief Returns the binding description for the vertex.
-		/// @return A VkVertexInputBindingDescription for the vertex binding.
-        static VkVertexInputBindingDescription getBindingDescription();
     };
 
     /// @brief Utility functions for Vulkan operations.
@@ -62,6 +59,52 @@ namespace segfault::renderer {
         /// @param physicalDevice The physical device to query.
         /// @return A supported depth format.
         static VkFormat findDepthFormat(VkPhysicalDevice &physicalDevice);
+
+        /// @brief Returns the attribute descriptions of a mesh vertex format, the location of an 
+        /// attribute is its semantic.
+        /// @param format The mesh vertex format.
+        /// @return The attribute descriptions for binding 0, empty for invalid formats.
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(MeshVertexFormat format);
+
+        /// @brief Returns the attribute descriptions of a mesh vertex format for the inputs a 
+        /// vertex shader reads, attributes the shader does not read are left out.
+        /// @param format The mesh vertex format.
+        /// @param reflection The interface of the vertex shader.
+        /// @param attributeDescriptions Receives the attribute descriptions for binding 0.
+        /// @return False if the format lacks an input or an input is not a float vector.
+        static bool getAttributeDescriptions(MeshVertexFormat format, const ShaderReflection &reflection, 
+            std::vector<VkVertexInputAttributeDescription> &attributeDescriptions);
+
+        /// @brief Returns the binding description of a mesh vertex format.
+        /// @param format The mesh vertex format.
+        /// @return The description of binding 0.
+        static VkVertexInputBindingDescription getBindingDescription(MeshVertexFormat format);
+
+        /// @brief Returns the Vulkan format of a baked texture format.
+        /// @param format The texture format.
+        /// @param srgb True if the texture holds sRGB encoded color.
+        /// @return The format, VK_FORMAT_UNDEFINED if there is no matching one.
+        static VkFormat getTextureFormat(TextureFormat format, bool srgb);
+
+        /// @brief Returns the Vulkan descriptor type of a reflected binding.
+        /// @param type The reflected descriptor type.
+        /// @return The descriptor type, VK_DESCRIPTOR_TYPE_MAX_ENUM for invalid types.
+        static VkDescriptorType getDescriptorType(ShaderDescriptorType type);
+
+        /// @brief Returns the Vulkan stage flags of reflected shader stages.
+        /// @param stages The ShaderStage bits.
+        /// @return The stage flags.
+        static VkShaderStageFlags getShaderStageFlags(uint32_t stages);
+
+        /// @brief Returns the Vulkan cull mode of a pipeline cull mode.
+        /// @param mode The cull mode.
+        /// @return The cull mode flags, back face culling for invalid modes.
+        static VkCullModeFlags getCullMode(PipelineCullMode mode);
+
+        /// @brief Returns the color blend state of a pipeline blend mode, all channels are written.
+        /// @param mode The blend mode.
+        /// @return The blend state, opaque for invalid modes.
+        static VkPipelineColorBlendAttachmentState getColorBlendAttachment(PipelineBlendMode mode);
     };
 
 } // namespace segfault::renderer
@@ -0,0 +1,204 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace segfault::scene {
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	An axis-aligned bounding box.
+    //-------------------------------------------------------------------------------------------------
+    struct Aabb {
+        glm::vec3 min{ std::numeric_limits<float>::max() };
+        glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+        /// @brief The default constructor, creates an empty box.
+        Aabb() = default;
+
+        /// @brief Creates a box from its corners.
+        Aabb(const glm::vec3 &boxMin, const glm::vec3 &boxMax) : min(boxMin), max(boxMax) {}
+
+        /// @brief Returns true if the box contains no point.
+        bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+        /// @brief Returns the center.
+        glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+        /// @brief Returns half of the size.
+        glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+        /// @brief Returns the surface area, the cost measure of the SAH.
+        float getSurfaceArea() const {
+            if (isEmpty()) {
+                return 0.0f;
+            }
+            const glm::vec3 d = max - min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        /// @brief Grows the box to contain a point.
+        void merge(const glm::vec3 &point) {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        /// @brief Grows the box to contain another box.
+        void merge(const Aabb &box) {
+            min = glm::min(min, box.min);
+            max = glm::max(max, box.max);
+        }
+
+        /// @brief Returns true if the box contains another box.
+        bool contains(const Aabb &box) const {
+            return min.x <= box.min.x && min.y <= box.min.y && min.z <= box.min.z &&
+                    max.x >= box.max.x && max.y >= box.max.y && max.z >= box.max.z;
+        }
+
+        /// @brief Returns true if the boxes overlap.
+        bool overlaps(const Aabb &box) const {
+            return min.x <= box.max.x && max.x >= box.min.x && min.y <= box.max.y && max.y >= box.min.y &&
+                    min.z <= box.max.z && max.z >= box.min.z;
+        }
+
+        /// @brief Returns the union of two boxes.
+        static Aabb combine(const Aabb &a, const Aabb &b) {
+            return Aabb(glm::min(a.min, b.min), glm::max(a.max, b.max));
+        }
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A ray with precomputed reciprocal direction for slab tests.
+    //-------------------------------------------------------------------------------------------------
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        glm::vec3 invDirection;
+
+        /// @brief Creates a ray.
+        /// @param[ in ] rayOrigin The origin.
+        /// @param[ in ] rayDirection The direction, the hit distances are measured in its length.
+        Ray(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection) :
+                origin(rayOrigin), direction(rayDirection),
+                invDirection(1.0f / rayDirection.x, 1.0f / rayDirection.y, 1.0f / rayDirection.z) {}
+
+        /// @brief Intersects the ray with a box.
+        /// @param[ in ] box The box.
+        /// @param[ in ] maxDistance Hits further away are ignored.
+        /// @param[ out ] distance The entry distance, zero if the origin is inside.
+        /// @return True on a hit.
+        bool intersect(const Aabb &box, float maxDistance, float &distance) const {
+            float tmin = 0.0f, tmax = maxDistance;
+            for (int i = 0; i < 3; ++i) {
+                // A ray parallel to the slab hits it only from inside, the distances would be 
+                // 0 * inf = NaN for an origin on the slab plane
+                if (std::isinf(invDirection[i])) {
+                    if (origin[i] < box.min[i] || origin[i] > box.max[i]) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                const float t0 = (box.min[i] - origin[i]) * invDirection[i], t1 = (box.max[i] - origin[i]) * invDirection[i];
+                tmin = std::max(tmin, std::min(t0, t1));
+                tmax = std::min(tmax, std::max(t0, t1));
+            }
+            distance = tmin;
+            return tmin <= tmax;
+        }
+    };
+
+    /// @brief The result of a frustum test.
+    enum class FrustumTest {
+        Outside = 0,
+        Intersects,
+        Inside
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A view frustum given by six inward facing planes.
+    //-------------------------------------------------------------------------------------------------
+    struct Frustum {
+        /// @brief The planes as (normal, distance), a point p is inside if dot(n, p) + d >= 0.
+        glm::vec4 planes[6];
+
+        /// @brief Extracts the planes from a view-projection matrix.
+        /// @param[ in ] viewProj The view-projection matrix.
+        /// @return The frustum in world space.
+        static Frustum fromMatrix(const glm::mat4 &viewProj) {
+            auto row = [&viewProj](int i) {
+                return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+            };
+            const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+            Frustum frustum;
+            frustum.planes[0] = r3 + r0;
+            frustum.planes[1] = r3 - r0;
+            frustum.planes[2] = r3 + r1;
+            frustum.planes[3] = r3 - r1;
+            frustum.planes[4] = r3 + r2;
+            frustum.planes[5] = r3 - r2;
+            for (glm::vec4 &plane : frustum.planes) {
+                const float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+                plane = plane * (1.0f / length);
+            }
+            return frustum;
+        }
+
+        /// @brief Classifies a box against the planes selected by a mask.
+        /// @param[ in ] box The box.
+        /// @param[ in, out ] planeMask The planes to test, planes fully containing the box are removed.
+        /// @return The classification.
+        FrustumTest test(const Aabb &box, uint32_t &planeMask) const {
+            const glm::vec3 center = box.getCenter();
+            const glm::vec3 extents = box.getExtents();
+            for (uint32_t i = 0; i < 6; ++i) {
+                if ((planeMask & (1u << i)) == 0) {
+                    continue;
+                }
+                const glm::vec4 &p = planes[i];
+                const float d = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+                const float r = std::fabs(p.x) * extents.x + std::fabs(p.y) * extents.y + std::fabs(p.z) * extents.z;
+                if (d + r < 0.0f) {
+                    return FrustumTest::Outside;
+                }
+                if (d - r >= 0.0f) {
+                    planeMask &= ~(1u << i);
+                }
+            }
+            return planeMask == 0 ? FrustumTest::Inside : FrustumTest::Intersects;
+        }
+    };
+
+} // namespace segfault::scene
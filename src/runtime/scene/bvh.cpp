@@ -0,0 +1,689 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "scene/bvh.h"
+#include "core/threadpool.h"
+
+#include <array>
+#include <numeric>
+
+namespace segfault::scene {
+
+    using namespace ::segfault::core;
+
+    namespace {
+        constexpr uint32_t NumBins = 16;
+
+        // Subtrees with at least this many objects are split between the workers
+        constexpr size_t ParallelBuildThreshold = 4096;
+
+        constexpr uint32_t AllFrustumPlanes = 0x3f;
+
+        /// A traversal stack which only allocates for very deep trees.
+        template<class T>
+        class TraversalStack {
+        public:
+            void push(const T &value) {
+                if (mSize < InlineSize) {
+                    mInline[mSize] = value;
+                } else {
+                    mSpill.push_back(value);
+                }
+                ++mSize;
+            }
+
+            T pop() {
+                --mSize;
+                if (mSize >= InlineSize) {
+                    const T value = mSpill.back();
+                    mSpill.pop_back();
+                    return value;
+                }
+                return mInline[mSize];
+            }
+
+            bool empty() const { return mSize == 0; }
+
+        private:
+            static constexpr size_t InlineSize = 64;
+            std::array<T, InlineSize> mInline;
+            std::vector<T> mSpill;
+            size_t mSize{ 0 };
+        };
+
+        struct Bin {
+            Aabb bounds;
+            uint32_t count{ 0 };
+        };
+    } // Anonymous namespace
+
+    struct Bvh::BuildContext {
+        const Aabb *bounds;
+        const uint32_t *userData;
+        ThreadPool *pool;
+        std::vector<uint32_t> indices;
+        std::vector<glm::vec3> centroids;
+    };
+
+    Bvh::Bvh(float margin) :
+            mMargin(margin),
+            mRoot(InvalidNode),
+            mNodes(),
+            mFreeNodes(),
+            mProxies(),
+            mFreeProxies(),
+            mNumProxies(0) {
+        // empty
+    }
+
+    Aabb Bvh::enlarge(const Aabb &bounds) const {
+        const glm::vec3 margin(mMargin);
+        return Aabb(bounds.min - margin, bounds.max + margin);
+    }
+
+    uint32_t Bvh::allocateNode() {
+        if (!mFreeNodes.empty()) {
+            const uint32_t node = mFreeNodes.back();
+            mFreeNodes.pop_back();
+            mNodes[node] = Node();
+            return node;
+        }
+
+        mNodes.emplace_back();
+        return static_cast<uint32_t>(mNodes.size() - 1);
+    }
+
+    void Bvh::freeNode(uint32_t node) {
+        mNodes[node].height = -1;
+        mFreeNodes.push_back(node);
+    }
+
+    BvhProxy Bvh::allocateProxy(uint32_t node) {
+        if (!mFreeProxies.empty()) {
+            const BvhProxy proxy = mFreeProxies.back();
+            mFreeProxies.pop_back();
+            mProxies[proxy] = node;
+            return proxy;
+        }
+
+        mProxies.push_back(node);
+        return static_cast<BvhProxy>(mProxies.size() - 1);
+    }
+
+    void Bvh::clear() {
+        mRoot = InvalidNode;
+        mNodes.clear();
+        mFreeNodes.clear();
+        mProxies.clear();
+        mFreeProxies.clear();
+        mNumProxies = 0;
+    }
+
+    void Bvh::build(const Aabb *bounds, const uint32_t *userData, size_t count, ThreadPool *pool) {
+        clear();
+        if (count == 0) {
+            return;
+        }
+        if (bounds == nullptr) {
+            logMessage(LogType::Error, "Invalid bounds for the BVH build.");
+            return;
+        }
+
+        BuildContext context{ bounds, userData, pool, std::vector<uint32_t>(count), std::vector<glm::vec3>(count) };
+        std::iota(context.indices.begin(), context.indices.end(), 0u);
+        for (size_t i = 0; i < count; ++i) {
+            context.centroids[i] = bounds[i].getCenter();
+        }
+
+        // A binary tree with n leaves has 2n - 1 nodes, each subtree gets a fixed node range so 
+        // the workers never allocate
+        mNodes.resize(2 * count - 1);
+        mProxies.resize(count);
+        mNumProxies = count;
+        mRoot = 0;
+        buildRange(context, 0, InvalidNode, 0, count);
+    }
+
+    int32_t Bvh::buildRange(BuildContext &context, uint32_t node, uint32_t parent, size_t begin, size_t end) {
+        mNodes[node].parent = parent;
+        if (end - begin == 1) {
+            const uint32_t object = context.indices[begin];
+            Node &leaf = mNodes[node];
+            leaf.bounds = enlarge(context.bounds[object]);
+            leaf.objectBounds = context.bounds[object];
+            leaf.child1 = InvalidNode;
+            leaf.child2 = InvalidNode;
+            leaf.height = 0;
+            leaf.userData = context.userData != nullptr ? context.userData[object] : object;
+            leaf.proxy = object;
+            mProxies[object] = node;
+            return 0;
+        }
+
+        Aabb centroidBounds;
+        for (size_t i = begin; i < end; ++i) {
+            centroidBounds.merge(context.centroids[context.indices[i]]);
+        }
+
+        // Binned SAH over all three axes
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        uint32_t bestSplit = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+            if (extent <= 0.0f) {
+                continue;
+            }
+
+            const float scale = NumBins / extent;
+            std::array<Bin, NumBins> bins;
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t object = context.indices[i];
+                const uint32_t bin = std::min(NumBins - 1, static_cast<uint32_t>((context.centroids[object][axis] - centroidBounds.min[axis]) * scale));
+                bins[bin].bounds.merge(context.bounds[object]);
+                ++bins[bin].count;
+            }
+
+            std::array<float, NumBins - 1> leftCost;
+            Aabb left;
+            uint32_t leftCount = 0;
+            for (uint32_t i = 0; i + 1 < NumBins; ++i) {
+                left.merge(bins[i].bounds);
+                leftCount += bins[i].count;
+                leftCost[i] = left.getSurfaceArea() * leftCount;
+            }
+
+            Aabb right;
+            uint32_t rightCount = 0;
+            for (uint32_t i = NumBins - 1; i > 0; --i) {
+                right.merge(bins[i].bounds);
+                rightCount += bins[i].count;
+                const float cost = leftCost[i - 1] + right.getSurfaceArea() * rightCount;
+                if (cost < bestCost && rightCount > 0 && rightCount < end - begin) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i - 1;
+                }
+            }
+        }
+
+        size_t mid = (begin + end) / 2;
+        if (bestAxis >= 0) {
+            const float scale = NumBins / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+            const float minimum = centroidBounds.min[bestAxis];
+            auto it = std::partition(context.indices.begin() + begin, context.indices.begin() + end, [&](uint32_t object) {
+                const uint32_t bin = std::min(NumBins - 1, static_cast<uint32_t>((context.centroids[object][bestAxis] - minimum) * scale));
+                return bin <= bestSplit;
+            });
+            const size_t split = static_cast<size_t>(it - context.indices.begin());
+            if (split > begin && split < end) {
+                mid = split;
+            }
+        }
+
+        const size_t leftCount = mid - begin;
+        const uint32_t child1 = node + 1;
+        const uint32_t child2 = node + static_cast<uint32_t>(2 * leftCount);
+        mNodes[node].child1 = child1;
+        mNodes[node].child2 = child2;
+        mNodes[node].proxy = InvalidBvhProxy;
+
+        int32_t height1 = 0, height2 = 0;
+        if (context.pool != nullptr && end - begin >= ParallelBuildThreshold) {
+            context.pool->parallelFor(2, 1, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    if (i == 0) {
+                        height1 = buildRange(context, child1, node, begin, mid);
+                    } else {
+                        height2 = buildRange(context, child2, node, mid, end);
+                    }
+                }
+            });
+        } else {
+            height1 = buildRange(context, child1, node, begin, mid);
+            height2 = buildRange(context, child2, node, mid, end);
+        }
+
+        Node &inner = mNodes[node];
+        inner.bounds = Aabb::combine(mNodes[child1].bounds, mNodes[child2].bounds);
+        inner.height = 1 + std::max(height1, height2);
+
+        return inner.height;
+    }
+
+    BvhProxy Bvh::insert(const Aabb &bounds, uint32_t userData) {
+        const uint32_t leaf = allocateNode();
+        const BvhProxy proxy = allocateProxy(leaf);
+        Node &node = mNodes[leaf];
+        node.bounds = enlarge(bounds);
+        node.objectBounds = bounds;
+        node.userData = userData;
+        node.proxy = proxy;
+        insertLeaf(leaf);
+        ++mNumProxies;
+
+        return proxy;
+    }
+
+    void Bvh::remove(BvhProxy proxy) {
+        if (proxy >= mProxies.size() || mProxies[proxy] == InvalidNode) {
+            logMessage(LogType::Error, "Invalid BVH proxy.");
+            return;
+        }
+
+        const uint32_t leaf = mProxies[proxy];
+        removeLeaf(leaf);
+        freeNode(leaf);
+        mProxies[proxy] = InvalidNode;
+        mFreeProxies.push_back(proxy);
+        --mNumProxies;
+    }
+
+    bool Bvh::update(BvhProxy proxy, const Aabb &bounds) {
+        if (proxy >= mProxies.size() || mProxies[proxy] == InvalidNode) {
+            logMessage(LogType::Error, "Invalid BVH proxy.");
+            return false;
+        }
+
+        const uint32_t leaf = mProxies[proxy];
+        mNodes[leaf].objectBounds = bounds;
+        if (mNodes[leaf].bounds.contains(bounds)) {
+            return false;
+        }
+
+        removeLeaf(leaf);
+        mNodes[leaf].bounds = enlarge(bounds);
+        insertLeaf(leaf);
+
+        return true;
+    }
+
+    void Bvh::setBounds(BvhProxy proxy, const Aabb &bounds) {
+        if (proxy >= mProxies.size() || mProxies[proxy] == InvalidNode) {
+            logMessage(LogType::Error, "Invalid BVH proxy.");
+            return;
+        }
+
+        Node &leaf = mNodes[mProxies[proxy]];
+        leaf.bounds = enlarge(bounds);
+        leaf.objectBounds = bounds;
+    }
+
+    void Bvh::refit() {
+        if (mRoot == InvalidNode) {
+            return;
+        }
+
+        // Parents precede their children in pre-order, so the reversed order is bottom-up
+        std::vector<uint32_t> order;
+        order.reserve(mNodes.size());
+        order.push_back(mRoot);
+        for (size_t i = 0; i < order.size(); ++i) {
+            const Node &node = mNodes[order[i]];
+            if (!node.isLeaf()) {
+                order.push_back(node.child1);
+                order.push_back(node.child2);
+            }
+        }
+        for (size_t i = order.size(); i-- > 0;) {
+            Node &node = mNodes[order[i]];
+            if (!node.isLeaf()) {
+                node.bounds = Aabb::combine(mNodes[node.child1].bounds, mNodes[node.child2].bounds);
+            }
+        }
+    }
+
+    void Bvh::insertLeaf(uint32_t leaf) {
+        if (mRoot == InvalidNode) {
+            mRoot = leaf;
+            mNodes[leaf].parent = InvalidNode;
+            return;
+        }
+
+        // Descend to the sibling with the lowest SAH cost increase
+        const Aabb leafBounds = mNodes[leaf].bounds;
+        uint32_t index = mRoot;
+        while (!mNodes[index].isLeaf()) {
+            const Node &node = mNodes[index];
+            const float area = node.bounds.getSurfaceArea();
+            const float combinedArea = Aabb::combine(node.bounds, leafBounds).getSurfaceArea();
+            const float cost = 2.0f * combinedArea;
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto childCost = [&](uint32_t child) {
+                const Node &c = mNodes[child];
+                const float enlarged = Aabb::combine(c.bounds, leafBounds).getSurfaceArea();
+                return (c.isLeaf() ? enlarged : enlarged - c.bounds.getSurfaceArea()) + inheritanceCost;
+            };
+            const float cost1 = childCost(node.child1);
+            const float cost2 = childCost(node.child2);
+            if (cost < cost1 && cost < cost2) {
+                break;
+            }
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        const uint32_t sibling = index;
+        const uint32_t oldParent = mNodes[sibling].parent;
+        const uint32_t newParent = allocateNode();
+        Node &parent = mNodes[newParent];
+        parent.parent = oldParent;
+        parent.bounds = Aabb::combine(leafBounds, mNodes[sibling].bounds);
+        parent.height = mNodes[sibling].height + 1;
+        parent.child1 = sibling;
+        parent.child2 = leaf;
+        if (oldParent != InvalidNode) {
+            if (mNodes[oldParent].child1 == sibling) {
+                mNodes[oldParent].child1 = newParent;
+            } else {
+                mNodes[oldParent].child2 = newParent;
+            }
+        } else {
+            mRoot = newParent;
+        }
+        mNodes[sibling].parent = newParent;
+        mNodes[leaf].parent = newParent;
+
+        for (index = mNodes[leaf].parent; index != InvalidNode; index = mNodes[index].parent) {
+            index = balance(index);
+            Node &node = mNodes[index];
+            node.height = 1 + std::max(mNodes[node.child1].height, mNodes[node.child2].height);
+            node.bounds = Aabb::combine(mNodes[node.child1].bounds, mNodes[node.child2].bounds);
+        }
+    }
+
+    void Bvh::removeLeaf(uint32_t leaf) {
+        if (leaf == mRoot) {
+            mRoot = InvalidNode;
+            return;
+        }
+
+        const uint32_t parent = mNodes[leaf].parent;
+        const uint32_t grandParent = mNodes[parent].parent;
+        const uint32_t sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+        freeNode(parent);
+        mNodes[leaf].parent = InvalidNode;
+        if (grandParent == InvalidNode) {
+            mRoot = sibling;
+            mNodes[sibling].parent = InvalidNode;
+            return;
+        }
+
+        if (mNodes[grandParent].child1 == parent) {
+            mNodes[grandParent].child1 = sibling;
+        } else {
+            mNodes[grandParent].child2 = sibling;
+        }
+        mNodes[sibling].parent = grandParent;
+
+        for (uint32_t index = grandParent; index != InvalidNode; index = mNodes[index].parent) {
+            index = balance(index);
+            Node &node = mNodes[index];
+            node.height = 1 + std::max(mNodes[node.child1].height, mNodes[node.child2].height);
+            node.bounds = Aabb::combine(mNodes[node.child1].bounds, mNodes[node.child2].bounds);
+        }
+    }
+
+    uint32_t Bvh::balance(uint32_t iA) {
+        Node &a = mNodes[iA];
+        if (a.isLeaf() || a.height < 2) {
+            return iA;
+        }
+
+        const uint32_t iB = a.child1;
+        const uint32_t iC = a.child2;
+        Node &b = mNodes[iB];
+        Node &c = mNodes[iC];
+        const int32_t difference = c.height - b.height;
+
+        // Rotate the higher child up, its higher grandchild stays below it
+        auto rotateUp = [&](uint32_t iUp, Node &up, Node &other, bool upIsChild2) {
+            const uint32_t iF = up.child1;
+            const uint32_t iG = up.child2;
+            Node &f = mNodes[iF];
+            Node &g = mNodes[iG];
+
+            up.child1 = iA;
+            up.parent = a.parent;
+            a.parent = iUp;
+            if (up.parent != InvalidNode) {
+                if (mNodes[up.parent].child1 == iA) {
+                    mNodes[up.parent].child1 = iUp;
+                } else {
+                    mNodes[up.parent].child2 = iUp;
+                }
+            } else {
+                mRoot = iUp;
+            }
+
+            const bool keepF = f.height > g.height;
+            const uint32_t iKeep = keepF ? iF : iG;
+            const uint32_t iMove = keepF ? iG : iF;
+            up.child2 = iKeep;
+            if (upIsChild2) {
+                a.child2 = iMove;
+            } else {
+                a.child1 = iMove;
+            }
+            mNodes[iMove].parent = iA;
+
+            a.bounds = Aabb::combine(other.bounds, mNodes[iMove].bounds);
+            up.bounds = Aabb::combine(a.bounds, mNodes[iKeep].bounds);
+            a.height = 1 + std::max(other.height, mNodes[iMove].height);
+            up.height = 1 + std::max(a.height, mNodes[iKeep].height);
+        };
+
+        if (difference > 1) {
+            rotateUp(iC, c, b, true);
+            return iC;
+        }
+        if (difference < -1) {
+            rotateUp(iB, b, c, false);
+            return iB;
+        }
+
+        return iA;
+    }
+
+    void Bvh::collectLeaves(uint32_t node, std::vector<uint32_t> &result) const {
+        TraversalStack<uint32_t> stack;
+        stack.push(node);
+        while (!stack.empty()) {
+            const Node &current = mNodes[stack.pop()];
+            if (current.isLeaf()) {
+                result.push_back(current.userData);
+            } else {
+                stack.push(current.child1);
+                stack.push(current.child2);
+            }
+        }
+    }
+
+    void Bvh::queryFrustum(const Frustum &frustum, std::vector<uint32_t> &result) const {
+        if (mRoot == InvalidNode) {
+            return;
+        }
+
+        // Planes which contain a node are skipped for its subtree, fully visible subtrees are 
+        // collected without further tests
+        TraversalStack<std::pair<uint32_t, uint32_t>> stack;
+        stack.push({ mRoot, AllFrustumPlanes });
+        while (!stack.empty()) {
+            auto [index, planeMask] = stack.pop();
+            const Node &node = mNodes[index];
+            const FrustumTest test = frustum.test(node.bounds, planeMask);
+            if (test == FrustumTest::Outside) {
+                continue;
+            }
+            if (test == FrustumTest::Inside) {
+                collectLeaves(index, result);
+            } else if (node.isLeaf()) {
+                result.push_back(node.userData);
+            } else {
+                stack.push({ node.child1, planeMask });
+                stack.push({ node.child2, planeMask });
+            }
+        }
+    }
+
+    void Bvh::queryAabb(const Aabb &box, std::vector<uint32_t> &result) const {
+        if (mRoot == InvalidNode) {
+            return;
+        }
+
+        TraversalStack<uint32_t> stack;
+        stack.push(mRoot);
+        while (!stack.empty()) {
+            const Node &node = mNodes[stack.pop()];
+            if (!node.bounds.overlaps(box)) {
+                continue;
+            }
+            if (node.isLeaf()) {
+                result.push_back(node.userData);
+            } else {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    bool Bvh::raycast(const Ray &ray, float maxDistance, const BvhRayHitFunc &hitFunc, BvhRayHit &hit) const {
+        float entry = 0.0f;
+        if (mRoot == InvalidNode || !ray.intersect(mNodes[mRoot].bounds, maxDistance, entry)) {
+            return false;
+        }
+
+        float best = maxDistance;
+        bool found = false;
+        TraversalStack<std::pair<uint32_t, float>> stack;
+        stack.push({ mRoot, entry });
+        while (!stack.empty()) {
+            const auto [index, distance] = stack.pop();
+            if (distance > best) {
+                continue;
+            }
+
+            const Node &node = mNodes[index];
+            if (node.isLeaf()) {
+                // Without a narrow phase test the exact bounds, the enlarged ones only guide the traversal
+                float hitDistance = -1.0f;
+                if (hitFunc) {
+                    hitDistance = hitFunc(node.userData, ray, best);
+                } else if (!ray.intersect(node.objectBounds, best, hitDistance)) {
+                    continue;
+                }
+                if (hitDistance >= 0.0f && hitDistance <= best) {
+                    best = hitDistance;
+                    hit.userData = node.userData;
+                    hit.distance = hitDistance;
+                    found = true;
+                }
+                continue;
+            }
+
+            // Visit the nearer child first by pushing it last
+            float distance1 = 0.0f, distance2 = 0.0f;
+            const bool hit1 = ray.intersect(mNodes[node.child1].bounds, best, distance1);
+            const bool hit2 = ray.intersect(mNodes[node.child2].bounds, best, distance2);
+            if (hit1 && hit2) {
+                if (distance1 < distance2) {
+                    stack.push({ node.child2, distance2 });
+                    stack.push({ node.child1, distance1 });
+                } else {
+                    stack.push({ node.child1, distance1 });
+                    stack.push({ node.child2, distance2 });
+                }
+            } else if (hit1) {
+                stack.push({ node.child1, distance1 });
+            } else if (hit2) {
+                stack.push({ node.child2, distance2 });
+            }
+        }
+
+        return found;
+    }
+
+    bool Bvh::lineOfSight(const glm::vec3 &from, const glm::vec3 &to, const BvhFilterFunc &isOccluder) const {
+        const glm::vec3 direction = to - from;
+        if (mRoot == InvalidNode || glm::dot(direction, direction) <= 0.0f) {
+            return true;
+        }
+
+        // The segment is the ray interval [0, 1], any blocking hit ends the search
+        const Ray ray(from, direction);
+        TraversalStack<uint32_t> stack;
+        stack.push(mRoot);
+        float distance = 0.0f;
+        while (!stack.empty()) {
+            const Node &node = mNodes[stack.pop()];
+            if (!ray.intersect(node.isLeaf() ? node.objectBounds : node.bounds, 1.0f, distance)) {
+                continue;
+            }
+            if (node.isLeaf()) {
+                if (!isOccluder || isOccluder(node.userData)) {
+                    return false;
+                }
+            } else {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+
+        return true;
+    }
+
+    const Aabb &Bvh::getBounds(BvhProxy proxy) const {
+        static const Aabb Empty;
+        if (proxy >= mProxies.size() || mProxies[proxy] == InvalidNode) {
+            logMessage(LogType::Error, "Invalid BVH proxy.");
+            return Empty;
+        }
+
+        return mNodes[mProxies[proxy]].bounds;
+    }
+
+    int32_t Bvh::getHeight() const {
+        return mRoot == InvalidNode ? 0 : mNodes[mRoot].height;
+    }
+
+    float Bvh::computeSahCost() const {
+        if (mRoot == InvalidNode) {
+            return 0.0f;
+        }
+
+        float innerArea = 0.0f;
+        TraversalStack<uint32_t> stack;
+        stack.push(mRoot);
+        while (!stack.empty()) {
+            const Node &node = mNodes[stack.pop()];
+            if (!node.isLeaf()) {
+                innerArea += node.bounds.getSurfaceArea();
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+        const float rootArea = mNodes[mRoot].bounds.getSurfaceArea();
+
+        return rootArea > 0.0f ? innerArea / rootArea : 0.0f;
+    }
+
+} // namespace segfault::scene
@@ -0,0 +1,187 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "scene/bounds.h"
+
+#include <functional>
+#include <vector>
+
+namespace segfault::core {
+    class ThreadPool;
+}
+
+namespace segfault::scene {
+
+    /// @brief A handle to an object stored in a bounding volume hierarchy.
+    using BvhProxy = uint32_t;
+
+    /// @brief The invalid proxy handle.
+    constexpr BvhProxy InvalidBvhProxy = ~0u;
+
+    /// @brief Narrow phase of a ray cast, returns the hit distance or a negative value for a miss.
+    using BvhRayHitFunc = std::function<float(uint32_t userData, const Ray &ray, float maxDistance)>;
+
+    /// @brief Selects the objects a query takes into account.
+    using BvhFilterFunc = std::function<bool(uint32_t userData)>;
+
+    /// @brief The closest hit of a ray cast.
+    struct BvhRayHit {
+        uint32_t userData{ ~0u };
+        float distance{ 0.0f };
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A dynamic bounding volume hierarchy over object bounds.
+    ///
+    /// The tree is built top-down with a binned surface area heuristic, large subtrees are built 
+    /// in parallel on the thread pool. Afterwards objects can be inserted and removed 
+    /// incrementally, the insertion descends by the SAH cost and rebalances with tree rotations. 
+    /// Leaves store the bounds enlarged by a margin, so small movements do not change the tree. 
+    /// The exact bounds are kept as well, ray casts and line of sight tests use them for the leaves. 
+    /// Animated scenes can set the bounds of many objects and refit the tree in one pass.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT Bvh final {
+    public:
+        /// @brief The class constructor.
+        /// @param[ in ] margin The amount leaf bounds are enlarged by.
+        explicit Bvh(float margin = 0.1f);
+
+        /// @brief The class destructor.
+        ~Bvh() = default;
+
+        /// @brief Replaces the content by a SAH build over the given objects.
+        /// @param[ in ] bounds The object bounds.
+        /// @param[ in ] userData The user data per object, nullptr uses the object index.
+        /// @param[ in ] count The number of objects, the proxy of object i is i.
+        /// @param[ in ] pool The worker threads or nullptr for a serial build.
+        void build(const Aabb *bounds, const uint32_t *userData, size_t count, core::ThreadPool *pool = nullptr);
+
+        /// @brief Inserts an object.
+        /// @param[ in ] bounds The object bounds.
+        /// @param[ in ] userData The user data returned by queries.
+        /// @return The proxy.
+        BvhProxy insert(const Aabb &bounds, uint32_t userData);
+
+        /// @brief Removes an object.
+        /// @param[ in ] proxy The proxy.
+        void remove(BvhProxy proxy);
+
+        /// @brief Moves an object, it is reinserted if it left its enlarged bounds.
+        /// @param[ in ] proxy The proxy.
+        /// @param[ in ] bounds The new bounds.
+        /// @return True if the object was reinserted.
+        bool update(BvhProxy proxy, const Aabb &bounds);
+
+        /// @brief Sets the bounds of an object without touching the tree, call refit afterwards.
+        /// @param[ in ] proxy The proxy.
+        /// @param[ in ] bounds The new bounds.
+        void setBounds(BvhProxy proxy, const Aabb &bounds);
+
+        /// @brief Recomputes all inner bounds bottom-up, keeps the topology.
+        void refit();
+
+        /// @brief Removes all objects.
+        void clear();
+
+        /// @brief Collects the objects intersecting a frustum.
+        /// @param[ in ] frustum The frustum.
+        /// @param[ out ] result The user data of the visible objects are appended to it.
+        void queryFrustum(const Frustum &frustum, std::vector<uint32_t> &result) const;
+
+        /// @brief Collects the objects overlapping a box.
+        /// @param[ in ] box The box.
+        /// @param[ out ] result The user data of the objects are appended to it.
+        void queryAabb(const Aabb &box, std::vector<uint32_t> &result) const;
+
+        /// @brief Finds the closest object hit by a ray.
+        /// @param[ in ] ray The ray.
+        /// @param[ in ] maxDistance The maximum hit distance.
+        /// @param[ in ] hitFunc The exact hit test or nullptr to use the object bounds.
+        /// @param[ out ] hit The closest hit.
+        /// @return True if anything was hit.
+        bool raycast(const Ray &ray, float maxDistance, const BvhRayHitFunc &hitFunc, BvhRayHit &hit) const;
+
+        /// @brief Checks if the segment between two points is free of occluders.
+        /// @param[ in ] from The start, usually the eye of the observer.
+        /// @param[ in ] to The end, usually the target.
+        /// @param[ in ] isOccluder Selects the blocking objects, nullptr treats all objects as occluders.
+        /// @return True if no occluder bounds intersect the segment.
+        bool lineOfSight(const glm::vec3 &from, const glm::vec3 &to, const BvhFilterFunc &isOccluder) const;
+
+        /// @brief Returns the enlarged bounds of an object.
+        const Aabb &getBounds(BvhProxy proxy) const;
+
+        /// @brief Returns the number of objects.
+        size_t getNumProxies() const { return mNumProxies; }
+
+        /// @brief Returns the height of the tree.
+        int32_t getHeight() const;
+
+        /// @brief Returns the SAH cost of the tree, the summed inner node area relative to the root.
+        float computeSahCost() const;
+
+        Bvh(const Bvh &) = delete;
+        Bvh &operator = (const Bvh &) = delete;
+
+    private:
+        static constexpr uint32_t InvalidNode = ~0u;
+
+        struct Node {
+            Aabb bounds;
+            Aabb objectBounds;
+            uint32_t parent{ InvalidNode };
+            uint32_t child1{ InvalidNode };
+            uint32_t child2{ InvalidNode };
+            int32_t height{ 0 };
+            uint32_t userData{ 0 };
+            BvhProxy proxy{ InvalidBvhProxy };
+
+            bool isLeaf() const { return child1 == InvalidNode; }
+        };
+
+        struct BuildContext;
+
+        Aabb enlarge(const Aabb &bounds) const;
+        uint32_t allocateNode();
+        void freeNode(uint32_t node);
+        BvhProxy allocateProxy(uint32_t node);
+        void insertLeaf(uint32_t leaf);
+        void removeLeaf(uint32_t leaf);
+        uint32_t balance(uint32_t node);
+        int32_t buildRange(BuildContext &context, uint32_t node, uint32_t parent, size_t begin, size_t end);
+        void collectLeaves(uint32_t node, std::vector<uint32_t> &result) const;
+
+    private:
+        float mMargin;
+        uint32_t mRoot;
+        std::vector<Node> mNodes;
+        std::vector<uint32_t> mFreeNodes;
+        std::vector<uint32_t> mProxies;
+        std::vector<BvhProxy> mFreeProxies;
+        size_t mNumProxies;
+    };
+
+} // namespace segfault::scene
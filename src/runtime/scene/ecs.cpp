@@ -0,0 +1,493 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "scene/ecs.h"
+#include "core/threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace segfault::scene {
+
+    using namespace ::segfault::core;
+
+    namespace {
+        constexpr size_t ChunkAlignment = 64;
+
+        inline uint32_t getIndex(Entity entity) {
+            return static_cast<uint32_t>(entity & 0xffffffffull);
+        }
+
+        inline uint32_t getGeneration(Entity entity) {
+            return static_cast<uint32_t>(entity >> 32);
+        }
+
+        inline Entity makeEntity(uint32_t index, uint32_t generation) {
+            return (static_cast<Entity>(generation) << 32) | index;
+        }
+
+        inline size_t alignUp(size_t value, size_t align) {
+            return (value + align - 1) & ~(align - 1);
+        }
+
+        uint8_t *allocateChunk() {
+            return static_cast<uint8_t*>(::operator new(EcsChunkSize, std::align_val_t(ChunkAlignment)));
+        }
+
+        void freeChunk(uint8_t *data) {
+            ::operator delete(data, std::align_val_t(ChunkAlignment));
+        }
+    } // Anonymous namespace
+
+    ComponentId getComponentId(uint64_t typeKey) {
+        static std::mutex sLock;
+        static std::unordered_map<uint64_t, ComponentId> sIds;
+        std::lock_guard<std::mutex> lock(sLock);
+        auto it = sIds.find(typeKey);
+        if (it != sIds.end()) {
+            return it->second;
+        }
+
+        const ComponentId id = static_cast<ComponentId>(sIds.size());
+        if (id >= MaxComponents) {
+            // The id would not fit the component masks, going on corrupts every archetype and query
+            logMessage(LogType::Error, "Too many component types, raise MaxComponents.");
+            std::abort();
+        }
+        sIds.emplace(typeKey, id);
+
+        return id;
+    }
+
+    Archetype::Archetype(ComponentMask mask, const ComponentInfo *infos) :
+            mMask(mask), mInfos(infos), mComponents(), mOffsets(), mCapacity(0), mChunks(), mAddEdges(), mRemoveEdges() {
+        mOffsets.fill(InvalidOffset);
+        mAddEdges.fill(nullptr);
+        mRemoveEdges.fill(nullptr);
+
+        size_t rowSize = sizeof(Entity);
+        for (ComponentId id = 0; id < MaxComponents; ++id) {
+            if ((mask & (ComponentMask(1) << id)) != 0) {
+                mComponents.push_back(id);
+                rowSize += infos[id].size;
+            }
+        }
+
+        // Start with the ideal capacity and shrink it until the aligned arrays fit into the chunk
+        for (size_t capacity = EcsChunkSize / rowSize; capacity > 0; --capacity) {
+            size_t offset = capacity * sizeof(Entity);
+            bool fits = true;
+            for (ComponentId id : mComponents) {
+                offset = alignUp(offset, infos[id].align);
+                mOffsets[id] = static_cast<uint32_t>(offset);
+                offset += capacity * infos[id].size;
+                if (offset > EcsChunkSize) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) {
+                mCapacity = static_cast<uint32_t>(capacity);
+                break;
+            }
+        }
+        if (mCapacity == 0) {
+            // The offsets of the last attempt point past the chunk, World rejects all rows
+            logMessage(LogType::Error, "Components of an archetype do not fit into a chunk.");
+        }
+    }
+
+    Archetype::~Archetype() {
+        for (EcsChunk &chunk : mChunks) {
+            freeChunk(chunk.data);
+        }
+    }
+
+    size_t Archetype::getNumEntities() const {
+        if (mChunks.empty()) {
+            return 0;
+        }
+
+        // All chunks but the last one are full
+        return (mChunks.size() - 1) * mCapacity + mChunks.back().count;
+    }
+
+    size_t Query::getNumEntities() const {
+        size_t count = 0;
+        for (const Archetype *archetype : mArchetypes) {
+            count += archetype->getNumEntities();
+        }
+
+        return count;
+    }
+
+    World::World() :
+            mComponentInfos(),
+            mArchetypes(),
+            mQueries(),
+            mRecords(),
+            mFreeRecords(),
+            mSystems(),
+            mWorkItems(),
+            mNumEntities(0),
+            mNumPhases(0),
+            mChunkVersion(0),
+            mPhasesDirty(false) {
+        // The root archetype without components
+        getArchetype(0);
+    }
+
+    World::~World() {
+        // empty
+    }
+
+    Archetype *World::getArchetype(ComponentMask mask) {
+        for (auto &archetype : mArchetypes) {
+            if (archetype->getMask() == mask) {
+                return archetype.get();
+            }
+        }
+
+        mArchetypes.emplace_back(std::make_unique<Archetype>(mask, mComponentInfos.data()));
+        Archetype *archetype = mArchetypes.back().get();
+        for (auto &query : mQueries) {
+            if (query->matches(mask)) {
+                query->mArchetypes.push_back(archetype);
+            }
+        }
+        ++mChunkVersion;
+
+        return archetype;
+    }
+
+    Entity World::allocateEntity(Archetype *archetype) {
+        if (archetype->mCapacity == 0) {
+            return InvalidEntity;
+        }
+
+        uint32_t index = 0;
+        if (!mFreeRecords.empty()) {
+            index = mFreeRecords.back();
+            mFreeRecords.pop_back();
+        } else {
+            index = static_cast<uint32_t>(mRecords.size());
+            mRecords.emplace_back();
+        }
+
+        EntityRecord &record = mRecords[index];
+        const Entity entity = makeEntity(index, record.generation);
+        allocateRow(archetype, record.chunk, record.row);
+        record.archetype = archetype;
+        EcsChunk &chunk = archetype->mChunks[record.chunk];
+        reinterpret_cast<Entity*>(chunk.data)[record.row] = entity;
+        ++mNumEntities;
+
+        return entity;
+    }
+
+    const World::EntityRecord *World::getRecord(Entity entity) const {
+        const uint32_t index = getIndex(entity);
+        if (index >= mRecords.size()) {
+            return nullptr;
+        }
+
+        const EntityRecord &record = mRecords[index];
+        if (record.archetype == nullptr || record.generation != getGeneration(entity)) {
+            return nullptr;
+        }
+
+        return &record;
+    }
+
+    bool World::isAlive(Entity entity) const {
+        return getRecord(entity) != nullptr;
+    }
+
+    void World::allocateRow(Archetype *archetype, uint32_t &chunk, uint32_t &row) {
+        assert(archetype->mCapacity != 0);
+        std::vector<EcsChunk> &chunks = archetype->mChunks;
+        if (chunks.empty() || chunks.back().count == archetype->mCapacity) {
+            chunks.push_back(EcsChunk{ allocateChunk(), 0 });
+            ++mChunkVersion;
+        }
+
+        chunk = static_cast<uint32_t>(chunks.size() - 1);
+        row = chunks.back().count++;
+    }
+
+    void World::removeRow(Archetype *archetype, uint32_t chunk, uint32_t row) {
+        // Fill the hole with the last entity of the archetype to keep the chunks dense
+        std::vector<EcsChunk> &chunks = archetype->mChunks;
+        EcsChunk &last = chunks.back();
+        const uint32_t lastChunk = static_cast<uint32_t>(chunks.size() - 1);
+        const uint32_t lastRow = last.count - 1;
+        if (chunk != lastChunk || row != lastRow) {
+            EcsChunk &dst = chunks[chunk];
+            const Entity moved = reinterpret_cast<Entity*>(last.data)[lastRow];
+            reinterpret_cast<Entity*>(dst.data)[row] = moved;
+            for (ComponentId id : archetype->mComponents) {
+                const size_t size = mComponentInfos[id].size;
+                const uint32_t offset = archetype->mOffsets[id];
+                std::memcpy(dst.data + offset + row * size, last.data + offset + lastRow * size, size);
+            }
+
+            EntityRecord &record = mRecords[getIndex(moved)];
+            record.chunk = chunk;
+            record.row = row;
+        }
+
+        if (--last.count == 0) {
+            freeChunk(last.data);
+            chunks.pop_back();
+            ++mChunkVersion;
+        }
+    }
+
+    void World::moveEntity(Entity entity, Archetype *target) {
+        EntityRecord &record = mRecords[getIndex(entity)];
+        Archetype *source = record.archetype;
+        uint32_t chunk = 0, row = 0;
+        allocateRow(target, chunk, row);
+
+        const EcsChunk &src = source->mChunks[record.chunk];
+        EcsChunk &dst = target->mChunks[chunk];
+        reinterpret_cast<Entity*>(dst.data)[row] = entity;
+        for (ComponentId id : target->mComponents) {
+            if (source->mOffsets[id] != Archetype::InvalidOffset) {
+                const size_t size = mComponentInfos[id].size;
+                std::memcpy(dst.data + target->mOffsets[id] + row * size, src.data + source->mOffsets[id] + record.row * size, size);
+            }
+        }
+
+        removeRow(source, record.chunk, record.row);
+        record.archetype = target;
+        record.chunk = chunk;
+        record.row = row;
+    }
+
+    bool World::destroy(Entity entity) {
+        if (getRecord(entity) == nullptr) {
+            return false;
+        }
+
+        const uint32_t index = getIndex(entity);
+        EntityRecord &record = mRecords[index];
+        removeRow(record.archetype, record.chunk, record.row);
+        record.archetype = nullptr;
+        if (++record.generation == 0) {
+            record.generation = 1;
+        }
+        mFreeRecords.push_back(index);
+        --mNumEntities;
+
+        return true;
+    }
+
+    bool World::addComponent(Entity entity, ComponentId id) {
+        if (getRecord(entity) == nullptr || id >= MaxComponents) {
+            return false;
+        }
+
+        Archetype *source = mRecords[getIndex(entity)].archetype;
+        if (source->mOffsets[id] != Archetype::InvalidOffset) {
+            return true;
+        }
+
+        if (source->mAddEdges[id] == nullptr) {
+            source->mAddEdges[id] = getArchetype(source->mMask | (ComponentMask(1) << id));
+        }
+        if (source->mAddEdges[id]->mCapacity == 0) {
+            return false;
+        }
+        moveEntity(entity, source->mAddEdges[id]);
+
+        return true;
+    }
+
+    bool World::removeComponent(Entity entity, ComponentId id) {
+        if (getRecord(entity) == nullptr || id >= MaxComponents) {
+            return false;
+        }
+
+        Archetype *source = mRecords[getIndex(entity)].archetype;
+        if (source->mOffsets[id] == Archetype::InvalidOffset) {
+            return false;
+        }
+
+        if (source->mRemoveEdges[id] == nullptr) {
+            source->mRemoveEdges[id] = getArchetype(source->mMask & ~(ComponentMask(1) << id));
+        }
+        if (source->mRemoveEdges[id]->mCapacity == 0) {
+            return false;
+        }
+        moveEntity(entity, source->mRemoveEdges[id]);
+
+        return true;
+    }
+
+    void *World::getComponent(Entity entity, ComponentId id) const {
+        const EntityRecord *record = getRecord(entity);
+        if (record == nullptr || id >= MaxComponents) {
+            return nullptr;
+        }
+
+        const Archetype *archetype = record->archetype;
+        const uint32_t offset = archetype->mOffsets[id];
+        if (offset == Archetype::InvalidOffset) {
+            return nullptr;
+        }
+
+        return archetype->mChunks[record->chunk].data + offset + record->row * mComponentInfos[id].size;
+    }
+
+    void World::writeComponent(Entity entity, ComponentId id, const void *value) {
+        void *dst = getComponent(entity, id);
+        if (dst != nullptr) {
+            std::memcpy(dst, value, mComponentInfos[id].size);
+        }
+    }
+
+    Query &World::query(ComponentMask include, ComponentMask exclude) {
+        for (auto &query : mQueries) {
+            if (query->mInclude == include && query->mExclude == exclude) {
+                return *query;
+            }
+        }
+
+        mQueries.emplace_back(std::make_unique<Query>(include, exclude));
+        Query &query = *mQueries.back();
+        for (auto &archetype : mArchetypes) {
+            if (query.matches(archetype->getMask())) {
+                query.mArchetypes.push_back(archetype.get());
+            }
+        }
+
+        return query;
+    }
+
+    void World::refreshChunkRefs(Query &query) {
+        if (query.mChunkVersion == mChunkVersion) {
+            return;
+        }
+
+        query.mChunkRefs.clear();
+        for (Archetype *archetype : query.mArchetypes) {
+            for (uint32_t i = 0; i < archetype->mChunks.size(); ++i) {
+                query.mChunkRefs.push_back(Query::ChunkRef{ archetype, i });
+            }
+        }
+        query.mChunkVersion = mChunkVersion;
+    }
+
+    SystemId World::addChunkSystem(const std::string &name, Query &query, ComponentMask reads, ComponentMask writes, ChunkSystemFunc func) {
+        if (!func) {
+            logMessage(LogType::Error, "Invalid system function.");
+            return ~0u;
+        }
+
+        mSystems.push_back(System{ name, &query, reads | writes, writes, std::move(func), 0, true });
+        mPhasesDirty = true;
+
+        return static_cast<SystemId>(mSystems.size() - 1);
+    }
+
+    void World::setSystemEnabled(SystemId id, bool enabled) {
+        if (id >= mSystems.size()) {
+            logMessage(LogType::Error, "Invalid system id.");
+            return;
+        }
+
+        mSystems[id].enabled = enabled;
+    }
+
+    void World::buildPhases() {
+        // A system runs after every earlier system it conflicts with, everything else may overlap
+        mNumPhases = 0;
+        for (size_t i = 0; i < mSystems.size(); ++i) {
+            System &system = mSystems[i];
+            system.phase = 0;
+            for (size_t j = 0; j < i; ++j) {
+                const System &other = mSystems[j];
+                if ((system.writes & other.reads) != 0 || (other.writes & system.reads) != 0) {
+                    system.phase = std::max(system.phase, other.phase + 1);
+                }
+            }
+            mNumPhases = std::max<size_t>(mNumPhases, system.phase + 1);
+        }
+        mPhasesDirty = false;
+    }
+
+    size_t World::getNumSystemPhases() {
+        if (mPhasesDirty) {
+            buildPhases();
+        }
+
+        return mNumPhases;
+    }
+
+    void World::runSystems(float dt, ThreadPool *pool) {
+        if (mPhasesDirty) {
+            buildPhases();
+        }
+
+        for (uint32_t phase = 0; phase < mNumPhases; ++phase) {
+            // Flatten the chunks of all systems in the phase into one parallel loop
+            mWorkItems.clear();
+            for (System &system : mSystems) {
+                if (!system.enabled || system.phase != phase) {
+                    continue;
+                }
+                refreshChunkRefs(*system.query);
+                for (const Query::ChunkRef &ref : system.query->mChunkRefs) {
+                    mWorkItems.emplace_back(&system, ref);
+                }
+            }
+
+            auto process = [this, dt](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const auto &item = mWorkItems[i];
+                    const Archetype &archetype = *item.second.archetype;
+                    item.first->func(ChunkView(archetype, archetype.getChunks()[item.second.chunk]), dt);
+                }
+            };
+            if (pool != nullptr && mWorkItems.size() > 1) {
+                pool->parallelFor(mWorkItems.size(), 1, process);
+            } else {
+                process(0, mWorkItems.size());
+            }
+        }
+    }
+
+    size_t World::getNumChunks() const {
+        size_t count = 0;
+        for (const auto &archetype : mArchetypes) {
+            count += archetype->getChunks().size();
+        }
+
+        return count;
+    }
+
+} // namespace segfault::scene
@@ -0,0 +1,463 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+#include "core/hash.h"
+
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace segfault::core {
+    class ThreadPool;
+}
+
+namespace segfault::scene {
+
+    /// @brief An entity handle, the slot index in the low and its generation in the high 32 bits.
+    using Entity = uint64_t;
+
+    /// @brief The invalid entity handle.
+    constexpr Entity InvalidEntity = 0;
+
+    /// @brief The process wide id of a component type.
+    using ComponentId = uint32_t;
+
+    /// @brief The maximum number of component types.
+    constexpr ComponentId MaxComponents = 64;
+
+    /// @brief A set of component types, one bit per component id.
+    using ComponentMask = uint64_t;
+
+    /// @brief The size of a component chunk in bytes.
+    constexpr size_t EcsChunkSize = 16 * 1024;
+
+    /// @brief Returns the id of a component type, the first request for a key assigns the next 
+    /// free id. Aborts when more than MaxComponents types are registered.
+    /// @param[ in ] typeKey The key of the type, see getComponentTypeKey.
+    /// @return The component id.
+    SEGFAULT_EXPORT ComponentId getComponentId(uint64_t typeKey);
+
+    /// @brief Returns the key of a component type, the hash of the type name as spelled by the 
+    /// compiler. It is the same in the engine and in every module loading it, so component types 
+    /// need unique names.
+    template<class T>
+    inline uint64_t getComponentTypeKey() {
+#ifdef _MSC_VER
+        return core::hashString(__FUNCSIG__);
+#else
+        return core::hashString(__PRETTY_FUNCTION__);
+#endif
+    }
+
+    /// @brief Assigns a component id to a component type on first use.
+    template<class T>
+    struct ComponentType {
+        static ComponentId id() {
+            // Each module caches the id, the registry in the engine hands out the same id to all
+            static const ComponentId sId = getComponentId(getComponentTypeKey<T>());
+            return sId;
+        }
+    };
+
+    /// @brief Returns the mask of a list of component types.
+    template<class... T>
+    inline ComponentMask componentMask() {
+        return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentType<std::remove_const_t<T>>::id()));
+    }
+
+    /// @brief Describes the storage of a component type.
+    struct ComponentInfo {
+        size_t size{ 0 };
+        size_t align{ 0 };
+    };
+
+    /// @brief A block of entities of one archetype, every component is stored as its own array.
+    struct EcsChunk {
+        uint8_t *data{ nullptr };
+        uint32_t count{ 0 };
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	All entities with exactly the same set of components.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT Archetype final {
+    public:
+        /// @brief Marks a component which is not part of the archetype.
+        static constexpr uint32_t InvalidOffset = ~0u;
+
+        /// @brief The class constructor.
+        /// @param[ in ] mask The components.
+        /// @param[ in ] infos The storage description of all component types.
+        Archetype(ComponentMask mask, const ComponentInfo *infos);
+
+        /// @brief The class destructor, releases the chunks.
+        ~Archetype();
+
+        /// @brief Returns the components.
+        ComponentMask getMask() const { return mMask; }
+
+        /// @brief Returns the number of entities per chunk.
+        uint32_t getCapacity() const { return mCapacity; }
+
+        /// @brief Returns the byte offset of a component array in a chunk.
+        uint32_t getOffset(ComponentId id) const { return mOffsets[id]; }
+
+        /// @brief Returns the component ids.
+        const std::vector<ComponentId> &getComponents() const { return mComponents; }
+
+        /// @brief Returns the size of a component.
+        size_t getComponentSize(ComponentId id) const { return mInfos[id].size; }
+
+        /// @brief Returns the chunks.
+        std::vector<EcsChunk> &getChunks() { return mChunks; }
+
+        /// @brief Returns the chunks.
+        const std::vector<EcsChunk> &getChunks() const { return mChunks; }
+
+        /// @brief Returns the number of entities.
+        size_t getNumEntities() const;
+
+        Archetype(const Archetype &) = delete;
+        Archetype &operator = (const Archetype &) = delete;
+
+    private:
+        friend class World;
+
+        ComponentMask mMask;
+        const ComponentInfo *mInfos;
+        std::vector<ComponentId> mComponents;
+        std::array<uint32_t, MaxComponents> mOffsets;
+        uint32_t mCapacity;
+        std::vector<EcsChunk> mChunks;
+        std::array<Archetype*, MaxComponents> mAddEdges;
+        std::array<Archetype*, MaxComponents> mRemoveEdges;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	Gives typed access to the component arrays of one chunk.
+    //-------------------------------------------------------------------------------------------------
+    class ChunkView final {
+    public:
+        /// @brief The class constructor.
+        ChunkView(const Archetype &archetype, const EcsChunk &chunk) : mArchetype(&archetype), mChunk(&chunk) {}
+
+        /// @brief Returns the number of entities.
+        uint32_t size() const { return mChunk->count; }
+
+        /// @brief Returns the entity handles.
+        const Entity *getEntities() const { return reinterpret_cast<const Entity*>(mChunk->data); }
+
+        /// @brief Returns a component array or nullptr if the archetype has no such component.
+        template<class T>
+        T *get() const {
+            const uint32_t offset = mArchetype->getOffset(ComponentType<std::remove_const_t<T>>::id());
+            return offset == Archetype::InvalidOffset ? nullptr : reinterpret_cast<T*>(mChunk->data + offset);
+        }
+
+    private:
+        const Archetype *mArchetype;
+        const EcsChunk *mChunk;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A cached query. The world appends new matching archetypes, so it never rescans.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT Query final {
+    public:
+        /// @brief A chunk matched by the query.
+        struct ChunkRef {
+            Archetype *archetype;
+            uint32_t chunk;
+        };
+
+        /// @brief The class constructor.
+        /// @param[ in ] include The required components.
+        /// @param[ in ] exclude The components an entity must not have.
+        Query(ComponentMask include, ComponentMask exclude) : mInclude(include), mExclude(exclude) {}
+
+        /// @brief Returns true if an archetype matches.
+        bool matches(ComponentMask mask) const { return (mask & mInclude) == mInclude && (mask & mExclude) == 0; }
+
+        /// @brief Returns the required components.
+        ComponentMask getInclude() const { return mInclude; }
+
+        /// @brief Returns the excluded components.
+        ComponentMask getExclude() const { return mExclude; }
+
+        /// @brief Returns the matching archetypes.
+        const std::vector<Archetype*> &getArchetypes() const { return mArchetypes; }
+
+        /// @brief Returns the number of matching entities.
+        size_t getNumEntities() const;
+
+        /// @brief Calls a function for every non-empty matching chunk.
+        template<class TFunc>
+        void forEachChunk(TFunc &&func) const {
+            for (const Archetype *archetype : mArchetypes) {
+                for (const EcsChunk &chunk : archetype->getChunks()) {
+                    func(ChunkView(*archetype, chunk));
+                }
+            }
+        }
+
+    private:
+        friend class World;
+
+        ComponentMask mInclude;
+        ComponentMask mExclude;
+        std::vector<Archetype*> mArchetypes;
+        std::vector<ChunkRef> mChunkRefs;
+        uint64_t mChunkVersion{ ~0ull };
+    };
+
+    /// @brief The id of a system.
+    using SystemId = uint32_t;
+
+    /// @brief A system body, processes one chunk.
+    using ChunkSystemFunc = std::function<void(const ChunkView &view, float dt)>;
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	An archetype based entity component system.
+    ///
+    /// Entities with the same set of components share an archetype. Its entities are packed into 
+    /// fixed size chunks where every component is a contiguous array, so systems stream through 
+    /// memory. Components must be trivially copyable, they are moved with memcpy when an entity 
+    /// changes its archetype.
+    ///
+    /// Systems declare which components they read and write. runSystems groups systems without 
+    /// conflicting writes into phases and processes all chunks of a phase in parallel on the 
+    /// thread pool. Structural changes (create, destroy, add, remove) are not allowed while the 
+    /// systems run.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT World final {
+    public:
+        /// @brief The class constructor.
+        World();
+
+        /// @brief The class destructor.
+        ~World();
+
+        /// @brief Creates an entity with the given components.
+        /// @param[ in ] values The initial component values.
+        /// @return The entity or InvalidEntity if the components do not fit into a chunk.
+        template<class... T>
+        Entity create(const T &...values) {
+            (registerComponent<T>(), ...);
+            Archetype *archetype = getArchetype(componentMask<T...>());
+            const Entity entity = allocateEntity(archetype);
+            if (entity == InvalidEntity) {
+                return InvalidEntity;
+            }
+            (writeComponent(entity, ComponentType<T>::id(), &values), ...);
+            return entity;
+        }
+
+        /// @brief Destroys an entity.
+        /// @param[ in ] entity The entity.
+        /// @return False if the entity was not alive.
+        bool destroy(Entity entity);
+
+        /// @brief Returns true if the entity is alive.
+        bool isAlive(Entity entity) const;
+
+        /// @brief Adds or overwrites a component.
+        /// @param[ in ] entity The entity.
+        /// @param[ in ] value The component value.
+        /// @return False if the entity was not alive or the components do not fit into a chunk.
+        template<class T>
+        bool add(Entity entity, const T &value) {
+            registerComponent<T>();
+            const ComponentId id = ComponentType<T>::id();
+            if (!addComponent(entity, id)) {
+                return false;
+            }
+            writeComponent(entity, id, &value);
+            return true;
+        }
+
+        /// @brief Removes a component.
+        /// @param[ in ] entity The entity.
+        /// @return False if the entity was not alive or did not have the component.
+        template<class T>
+        bool remove(Entity entity) {
+            return removeComponent(entity, ComponentType<T>::id());
+        }
+
+        /// @brief Returns true if the entity has a component.
+        template<class T>
+        bool has(Entity entity) const {
+            return getComponent(entity, ComponentType<T>::id()) != nullptr;
+        }
+
+        /// @brief Returns a component of an entity or nullptr.
+        template<class T>
+        T *get(Entity entity) const {
+            return static_cast<T*>(getComponent(entity, ComponentType<T>::id()));
+        }
+
+        /// @brief Returns the cached query for a set of components.
+        /// @param[ in ] include The required components.
+        /// @param[ in ] exclude The components an entity must not have.
+        /// @return The query.
+        Query &query(ComponentMask include, ComponentMask exclude = 0);
+
+        /// @brief Returns the cached query for a list of component types.
+        template<class... T>
+        Query &query() {
+            (registerComponent<std::remove_const_t<T>>(), ...);
+            return query(componentMask<T...>());
+        }
+
+        /// @brief Calls a function for every entity with the given components.
+        /// @param[ in ] func Called as func(T&...) per entity.
+        template<class... T, class TFunc>
+        void forEach(TFunc &&func) {
+            query<T...>().forEachChunk([&func](const ChunkView &view) {
+                runRows(func, view.size(), view.template get<T>()...);
+            });
+        }
+
+        /// @brief Registers a system working on chunks.
+        /// @param[ in ] name The system name.
+        /// @param[ in ] query The query selecting the chunks.
+        /// @param[ in ] reads All components the system accesses.
+        /// @param[ in ] writes The components the system modifies.
+        /// @param[ in ] func The system body.
+        /// @return The system id.
+        SystemId addChunkSystem(const std::string &name, Query &query, ComponentMask reads, ComponentMask writes, ChunkSystemFunc func);
+
+        /// @brief Registers a system running a function for every entity with the given components.
+        ///
+        /// Const components are read, all others written. The function is called as func(dt, T&...).
+        /// @param[ in ] name The system name.
+        /// @param[ in ] func The system body.
+        /// @return The system id.
+        template<class... T, class TFunc>
+        SystemId addSystem(const std::string &name, TFunc func) {
+            const ComponentMask writes = (ComponentMask(0) | ... | (std::is_const_v<T> ? 0 : componentMask<T>()));
+            return addChunkSystem(name, query<T...>(), componentMask<T...>(), writes,
+                    [func](const ChunkView &view, float dt) {
+                        auto body = [&func, dt](T &...components) { func(dt, components...); };
+                        runRows(body, view.size(), view.template get<T>()...);
+                    });
+        }
+
+        /// @brief Enables or disables a system.
+        void setSystemEnabled(SystemId id, bool enabled);
+
+        /// @brief Runs all enabled systems.
+        /// @param[ in ] dt The frame time in seconds.
+        /// @param[ in ] pool The worker threads or nullptr to run on the calling thread.
+        void runSystems(float dt, core::ThreadPool *pool);
+
+        /// @brief Returns the number of phases the systems are grouped into.
+        size_t getNumSystemPhases();
+
+        /// @brief Returns the number of living entities.
+        size_t getNumEntities() const { return mNumEntities; }
+
+        /// @brief Returns the number of archetypes.
+        size_t getNumArchetypes() const { return mArchetypes.size(); }
+
+        /// @brief Returns the number of allocated chunks.
+        size_t getNumChunks() const;
+
+        World(const World &) = delete;
+        World &operator = (const World &) = delete;
+
+    private:
+        struct EntityRecord {
+            Archetype *archetype{ nullptr };
+            uint32_t chunk{ 0 };
+            uint32_t row{ 0 };
+            uint32_t generation{ 1 };
+        };
+
+        struct System {
+            std::string name;
+            Query *query;
+            ComponentMask reads;
+            ComponentMask writes;
+            ChunkSystemFunc func;
+            uint32_t phase;
+            bool enabled;
+        };
+
+        template<class TFunc, class... P>
+        static void runRows(TFunc &func, uint32_t count, P *...columns) {
+            for (uint32_t i = 0; i < count; ++i) {
+                func(columns[i]...);
+            }
+        }
+
+        template<class T>
+        void registerComponent() {
+            static_assert(std::is_trivially_copyable_v<T>, "Components must be trivially copyable.");
+            const ComponentId id = ComponentType<T>::id();
+            if (id < MaxComponents && mComponentInfos[id].size == 0) {
+                mComponentInfos[id] = ComponentInfo{ sizeof(T), alignof(T) };
+            }
+        }
+
+        Archetype *getArchetype(ComponentMask mask);
+        Entity allocateEntity(Archetype *archetype);
+        const EntityRecord *getRecord(Entity entity) const;
+        void allocateRow(Archetype *archetype, uint32_t &chunk, uint32_t &row);
+        void removeRow(Archetype *archetype, uint32_t chunk, uint32_t row);
+        void moveEntity(Entity entity, Archetype *target);
+        bool addComponent(Entity entity, ComponentId id);
+        bool removeComponent(Entity entity, ComponentId id);
+        void *getComponent(Entity entity, ComponentId id) const;
+        void writeComponent(Entity entity, ComponentId id, const void *value);
+        void refreshChunkRefs(Query &query);
+        void buildPhases();
+
+    private:
+        std::array<ComponentInfo, MaxComponents> mComponentInfos;
+        std::vector<std::unique_ptr<Archetype>> mArchetypes;
+        std::vector<std::unique_ptr<Query>> mQueries;
+        std::vector<EntityRecord> mRecords;
+        std::vector<uint32_t> mFreeRecords;
+        std::vector<System> mSystems;
+        std::vector<std::pair<const System*, Query::ChunkRef>> mWorkItems;
+        size_t mNumEntities;
+        size_t mNumPhases;
+        uint64_t mChunkVersion;
+        bool mPhasesDirty;
+    };
+
+} // namespace segfault::scene
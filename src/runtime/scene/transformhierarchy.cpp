@@ -0,0 +1,361 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "scene/transformhierarchy.h"
+#include "core/simd.h"
+
+#include <algorithm>
+
+namespace segfault::scene {
+
+    using namespace ::segfault::core;
+
+    namespace {
+        const glm::mat4 Identity(1.0f);
+        const glm::vec3 ZeroVector(0.0f);
+        const glm::quat IdentityRotation(1.0f, 0.0f, 0.0f, 0.0f);
+
+        void composeMatrix(const glm::vec3 &t, const glm::quat &q, const glm::vec3 &s, glm::mat4 &m) {
+            const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+            m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f);
+            m[1] = glm::vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f);
+            m[2] = glm::vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+            m[3] = glm::vec4(t, 1.0f);
+        }
+    } // Anonymous namespace
+
+    TransformHierarchy::TransformHierarchy() :
+            mNodes(),
+            mFreeNodes(),
+            mNumAlive(0),
+            mOrderDirty(false) {
+        // empty
+    }
+
+    TransformHandle TransformHierarchy::create(TransformHandle parent) {
+        if (parent != InvalidTransform && !isValid(parent)) {
+            logMessage(LogType::Error, "Invalid parent transform.");
+            return InvalidTransform;
+        }
+
+        TransformHandle handle = InvalidTransform;
+        if (!mFreeNodes.empty()) {
+            handle = mFreeNodes.back();
+            mFreeNodes.pop_back();
+            mNodes[handle] = Node();
+        } else {
+            handle = static_cast<TransformHandle>(mNodes.size());
+            mNodes.emplace_back();
+        }
+
+        // Append to the arrays, the next update moves it to its breadth-first position
+        Node &node = mNodes[handle];
+        node.alive = true;
+        node.dense = static_cast<uint32_t>(mHandles.size());
+        link(handle, parent);
+        mHandles.push_back(handle);
+        mParents.push_back(InvalidIndex);
+        mFirstChild.push_back(0);
+        mNumChildren.push_back(0);
+        mDepth.push_back(0);
+        mPositions.push_back(ZeroVector);
+        mRotations.push_back(IdentityRotation);
+        mScales.push_back(glm::vec3(1.0f));
+        mWorld.push_back(Identity);
+        mDirty.push_back(1);
+        ++mNumAlive;
+        mOrderDirty = true;
+
+        return handle;
+    }
+
+    void TransformHierarchy::destroy(TransformHandle handle) {
+        if (!isValid(handle)) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return;
+        }
+
+        unlink(handle);
+        std::vector<TransformHandle> stack{ handle };
+        while (!stack.empty()) {
+            const TransformHandle current = stack.back();
+            stack.pop_back();
+            for (TransformHandle child = mNodes[current].firstChild; child != InvalidTransform; child = mNodes[child].nextSibling) {
+                stack.push_back(child);
+            }
+            mNodes[current].alive = false;
+            mFreeNodes.push_back(current);
+            --mNumAlive;
+        }
+        mOrderDirty = true;
+    }
+
+    bool TransformHierarchy::setParent(TransformHandle handle, TransformHandle parent) {
+        if (!isValid(handle) || (parent != InvalidTransform && !isValid(parent))) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return false;
+        }
+
+        for (TransformHandle ancestor = parent; ancestor != InvalidTransform; ancestor = mNodes[ancestor].parent) {
+            if (ancestor == handle) {
+                logMessage(LogType::Error, "A transform cannot become a child of its own subtree.");
+                return false;
+            }
+        }
+
+        unlink(handle);
+        link(handle, parent);
+        markDirty(mNodes[handle].dense);
+        mOrderDirty = true;
+
+        return true;
+    }
+
+    TransformHandle TransformHierarchy::getParent(TransformHandle handle) const {
+        return isValid(handle) ? mNodes[handle].parent : InvalidTransform;
+    }
+
+    bool TransformHierarchy::isValid(TransformHandle handle) const {
+        return handle < mNodes.size() && mNodes[handle].alive;
+    }
+
+    void TransformHierarchy::link(TransformHandle handle, TransformHandle parent) {
+        Node &node = mNodes[handle];
+        node.parent = parent;
+        if (parent != InvalidTransform) {
+            node.nextSibling = mNodes[parent].firstChild;
+            mNodes[parent].firstChild = handle;
+        }
+    }
+
+    void TransformHierarchy::unlink(TransformHandle handle) {
+        Node &node = mNodes[handle];
+        if (node.parent != InvalidTransform) {
+            TransformHandle *link = &mNodes[node.parent].firstChild;
+            while (*link != handle) {
+                link = &mNodes[*link].nextSibling;
+            }
+            *link = node.nextSibling;
+        }
+        node.parent = InvalidTransform;
+        node.nextSibling = InvalidTransform;
+    }
+
+    void TransformHierarchy::markDirty(uint32_t dense) {
+        if (mDirty[dense] != 0) {
+            return;
+        }
+
+        mDirty[dense] = 1;
+        if (!mOrderDirty) {
+            mDirtyLevels[mDepth[dense]].push_back(dense);
+        }
+    }
+
+    void TransformHierarchy::setLocal(TransformHandle handle, const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale) {
+        if (!isValid(handle)) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return;
+        }
+
+        const uint32_t dense = mNodes[handle].dense;
+        mPositions[dense] = position;
+        mRotations[dense] = rotation;
+        mScales[dense] = scale;
+        markDirty(dense);
+    }
+
+    void TransformHierarchy::setLocalPosition(TransformHandle handle, const glm::vec3 &position) {
+        if (!isValid(handle)) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return;
+        }
+
+        const uint32_t dense = mNodes[handle].dense;
+        mPositions[dense] = position;
+        markDirty(dense);
+    }
+
+    void TransformHierarchy::setLocalRotation(TransformHandle handle, const glm::quat &rotation) {
+        if (!isValid(handle)) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return;
+        }
+
+        const uint32_t dense = mNodes[handle].dense;
+        mRotations[dense] = rotation;
+        markDirty(dense);
+    }
+
+    void TransformHierarchy::setLocalScale(TransformHandle handle, const glm::vec3 &scale) {
+        if (!isValid(handle)) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return;
+        }
+
+        const uint32_t dense = mNodes[handle].dense;
+        mScales[dense] = scale;
+        markDirty(dense);
+    }
+
+    const glm::vec3 &TransformHierarchy::getLocalPosition(TransformHandle handle) const {
+        return isValid(handle) ? mPositions[mNodes[handle].dense] : ZeroVector;
+    }
+
+    const glm::quat &TransformHierarchy::getLocalRotation(TransformHandle handle) const {
+        return isValid(handle) ? mRotations[mNodes[handle].dense] : IdentityRotation;
+    }
+
+    const glm::vec3 &TransformHierarchy::getLocalScale(TransformHandle handle) const {
+        return isValid(handle) ? mScales[mNodes[handle].dense] : ZeroVector;
+    }
+
+    const glm::mat4 &TransformHierarchy::getWorldMatrix(TransformHandle handle) const {
+        if (!isValid(handle)) {
+            logMessage(LogType::Error, "Invalid transform.");
+            return Identity;
+        }
+
+        return mWorld[mNodes[handle].dense];
+    }
+
+    uint32_t TransformHierarchy::getDenseIndex(TransformHandle handle) const {
+        return isValid(handle) ? mNodes[handle].dense : InvalidIndex;
+    }
+
+    void TransformHierarchy::rebuildOrder() {
+        std::vector<TransformHandle> order;
+        order.reserve(mNumAlive);
+        for (TransformHandle handle = 0; handle < mNodes.size(); ++handle) {
+            if (mNodes[handle].alive && mNodes[handle].parent == InvalidTransform) {
+                order.push_back(handle);
+            }
+        }
+
+        // Breadth-first walk, appending the children of a node keeps them contiguous
+        std::vector<uint32_t> firstChild, numChildren;
+        firstChild.reserve(mNumAlive);
+        numChildren.reserve(mNumAlive);
+        for (size_t i = 0; i < order.size(); ++i) {
+            firstChild.push_back(static_cast<uint32_t>(order.size()));
+            uint32_t count = 0;
+            for (TransformHandle child = mNodes[order[i]].firstChild; child != InvalidTransform; child = mNodes[child].nextSibling) {
+                order.push_back(child);
+                ++count;
+            }
+            numChildren.push_back(count);
+        }
+
+        const size_t count = order.size();
+        std::vector<uint32_t> parents(count), depth(count);
+        std::vector<glm::vec3> positions(count), scales(count);
+        std::vector<glm::quat> rotations(count);
+        std::vector<glm::mat4> world(count);
+        std::vector<uint8_t> dirty(count);
+        for (size_t i = 0; i < count; ++i) {
+            Node &node = mNodes[order[i]];
+            const uint32_t old = node.dense;
+            positions[i] = mPositions[old];
+            rotations[i] = mRotations[old];
+            scales[i] = mScales[old];
+            world[i] = mWorld[old];
+            dirty[i] = mDirty[old];
+
+            // Parents come first, so their index is already the new one
+            parents[i] = node.parent == InvalidTransform ? InvalidIndex : mNodes[node.parent].dense;
+            depth[i] = parents[i] == InvalidIndex ? 0 : depth[parents[i]] + 1;
+            node.dense = static_cast<uint32_t>(i);
+        }
+
+        mHandles.swap(order);
+        mParents.swap(parents);
+        mFirstChild.swap(firstChild);
+        mNumChildren.swap(numChildren);
+        mDepth.swap(depth);
+        mPositions.swap(positions);
+        mRotations.swap(rotations);
+        mScales.swap(scales);
+        mWorld.swap(world);
+        mDirty.swap(dirty);
+
+        const uint32_t numLevels = count == 0 ? 0 : mDepth.back() + 1;
+        mLevelStart.assign(numLevels + 1, static_cast<uint32_t>(count));
+        for (size_t i = count; i-- > 0;) {
+            mLevelStart[mDepth[i]] = static_cast<uint32_t>(i);
+        }
+
+        mDirtyLevels.resize(numLevels + 1);
+        for (auto &level : mDirtyLevels) {
+            level.clear();
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            if (mDirty[i] != 0) {
+                mDirtyLevels[mDepth[i]].push_back(i);
+            }
+        }
+        mOrderDirty = false;
+    }
+
+    size_t TransformHierarchy::update() {
+        if (mOrderDirty) {
+            rebuildOrder();
+        }
+
+        size_t numUpdated = 0;
+        glm::mat4 local;
+        for (size_t level = 0; level + 1 < mDirtyLevels.size(); ++level) {
+            std::vector<uint32_t> &dirty = mDirtyLevels[level];
+            if (dirty.empty()) {
+                continue;
+            }
+
+            // Walk the level in memory order, the children of a level are queued sorted already
+            std::sort(dirty.begin(), dirty.end());
+            std::vector<uint32_t> &next = mDirtyLevels[level + 1];
+            for (uint32_t index : dirty) {
+                const uint32_t parent = mParents[index];
+                if (parent == InvalidIndex) {
+                    composeMatrix(mPositions[index], mRotations[index], mScales[index], mWorld[index]);
+                } else {
+                    composeMatrix(mPositions[index], mRotations[index], mScales[index], local);
+                    multiplyMatrix4(&mWorld[parent][0][0], &local[0][0], &mWorld[index][0][0]);
+                }
+                mDirty[index] = 0;
+                ++numUpdated;
+
+                const uint32_t end = mFirstChild[index] + mNumChildren[index];
+                for (uint32_t child = mFirstChild[index]; child < end; ++child) {
+                    if (mDirty[child] == 0) {
+                        mDirty[child] = 1;
+                        next.push_back(child);
+                    }
+                }
+            }
+            dirty.clear();
+        }
+
+        return numUpdated;
+    }
+
+} // namespace segfault::scene
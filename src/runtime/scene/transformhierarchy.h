@@ -0,0 +1,169 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "core/segfault.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+namespace segfault::scene {
+
+    /// @brief A stable handle to a transform.
+    using TransformHandle = uint32_t;
+
+    /// @brief The invalid transform handle.
+    constexpr TransformHandle InvalidTransform = ~0u;
+
+    //-------------------------------------------------------------------------------------------------
+    ///	@ingroup    Runtime
+    ///
+    ///	@brief	A parent / child hierarchy of transforms.
+    ///
+    /// Local and world transforms are stored as structure of arrays in breadth-first order, so 
+    /// every parent precedes its children and the children of a node are contiguous. Changing a 
+    /// local transform puts the node into the dirty list of its depth, update walks the depths 
+    /// from the root down and recomputes only the dirty nodes and their subtrees. The cost of a 
+    /// frame is proportional to what moved, not to the size of the hierarchy.
+    ///
+    /// Structural changes (create, destroy, setParent) are applied lazily by reordering the 
+    /// arrays on the next update.
+    //-------------------------------------------------------------------------------------------------
+    class SEGFAULT_EXPORT TransformHierarchy final {
+    public:
+        /// @brief The class constructor.
+        TransformHierarchy();
+
+        /// @brief The class destructor.
+        ~TransformHierarchy() = default;
+
+        /// @brief Creates a transform with an identity local transform.
+        /// @param[ in ] parent The parent or InvalidTransform for a root.
+        /// @return The handle or InvalidTransform if the parent is not valid.
+        TransformHandle create(TransformHandle parent = InvalidTransform);
+
+        /// @brief Destroys a transform and all of its descendants.
+        /// @param[ in ] handle The transform.
+        void destroy(TransformHandle handle);
+
+        /// @brief Moves a transform and its subtree to another parent, the local transform is kept.
+        /// @param[ in ] handle The transform.
+        /// @param[ in ] parent The new parent or InvalidTransform to make it a root.
+        /// @return False if the handles are invalid or the parent is part of the subtree.
+        bool setParent(TransformHandle handle, TransformHandle parent);
+
+        /// @brief Returns the parent or InvalidTransform for a root.
+        TransformHandle getParent(TransformHandle handle) const;
+
+        /// @brief Returns true if the handle refers to a living transform.
+        bool isValid(TransformHandle handle) const;
+
+        /// @brief Sets the local translation, rotation and scale.
+        /// @param[ in ] handle The transform.
+        /// @param[ in ] position The translation relative to the parent.
+        /// @param[ in ] rotation The rotation relative to the parent.
+        /// @param[ in ] scale The scale relative to the parent.
+        void setLocal(TransformHandle handle, const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale);
+
+        /// @brief Sets the local translation.
+        void setLocalPosition(TransformHandle handle, const glm::vec3 &position);
+
+        /// @brief Sets the local rotation.
+        void setLocalRotation(TransformHandle handle, const glm::quat &rotation);
+
+        /// @brief Sets the local scale.
+        void setLocalScale(TransformHandle handle, const glm::vec3 &scale);
+
+        /// @brief Returns the local translation.
+        const glm::vec3 &getLocalPosition(TransformHandle handle) const;
+
+        /// @brief Returns the local rotation.
+        const glm::quat &getLocalRotation(TransformHandle handle) const;
+
+        /// @brief Returns the local scale.
+        const glm::vec3 &getLocalScale(TransformHandle handle) const;
+
+        /// @brief Returns the world matrix as of the last update.
+        const glm::mat4 &getWorldMatrix(TransformHandle handle) const;
+
+        /// @brief Recomputes the world matrices of all dirty subtrees.
+        /// @return The number of recomputed world matrices.
+        size_t update();
+
+        /// @brief Returns the number of transforms.
+        size_t getNumTransforms() const { return mNumAlive; }
+
+        /// @brief Returns the depth of the deepest transform plus one.
+        size_t getNumLevels() const { return mLevelStart.empty() ? 0 : mLevelStart.size() - 1; }
+
+        /// @brief Returns the world matrices in breadth-first order, valid after update.
+        const glm::mat4 *getWorldMatrices() const { return mWorld.data(); }
+
+        /// @brief Returns the index of a transform in the breadth-first arrays, valid after update.
+        uint32_t getDenseIndex(TransformHandle handle) const;
+
+        /// @brief Returns the transform at an index of the breadth-first arrays, valid after update.
+        TransformHandle getHandle(uint32_t denseIndex) const {
+            return denseIndex < mHandles.size() ? mHandles[denseIndex] : InvalidTransform;
+        }
+
+    private:
+        static constexpr uint32_t InvalidIndex = ~0u;
+
+        struct Node {
+            TransformHandle parent{ InvalidTransform };
+            TransformHandle firstChild{ InvalidTransform };
+            TransformHandle nextSibling{ InvalidTransform };
+            uint32_t dense{ InvalidIndex };
+            bool alive{ false };
+        };
+
+        void link(TransformHandle handle, TransformHandle parent);
+        void unlink(TransformHandle handle);
+        void markDirty(uint32_t dense);
+        void rebuildOrder();
+
+    private:
+        std::vector<Node> mNodes;
+        std::vector<TransformHandle> mFreeNodes;
+        size_t mNumAlive;
+        bool mOrderDirty;
+
+        // Breadth-first structure of arrays
+        std::vector<TransformHandle> mHandles;
+        std::vector<uint32_t> mParents;
+        std::vector<uint32_t> mFirstChild;
+        std::vector<uint32_t> mNumChildren;
+        std::vector<uint32_t> mDepth;
+        std::vector<glm::vec3> mPositions;
+        std::vector<glm::quat> mRotations;
+        std::vector<glm::vec3> mScales;
+        std::vector<glm::mat4> mWorld;
+        std::vector<uint8_t> mDirty;
+        std::vector<uint32_t> mLevelStart;
+        std::vector<std::vector<uint32_t>> mDirtyLevels;
+    };
+
+} // namespace segfault::scene
@@ -23,11 +23,25 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "core/segfault.h"
 #include "core/filearchive.h"
 #include "core/genericfilemanager.h"
+#include "core/threadpool.h"
+#include "ai/behavior_tree_format.h"
+#include "ai/utility_ai_format.h"
+#include "renderer/meshformat.h"
+#include "renderer/textureformat.h"
+#include "meshimporter.h"
+#include "meshletbuilder.h"
+#include "meshoptimizer.h"
+#include "meshpacker.h"
+#include "meshsimplifier.h"
+#include "textureencoder.h"
+#include "textureimporter.h"
 #include <cppcore/Common/TStringBase.h>
 
 #include <nlohmann/json.hpp>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <vector>
 
 static const cppcore::TStringBase<char> ManifestName("Manifest", 8);
 
@@ -49,6 +63,188 @@ static void showHelp() {
     std::cout << "SegFault AssetBacker "<< v << std::endl << std::endl;
     std::cout << "Usage:" << std::endl;
     std::cout << "assetbaker -i <manifest_file> -o <output_file" << std::endl;
+    std::cout << "assetbaker -i <behavior_tree.json> -o <behavior_tree.sbt>" << std::endl;
+    std::cout << "assetbaker -i <utility_model.json> -o <utility_model.sua>" << std::endl;
+    std::cout << "assetbaker -i <mesh.obj> -o <mesh.smesh> [-f float|half|snorm16]" << std::endl;
+    std::cout << "assetbaker -i <image> -o <texture.stex> [-f rgba8|bc1|bc3|bc5|bc7] [-c srgb|linear|normal]" << std::endl;
+}
+
+static bool hasExtension(const std::string &name, const char *ext) {
+    const size_t extLen = strlen(ext);
+    return name.size() >= extLen && name.compare(name.size() - extLen, extLen, ext) == 0;
+}
+
+static bool readFileContent(const std::string &name, std::vector<uint8_t> &content) {
+    FileArchive archive(name.c_str(), "rb", true, false);
+    if (!archive.isValid()) {
+        std::cout << "Cannot open " << name << std::endl;
+        return false;
+    }
+
+    content.resize(archive.getSize());
+    return archive.read(content.data(), content.size()) == content.size();
+}
+
+static bool writeFileContent(const std::string &name, const std::vector<uint8_t> &content) {
+    FileArchive archive(name.c_str(), "wb", false, true);
+    if (!archive.isValid()) {
+        std::cout << "Cannot create " << name << std::endl;
+        return false;
+    }
+
+    return archive.write(content.data(), content.size()) == content.size();
+}
+
+template<class TCompiled>
+bool bakeCompiledAsset(const std::string &input, const std::string &output, const char *kind, MemoryStatistics &stats) {
+    std::cout << "Try to bake " << kind << " " << input << std::endl;
+    std::vector<uint8_t> content;
+    if (!readFileContent(input, content)) {
+        return false;
+    }
+    stats.inputSize = content.size();
+
+    json doc = json::parse(content.begin(), content.end(), nullptr, false);
+    if (doc.is_discarded()) {
+        std::cout << "Invalid json in " << input << std::endl;
+        return false;
+    }
+
+    TCompiled compiled;
+    std::vector<uint8_t> blob;
+    if (!compiled.compile(doc) || !compiled.save(blob)) {
+        return false;
+    }
+    stats.outputSize = blob.size();
+
+    return writeFileContent(output, blob);
+}
+
+bool bakeMesh(const std::string &input, const std::string &output, const std::string &vertexFormat, MemoryStatistics &stats) {
+    using namespace segfault::tools;
+
+    const segfault::renderer::MeshVertexFormat format = getVertexFormatByName(vertexFormat);
+    if (format == segfault::renderer::MeshVertexFormat::Invalid) {
+        std::cout << "Unknown vertex format " << vertexFormat << std::endl;
+        return false;
+    }
+
+    std::cout << "Try to bake mesh " << input << std::endl;
+    std::vector<uint8_t> content;
+    if (!readFileContent(input, content)) {
+        return false;
+    }
+    stats.inputSize = content.size();
+
+    BakeMesh mesh;
+    if (!importObj(content.data(), content.size(), mesh)) {
+        std::cout << "No triangles in " << input << std::endl;
+        return false;
+    }
+
+    MeshOptimizationStats meshStats;
+    optimizeMesh(mesh, meshStats);
+    std::cout << "Vertices: " << meshStats.numInputVertices << " -> " << meshStats.numVertices << std::endl;
+    std::cout << "Triangles: " << meshStats.numTriangles << ", overdraw clusters: " << meshStats.numClusters << std::endl;
+    std::cout << "ACMR: " << meshStats.acmrBefore << " -> " << meshStats.acmrAfter << std::endl;
+
+    std::vector<segfault::renderer::MeshLodRecord> lods = generateLods(mesh, LodChainSettings());
+    std::vector<segfault::renderer::MeshletRecord> meshlets;
+    for (size_t i = 0; i < lods.size(); ++i) {
+        segfault::renderer::MeshLodRecord &lod = lods[i];
+        const std::vector<segfault::renderer::MeshletRecord> lodMeshlets = buildMeshlets(mesh, lod.firstIndex, lod.numIndices);
+        lod.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+        lod.numMeshlets = static_cast<uint32_t>(lodMeshlets.size());
+        meshlets.insert(meshlets.end(), lodMeshlets.begin(), lodMeshlets.end());
+        std::cout << "Lod " << i << ": " << lod.numIndices / 3 << " triangles, " << lod.numMeshlets << " meshlets, error " << lod.error << std::endl;
+    }
+
+    std::vector<uint8_t> vertices;
+    glm::vec3 positionScale, positionOffset;
+    if (!packVertices(mesh.vertices, format, vertices, positionScale, positionOffset)) {
+        return false;
+    }
+    std::cout << "Vertex format: " << vertexFormat << ", " << segfault::renderer::getMeshVertexStride(format) << " bytes per vertex, max position error " << 
+        computePositionError(mesh.vertices, format, vertices, positionScale, positionOffset) << std::endl;
+
+    segfault::scene::Aabb bounds;
+    for (const BakeVertex &vertex : mesh.vertices) {
+        bounds.merge(vertex.position);
+    }
+
+    segfault::renderer::MeshData meshData;
+    std::vector<uint8_t> blob;
+    if (!meshData.create(format, vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size(), 
+            bounds, positionScale, positionOffset, meshlets.data(), meshlets.size(), lods.data(), lods.size()) || !meshData.save(blob)) {
+        return false;
+    }
+    stats.outputSize = blob.size();
+
+    return writeFileContent(output, blob);
+}
+
+bool bakeTexture(const std::string &input, const std::string &output, const std::string &textureFormat, 
+        const std::string &colorSpace, MemoryStatistics &stats) {
+    using namespace segfault::tools;
+    using segfault::renderer::TextureFormat;
+
+    const TextureFormat format = getTextureFormatByName(textureFormat);
+    if (format == TextureFormat::Invalid) {
+        std::cout << "Unknown texture format " << textureFormat << std::endl;
+        return false;
+    }
+
+    // Two channel normal maps have no sRGB variant, so they default to normal filtering
+    const MipFilterMode mode = colorSpace.empty() ? (format == TextureFormat::BC5 ? MipFilterMode::NormalMap : MipFilterMode::Srgb) :
+        getMipFilterModeByName(colorSpace);
+    if (mode == MipFilterMode::Invalid || (format == TextureFormat::BC5 && mode == MipFilterMode::Srgb)) {
+        std::cout << "Invalid color space " << colorSpace << " for " << textureFormat << std::endl;
+        return false;
+    }
+
+    std::cout << "Try to bake texture " << input << std::endl;
+    std::vector<uint8_t> content;
+    if (!readFileContent(input, content)) {
+        return false;
+    }
+    stats.inputSize = content.size();
+
+    BakeImage image;
+    if (!importImage(content.data(), content.size(), image)) {
+        std::cout << "Cannot decode " << input << std::endl;
+        return false;
+    }
+
+    std::vector<BakeImage> mips;
+    generateMips(image, mode, mips);
+    if (mips.size() > segfault::renderer::MaxTextureMips) {
+        std::cout << "Image is too large: " << image.width << " x " << image.height << std::endl;
+        return false;
+    }
+
+    ThreadPool threadPool;
+    std::vector<std::vector<uint8_t>> encoded(mips.size());
+    std::vector<const uint8_t*> levels;
+    for (size_t i = 0; i < mips.size(); ++i) {
+        if (!encodeImage(mips[i], format, encoded[i], &threadPool)) {
+            return false;
+        }
+        levels.push_back(encoded[i].data());
+    }
+    std::cout << "Texture format: " << textureFormat << ", " << image.width << " x " << image.height << ", " << mips.size() << " mips, PSNR " <<
+        computeEncodingPsnr(mips[0], format, encoded[0]) << " dB" << std::endl;
+
+    const uint8_t flags = (mode == MipFilterMode::Srgb ? segfault::renderer::TextureFlagSrgb : 0) | 
+        (mode == MipFilterMode::NormalMap ? segfault::renderer::TextureFlagNormalMap : 0);
+    segfault::renderer::TextureData textureData;
+    std::vector<uint8_t> blob;
+    if (!textureData.create(format, flags, image.width, image.height, static_cast<uint32_t>(levels.size()), levels.data()) || 
+            !textureData.save(blob)) {
+        return false;
+    }
+    stats.outputSize = blob.size();
+
+    return writeFileContent(output, blob);
 }
 
 bool readManifest(const std::string& input, MemoryStatistics& stats) {
@@ -67,28 +263,59 @@ void showStatistics(const MemoryStatistics& stats) {
     std::cout << "Memory statistics:" << std::endl;
     std::cout << "==================" << std::endl;
     std::cout << "Input filesize: " << stats.inputSize << std::endl;
-    std::cout << "Output filesize: " << stats.inputSize << std::endl;
+    std::cout << "Output filesize: " << stats.outputSize << std::endl;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 5) {
+    if (argc < 5 || argc > 9 || argc % 2 == 0) {
         showHelp();
         return 0;
     }
 
-    std::string input, output;
-    if (strncmp(argv[1], "-i", 2) == 0) {
-        input = std::string(argv[2]);
-    }
-
-    if (strncmp(argv[3], "-o", 2) == 0) {
-        output = std::string(argv[4]);
+    std::string input, output, format, colorSpace;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strncmp(argv[i], "-i", 2) == 0) {
+            input = std::string(argv[i + 1]);
+        } else if (strncmp(argv[i], "-o", 2) == 0) {
+            output = std::string(argv[i + 1]);
+        } else if (strncmp(argv[i], "-f", 2) == 0) {
+            format = std::string(argv[i + 1]);
+        } else if (strncmp(argv[i], "-c", 2) == 0) {
+            colorSpace = std::string(argv[i + 1]);
+        }
     }
     std::string v;
     getVersion(v);
     std::cout << std::endl << "AssetBaker " << v << std::endl;
     std::cout << std::endl << "Start asset baking process ... " << std::endl;
     MemoryStatistics stats;
+    if (hasExtension(output, ".sbt") || hasExtension(output, ".sua")) {
+        const bool baked = hasExtension(output, ".sbt") ? 
+            bakeCompiledAsset<segfault::ai::CompiledBehaviorTree>(input, output, "behavior tree", stats) :
+            bakeCompiledAsset<segfault::ai::CompiledUtilityModel>(input, output, "utility model", stats);
+        if (!baked) {
+            return -1;
+        }
+        showStatistics(stats);
+        return 0;
+    }
+
+    if (hasExtension(output, ".smesh")) {
+        if (!bakeMesh(input, output, format.empty() ? "snorm16" : format, stats)) {
+            return -1;
+        }
+        showStatistics(stats);
+        return 0;
+    }
+
+    if (hasExtension(output, ".stex")) {
+        if (!bakeTexture(input, output, format.empty() ? "bc7" : format, colorSpace, stats)) {
+            return -1;
+        }
+        showStatistics(stats);
+        return 0;
+    }
+
     if (!readManifest(input, stats)) {
         return -1;
     }
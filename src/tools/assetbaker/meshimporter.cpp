@@ -0,0 +1,231 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "meshimporter.h"
+#include "core/hash.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace segfault::tools {
+
+    namespace {
+
+        struct ObjCorner {
+            int32_t position{ 0 };
+            int32_t texCoord{ 0 };
+            int32_t normal{ 0 };
+        };
+
+        // OBJ indices are 1 based, negative ones count from the end of the current list
+        bool resolveIndex(int32_t index, size_t count, size_t &result) {
+            if (index > 0 && static_cast<size_t>(index) <= count) {
+                result = static_cast<size_t>(index) - 1;
+                return true;
+            }
+            if (index < 0 && static_cast<size_t>(-index) <= count) {
+                result = count - static_cast<size_t>(-index);
+                return true;
+            }
+            return false;
+        }
+
+        const char *skipSpaces(const char *cur, const char *end) {
+            while (cur != end && (*cur == ' ' || *cur == '\t')) {
+                ++cur;
+            }
+            return cur;
+        }
+
+        // The line is copied into a terminated buffer before, so strtof and strtol stop at its end
+        int parseFloats(const char *cur, float *values, int maxValues) {
+            int count = 0;
+            while (count < maxValues) {
+                char *next = nullptr;
+                const float value = strtof(cur, &next);
+                if (next == cur) {
+                    break;
+                }
+                values[count++] = value;
+                cur = next;
+            }
+            return count;
+        }
+
+        const char *parseCorner(const char *cur, ObjCorner &corner) {
+            char *next = nullptr;
+            corner = ObjCorner{};
+            corner.position = static_cast<int32_t>(strtol(cur, &next, 10));
+            if (next == cur) {
+                return nullptr;
+            }
+            cur = next;
+            if (*cur == '/') {
+                ++cur;
+                if (*cur != '/') {
+                    corner.texCoord = static_cast<int32_t>(strtol(cur, &next, 10));
+                    cur = next;
+                }
+                if (*cur == '/') {
+                    ++cur;
+                    corner.normal = static_cast<int32_t>(strtol(cur, &next, 10));
+                    cur = next;
+                }
+            }
+            return cur;
+        }
+
+    } // namespace
+
+    bool importObj(const uint8_t *data, size_t size, BakeMesh &mesh) {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        if (data == nullptr || size == 0) {
+            return false;
+        }
+
+        std::vector<glm::vec3> positions, colors, normals;
+        std::vector<glm::vec2> texCoords;
+        std::vector<ObjCorner> face;
+        std::vector<char> line;
+        size_t lineNumber = 0, numSkipped = 0;
+        const char *cur = reinterpret_cast<const char*>(data);
+        const char *end = cur + size;
+        while (cur != end) {
+            const char *lineEnd = static_cast<const char*>(memchr(cur, '\n', end - cur));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            // Drop the carriage return of files with Windows line endings
+            const char *textEnd = lineEnd != cur && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+            line.assign(skipSpaces(cur, textEnd), textEnd);
+            line.push_back('\0');
+            cur = lineEnd == end ? end : lineEnd + 1;
+            ++lineNumber;
+
+            const char *text = line.data();
+            if (text[0] == 'v' && (text[1] == ' ' || text[1] == '\t')) {
+                float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+                const int count = parseFloats(text + 2, values, 6);
+                if (count < 3) {
+                    std::cout << "Invalid position in line " << lineNumber << std::endl;
+                    return false;
+                }
+                positions.emplace_back(values[0], values[1], values[2]);
+                colors.emplace_back(count >= 6 ? glm::vec3(values[3], values[4], values[5]) : glm::vec3(1.0f));
+            } else if (text[0] == 'v' && text[1] == 't') {
+                float values[2] = { 0.0f, 0.0f };
+                parseFloats(text + 2, values, 2);
+                // OBJ puts the origin of the texture space bottom left, Vulkan top left
+                texCoords.emplace_back(values[0], 1.0f - values[1]);
+            } else if (text[0] == 'v' && text[1] == 'n') {
+                float values[3] = { 0.0f, 0.0f, 0.0f };
+                parseFloats(text + 2, values, 3);
+                normals.emplace_back(values[0], values[1], values[2]);
+            } else if (text[0] == 'f' && (text[1] == ' ' || text[1] == '\t')) {
+                face.clear();
+                const char *faceCur = skipSpaces(text + 2, text + line.size() - 1);
+                while (*faceCur != '\0' && *faceCur != '#') {
+                    ObjCorner corner;
+                    faceCur = parseCorner(faceCur, corner);
+                    if (faceCur == nullptr) {
+                        std::cout << "Invalid face in line " << lineNumber << std::endl;
+                        return false;
+                    }
+                    face.push_back(corner);
+                    faceCur = skipSpaces(faceCur, text + line.size() - 1);
+                }
+                if (face.size() < 3) {
+                    ++numSkipped;
+                    continue;
+                }
+
+                const uint32_t first = static_cast<uint32_t>(mesh.vertices.size());
+                for (const ObjCorner &corner : face) {
+                    BakeVertex vertex;
+                    size_t index = 0;
+                    if (!resolveIndex(corner.position, positions.size(), index)) {
+                        std::cout << "Invalid position index in line " << lineNumber << std::endl;
+                        return false;
+                    }
+                    vertex.position = positions[index];
+                    vertex.color = colors[index];
+                    if (corner.texCoord != 0 && resolveIndex(corner.texCoord, texCoords.size(), index)) {
+                        vertex.texCoord = texCoords[index];
+                    }
+                    if (corner.normal != 0 && resolveIndex(corner.normal, normals.size(), index)) {
+                        vertex.normal = normals[index];
+                    }
+                    mesh.vertices.push_back(vertex);
+                }
+                for (uint32_t i = 2; i < face.size(); ++i) {
+                    mesh.indices.push_back(first);
+                    mesh.indices.push_back(first + i - 1);
+                    mesh.indices.push_back(first + i);
+                }
+            }
+        }
+
+        if (numSkipped != 0) {
+            std::cout << "Skipped " << numSkipped << " degenerated faces" << std::endl;
+        }
+
+        return !mesh.indices.empty();
+    }
+
+    size_t deduplicateVertices(BakeMesh &mesh) {
+        const size_t numVertices = mesh.vertices.size();
+        size_t tableSize = 16;
+        while (tableSize < numVertices * 2) {
+            tableSize *= 2;
+        }
+
+        // Open addressing over the indices of the unique vertices
+        constexpr uint32_t Empty = 0xffffffffu;
+        std::vector<uint32_t> table(tableSize, Empty);
+        std::vector<uint32_t> remap(numVertices);
+        std::vector<BakeVertex> unique;
+        unique.reserve(numVertices);
+        for (size_t i = 0; i < numVertices; ++i) {
+            const BakeVertex &vertex = mesh.vertices[i];
+            size_t slot = core::hashBytes(&vertex, sizeof(BakeVertex)) & (tableSize - 1);
+            while (table[slot] != Empty && memcmp(&unique[table[slot]], &vertex, sizeof(BakeVertex)) != 0) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (table[slot] == Empty) {
+                table[slot] = static_cast<uint32_t>(unique.size());
+                unique.push_back(vertex);
+            }
+            remap[i] = table[slot];
+        }
+
+        for (uint32_t &index : mesh.indices) {
+            index = remap[index];
+        }
+        const size_t removed = numVertices - unique.size();
+        mesh.vertices.swap(unique);
+
+        return removed;
+    }
+
+} // namespace segfault::tools
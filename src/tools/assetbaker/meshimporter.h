@@ -0,0 +1,62 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace segfault::tools {
+
+    /// @brief The full precision vertex the baker works on before the mesh is packed.
+    struct BakeVertex {
+        glm::vec3 position{ 0.0f };     ///< The position.
+        glm::vec3 normal{ 0.0f };       ///< The normal, zero if the source has none.
+        glm::vec2 texCoord{ 0.0f };     ///< The texture coordinate, v points down like in Vulkan.
+        glm::vec3 color{ 1.0f };        ///< The vertex color.
+    };
+    static_assert(sizeof(BakeVertex) == 11 * sizeof(float), "BakeVertex must not contain padding, it is hashed bytewise.");
+
+    /// @brief An indexed triangle list.
+    struct BakeMesh {
+        std::vector<BakeVertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    /// @brief Imports a Wavefront OBJ file. Polygons are triangulated as fans, all groups and 
+    /// objects are merged and the optional vertex color extension "v x y z r g b" is supported.
+    /// The result is not indexed, use deduplicateVertices to share the vertices.
+    /// @param[ in ] data The file content.
+    /// @param[ in ] size The size of the content in bytes.
+    /// @param[ out ] mesh The imported mesh.
+    /// @return True if at least one triangle was imported, false otherwise.
+    bool importObj(const uint8_t *data, size_t size, BakeMesh &mesh);
+
+    /// @brief Merges bitwise identical vertices and rewrites the indices.
+    /// @param[ inout ] mesh The mesh to deduplicate.
+    /// @return The number of removed vertices.
+    size_t deduplicateVertices(BakeMesh &mesh);
+
+} // namespace segfault::tools
@@ -0,0 +1,180 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "meshletbuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace segfault::tools {
+
+    using namespace segfault::renderer;
+
+    namespace {
+
+        // Below this cosine the normals spread too far for the cone to cull anything
+        constexpr float MinConeCosine = 0.1f;
+
+        void computeBoundingSphere(const BakeMesh &mesh, const std::vector<uint32_t> &vertices, MeshletRecord &meshlet) {
+            // Ritter: start with the sphere over two distant points and grow it to the outliers
+            const glm::vec3 &first = mesh.vertices[vertices[0]].position;
+            auto farthest = [&mesh, &vertices](const glm::vec3 &from) {
+                glm::vec3 result = from;
+                float maxDistance = -1.0f;
+                for (uint32_t vertex : vertices) {
+                    const glm::vec3 &p = mesh.vertices[vertex].position;
+                    const float distance = glm::dot(p - from, p - from);
+                    if (distance > maxDistance) {
+                        maxDistance = distance;
+                        result = p;
+                    }
+                }
+                return result;
+            };
+            const glm::vec3 a = farthest(first);
+            const glm::vec3 b = farthest(a);
+            glm::vec3 center = (a + b) * 0.5f;
+            float radius = glm::length(b - a) * 0.5f;
+            for (uint32_t vertex : vertices) {
+                const glm::vec3 &p = mesh.vertices[vertex].position;
+                const float distance = glm::length(p - center);
+                if (distance > radius) {
+                    const float newRadius = (radius + distance) * 0.5f;
+                    center = center + (p - center) * ((newRadius - radius) / distance);
+                    radius = newRadius;
+                }
+            }
+
+            for (int k = 0; k < 3; ++k) {
+                meshlet.center[k] = center[k];
+            }
+            meshlet.radius = radius;
+        }
+
+        void computeNormalCone(const BakeMesh &mesh, MeshletRecord &meshlet) {
+            std::vector<glm::vec3> normals;
+            normals.reserve(meshlet.numIndices / 3);
+            glm::vec3 axis(0.0f);
+            for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numIndices; i += 3) {
+                const glm::vec3 &p0 = mesh.vertices[mesh.indices[i]].position;
+                const glm::vec3 &p1 = mesh.vertices[mesh.indices[i + 1]].position;
+                const glm::vec3 &p2 = mesh.vertices[mesh.indices[i + 2]].position;
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float length = glm::length(normal);
+                if (length > 0.0f) {
+                    normals.push_back(normal / length);
+                    axis += normals.back();
+                }
+            }
+
+            const float axisLength = glm::length(axis);
+            if (normals.empty() || axisLength <= 0.0f) {
+                return;
+            }
+            axis = axis / axisLength;
+
+            float minCosine = 1.0f;
+            for (const glm::vec3 &normal : normals) {
+                minCosine = std::min(minCosine, glm::dot(normal, axis));
+            }
+            if (minCosine <= MinConeCosine) {
+                return;
+            }
+
+            // Move the apex back along the axis until it lies behind all triangle planes
+            const glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+            float maxT = 0.0f;
+            size_t normalIndex = 0;
+            for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.numIndices; i += 3) {
+                const glm::vec3 &p0 = mesh.vertices[mesh.indices[i]].position;
+                const glm::vec3 &p1 = mesh.vertices[mesh.indices[i + 1]].position;
+                const glm::vec3 &p2 = mesh.vertices[mesh.indices[i + 2]].position;
+                if (glm::length(glm::cross(p1 - p0, p2 - p0)) <= 0.0f) {
+                    continue;
+                }
+                const glm::vec3 &normal = normals[normalIndex++];
+                maxT = std::max(maxT, glm::dot(center - p0, normal) / glm::dot(axis, normal));
+            }
+
+            const glm::vec3 apex = center - axis * maxT;
+            for (int k = 0; k < 3; ++k) {
+                meshlet.coneApex[k] = apex[k];
+                meshlet.coneAxis[k] = axis[k];
+            }
+            meshlet.coneCutoff = std::sqrt(1.0f - minCosine * minCosine);
+        }
+
+    } // namespace
+
+    std::vector<MeshletRecord> buildMeshlets(const BakeMesh &mesh, uint32_t firstIndex, uint32_t numIndices) {
+        std::vector<MeshletRecord> meshlets;
+        std::vector<uint32_t> stamps(mesh.vertices.size(), 0);
+        std::vector<uint32_t> vertices;
+        vertices.reserve(MaxMeshletVertices);
+        uint32_t stamp = 1;
+
+        auto finish = [&](uint32_t endIndex) {
+            MeshletRecord &meshlet = meshlets.back();
+            meshlet.numIndices = endIndex - meshlet.firstIndex;
+            meshlet.numVertices = static_cast<uint32_t>(vertices.size());
+            computeBoundingSphere(mesh, vertices, meshlet);
+            computeNormalCone(mesh, meshlet);
+        };
+
+        const uint32_t endIndex = firstIndex + static_cast<uint32_t>(std::min<size_t>(numIndices, mesh.indices.size() - firstIndex) / 3 * 3);
+        for (uint32_t i = firstIndex; i < endIndex; i += 3) {
+            uint32_t newVertices = 0;
+            for (uint32_t k = 0; k < 3; ++k) {
+                const uint32_t vertex = mesh.indices[i + k];
+                // Count repeated vertices of degenerated triangles once
+                const bool repeated = (k > 0 && vertex == mesh.indices[i]) || (k > 1 && vertex == mesh.indices[i + 1]);
+                newVertices += stamps[vertex] != stamp && !repeated ? 1 : 0;
+            }
+
+            const bool full = meshlets.empty() || vertices.size() + newVertices > MaxMeshletVertices ||
+                i - meshlets.back().firstIndex >= MaxMeshletTriangles * 3;
+            if (full) {
+                if (!meshlets.empty()) {
+                    finish(i);
+                }
+                ++stamp;
+                vertices.clear();
+                meshlets.emplace_back();
+                meshlets.back().firstIndex = i;
+            }
+
+            for (uint32_t k = 0; k < 3; ++k) {
+                const uint32_t vertex = mesh.indices[i + k];
+                if (stamps[vertex] != stamp) {
+                    stamps[vertex] = stamp;
+                    vertices.push_back(vertex);
+                }
+            }
+        }
+        if (!meshlets.empty()) {
+            finish(endIndex);
+        }
+
+        return meshlets;
+    }
+
+} // namespace segfault::tools
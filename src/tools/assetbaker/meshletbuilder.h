@@ -0,0 +1,42 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "meshimporter.h"
+#include "renderer/meshformat.h"
+
+namespace segfault::tools {
+
+    /// @brief Splits the triangle list into meshlets of up to MaxMeshletVertices vertices and 
+    /// MaxMeshletTriangles triangles and computes their bounding spheres and normal cones.
+    ///
+    /// The triangles are grouped in their order, so the meshlets are contiguous index ranges 
+    /// and the cache optimized order already makes them spatially compact. Run it after all 
+    /// optimizations which change the triangle order.
+    /// @param[ in ] mesh The optimized mesh.
+    /// @param[ in ] firstIndex The first index of the triangles to split, e.g. of a detail level.
+    /// @param[ in ] numIndices The number of indices.
+    /// @return The meshlets covering the triangles.
+    std::vector<renderer::MeshletRecord> buildMeshlets(const BakeMesh &mesh, uint32_t firstIndex, uint32_t numIndices);
+
+} // namespace segfault::tools
@@ -0,0 +1,358 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "meshoptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace segfault::tools {
+
+    namespace {
+
+        constexpr uint32_t InvalidIndex = 0xffffffffu;
+
+        // The tuning of the original publication
+        constexpr uint32_t ForsythCacheSize = 32;
+        constexpr uint32_t ForsythMaxValence = 32;
+        constexpr float ForsythDecayPower = 1.5f;
+        constexpr float ForsythLastTriangleScore = 0.75f;
+        constexpr float ForsythValenceBoostScale = 2.0f;
+        constexpr float ForsythValenceBoostPower = 0.5f;
+
+        struct ForsythScores {
+            std::array<float, ForsythCacheSize> cache{};
+            std::array<float, ForsythMaxValence + 1> valence{};
+
+            ForsythScores() {
+                for (uint32_t i = 0; i < ForsythCacheSize; ++i) {
+                    // The vertices of the last triangle get a fixed score, otherwise the triangle 
+                    // would be picked again the next time
+                    cache[i] = i < 3 ? ForsythLastTriangleScore : 
+                        std::pow(1.0f - static_cast<float>(i - 3) / static_cast<float>(ForsythCacheSize - 3), ForsythDecayPower);
+                }
+                for (uint32_t i = 1; i <= ForsythMaxValence; ++i) {
+                    valence[i] = ForsythValenceBoostScale * std::pow(static_cast<float>(i), -ForsythValenceBoostPower);
+                }
+            }
+
+            float get(int32_t cachePosition, uint32_t numTriangles) const {
+                if (numTriangles == 0) {
+                    return -1.0f;
+                }
+                const float cacheScore = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+                return cacheScore + valence[std::min(numTriangles, ForsythMaxValence)];
+            }
+        };
+
+        // Models a FIFO cache by the time a vertex entered it, a reset lets every vertex miss
+        class FifoCache {
+        public:
+            FifoCache(size_t numVertices, uint32_t cacheSize) : 
+                    mTimestamps(numVertices, 0), mCacheSize(cacheSize), mTime(cacheSize + 1) {
+                // empty
+            }
+
+            bool access(uint32_t vertex) {
+                if (mTime - mTimestamps[vertex] <= mCacheSize) {
+                    return false;
+                }
+                mTimestamps[vertex] = mTime++;
+                return true;
+            }
+
+            uint32_t accessTriangle(const uint32_t *triangle) {
+                return static_cast<uint32_t>(access(triangle[0])) + static_cast<uint32_t>(access(triangle[1])) + 
+                    static_cast<uint32_t>(access(triangle[2]));
+            }
+
+            void reset() {
+                mTime += mCacheSize + 1;
+            }
+
+        private:
+            std::vector<uint64_t> mTimestamps;
+            uint64_t mCacheSize;
+            uint64_t mTime;
+        };
+
+    } // namespace
+
+    float computeAcmr(const uint32_t *indices, size_t numIndices, size_t numVertices, uint32_t cacheSize) {
+        if (numIndices < 3) {
+            return 0.0f;
+        }
+
+        FifoCache cache(numVertices, cacheSize);
+        size_t misses = 0;
+        for (size_t i = 0; i + 2 < numIndices; i += 3) {
+            misses += cache.accessTriangle(&indices[i]);
+        }
+
+        return static_cast<float>(misses) / static_cast<float>(numIndices / 3);
+    }
+
+    void optimizeVertexCache(std::vector<uint32_t> &indices, size_t numVertices) {
+        const size_t numTriangles = indices.size() / 3;
+        if (numTriangles == 0) {
+            return;
+        }
+
+        static const ForsythScores scores;
+
+        // The triangles of every vertex, the first liveTriangles entries are the not emitted ones
+        std::vector<uint32_t> liveTriangles(numVertices, 0);
+        for (size_t i = 0; i < numTriangles * 3; ++i) {
+            ++liveTriangles[indices[i]];
+        }
+        std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+        for (size_t v = 0; v < numVertices; ++v) {
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        }
+        std::vector<uint32_t> adjacency(numTriangles * 3);
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < numTriangles * 3; ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<float> vertexScores(numVertices);
+        for (size_t v = 0; v < numVertices; ++v) {
+            vertexScores[v] = scores.get(-1, liveTriangles[v]);
+        }
+
+        std::vector<float> triangleScores(numTriangles);
+        std::vector<uint8_t> emitted(numTriangles, 0);
+        uint32_t best = 0;
+        for (size_t t = 0; t < numTriangles; ++t) {
+            triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+            if (triangleScores[t] > triangleScores[best]) {
+                best = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::array<uint32_t, ForsythCacheSize + 3> cache{}, nextCache{};
+        uint32_t cacheCount = 0;
+        size_t inputCursor = 0;
+        std::vector<uint32_t> result;
+        result.reserve(numTriangles * 3);
+        for (size_t i = 0; i < numTriangles; ++i) {
+            if (best == InvalidIndex) {
+                // Dead end, no triangle in the cache has a live vertex left
+                while (emitted[inputCursor] != 0) {
+                    ++inputCursor;
+                }
+                best = static_cast<uint32_t>(inputCursor);
+            }
+
+            const uint32_t *triangle = &indices[best * 3];
+            result.insert(result.end(), triangle, triangle + 3);
+            emitted[best] = 1;
+
+            // Remove the triangle from its vertices and put them in front of the cache
+            uint32_t nextCount = 0;
+            for (uint32_t k = 0; k < 3; ++k) {
+                const uint32_t vertex = triangle[k];
+                uint32_t *triangles = &adjacency[adjacencyOffsets[vertex]];
+                const uint32_t count = liveTriangles[vertex];
+                for (uint32_t j = 0; j < count; ++j) {
+                    if (triangles[j] == best) {
+                        std::swap(triangles[j], triangles[count - 1]);
+                        break;
+                    }
+                }
+                --liveTriangles[vertex];
+                nextCache[nextCount++] = vertex;
+            }
+            for (uint32_t j = 0; j < cacheCount; ++j) {
+                const uint32_t vertex = cache[j];
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                    nextCache[nextCount++] = vertex;
+                }
+            }
+
+            // Rescore the cached and the evicted vertices, then pick the best triangle among the 
+            // neighbours of the cached ones
+            for (uint32_t j = 0; j < nextCount; ++j) {
+                const uint32_t vertex = nextCache[j];
+                const int32_t position = j < ForsythCacheSize ? static_cast<int32_t>(j) : -1;
+                const float score = scores.get(position, liveTriangles[vertex]);
+                const float delta = score - vertexScores[vertex];
+                vertexScores[vertex] = score;
+
+                const uint32_t *triangles = &adjacency[adjacencyOffsets[vertex]];
+                for (uint32_t k = 0; k < liveTriangles[vertex]; ++k) {
+                    triangleScores[triangles[k]] += delta;
+                }
+            }
+
+            best = InvalidIndex;
+            float bestScore = -1.0f;
+            cacheCount = std::min(nextCount, ForsythCacheSize);
+            for (uint32_t j = 0; j < cacheCount; ++j) {
+                const uint32_t vertex = nextCache[j];
+                const uint32_t *triangles = &adjacency[adjacencyOffsets[vertex]];
+                for (uint32_t k = 0; k < liveTriangles[vertex]; ++k) {
+                    if (triangleScores[triangles[k]] > bestScore) {
+                        bestScore = triangleScores[triangles[k]];
+                        best = triangles[k];
+                    }
+                }
+            }
+            std::copy(nextCache.begin(), nextCache.begin() + cacheCount, cache.begin());
+        }
+
+        indices.swap(result);
+    }
+
+    size_t optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<BakeVertex> &vertices, float threshold) {
+        const size_t numTriangles = indices.size() / 3;
+        if (numTriangles < 2) {
+            return 0;
+        }
+
+        // Hard boundaries are triangles missing the cache with all vertices, the order can change 
+        // there without cost. Hard clusters are split further where the cluster restarted with a 
+        // cold cache still stays within the threshold.
+        FifoCache cache(vertices.size(), MeshStatsCacheSize);
+        std::vector<uint32_t> hardBoundaries;
+        for (size_t t = 0; t < numTriangles; ++t) {
+            if (cache.accessTriangle(&indices[t * 3]) == 3) {
+                hardBoundaries.push_back(static_cast<uint32_t>(t));
+            }
+        }
+        hardBoundaries.push_back(static_cast<uint32_t>(numTriangles));
+
+        std::vector<uint32_t> clusters;
+        for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h) {
+            const uint32_t begin = hardBoundaries[h], end = hardBoundaries[h + 1];
+            cache.reset();
+            uint32_t misses = 0;
+            for (uint32_t t = begin; t < end; ++t) {
+                misses += cache.accessTriangle(&indices[t * 3]);
+            }
+            const float clusterThreshold = threshold * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+            cache.reset();
+            clusters.push_back(begin);
+            uint32_t clusterBegin = begin;
+            misses = 0;
+            for (uint32_t t = begin; t < end; ++t) {
+                misses += cache.accessTriangle(&indices[t * 3]);
+                if (t + 1 < end && static_cast<float>(misses) <= clusterThreshold * static_cast<float>(t + 1 - clusterBegin)) {
+                    clusters.push_back(t + 1);
+                    clusterBegin = t + 1;
+                    misses = 0;
+                    cache.reset();
+                }
+            }
+        }
+        const size_t numClusters = clusters.size();
+        clusters.push_back(static_cast<uint32_t>(numTriangles));
+        if (numClusters < 2) {
+            return 0;
+        }
+
+        // Sort the clusters by how far they face away from the mesh center
+        std::vector<glm::vec3> centroids(numClusters, glm::vec3(0.0f)), normals(numClusters, glm::vec3(0.0f));
+        std::vector<float> areas(numClusters, 0.0f);
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < numClusters; ++c) {
+            for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+                const glm::vec3 &p0 = vertices[indices[t * 3]].position;
+                const glm::vec3 &p1 = vertices[indices[t * 3 + 1]].position;
+                const glm::vec3 &p2 = vertices[indices[t * 3 + 2]].position;
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+                normals[c] += normal;
+                areas[c] += area;
+            }
+            meshCentroid += centroids[c];
+            meshArea += areas[c];
+        }
+        if (meshArea <= 0.0f) {
+            return 0;
+        }
+        meshCentroid /= meshArea;
+
+        std::vector<float> sortKeys(numClusters, 0.0f);
+        for (size_t c = 0; c < numClusters; ++c) {
+            const float normalLength = glm::length(normals[c]);
+            if (areas[c] > 0.0f && normalLength > 0.0f) {
+                sortKeys[c] = glm::dot(centroids[c] / areas[c] - meshCentroid, normals[c] / normalLength);
+            }
+        }
+        std::vector<uint32_t> order(numClusters);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order) {
+            result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+        }
+
+        const float acmrBefore = computeAcmr(indices.data(), indices.size(), vertices.size(), MeshStatsCacheSize);
+        const float acmrAfter = computeAcmr(result.data(), result.size(), vertices.size(), MeshStatsCacheSize);
+        if (acmrAfter > acmrBefore * threshold) {
+            return 0;
+        }
+        indices.swap(result);
+
+        return numClusters;
+    }
+
+    size_t optimizeVertexFetch(BakeMesh &mesh) {
+        std::vector<uint32_t> remap(mesh.vertices.size(), InvalidIndex);
+        std::vector<BakeVertex> result;
+        result.reserve(mesh.vertices.size());
+        for (uint32_t &index : mesh.indices) {
+            if (remap[index] == InvalidIndex) {
+                remap[index] = static_cast<uint32_t>(result.size());
+                result.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        mesh.vertices.swap(result);
+
+        return mesh.vertices.size();
+    }
+
+    void optimizeMesh(BakeMesh &mesh, MeshOptimizationStats &stats) {
+        stats = MeshOptimizationStats{};
+        stats.numInputVertices = mesh.vertices.size();
+        deduplicateVertices(mesh);
+        stats.acmrBefore = computeAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), MeshStatsCacheSize);
+
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        stats.numClusters = optimizeOverdraw(mesh.indices, mesh.vertices, 1.05f);
+        stats.numVertices = optimizeVertexFetch(mesh);
+        stats.numTriangles = mesh.indices.size() / 3;
+        stats.acmrAfter = computeAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), MeshStatsCacheSize);
+    }
+
+} // namespace segfault::tools
@@ -0,0 +1,78 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "meshimporter.h"
+
+namespace segfault::tools {
+
+    /// @brief The size of the modeled post transform cache used for the statistics.
+    constexpr uint32_t MeshStatsCacheSize = 16;
+
+    /// @brief The statistics of a mesh optimization run.
+    struct MeshOptimizationStats {
+        size_t numInputVertices{ 0 };   ///< The number of vertices before the deduplication.
+        size_t numVertices{ 0 };        ///< The number of vertices after the deduplication.
+        size_t numTriangles{ 0 };       ///< The number of triangles.
+        size_t numClusters{ 0 };        ///< The number of clusters sorted for overdraw.
+        float acmrBefore{ 0.0f };       ///< The average cache miss ratio of the imported order.
+        float acmrAfter{ 0.0f };        ///< The average cache miss ratio of the optimized order.
+    };
+
+    /// @brief Computes the average number of vertex shader invocations per triangle for a FIFO 
+    /// post transform cache, 3 is the worst case and 0.5 the best case for large regular meshes.
+    /// @param[ in ] indices The triangle list.
+    /// @param[ in ] numIndices The number of indices.
+    /// @param[ in ] numVertices The number of vertices.
+    /// @param[ in ] cacheSize The number of cache entries.
+    /// @return The average cache miss ratio.
+    float computeAcmr(const uint32_t *indices, size_t numIndices, size_t numVertices, uint32_t cacheSize);
+
+    /// @brief Reorders the triangles for the post transform cache with Tom Forsyth's linear speed 
+    /// vertex cache optimization. The scoring does not depend on an exact cache size.
+    /// @param[ inout ] indices The triangle list to reorder.
+    /// @param[ in ] numVertices The number of vertices.
+    void optimizeVertexCache(std::vector<uint32_t> &indices, size_t numVertices);
+
+    /// @brief Reduces the overdraw of a cache optimized triangle list. The list is split into 
+    /// clusters where the cache restarts anyway and the clusters facing outwards are moved to the 
+    /// front, so they occlude the rest of the mesh, see Sander et al., "Fast Triangle Reordering 
+    /// for Vertex Locality and Reduced Overdraw".
+    /// @param[ inout ] indices The cache optimized triangle list.
+    /// @param[ in ] vertices The vertices.
+    /// @param[ in ] threshold The accepted growth of the cache miss ratio, the order is kept if exceeded.
+    /// @return The number of clusters, 0 if the order was kept.
+    size_t optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<BakeVertex> &vertices, float threshold);
+
+    /// @brief Reorders the vertices in the order of their first use, so the vertex fetch reads the 
+    /// vertex buffer nearly linear. Unreferenced vertices are removed.
+    /// @param[ inout ] mesh The mesh to reorder.
+    /// @return The number of vertices after the reordering.
+    size_t optimizeVertexFetch(BakeMesh &mesh);
+
+    /// @brief Runs the deduplication and all optimizations in the order they depend on each other.
+    /// @param[ inout ] mesh The imported mesh.
+    /// @param[ out ] stats The statistics of the run.
+    void optimizeMesh(BakeMesh &mesh, MeshOptimizationStats &stats);
+
+} // namespace segfault::tools
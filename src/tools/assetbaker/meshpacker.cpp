@@ -0,0 +1,133 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "meshpacker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace segfault::tools {
+
+    using namespace segfault::renderer;
+
+    namespace {
+
+        uint8_t packUnorm8(float value) {
+            return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+
+        // The smallest extent keeps flat meshes from dividing by zero
+        constexpr float MinQuantizationExtent = 1e-6f;
+
+    } // namespace
+
+    MeshVertexFormat getVertexFormatByName(const std::string &name) {
+        if (name == "float") {
+            return MeshVertexFormat::PosColorUv;
+        } else if (name == "half") {
+            return MeshVertexFormat::PackedHalf;
+        } else if (name == "snorm16") {
+            return MeshVertexFormat::PackedSnorm16;
+        }
+
+        return MeshVertexFormat::Invalid;
+    }
+
+    bool packVertices(const std::vector<BakeVertex> &vertices, MeshVertexFormat format, 
+            std::vector<uint8_t> &data, glm::vec3 &positionScale, glm::vec3 &positionOffset) {
+        const uint32_t stride = getMeshVertexStride(format);
+        if (stride == 0) {
+            return false;
+        }
+
+        data.resize(vertices.size() * stride);
+        positionScale = glm::vec3(1.0f);
+        positionOffset = glm::vec3(0.0f);
+        if (format == MeshVertexFormat::PosColorUv) {
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                const BakeVertex &src = vertices[i];
+                MeshVertex dst{};
+                for (int k = 0; k < 3; ++k) {
+                    dst.pos[k] = src.position[k];
+                    dst.color[k] = src.color[k];
+                }
+                dst.texCoord[0] = src.texCoord[0];
+                dst.texCoord[1] = src.texCoord[1];
+                memcpy(&data[i * stride], &dst, sizeof(dst));
+            }
+            return true;
+        }
+
+        scene::Aabb bounds;
+        for (const BakeVertex &vertex : vertices) {
+            bounds.merge(vertex.position);
+        }
+        positionOffset = bounds.getCenter();
+        positionScale = bounds.getExtents();
+        for (int k = 0; k < 3; ++k) {
+            positionScale[k] = std::max(positionScale[k], MinQuantizationExtent);
+        }
+
+        const bool half = format == MeshVertexFormat::PackedHalf;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const BakeVertex &src = vertices[i];
+            PackedMeshVertex dst{};
+            for (int k = 0; k < 3; ++k) {
+                const float normalized = (src.position[k] - positionOffset[k]) / positionScale[k];
+                dst.pos[k] = half ? packHalf(normalized) : static_cast<uint16_t>(packSnorm16(normalized));
+                dst.color[k] = packUnorm8(src.color[k]);
+            }
+            dst.pos[3] = half ? packHalf(1.0f) : static_cast<uint16_t>(packSnorm16(1.0f));
+            dst.color[3] = 255;
+            encodeOctahedral(src.normal, dst.normal);
+            dst.texCoord[0] = packHalf(src.texCoord[0]);
+            dst.texCoord[1] = packHalf(src.texCoord[1]);
+            memcpy(&data[i * stride], &dst, sizeof(dst));
+        }
+
+        return true;
+    }
+
+    float computePositionError(const std::vector<BakeVertex> &vertices, MeshVertexFormat format, 
+            const std::vector<uint8_t> &data, const glm::vec3 &positionScale, const glm::vec3 &positionOffset) {
+        if (format != MeshVertexFormat::PackedHalf && format != MeshVertexFormat::PackedSnorm16) {
+            return 0.0f;
+        }
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            PackedMeshVertex packed;
+            memcpy(&packed, &data[i * sizeof(PackedMeshVertex)], sizeof(packed));
+            glm::vec3 restored;
+            for (int k = 0; k < 3; ++k) {
+                const float normalized = format == MeshVertexFormat::PackedHalf ? unpackHalf(packed.pos[k]) :
+                    unpackSnorm16(static_cast<int16_t>(packed.pos[k]));
+                restored[k] = normalized * positionScale[k] + positionOffset[k];
+            }
+            maxError = std::max(maxError, glm::length(restored - vertices[i].position));
+        }
+
+        return maxError;
+    }
+
+} // namespace segfault::tools
@@ -0,0 +1,59 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "meshimporter.h"
+#include "renderer/meshformat.h"
+
+#include <string>
+
+namespace segfault::tools {
+
+    /// @brief Returns the vertex format for its command line name.
+    /// @param[ in ] name The name, "float", "half" or "snorm16".
+    /// @return The format, MeshVertexFormat::Invalid for unknown names.
+    renderer::MeshVertexFormat getVertexFormatByName(const std::string &name);
+
+    /// @brief Packs the vertices into the GPU layout of a vertex format. The packed formats 
+    /// store the positions normalized to [-1, 1] over the bounds of the mesh, the returned 
+    /// scale and offset restore them.
+    /// @param[ in ] vertices The vertices.
+    /// @param[ in ] format The vertex format.
+    /// @param[ out ] data The packed vertices.
+    /// @param[ out ] positionScale The scale restoring the positions.
+    /// @param[ out ] positionOffset The offset applied after the scale.
+    /// @return True if the vertices were packed, false for invalid formats.
+    bool packVertices(const std::vector<BakeVertex> &vertices, renderer::MeshVertexFormat format, 
+        std::vector<uint8_t> &data, glm::vec3 &positionScale, glm::vec3 &positionOffset);
+
+    /// @brief Returns the largest position error of the packed vertices, for the statistics.
+    /// @param[ in ] vertices The original vertices.
+    /// @param[ in ] format The vertex format of the data.
+    /// @param[ in ] data The packed vertices.
+    /// @param[ in ] positionScale The scale restoring the positions.
+    /// @param[ in ] positionOffset The offset applied after the scale.
+    /// @return The largest distance between an original and a restored position.
+    float computePositionError(const std::vector<BakeVertex> &vertices, renderer::MeshVertexFormat format, 
+        const std::vector<uint8_t> &data, const glm::vec3 &positionScale, const glm::vec3 &positionOffset);
+
+} // namespace segfault::tools
@@ -0,0 +1,433 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "meshsimplifier.h"
+#include "meshoptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace segfault::tools {
+
+    using namespace segfault::renderer;
+
+    namespace {
+
+        constexpr uint32_t InvalidIndex = 0xffffffffu;
+
+        // Border planes are weighted up, so the outline of open meshes survives
+        constexpr double BorderWeight = 10.0;
+
+        // A level has to remove at least this share of the triangles of the previous one
+        constexpr float MinLodReduction = 0.85f;
+
+        enum class VertexKind : uint8_t {
+            Manifold,   // Collapses onto any neighbour
+            Border,     // Collapses along the open border only
+            Seam,       // Two vertices at one position, collapses along the attribute seam only
+            Locked      // Junctions of seams and borders and non-manifold vertices never move
+        };
+
+        struct Quadric {
+            double a00{ 0.0 }, a01{ 0.0 }, a02{ 0.0 }, a03{ 0.0 };
+            double a11{ 0.0 }, a12{ 0.0 }, a13{ 0.0 };
+            double a22{ 0.0 }, a23{ 0.0 };
+            double a33{ 0.0 };
+            double weight{ 0.0 };
+
+            void addPlane(const glm::vec3 &normal, float distance, double w) {
+                const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+                a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+                a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+                a22 += w * c * c; a23 += w * c * d;
+                a33 += w * d * d;
+                weight += w;
+            }
+
+            void add(const Quadric &q) {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+                a11 += q.a11; a12 += q.a12; a13 += q.a13;
+                a22 += q.a22; a23 += q.a23;
+                a33 += q.a33;
+                weight += q.weight;
+            }
+
+            // The weighted sum of the squared plane distances
+            double evaluate(const glm::vec3 &p) const {
+                const double x = p.x, y = p.y, z = p.z;
+                return x * x * a00 + 2.0 * x * y * a01 + 2.0 * x * z * a02 + 2.0 * x * a03 +
+                    y * y * a11 + 2.0 * y * z * a12 + 2.0 * y * a13 +
+                    z * z * a22 + 2.0 * z * a23 + a33;
+            }
+        };
+
+        struct Collapse {
+            uint32_t from;
+            uint32_t to;
+            float cost;
+        };
+
+        // Maps every vertex to the first vertex with the same position, the simplification works on positions
+        std::vector<uint32_t> buildPositionRemap(const std::vector<BakeVertex> &vertices) {
+            std::vector<uint32_t> order(vertices.size());
+            std::iota(order.begin(), order.end(), 0u);
+            auto less = [&vertices](uint32_t a, uint32_t b) {
+                const glm::vec3 &pa = vertices[a].position;
+                const glm::vec3 &pb = vertices[b].position;
+                if (pa.x != pb.x) {
+                    return pa.x < pb.x;
+                }
+                if (pa.y != pb.y) {
+                    return pa.y < pb.y;
+                }
+                if (pa.z != pb.z) {
+                    return pa.z < pb.z;
+                }
+                return a < b;
+            };
+            std::sort(order.begin(), order.end(), less);
+
+            std::vector<uint32_t> remap(vertices.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                const bool same = i > 0 && vertices[order[i]].position.x == vertices[order[i - 1]].position.x &&
+                    vertices[order[i]].position.y == vertices[order[i - 1]].position.y &&
+                    vertices[order[i]].position.z == vertices[order[i - 1]].position.z;
+                remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+            }
+
+            return remap;
+        }
+
+        uint64_t makeEdgeKey(uint32_t a, uint32_t b) {
+            return (static_cast<uint64_t>(a) << 32) | b;
+        }
+
+        std::vector<VertexKind> classifyVertices(const std::vector<uint32_t> &indices, const std::vector<uint32_t> &remap, 
+                std::vector<uint64_t> &borderEdges) {
+            std::vector<VertexKind> kinds(remap.size(), VertexKind::Manifold);
+            std::vector<uint32_t> wedges(remap.size() * 2, InvalidIndex);
+            std::vector<uint64_t> edges;
+            edges.reserve(indices.size());
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                for (size_t k = 0; k < 3; ++k) {
+                    // More than one vertex at a position marks a seam in the attributes, where 
+                    // more than two charts meet the position is locked
+                    const uint32_t vertex = remap[indices[i + k]];
+                    uint32_t *vertexWedges = &wedges[vertex * 2];
+                    if (vertexWedges[0] == InvalidIndex || vertexWedges[0] == indices[i + k]) {
+                        vertexWedges[0] = indices[i + k];
+                    } else if (vertexWedges[1] == InvalidIndex || vertexWedges[1] == indices[i + k]) {
+                        vertexWedges[1] = indices[i + k];
+                        kinds[vertex] = VertexKind::Seam;
+                    } else {
+                        kinds[vertex] = VertexKind::Locked;
+                    }
+                    edges.push_back(makeEdgeKey(vertex, remap[indices[i + (k + 1) % 3]]));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            borderEdges.clear();
+            for (size_t i = 0; i < edges.size(); ++i) {
+                const uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+                const uint32_t b = static_cast<uint32_t>(edges[i]);
+                if ((i > 0 && edges[i - 1] == edges[i]) || (i + 1 < edges.size() && edges[i + 1] == edges[i])) {
+                    kinds[a] = VertexKind::Locked;
+                    kinds[b] = VertexKind::Locked;
+                } else if (!std::binary_search(edges.begin(), edges.end(), makeEdgeKey(b, a))) {
+                    borderEdges.push_back(edges[i]);
+                    for (uint32_t vertex : { a, b }) {
+                        if (kinds[vertex] == VertexKind::Manifold) {
+                            kinds[vertex] = VertexKind::Border;
+                        } else if (kinds[vertex] == VertexKind::Seam) {
+                            kinds[vertex] = VertexKind::Locked;
+                        }
+                    }
+                }
+            }
+
+            return kinds;
+        }
+
+        std::vector<Quadric> computeQuadrics(const BakeMesh &mesh, const std::vector<uint32_t> &indices, 
+                const std::vector<uint32_t> &remap, const std::vector<uint64_t> &borderEdges) {
+            std::vector<Quadric> quadrics(remap.size());
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                const uint32_t v[3] = { remap[indices[i]], remap[indices[i + 1]], remap[indices[i + 2]] };
+                const glm::vec3 &p0 = mesh.vertices[v[0]].position;
+                const glm::vec3 &p1 = mesh.vertices[v[1]].position;
+                const glm::vec3 &p2 = mesh.vertices[v[2]].position;
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float length = glm::length(normal);
+                if (length <= 0.0f) {
+                    continue;
+                }
+                normal = normal / length;
+
+                // Area weighted, so small triangles do not dominate the error
+                Quadric face;
+                face.addPlane(normal, -glm::dot(normal, p0), length * 0.5);
+                for (uint32_t k = 0; k < 3; ++k) {
+                    quadrics[v[k]].add(face);
+                }
+
+                // The plane through a border edge perpendicular to the face keeps the border in place
+                for (uint32_t k = 0; k < 3; ++k) {
+                    const uint32_t a = v[k], b = v[(k + 1) % 3];
+                    if (!std::binary_search(borderEdges.begin(), borderEdges.end(), makeEdgeKey(a, b))) {
+                        continue;
+                    }
+                    const glm::vec3 edge = mesh.vertices[b].position - mesh.vertices[a].position;
+                    glm::vec3 borderNormal = glm::cross(edge, normal);
+                    const float borderLength = glm::length(borderNormal);
+                    if (borderLength <= 0.0f) {
+                        continue;
+                    }
+                    borderNormal = borderNormal / borderLength;
+                    Quadric border;
+                    border.addPlane(borderNormal, -glm::dot(borderNormal, mesh.vertices[a].position), 
+                        BorderWeight * glm::dot(edge, edge));
+                    quadrics[a].add(border);
+                    quadrics[b].add(border);
+                }
+            }
+
+            return quadrics;
+        }
+
+        float computeCollapseCost(const Quadric &from, const Quadric &to, const glm::vec3 &position) {
+            Quadric merged = from;
+            merged.add(to);
+            if (merged.weight <= 0.0) {
+                return 0.0f;
+            }
+
+            return static_cast<float>(std::sqrt(std::max(merged.evaluate(position) / merged.weight, 0.0)));
+        }
+
+        bool isDegenerated(const std::vector<uint32_t> &remap, const uint32_t *triangle) {
+            const uint32_t a = remap[triangle[0]], b = remap[triangle[1]], c = remap[triangle[2]];
+            return a == b || b == c || c == a;
+        }
+
+    } // namespace
+
+    float simplifyMesh(const BakeMesh &mesh, const std::vector<uint32_t> &indices, size_t targetIndexCount, 
+            float maxError, std::vector<uint32_t> &result) {
+        const size_t numVertices = mesh.vertices.size();
+        const std::vector<uint32_t> remap = buildPositionRemap(mesh.vertices);
+        result.clear();
+        result.reserve(indices.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            if (!isDegenerated(remap, &indices[i])) {
+                result.insert(result.end(), &indices[i], &indices[i] + 3);
+            }
+        }
+        if (result.size() <= targetIndexCount) {
+            return 0.0f;
+        }
+
+        std::vector<uint64_t> borderEdges;
+        const std::vector<VertexKind> kinds = classifyVertices(result, remap, borderEdges);
+        std::vector<Quadric> quadrics = computeQuadrics(mesh, result, remap, borderEdges);
+
+        float error = 0.0f;
+        std::vector<uint32_t> offsets(numVertices + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<Collapse> collapses;
+        std::vector<uint8_t> touched(numVertices);
+        std::vector<uint32_t> targets(numVertices);
+        while (result.size() > targetIndexCount) {
+            const size_t numTriangles = result.size() / 3;
+
+            // The triangles around every position
+            std::fill(offsets.begin(), offsets.end(), 0u);
+            for (uint32_t index : result) {
+                ++offsets[remap[index] + 1];
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            adjacency.resize(result.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) {
+                adjacency[fill[remap[result[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (size_t k = 0; k < 3; ++k) {
+                    const uint32_t a = remap[result[i + k]];
+                    const uint32_t b = remap[result[i + (k + 1) % 3]];
+                    for (const auto &[from, to] : { std::make_pair(a, b), std::make_pair(b, a) }) {
+                        if (kinds[from] == VertexKind::Manifold || (kinds[from] != VertexKind::Locked && kinds[to] != VertexKind::Manifold)) {
+                            collapses.push_back({ from, to, computeCollapseCost(quadrics[from], quadrics[to], mesh.vertices[to].position) });
+                        }
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                if (a.cost != b.cost) {
+                    return a.cost < b.cost;
+                }
+                return a.from != b.from ? a.from < b.from : a.to < b.to;
+            });
+
+            // Collapse the cheapest edges, a vertex takes part in one collapse per pass, so the 
+            // flip test sees the final positions of all neighbours
+            std::fill(touched.begin(), touched.end(), 0);
+            std::fill(targets.begin(), targets.end(), InvalidIndex);
+            const size_t numToRemove = numTriangles - targetIndexCount / 3;
+            size_t numRemoved = 0;
+            for (const Collapse &collapse : collapses) {
+                if (numRemoved >= numToRemove || collapse.cost > maxError) {
+                    break;
+                }
+                if (touched[collapse.from] != 0 || touched[collapse.to] != 0) {
+                    continue;
+                }
+
+                // Every vertex at the collapsed position moves to the vertex at the target 
+                // position on the same side of the seam, a seam collapse needs both sides
+                uint32_t numShared = 0;
+                uint32_t fromWedges[2] = { InvalidIndex, InvalidIndex };
+                uint32_t toWedges[2] = { InvalidIndex, InvalidIndex };
+                bool valid = true;
+                for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1] && valid; ++j) {
+                    const uint32_t *triangle = &result[adjacency[j] * 3];
+                    glm::vec3 before[3], after[3];
+                    uint32_t fromWedge = InvalidIndex, toWedge = InvalidIndex;
+                    for (uint32_t k = 0; k < 3; ++k) {
+                        const uint32_t vertex = remap[triangle[k]];
+                        if (vertex == collapse.from) {
+                            fromWedge = triangle[k];
+                        } else if (vertex == collapse.to) {
+                            toWedge = triangle[k];
+                        }
+                        before[k] = mesh.vertices[vertex].position;
+                        after[k] = vertex == collapse.from ? mesh.vertices[collapse.to].position : before[k];
+                    }
+                    const uint32_t slot = fromWedges[0] == InvalidIndex || fromWedges[0] == fromWedge ? 0 : 1;
+                    if (fromWedges[slot] != InvalidIndex && fromWedges[slot] != fromWedge) {
+                        valid = false;
+                        continue;
+                    }
+                    fromWedges[slot] = fromWedge;
+                    if (toWedge != InvalidIndex) {
+                        valid = toWedges[slot] == InvalidIndex || toWedges[slot] == toWedge;
+                        toWedges[slot] = toWedge;
+                        ++numShared;
+                        continue;
+                    }
+
+                    // The remaining triangles must not flip over
+                    const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    valid = glm::dot(normalBefore, normalAfter) > 0.0f;
+                }
+                for (uint32_t k = 0; k < 2; ++k) {
+                    valid = valid && (fromWedges[k] == InvalidIndex) == (toWedges[k] == InvalidIndex);
+                }
+                if (!valid || (kinds[collapse.from] == VertexKind::Border && numShared != 1)) {
+                    continue;
+                }
+
+                for (uint32_t k = 0; k < 2 && fromWedges[k] != InvalidIndex; ++k) {
+                    targets[fromWedges[k]] = toWedges[k];
+                }
+                quadrics[collapse.to].add(quadrics[collapse.from]);
+                touched[collapse.from] = 1;
+                touched[collapse.to] = 1;
+                for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1]; ++j) {
+                    const uint32_t *triangle = &result[adjacency[j] * 3];
+                    for (uint32_t k = 0; k < 3; ++k) {
+                        touched[remap[triangle[k]]] = 1;
+                    }
+                }
+                numRemoved += numShared;
+                error = std::max(error, collapse.cost);
+            }
+            if (numRemoved == 0) {
+                break;
+            }
+
+            // Move the collapsed vertices and drop the triangles which became degenerated
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3) {
+                uint32_t triangle[3];
+                for (uint32_t k = 0; k < 3; ++k) {
+                    const uint32_t target = targets[result[i + k]];
+                    triangle[k] = target != InvalidIndex ? target : result[i + k];
+                }
+                if (!isDegenerated(remap, triangle)) {
+                    std::copy(triangle, triangle + 3, result.begin() + write);
+                    write += 3;
+                }
+            }
+            result.resize(write);
+        }
+
+        return error;
+    }
+
+    std::vector<MeshLodRecord> generateLods(BakeMesh &mesh, const LodChainSettings &settings) {
+        std::vector<MeshLodRecord> lods(1);
+        lods[0].numIndices = static_cast<uint32_t>(mesh.indices.size());
+        if (mesh.vertices.empty() || mesh.indices.empty()) {
+            return lods;
+        }
+
+        glm::vec3 boundsMin = mesh.vertices[0].position, boundsMax = boundsMin;
+        for (const BakeVertex &vertex : mesh.vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+        const float maxError = settings.maxError * glm::length(boundsMax - boundsMin) * 0.5f;
+
+        const std::vector<uint32_t> full(mesh.indices);
+        std::vector<uint32_t> level;
+        size_t previous = full.size();
+        while (lods.size() < std::min(settings.maxLods, MaxMeshLods)) {
+            const size_t targetTriangles = static_cast<size_t>(static_cast<float>(previous / 3) * settings.reduction);
+            if (targetTriangles < settings.minTriangles) {
+                break;
+            }
+
+            // Every level is simplified from the full mesh, so its error is measured against it
+            const float error = simplifyMesh(mesh, full, targetTriangles * 3, maxError, level);
+            if (level.empty() || static_cast<float>(level.size()) > static_cast<float>(previous) * MinLodReduction) {
+                break;
+            }
+            optimizeVertexCache(level, mesh.vertices.size());
+
+            MeshLodRecord lod;
+            lod.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+            lod.numIndices = static_cast<uint32_t>(level.size());
+            lod.error = std::max(error, lods.back().error);
+            mesh.indices.insert(mesh.indices.end(), level.begin(), level.end());
+            lods.push_back(lod);
+            previous = level.size();
+        }
+
+        return lods;
+    }
+
+} // namespace segfault::tools
@@ -0,0 +1,61 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "meshimporter.h"
+#include "renderer/meshformat.h"
+
+namespace segfault::tools {
+
+    /// @brief The settings of the detail level generation.
+    struct LodChainSettings {
+        uint32_t maxLods{ renderer::MaxMeshLods };  ///< The maximum number of levels including the full detail one.
+        float reduction{ 0.5f };                    ///< The triangle count of a level relative to the previous one.
+        float maxError{ 0.05f };                    ///< The maximum error relative to the radius of the mesh bounds.
+        uint32_t minTriangles{ 32 };                ///< No levels are generated below this triangle count.
+    };
+
+    /// @brief Simplifies a triangle list by greedy edge collapses ordered by their quadric error, 
+    /// see Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics".
+    ///
+    /// Vertices only collapse onto other vertices, so the result indexes the vertices of the 
+    /// mesh and all levels can share one vertex buffer. Open borders only collapse along the 
+    /// border and vertices on attribute seams are kept, so texture charts stay intact.
+    /// @param[ in ] mesh The mesh, only the vertices are used.
+    /// @param[ in ] indices The triangle list to simplify.
+    /// @param[ in ] targetIndexCount The number of indices to reduce to.
+    /// @param[ in ] maxError The largest accepted object space error of a collapse.
+    /// @param[ out ] result The simplified triangle list.
+    /// @return The object space error of the result.
+    float simplifyMesh(const BakeMesh &mesh, const std::vector<uint32_t> &indices, size_t targetIndexCount, 
+        float maxError, std::vector<uint32_t> &result);
+
+    /// @brief Appends the detail levels of a mesh to its index list. Every level is simplified 
+    /// from the full detail mesh and cache optimized, level 0 is the input triangle list. The 
+    /// chain ends early when the simplification stops making progress.
+    /// @param[ inout ] mesh The optimized mesh, receives the indices of the new levels.
+    /// @param[ in ] settings The settings.
+    /// @return The levels, without meshlets.
+    std::vector<renderer::MeshLodRecord> generateLods(BakeMesh &mesh, const LodChainSettings &settings);
+
+} // namespace segfault::tools
@@ -0,0 +1,673 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "textureencoder.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace segfault::tools {
+
+    using namespace segfault::renderer;
+
+    namespace {
+
+        constexpr int BlockTexels = 16;
+
+        // The refinement stops improving after a few rounds for almost all blocks
+        constexpr int EndpointRefinements = 3;
+
+        // The BC7 interpolation weights of 4 bit indices in 64ths
+        constexpr int Bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct BitWriter {
+            uint8_t *data;
+            uint32_t position{ 0 };
+
+            void write(uint32_t value, uint32_t numBits) {
+                for (uint32_t i = 0; i < numBits; ++i, ++position) {
+                    if (((value >> i) & 1u) != 0) {
+                        data[position >> 3] |= static_cast<uint8_t>(1u << (position & 7u));
+                    }
+                }
+            }
+        };
+
+        struct BitReader {
+            const uint8_t *data;
+            uint32_t position{ 0 };
+
+            uint32_t read(uint32_t numBits) {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < numBits; ++i, ++position) {
+                    value |= static_cast<uint32_t>((data[position >> 3] >> (position & 7u)) & 1u) << i;
+                }
+                return value;
+            }
+        };
+
+        float squaredDistance(const glm::vec4 &a, const glm::vec4 &b) {
+            const glm::vec4 d = a - b;
+            return d.x * d.x + d.y * d.y + d.z * d.z + d.w * d.w;
+        }
+
+        void loadBlock(const BakeImage &image, uint32_t blockX, uint32_t blockY, uint8_t rgba[BlockTexels * 4]) {
+            for (uint32_t y = 0; y < 4; ++y) {
+                const uint32_t sy = std::min(blockY * 4 + y, image.height - 1);
+                for (uint32_t x = 0; x < 4; ++x) {
+                    const uint32_t sx = std::min(blockX * 4 + x, image.width - 1);
+                    memcpy(&rgba[(y * 4 + x) * 4], &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * 4], 4);
+                }
+            }
+        }
+
+        // Fits a line through the texels with a nonzero weight by power iteration on their 
+        // covariance and returns its extent over the texels
+        void fitEndpoints(const glm::vec4 *texels, const float *weights, glm::vec4 &e0, glm::vec4 &e1) {
+            glm::vec4 mean(0.0f), low(255.0f), high(0.0f);
+            float total = 0.0f;
+            for (int i = 0; i < BlockTexels; ++i) {
+                if (weights[i] > 0.0f) {
+                    mean += texels[i];
+                    low = glm::min(low, texels[i]);
+                    high = glm::max(high, texels[i]);
+                    total += 1.0f;
+                }
+            }
+            if (total == 0.0f) {
+                e0 = e1 = glm::vec4(0.0f);
+                return;
+            }
+            mean /= total;
+
+            float covariance[4][4] = {};
+            for (int i = 0; i < BlockTexels; ++i) {
+                if (weights[i] > 0.0f) {
+                    const glm::vec4 d = texels[i] - mean;
+                    for (int r = 0; r < 4; ++r) {
+                        for (int c = 0; c < 4; ++c) {
+                            covariance[r][c] += d[r] * d[c];
+                        }
+                    }
+                }
+            }
+
+            glm::vec4 axis = high - low;
+            for (int iteration = 0; iteration < 8; ++iteration) {
+                glm::vec4 next(0.0f);
+                for (int r = 0; r < 4; ++r) {
+                    for (int c = 0; c < 4; ++c) {
+                        next[r] += covariance[r][c] * axis[c];
+                    }
+                }
+                const float length = std::sqrt(glm::dot(next, next));
+                if (length < 1e-6f) {
+                    break;
+                }
+                axis = next / length;
+            }
+            const float axisLength = std::sqrt(glm::dot(axis, axis));
+            if (axisLength < 1e-6f) {
+                e0 = e1 = mean;
+                return;
+            }
+            axis /= axisLength;
+
+            float minT = std::numeric_limits<float>::max(), maxT = -std::numeric_limits<float>::max();
+            for (int i = 0; i < BlockTexels; ++i) {
+                if (weights[i] > 0.0f) {
+                    const float t = glm::dot(texels[i] - mean, axis);
+                    minT = std::min(minT, t);
+                    maxT = std::max(maxT, t);
+                }
+            }
+            e0 = glm::clamp(mean + axis * minT, glm::vec4(0.0f), glm::vec4(255.0f));
+            e1 = glm::clamp(mean + axis * maxT, glm::vec4(0.0f), glm::vec4(255.0f));
+        }
+
+        // Least squares endpoints for texels interpolated at t between e0 and e1
+        bool solveEndpoints(const glm::vec4 *texels, const float *weights, const float *t, glm::vec4 &e0, glm::vec4 &e1) {
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            glm::vec4 x0(0.0f), x1(0.0f);
+            for (int i = 0; i < BlockTexels; ++i) {
+                if (weights[i] > 0.0f) {
+                    const float s = 1.0f - t[i];
+                    a += s * s;
+                    b += s * t[i];
+                    c += t[i] * t[i];
+                    x0 += texels[i] * s;
+                    x1 += texels[i] * t[i];
+                }
+            }
+            const float determinant = a * c - b * b;
+            if (std::fabs(determinant) < 1e-6f) {
+                return false;
+            }
+
+            e0 = glm::clamp((x0 * c - x1 * b) / determinant, glm::vec4(0.0f), glm::vec4(255.0f));
+            e1 = glm::clamp((x1 * a - x0 * b) / determinant, glm::vec4(0.0f), glm::vec4(255.0f));
+
+            return true;
+        }
+
+        uint16_t packRgb565(const glm::vec4 &color) {
+            const uint32_t r = static_cast<uint32_t>(std::lround(color.x * 31.0f / 255.0f));
+            const uint32_t g = static_cast<uint32_t>(std::lround(color.y * 63.0f / 255.0f));
+            const uint32_t b = static_cast<uint32_t>(std::lround(color.z * 31.0f / 255.0f));
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        glm::ivec4 unpackRgb565(uint16_t color) {
+            const int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+            return glm::ivec4((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255);
+        }
+
+        void buildBc1Palette(uint16_t c0, uint16_t c1, bool threeColor, glm::ivec4 palette[4]) {
+            palette[0] = unpackRgb565(c0);
+            palette[1] = unpackRgb565(c1);
+            if (threeColor) {
+                palette[2] = (palette[0] + palette[1]) / 2;
+                palette[3] = glm::ivec4(0);
+            } else {
+                palette[2] = (palette[0] * 2 + palette[1]) / 3;
+                palette[3] = (palette[0] + palette[1] * 2) / 3;
+            }
+        }
+
+        float evaluateBc1(const glm::vec4 *texels, const float *weights, uint16_t c0, uint16_t c1, bool threeColor, uint8_t indices[BlockTexels]) {
+            glm::ivec4 palette[4];
+            buildBc1Palette(c0, c1, threeColor, palette);
+            const int numColors = threeColor ? 3 : 4;
+            float error = 0.0f;
+            for (int i = 0; i < BlockTexels; ++i) {
+                if (weights[i] == 0.0f) {
+                    indices[i] = 3;
+                    continue;
+                }
+                float best = std::numeric_limits<float>::max();
+                for (int p = 0; p < numColors; ++p) {
+                    const glm::vec4 color(palette[p].x, palette[p].y, palette[p].z, 0.0f);
+                    const float distance = squaredDistance(texels[i], color);
+                    if (distance < best) {
+                        best = distance;
+                        indices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        // Transparent texels need the three color mode, which is selected by c0 <= c1
+        void encodeBc1Block(const uint8_t *rgba, uint8_t *block, bool allowTransparent) {
+            glm::vec4 texels[BlockTexels];
+            float weights[BlockTexels];
+            bool threeColor = false, anyOpaque = false;
+            for (int i = 0; i < BlockTexels; ++i) {
+                texels[i] = glm::vec4(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], 0.0f);
+                weights[i] = allowTransparent && rgba[i * 4 + 3] < 128 ? 0.0f : 1.0f;
+                threeColor = threeColor || weights[i] == 0.0f;
+                anyOpaque = anyOpaque || weights[i] > 0.0f;
+            }
+            memset(block, 0, 8);
+            if (!anyOpaque) {
+                memset(block + 4, 0xff, 4);
+                return;
+            }
+
+            glm::vec4 e0, e1;
+            fitEndpoints(texels, weights, e0, e1);
+            float bestError = std::numeric_limits<float>::max();
+            uint16_t bestC0 = 0, bestC1 = 0;
+            uint8_t bestIndices[BlockTexels] = {};
+            for (int round = 0; round <= EndpointRefinements; ++round) {
+                uint16_t c0 = packRgb565(e1), c1 = packRgb565(e0);
+                if (threeColor ? c0 > c1 : c0 < c1) {
+                    std::swap(c0, c1);
+                }
+                uint8_t indices[BlockTexels];
+                const float error = evaluateBc1(texels, weights, c0, c1, threeColor, indices);
+                if (error < bestError) {
+                    bestError = error;
+                    bestC0 = c0;
+                    bestC1 = c1;
+                    memcpy(bestIndices, indices, sizeof(indices));
+                }
+                if (bestError == 0.0f || round == EndpointRefinements) {
+                    break;
+                }
+
+                const float fourColorT[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+                const float threeColorT[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+                float t[BlockTexels];
+                for (int i = 0; i < BlockTexels; ++i) {
+                    t[i] = threeColor ? threeColorT[bestIndices[i]] : fourColorT[bestIndices[i]];
+                }
+                if (!solveEndpoints(texels, weights, t, e1, e0)) {
+                    break;
+                }
+            }
+
+            memcpy(block, &bestC0, sizeof(bestC0));
+            memcpy(block + 2, &bestC1, sizeof(bestC1));
+            uint32_t bits = 0;
+            for (int i = 0; i < BlockTexels; ++i) {
+                bits |= static_cast<uint32_t>(bestIndices[i]) << (i * 2);
+            }
+            memcpy(block + 4, &bits, sizeof(bits));
+        }
+
+        void decodeBc1Block(const uint8_t *block, uint8_t *rgba, bool allowTransparent) {
+            uint16_t c0, c1;
+            uint32_t bits;
+            memcpy(&c0, block, sizeof(c0));
+            memcpy(&c1, block + 2, sizeof(c1));
+            memcpy(&bits, block + 4, sizeof(bits));
+            glm::ivec4 palette[4];
+            buildBc1Palette(c0, c1, allowTransparent && c0 <= c1, palette);
+            for (int i = 0; i < BlockTexels; ++i) {
+                const glm::ivec4 &color = palette[(bits >> (i * 2)) & 3u];
+                for (int c = 0; c < 4; ++c) {
+                    rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+                }
+            }
+        }
+
+        void buildBc4Palette(int e0, int e1, int palette[8]) {
+            palette[0] = e0;
+            palette[1] = e1;
+            if (e0 > e1) {
+                for (int i = 2; i < 8; ++i) {
+                    palette[i] = ((8 - i) * e0 + (i - 1) * e1) / 7;
+                }
+            } else {
+                for (int i = 2; i < 6; ++i) {
+                    palette[i] = ((6 - i) * e0 + (i - 1) * e1) / 5;
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        int evaluateBc4(const int *values, int e0, int e1, uint8_t indices[BlockTexels]) {
+            int palette[8];
+            buildBc4Palette(e0, e1, palette);
+            int error = 0;
+            for (int i = 0; i < BlockTexels; ++i) {
+                int best = std::numeric_limits<int>::max();
+                for (int p = 0; p < 8; ++p) {
+                    const int distance = (values[i] - palette[p]) * (values[i] - palette[p]);
+                    if (distance < best) {
+                        best = distance;
+                        indices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        // The eight value mode interpolates between the extremes, the six value mode keeps 
+        // exact 0 and 255 for blocks that also contain values in between
+        void encodeBc4Block(const uint8_t *rgba, int channel, uint8_t *block) {
+            int values[BlockTexels];
+            int low = 255, high = 0, innerLow = 255, innerHigh = 0;
+            for (int i = 0; i < BlockTexels; ++i) {
+                values[i] = rgba[i * 4 + channel];
+                low = std::min(low, values[i]);
+                high = std::max(high, values[i]);
+                if (values[i] != 0 && values[i] != 255) {
+                    innerLow = std::min(innerLow, values[i]);
+                    innerHigh = std::max(innerHigh, values[i]);
+                }
+            }
+
+            int bestE0 = high, bestE1 = low;
+            uint8_t bestIndices[BlockTexels] = {};
+            int bestError = high == low ? 0 : evaluateBc4(values, high, low, bestIndices);
+            for (int round = 0; round < EndpointRefinements && bestError != 0; ++round) {
+                glm::vec4 texels[BlockTexels];
+                float weights[BlockTexels], t[BlockTexels];
+                for (int i = 0; i < BlockTexels; ++i) {
+                    texels[i] = glm::vec4(static_cast<float>(values[i]), 0.0f, 0.0f, 0.0f);
+                    weights[i] = 1.0f;
+                    t[i] = bestIndices[i] == 0 ? 0.0f : (bestIndices[i] == 1 ? 1.0f : static_cast<float>(bestIndices[i] - 1) / 7.0f);
+                }
+                glm::vec4 e0, e1;
+                if (!solveEndpoints(texels, weights, t, e0, e1)) {
+                    break;
+                }
+                const int q0 = static_cast<int>(std::lround(e0.x)), q1 = static_cast<int>(std::lround(e1.x));
+                if (q0 <= q1) {
+                    break;
+                }
+                uint8_t indices[BlockTexels];
+                const int error = evaluateBc4(values, q0, q1, indices);
+                if (error >= bestError) {
+                    break;
+                }
+                bestError = error;
+                bestE0 = q0;
+                bestE1 = q1;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+            if (bestError != 0 && innerLow <= innerHigh && (low == 0 || high == 255)) {
+                uint8_t indices[BlockTexels];
+                const int error = evaluateBc4(values, innerLow, innerHigh, indices);
+                if (error < bestError) {
+                    bestE0 = innerLow;
+                    bestE1 = innerHigh;
+                    memcpy(bestIndices, indices, sizeof(indices));
+                }
+            }
+
+            block[0] = static_cast<uint8_t>(bestE0);
+            block[1] = static_cast<uint8_t>(bestE1);
+            uint64_t bits = 0;
+            for (int i = 0; i < BlockTexels; ++i) {
+                bits |= static_cast<uint64_t>(bestIndices[i]) << (i * 3);
+            }
+            for (int i = 0; i < 6; ++i) {
+                block[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+            }
+        }
+
+        void decodeBc4Block(const uint8_t *block, uint8_t *rgba, int channel) {
+            int palette[8];
+            buildBc4Palette(block[0], block[1], palette);
+            uint64_t bits = 0;
+            for (int i = 0; i < 6; ++i) {
+                bits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+            }
+            for (int i = 0; i < BlockTexels; ++i) {
+                rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7u]);
+            }
+        }
+
+        float evaluateBc7(const glm::vec4 *texels, const glm::ivec4 &v0, const glm::ivec4 &v1, uint8_t indices[BlockTexels]) {
+            glm::vec4 palette[16];
+            for (int p = 0; p < 16; ++p) {
+                palette[p] = glm::vec4((v0 * (64 - Bc7Weights[p]) + v1 * Bc7Weights[p] + 32) / 64);
+            }
+            float error = 0.0f;
+            for (int i = 0; i < BlockTexels; ++i) {
+                float best = std::numeric_limits<float>::max();
+                for (int p = 0; p < 16; ++p) {
+                    const float distance = squaredDistance(texels[i], palette[p]);
+                    if (distance < best) {
+                        best = distance;
+                        indices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        glm::ivec4 quantizeBc7Endpoint(const glm::vec4 &endpoint, int pBit) {
+            glm::ivec4 quantized;
+            for (int c = 0; c < 4; ++c) {
+                quantized[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - static_cast<float>(pBit)) * 0.5f)), 0, 127);
+            }
+            return quantized;
+        }
+
+        // Mode 6: 7 bit RGBA endpoints with one shared low bit each and 4 bit indices
+        void encodeBc7Block(const uint8_t *rgba, uint8_t *block) {
+            glm::vec4 texels[BlockTexels];
+            float weights[BlockTexels];
+            for (int i = 0; i < BlockTexels; ++i) {
+                texels[i] = glm::vec4(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+                weights[i] = 1.0f;
+            }
+
+            glm::vec4 e0, e1;
+            fitEndpoints(texels, weights, e0, e1);
+            float bestError = std::numeric_limits<float>::max();
+            glm::ivec4 bestQ0(0), bestQ1(0);
+            int bestP0 = 0, bestP1 = 0;
+            uint8_t bestIndices[BlockTexels] = {};
+            for (int round = 0; round <= EndpointRefinements; ++round) {
+                const float previousError = bestError;
+                for (int p0 = 0; p0 < 2; ++p0) {
+                    for (int p1 = 0; p1 < 2; ++p1) {
+                        const glm::ivec4 q0 = quantizeBc7Endpoint(e0, p0), q1 = quantizeBc7Endpoint(e1, p1);
+                        uint8_t indices[BlockTexels];
+                        const float error = evaluateBc7(texels, q0 * 2 + p0, q1 * 2 + p1, indices);
+                        if (error < bestError) {
+                            bestError = error;
+                            bestQ0 = q0;
+                            bestQ1 = q1;
+                            bestP0 = p0;
+                            bestP1 = p1;
+                            memcpy(bestIndices, indices, sizeof(indices));
+                        }
+                    }
+                }
+                if (bestError == 0.0f || bestError >= previousError || round == EndpointRefinements) {
+                    break;
+                }
+
+                float t[BlockTexels];
+                for (int i = 0; i < BlockTexels; ++i) {
+                    t[i] = static_cast<float>(Bc7Weights[bestIndices[i]]) / 64.0f;
+                }
+                if (!solveEndpoints(texels, weights, t, e0, e1)) {
+                    break;
+                }
+            }
+
+            // The high bit of the first index is implied zero
+            if (bestIndices[0] >= 8) {
+                std::swap(bestQ0, bestQ1);
+                std::swap(bestP0, bestP1);
+                for (uint8_t &index : bestIndices) {
+                    index = static_cast<uint8_t>(15 - index);
+                }
+            }
+
+            memset(block, 0, 16);
+            BitWriter writer{ block };
+            writer.write(1u << 6, 7);
+            for (int c = 0; c < 4; ++c) {
+                writer.write(static_cast<uint32_t>(bestQ0[c]), 7);
+                writer.write(static_cast<uint32_t>(bestQ1[c]), 7);
+            }
+            writer.write(static_cast<uint32_t>(bestP0), 1);
+            writer.write(static_cast<uint32_t>(bestP1), 1);
+            for (int i = 0; i < BlockTexels; ++i) {
+                writer.write(bestIndices[i], i == 0 ? 3 : 4);
+            }
+        }
+
+        // Only mode 6 is decoded, the encoder writes no other mode
+        void decodeBc7Block(const uint8_t *block, uint8_t *rgba) {
+            BitReader reader{ block };
+            if (reader.read(7) != (1u << 6)) {
+                memset(rgba, 0, BlockTexels * 4);
+                return;
+            }
+
+            glm::ivec4 v0, v1;
+            for (int c = 0; c < 4; ++c) {
+                v0[c] = static_cast<int>(reader.read(7)) << 1;
+                v1[c] = static_cast<int>(reader.read(7)) << 1;
+            }
+            v0 += glm::ivec4(static_cast<int>(reader.read(1)));
+            v1 += glm::ivec4(static_cast<int>(reader.read(1)));
+            for (int i = 0; i < BlockTexels; ++i) {
+                const int weight = Bc7Weights[reader.read(i == 0 ? 3 : 4)];
+                const glm::ivec4 color = (v0 * (64 - weight) + v1 * weight + 32) / 64;
+                for (int c = 0; c < 4; ++c) {
+                    rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+                }
+            }
+        }
+
+        int getStoredChannels(TextureFormat format) {
+            switch (format) {
+                case TextureFormat::BC1:
+                    return 3;
+                case TextureFormat::BC5:
+                    return 2;
+                default:
+                    break;
+            }
+            return 4;
+        }
+
+    } // namespace
+
+    TextureFormat getTextureFormatByName(const std::string &name) {
+        if (name == "rgba8") {
+            return TextureFormat::RGBA8;
+        } else if (name == "bc1") {
+            return TextureFormat::BC1;
+        } else if (name == "bc3") {
+            return TextureFormat::BC3;
+        } else if (name == "bc5") {
+            return TextureFormat::BC5;
+        } else if (name == "bc7") {
+            return TextureFormat::BC7;
+        }
+
+        return TextureFormat::Invalid;
+    }
+
+    bool encodeImage(const BakeImage &image, TextureFormat format, std::vector<uint8_t> &data, core::ThreadPool *threadPool) {
+        const size_t size = computeTextureMipSize(format, image.width, image.height);
+        if (size == 0 || image.pixels.size() != static_cast<size_t>(image.width) * image.height * 4) {
+            return false;
+        }
+
+        if (format == TextureFormat::RGBA8) {
+            data = image.pixels;
+            return true;
+        }
+
+        data.assign(size, 0);
+        const uint32_t blockSize = getTextureBlockSize(format);
+        const uint32_t blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+        auto encodeRows = [&](size_t begin, size_t end) {
+            uint8_t rgba[BlockTexels * 4];
+            for (size_t by = begin; by < end; ++by) {
+                for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                    loadBlock(image, bx, static_cast<uint32_t>(by), rgba);
+                    uint8_t *block = &data[(by * blocksX + bx) * blockSize];
+                    switch (format) {
+                        case TextureFormat::BC1:
+                            encodeBc1Block(rgba, block, true);
+                            break;
+                        case TextureFormat::BC3:
+                            encodeBc4Block(rgba, 3, block);
+                            encodeBc1Block(rgba, block + 8, false);
+                            break;
+                        case TextureFormat::BC5:
+                            encodeBc4Block(rgba, 0, block);
+                            encodeBc4Block(rgba, 1, block + 8);
+                            break;
+                        case TextureFormat::BC7:
+                            encodeBc7Block(rgba, block);
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+        };
+
+        // Every block row is independent and writes its own part of the data
+        if (threadPool != nullptr) {
+            threadPool->parallelFor(blocksY, 1, encodeRows);
+        } else {
+            encodeRows(0, blocksY);
+        }
+
+        return true;
+    }
+
+    float computeEncodingPsnr(const BakeImage &image, TextureFormat format, const std::vector<uint8_t> &data) {
+        if (data.size() != computeTextureMipSize(format, image.width, image.height) || data.empty()) {
+            return 0.0f;
+        }
+
+        const uint32_t extent = getTextureBlockExtent(format);
+        const uint32_t blockSize = getTextureBlockSize(format);
+        const uint32_t blocksX = (image.width + extent - 1) / extent, blocksY = (image.height + extent - 1) / extent;
+        const int numChannels = getStoredChannels(format);
+        double sum = 0.0, count = 0.0;
+        uint8_t rgba[BlockTexels * 4];
+        for (uint32_t by = 0; by < blocksY; ++by) {
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                const uint8_t *block = &data[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+                switch (format) {
+                    case TextureFormat::RGBA8:
+                        memcpy(rgba, block, 4);
+                        break;
+                    case TextureFormat::BC1:
+                        decodeBc1Block(block, rgba, true);
+                        break;
+                    case TextureFormat::BC3:
+                        decodeBc1Block(block + 8, rgba, false);
+                        decodeBc4Block(block, rgba, 3);
+                        break;
+                    case TextureFormat::BC5:
+                        decodeBc4Block(block, rgba, 0);
+                        decodeBc4Block(block + 8, rgba, 1);
+                        break;
+                    case TextureFormat::BC7:
+                        decodeBc7Block(block, rgba);
+                        break;
+                    default:
+                        break;
+                }
+
+                for (uint32_t y = 0; y < extent && by * extent + y < image.height; ++y) {
+                    for (uint32_t x = 0; x < extent && bx * extent + x < image.width; ++x) {
+                        const uint8_t *source = &image.pixels[((static_cast<size_t>(by) * extent + y) * image.width + bx * extent + x) * 4];
+                        const uint8_t *decoded = &rgba[(y * extent + x) * 4];
+                        if (format == TextureFormat::BC1 && source[3] < 128) {
+                            continue;
+                        }
+                        count += numChannels;
+                        for (int c = 0; c < numChannels; ++c) {
+                            const double difference = static_cast<double>(source[c]) - decoded[c];
+                            sum += difference * difference;
+                        }
+                    }
+                }
+            }
+        }
+
+        const double meanSquaredError = count > 0.0 ? sum / count : 0.0;
+        if (meanSquaredError == 0.0) {
+            return std::numeric_limits<float>::infinity();
+        }
+
+        return static_cast<float>(10.0 * std::log10(255.0 * 255.0 / meanSquaredError));
+    }
+
+} // namespace segfault::tools
@@ -0,0 +1,60 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include "textureimporter.h"
+#include "core/threadpool.h"
+#include "renderer/textureformat.h"
+
+#include <string>
+
+namespace segfault::tools {
+
+    /// @brief Returns the texture format for its command line name.
+    /// @param[ in ] name The name, "rgba8", "bc1", "bc3", "bc5" or "bc7".
+    /// @return The format, TextureFormat::Invalid for unknown names.
+    renderer::TextureFormat getTextureFormatByName(const std::string &name);
+
+    /// @brief Encodes an image into the GPU layout of a texture format. Blocks at the right and 
+    /// bottom border repeat the last row and column.
+    ///
+    /// BC1 switches to its three color mode with transparent black for blocks containing texels 
+    /// with an alpha below 128. BC5 stores the red and green channel. BC7 always uses mode 6, 
+    /// one RGBA endpoint pair with 16 interpolation steps.
+    /// @param[ in ] image The image.
+    /// @param[ in ] format The texture format.
+    /// @param[ out ] data The encoded image, computeTextureMipSize bytes.
+    /// @param[ in ] threadPool Encodes the block rows in parallel if set.
+    /// @return True if the image was encoded, false for invalid formats or empty images.
+    bool encodeImage(const BakeImage &image, renderer::TextureFormat format, std::vector<uint8_t> &data, 
+        core::ThreadPool *threadPool = nullptr);
+
+    /// @brief Returns the peak signal to noise ratio of an encoded image, for the statistics. 
+    /// Only the channels stored by the format are compared, transparent BC1 texels are skipped.
+    /// @param[ in ] image The original image.
+    /// @param[ in ] format The texture format of the data.
+    /// @param[ in ] data The data written by encodeImage.
+    /// @return The PSNR in dB, infinity for a lossless encoding.
+    float computeEncodingPsnr(const BakeImage &image, renderer::TextureFormat format, const std::vector<uint8_t> &data);
+
+} // namespace segfault::tools
@@ -0,0 +1,206 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "textureimporter.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace segfault::tools {
+
+    namespace {
+
+        /// The image in full precision, colors are linear or decoded normals.
+        struct FloatImage {
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+            std::vector<glm::vec4> texels;
+        };
+
+        /// The source texels covered by one destination texel in one axis.
+        struct FilterTaps {
+            std::vector<uint32_t> first;
+            std::vector<uint32_t> count;
+            std::vector<uint32_t> weightOffset;
+            std::vector<float> weights;
+        };
+
+        float srgbToLinear(float value) {
+            return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float value) {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        uint8_t packUnorm8(float value) {
+            return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+
+        // Every destination texel covers srcSize / dstSize source texels, the ones at the 
+        // border of that range are weighted by how much of them is covered
+        void computeTaps(uint32_t srcSize, uint32_t dstSize, FilterTaps &taps) {
+            const float ratio = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+            for (uint32_t i = 0; i < dstSize; ++i) {
+                const float begin = static_cast<float>(i) * ratio;
+                const float end = static_cast<float>(i + 1) * ratio;
+                const uint32_t first = static_cast<uint32_t>(begin);
+                const uint32_t last = std::min(static_cast<uint32_t>(std::ceil(end)), srcSize);
+                taps.first.push_back(first);
+                taps.count.push_back(last - first);
+                taps.weightOffset.push_back(static_cast<uint32_t>(taps.weights.size()));
+                for (uint32_t s = first; s < last; ++s) {
+                    const float overlap = std::min(end, static_cast<float>(s + 1)) - std::max(begin, static_cast<float>(s));
+                    taps.weights.push_back(overlap / ratio);
+                }
+            }
+        }
+
+        void toFloatImage(const BakeImage &image, MipFilterMode mode, FloatImage &result) {
+            float linear[256];
+            for (int i = 0; i < 256; ++i) {
+                const float value = static_cast<float>(i) / 255.0f;
+                linear[i] = mode == MipFilterMode::Srgb ? srgbToLinear(value) : 
+                    (mode == MipFilterMode::NormalMap ? value * 2.0f - 1.0f : value);
+            }
+
+            result.width = image.width;
+            result.height = image.height;
+            result.texels.resize(static_cast<size_t>(image.width) * image.height);
+            for (size_t i = 0; i < result.texels.size(); ++i) {
+                const uint8_t *pixel = &image.pixels[i * 4];
+                result.texels[i] = glm::vec4(linear[pixel[0]], linear[pixel[1]], linear[pixel[2]], static_cast<float>(pixel[3]) / 255.0f);
+            }
+        }
+
+        void toBakeImage(const FloatImage &image, MipFilterMode mode, BakeImage &result) {
+            result.width = image.width;
+            result.height = image.height;
+            result.pixels.resize(image.texels.size() * 4);
+            for (size_t i = 0; i < image.texels.size(); ++i) {
+                const glm::vec4 &texel = image.texels[i];
+                uint8_t *pixel = &result.pixels[i * 4];
+                for (int c = 0; c < 3; ++c) {
+                    const float value = texel[c];
+                    pixel[c] = packUnorm8(mode == MipFilterMode::Srgb ? linearToSrgb(value) : 
+                        (mode == MipFilterMode::NormalMap ? value * 0.5f + 0.5f : value));
+                }
+                pixel[3] = packUnorm8(texel.w);
+            }
+        }
+
+        void downsample(const FloatImage &src, MipFilterMode mode, FloatImage &dst) {
+            dst.width = std::max(src.width / 2, 1u);
+            dst.height = std::max(src.height / 2, 1u);
+            dst.texels.resize(static_cast<size_t>(dst.width) * dst.height);
+
+            FilterTaps tapsX, tapsY;
+            computeTaps(src.width, dst.width, tapsX);
+            computeTaps(src.height, dst.height, tapsY);
+            for (uint32_t y = 0; y < dst.height; ++y) {
+                for (uint32_t x = 0; x < dst.width; ++x) {
+                    glm::vec3 color(0.0f), weightedColor(0.0f);
+                    float alpha = 0.0f;
+                    for (uint32_t j = 0; j < tapsY.count[y]; ++j) {
+                        const uint32_t sy = tapsY.first[y] + j;
+                        const float wy = tapsY.weights[tapsY.weightOffset[y] + j];
+                        for (uint32_t i = 0; i < tapsX.count[x]; ++i) {
+                            const uint32_t sx = tapsX.first[x] + i;
+                            const float w = wy * tapsX.weights[tapsX.weightOffset[x] + i];
+                            const glm::vec4 &texel = src.texels[static_cast<size_t>(sy) * src.width + sx];
+                            color += glm::vec3(texel) * w;
+                            weightedColor += glm::vec3(texel) * (texel.w * w);
+                            alpha += texel.w * w;
+                        }
+                    }
+
+                    glm::vec3 result = color;
+                    if (mode == MipFilterMode::NormalMap) {
+                        const float length = glm::length(color);
+                        result = length > 0.0f ? color / length : glm::vec3(0.0f, 0.0f, 1.0f);
+                    } else if (alpha > 1e-6f) {
+                        result = weightedColor / alpha;
+                    }
+                    dst.texels[static_cast<size_t>(y) * dst.width + x] = glm::vec4(result, alpha);
+                }
+            }
+        }
+
+    } // namespace
+
+    MipFilterMode getMipFilterModeByName(const std::string &name) {
+        if (name == "linear") {
+            return MipFilterMode::Linear;
+        } else if (name == "srgb") {
+            return MipFilterMode::Srgb;
+        } else if (name == "normal") {
+            return MipFilterMode::NormalMap;
+        }
+
+        return MipFilterMode::Invalid;
+    }
+
+    bool importImage(const uint8_t *data, size_t size, BakeImage &image) {
+        image = BakeImage();
+        if (data == nullptr || size == 0 || size > 0x7fffffff) {
+            return false;
+        }
+
+        int width = 0, height = 0, channels = 0;
+        stbi_uc *pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+        if (pixels == nullptr) {
+            return false;
+        }
+
+        image.width = static_cast<uint32_t>(width);
+        image.height = static_cast<uint32_t>(height);
+        image.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+
+        return true;
+    }
+
+    void generateMips(const BakeImage &image, MipFilterMode mode, std::vector<BakeImage> &mips) {
+        mips.clear();
+        mips.push_back(image);
+        if (image.width == 0 || image.height == 0) {
+            return;
+        }
+
+        FloatImage level, next;
+        toFloatImage(image, mode, level);
+        while (level.width > 1 || level.height > 1) {
+            downsample(level, mode, next);
+            std::swap(level, next);
+            mips.emplace_back();
+            toBakeImage(level, mode, mips.back());
+        }
+    }
+
+} // namespace segfault::tools
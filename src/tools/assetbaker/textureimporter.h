@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2015-2026 Segfault by Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace segfault::tools {
+
+    /// @brief An uncompressed RGBA8 image the baker works on before it is encoded.
+    struct BakeImage {
+        uint32_t width{ 0 };            ///< The width in pixels.
+        uint32_t height{ 0 };           ///< The height in pixels.
+        std::vector<uint8_t> pixels;    ///< The rows from top to bottom, four bytes per pixel.
+    };
+
+    /// @brief How the mip levels of an image are filtered.
+    enum class MipFilterMode : int32_t {
+        Invalid = -1,
+        Linear,         ///< The channels hold linear data and are averaged as they are.
+        Srgb,           ///< The color channels are sRGB encoded and averaged in linear space.
+        NormalMap,      ///< The color channels hold a tangent space normal, averaged and renormalized.
+        Count
+    };
+
+    /// @brief Returns the mip filter mode for its command line name.
+    /// @param[ in ] name The name, "linear", "srgb" or "normal".
+    /// @return The mode, MipFilterMode::Invalid for unknown names.
+    MipFilterMode getMipFilterModeByName(const std::string &name);
+
+    /// @brief Imports an image file, every format stb_image can read is supported. Images 
+    /// with less than four channels get an opaque alpha channel.
+    /// @param[ in ] data The file content.
+    /// @param[ in ] size The size of the content in bytes.
+    /// @param[ out ] image The imported image.
+    /// @return True if the image was decoded, false otherwise.
+    bool importImage(const uint8_t *data, size_t size, BakeImage &image);
+
+    /// @brief Builds the full mip chain of an image down to 1 x 1 with a box filter. Each level 
+    /// is filtered from the full precision previous level, colors are weighted by alpha so 
+    /// transparent texels do not bleed into their neighbours.
+    /// @param[ in ] image The image, becomes level 0.
+    /// @param[ in ] mode How the channels are filtered.
+    /// @param[ out ] mips The levels, starting with a copy of the image.
+    void generateMips(const BakeImage &image, MipFilterMode mode, std::vector<BakeImage> &mips);
+
+} // namespace segfault::tools